@@ -0,0 +1,48 @@
+(* Compare G1.Prepared_bases.msm with G1.pippenger_with_affine_array for the
+   same bases and scalars, and report the cost of the precomputation in number
+   of multiplications. The prepared bases pay off when the bases are reused for
+   more multiplications than this number. *)
+let () =
+  let open Bls12_381 in
+  let nb_runs = 5 in
+  List.iter
+    (fun logn ->
+      let n = 1 lsl logn in
+      let ps = G1.to_affine_array (Array.init n (fun _ -> G1.random ())) in
+      let ss = Array.init n (fun _ -> Fr.random ()) in
+      let precompute_start_time = Sys.time () in
+      let bases = G1.Prepared_bases.create ps in
+      let precompute_end_time = Sys.time () in
+      let prepared_start_time = Sys.time () in
+      for _ = 1 to nb_runs do
+        ignore @@ G1.Prepared_bases.msm bases ss
+      done ;
+      let prepared_end_time = Sys.time () in
+      let pippenger_start_time = Sys.time () in
+      for _ = 1 to nb_runs do
+        ignore @@ G1.pippenger_with_affine_array ps ss
+      done ;
+      let pippenger_end_time = Sys.time () in
+      let res_precompute =
+        (precompute_end_time -. precompute_start_time) *. 1000.
+      in
+      let res_prepared =
+        (prepared_end_time -. prepared_start_time)
+        *. 1000. /. float_of_int nb_runs
+      in
+      let res_pippenger =
+        (pippenger_end_time -. pippenger_start_time)
+        *. 1000. /. float_of_int nb_runs
+      in
+      Printf.printf
+        "MSM of 2^%d points of G1 (window %d): prepared bases %f ms and %f ms \
+         (pippenger)\n\
+         It is a gain of %f pcts, for a precomputation of %f ms (%f MSMs)\n"
+        logn
+        (G1.Prepared_bases.window bases)
+        res_prepared
+        res_pippenger
+        (1. -. (res_prepared /. res_pippenger))
+        res_precompute
+        (res_precompute /. res_prepared))
+    [8; 10; 12; 14; 16]
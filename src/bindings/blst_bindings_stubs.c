@@ -1,12 +1,16 @@
 #include "blst.h"
 #include "blst_misc.h"
+#include "caml_bls12_381_parallel.h"
 #include "caml_bls12_381_stubs.h"
 #include "ocaml_integers.h"
 #include <caml/alloc.h>
 #include <caml/custom.h>
 #include <caml/fail.h>
+#include <caml/hash.h>
+#include <caml/intext.h>
 #include <caml/memory.h>
 #include <caml/mlvalues.h>
+#include <caml/signals.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -35,6 +39,51 @@
 #define Is_some(v) Is_block(v)
 #endif
 
+// Marshal support. The values are serialized using their raw Montgomery
+// limbs. Unless the unchecked mode is set, the deserialized values are
+// validated: the limbs must be reduced and the points must be on the curve and
+// in the prime subgroup. The mode is local to the thread, i.e. to the domain or
+// the system thread unmarshalling, so that it does not disable the validation
+// of the values unmarshalled meanwhile by the other threads.
+static __thread int unchecked_deserialization = 0;
+
+CAMLprim value caml_bls12_381_set_unchecked_deserialization_stubs(value b) {
+  CAMLparam1(b);
+  unchecked_deserialization = Bool_val(b);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_bls12_381_get_unchecked_deserialization_stubs(value unit) {
+  CAMLparam1(unit);
+  CAMLreturn(Val_bool(unchecked_deserialization));
+}
+
+static bool blst_fp2_is_reduced(const blst_fp2 *a) {
+  return (blst_fp_is_reduced(&a->fp[0]) && blst_fp_is_reduced(&a->fp[1]));
+}
+
+static bool blst_p1_affine_is_reduced(const blst_p1_affine *p) {
+  return (blst_fp_is_reduced(&p->x) && blst_fp_is_reduced(&p->y));
+}
+
+static bool blst_p2_affine_is_reduced(const blst_p2_affine *p) {
+  return (blst_fp2_is_reduced(&p->x) && blst_fp2_is_reduced(&p->y));
+}
+
+// Size of the data of a custom block, used for the contiguous arrays
+#define Custom_data_size(v) ((Wosize_val(v) - 1) * sizeof(value))
+
+// Size of the data of the custom block being unmarshalled at dst, as declared
+// by the stream. Since OCaml 5.0, the runtime allocates the block with this
+// size before calling the deserialize function. OCaml 4 writes the header of
+// the block afterwards and only compares the declared size with the one
+// returned by the deserialize function, so that the bound is not available and
+// the values of variable size, i.e. the affine arrays, are rejected.
+#if OCAML_VERSION >= 50000
+#define Custom_deserialized_size(dst)                                          \
+  Custom_data_size((value)((value *)(dst)-1))
+#endif
+
 static struct custom_operations blst_scalar_ops = {"blst_scalar",
                                                    custom_finalize_default,
                                                    custom_compare_default,
@@ -53,6 +102,19 @@ CAMLprim value allocate_scalar_stubs(value unit) {
   CAMLreturn(block);
 }
 
+void caml_blst_fr_serialize(value v, uintnat *bsize_32, uintnat *bsize_64) {
+  caml_serialize_block_8(Blst_fr_val(v), sizeof(blst_fr) / 8);
+  *bsize_32 = sizeof(blst_fr);
+  *bsize_64 = sizeof(blst_fr);
+}
+
+uintnat caml_blst_fr_deserialize(void *dst) {
+  caml_deserialize_block_8(dst, sizeof(blst_fr) / 8);
+  if (!unchecked_deserialization && !blst_fr_is_reduced((blst_fr *)dst))
+    caml_deserialize_error("blst_fr: the element is not in the field");
+  return (sizeof(blst_fr));
+}
+
 CAMLprim value caml_blst_fr_from_lendian_stubs(value x, value b) {
   CAMLparam2(x, b);
   blst_fr *x_c = Blst_fr_val(x);
@@ -336,14 +398,36 @@ CAMLprim value caml_blst_fp2_to_bytes_stubs(value buffer, value p) {
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
+static void caml_blst_fp12_serialize(value v, uintnat *bsize_32,
+                                     uintnat *bsize_64) {
+  caml_serialize_block_8(Blst_fp12_val(v), sizeof(blst_fp12) / 8);
+  *bsize_32 = sizeof(blst_fp12);
+  *bsize_64 = sizeof(blst_fp12);
+}
+
+static uintnat caml_blst_fp12_deserialize(void *dst) {
+  blst_fp *coordinates = (blst_fp *)dst;
+  caml_deserialize_block_8(dst, sizeof(blst_fp12) / 8);
+  if (!unchecked_deserialization) {
+    for (size_t i = 0; i < sizeof(blst_fp12) / sizeof(blst_fp); i++) {
+      if (!blst_fp_is_reduced(coordinates + i))
+        caml_deserialize_error("blst_fp12: the element is not in the field");
+    }
+  }
+  return (sizeof(blst_fp12));
+}
+
+static const struct custom_fixed_length blst_fp12_fixed_length = {
+    sizeof(blst_fp12), sizeof(blst_fp12)};
+
 static struct custom_operations blst_fp12_ops = {"blst_fp12",
                                                  custom_finalize_default,
                                                  custom_compare_default,
                                                  custom_hash_default,
-                                                 custom_serialize_default,
-                                                 custom_deserialize_default,
+                                                 caml_blst_fp12_serialize,
+                                                 caml_blst_fp12_deserialize,
                                                  custom_compare_ext_default,
-                                                 custom_fixed_length_default};
+                                                 &blst_fp12_fixed_length};
 
 CAMLprim value allocate_fp12_stubs(value unit) {
   CAMLparam1(unit);
@@ -420,20 +504,112 @@ CAMLprim value caml_blst_fp12_in_group_stubs(value x) {
   CAMLreturn(Val_int(r));
 }
 
+// Hash a byte sequence using the mixing function of the OCaml runtime. Used by
+// the custom blocks of points, on a canonical encoding.
+static intnat caml_bls12_381_hash_bytes(const byte *b, size_t n) {
+  uint32_t h = 0;
+  uint32_t w;
+  for (size_t i = 0; i + 4 <= n; i += 4) {
+    memcpy(&w, b + i, 4);
+    h = caml_hash_mix_uint32(h, w);
+  }
+  return ((intnat)h);
+}
+
+// Jacobian coordinates are not unique. Equal points are identified with
+// blst_p1_is_equal, which does not require any inversion. Otherwise, the order
+// is given by the compressed affine encoding. The inversion is skipped for
+// points with Z = 1, see caml_blst_p1_normalize_stubs.
+static int caml_blst_p1_compare(value x, value y) {
+  blst_p1 *x_c = Blst_p1_val(x);
+  blst_p1 *y_c = Blst_p1_val(y);
+  byte x_bytes[48];
+  byte y_bytes[48];
+  if (blst_p1_is_equal(x_c, y_c))
+    return (0);
+  blst_p1_compress(x_bytes, x_c);
+  blst_p1_compress(y_bytes, y_c);
+  return (memcmp(x_bytes, y_bytes, 48) < 0 ? -1 : 1);
+}
+
+static intnat caml_blst_p1_hash(value x) {
+  byte bytes[48];
+  blst_p1_compress(bytes, Blst_p1_val(x));
+  return (caml_bls12_381_hash_bytes(bytes, 48));
+}
+
+// The affine representation is unique (the point at infinity is (0, 0)), the
+// raw Montgomery limbs can be used directly.
+static int caml_blst_p1_affine_compare(value x, value y) {
+  int r = memcmp(Blst_p1_affine_val(x), Blst_p1_affine_val(y),
+                 sizeof(blst_p1_affine));
+  return (r < 0 ? -1 : (r > 0 ? 1 : 0));
+}
+
+static intnat caml_blst_p1_affine_hash(value x) {
+  return (caml_bls12_381_hash_bytes((byte *)Blst_p1_affine_val(x),
+                                    sizeof(blst_p1_affine)));
+}
+
+static void caml_blst_p1_serialize(value v, uintnat *bsize_32,
+                                   uintnat *bsize_64) {
+  caml_serialize_block_8(Blst_p1_val(v), sizeof(blst_p1) / 8);
+  *bsize_32 = sizeof(blst_p1);
+  *bsize_64 = sizeof(blst_p1);
+}
+
+static uintnat caml_blst_p1_deserialize(void *dst) {
+  blst_p1 *p = (blst_p1 *)dst;
+  caml_deserialize_block_8(dst, sizeof(blst_p1) / 8);
+  if (!unchecked_deserialization &&
+      !(blst_fp_is_reduced(&p->x) && blst_fp_is_reduced(&p->y) &&
+        blst_fp_is_reduced(&p->z) && blst_p1_on_curve(p) && blst_p1_in_g1(p)))
+    caml_deserialize_error("blst_p1: the point is not in the prime subgroup");
+  return (sizeof(blst_p1));
+}
+
+static const struct custom_fixed_length blst_p1_fixed_length = {
+    sizeof(blst_p1), sizeof(blst_p1)};
+
+static void caml_blst_p1_affine_serialize(value v, uintnat *bsize_32,
+                                          uintnat *bsize_64) {
+  caml_serialize_block_8(Blst_p1_affine_val(v), sizeof(blst_p1_affine) / 8);
+  *bsize_32 = sizeof(blst_p1_affine);
+  *bsize_64 = sizeof(blst_p1_affine);
+}
+
+static uintnat caml_blst_p1_affine_deserialize(void *dst) {
+  blst_p1_affine *p = (blst_p1_affine *)dst;
+  caml_deserialize_block_8(dst, sizeof(blst_p1_affine) / 8);
+  if (!unchecked_deserialization &&
+      !(blst_p1_affine_is_reduced(p) && blst_p1_affine_on_curve(p) &&
+        blst_p1_affine_in_g1(p)))
+    caml_deserialize_error(
+        "blst_p1_affine: the point is not in the prime subgroup");
+  return (sizeof(blst_p1_affine));
+}
+
+static const struct custom_fixed_length blst_p1_affine_fixed_length = {
+    sizeof(blst_p1_affine), sizeof(blst_p1_affine)};
+
 static struct custom_operations blst_p1_ops = {"blst_p1",
                                                custom_finalize_default,
-                                               custom_compare_default,
-                                               custom_hash_default,
-                                               custom_serialize_default,
-                                               custom_deserialize_default,
+                                               caml_blst_p1_compare,
+                                               caml_blst_p1_hash,
+                                               caml_blst_p1_serialize,
+                                               caml_blst_p1_deserialize,
                                                custom_compare_ext_default,
-                                               custom_fixed_length_default};
+                                               &blst_p1_fixed_length};
 
 static struct custom_operations blst_p1_affine_ops = {
-    "blst_p1_affine",           custom_finalize_default,
-    custom_compare_default,     custom_hash_default,
-    custom_serialize_default,   custom_deserialize_default,
-    custom_compare_ext_default, custom_fixed_length_default};
+    "blst_p1_affine",
+    custom_finalize_default,
+    caml_blst_p1_affine_compare,
+    caml_blst_p1_affine_hash,
+    caml_blst_p1_affine_serialize,
+    caml_blst_p1_affine_deserialize,
+    custom_compare_ext_default,
+    &blst_p1_affine_fixed_length};
 
 CAMLprim value allocate_p1_stubs(value unit) {
   CAMLparam1(unit);
@@ -465,6 +641,14 @@ CAMLprim value caml_blst_p1_from_affine_stubs(value buffer, value p) {
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
+CAMLprim value caml_blst_p1_normalize_stubs(value p) {
+  CAMLparam1(p);
+  blst_p1_affine p_affine;
+  blst_p1_to_affine(&p_affine, Blst_p1_val(p));
+  blst_p1_from_affine(Blst_p1_val(p), &p_affine);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
 CAMLprim value caml_blst_p1_double_stubs(value buffer, value p) {
   CAMLparam2(buffer, p);
   blst_p1_double(Blst_p1_val(buffer), Blst_p1_val(p));
@@ -569,20 +753,95 @@ CAMLprim value caml_blst_p1_set_coordinates_stubs(value buffer, value x,
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
+// See caml_blst_p1_compare
+static int caml_blst_p2_compare(value x, value y) {
+  blst_p2 *x_c = Blst_p2_val(x);
+  blst_p2 *y_c = Blst_p2_val(y);
+  byte x_bytes[96];
+  byte y_bytes[96];
+  if (blst_p2_is_equal(x_c, y_c))
+    return (0);
+  blst_p2_compress(x_bytes, x_c);
+  blst_p2_compress(y_bytes, y_c);
+  return (memcmp(x_bytes, y_bytes, 96) < 0 ? -1 : 1);
+}
+
+static intnat caml_blst_p2_hash(value x) {
+  byte bytes[96];
+  blst_p2_compress(bytes, Blst_p2_val(x));
+  return (caml_bls12_381_hash_bytes(bytes, 96));
+}
+
+static int caml_blst_p2_affine_compare(value x, value y) {
+  int r = memcmp(Blst_p2_affine_val(x), Blst_p2_affine_val(y),
+                 sizeof(blst_p2_affine));
+  return (r < 0 ? -1 : (r > 0 ? 1 : 0));
+}
+
+static intnat caml_blst_p2_affine_hash(value x) {
+  return (caml_bls12_381_hash_bytes((byte *)Blst_p2_affine_val(x),
+                                    sizeof(blst_p2_affine)));
+}
+
+static void caml_blst_p2_serialize(value v, uintnat *bsize_32,
+                                   uintnat *bsize_64) {
+  caml_serialize_block_8(Blst_p2_val(v), sizeof(blst_p2) / 8);
+  *bsize_32 = sizeof(blst_p2);
+  *bsize_64 = sizeof(blst_p2);
+}
+
+static uintnat caml_blst_p2_deserialize(void *dst) {
+  blst_p2 *p = (blst_p2 *)dst;
+  caml_deserialize_block_8(dst, sizeof(blst_p2) / 8);
+  if (!unchecked_deserialization &&
+      !(blst_fp2_is_reduced(&p->x) && blst_fp2_is_reduced(&p->y) &&
+        blst_fp2_is_reduced(&p->z) && blst_p2_on_curve(p) && blst_p2_in_g2(p)))
+    caml_deserialize_error("blst_p2: the point is not in the prime subgroup");
+  return (sizeof(blst_p2));
+}
+
+static const struct custom_fixed_length blst_p2_fixed_length = {
+    sizeof(blst_p2), sizeof(blst_p2)};
+
+static void caml_blst_p2_affine_serialize(value v, uintnat *bsize_32,
+                                          uintnat *bsize_64) {
+  caml_serialize_block_8(Blst_p2_affine_val(v), sizeof(blst_p2_affine) / 8);
+  *bsize_32 = sizeof(blst_p2_affine);
+  *bsize_64 = sizeof(blst_p2_affine);
+}
+
+static uintnat caml_blst_p2_affine_deserialize(void *dst) {
+  blst_p2_affine *p = (blst_p2_affine *)dst;
+  caml_deserialize_block_8(dst, sizeof(blst_p2_affine) / 8);
+  if (!unchecked_deserialization &&
+      !(blst_p2_affine_is_reduced(p) && blst_p2_affine_on_curve(p) &&
+        blst_p2_affine_in_g2(p)))
+    caml_deserialize_error(
+        "blst_p2_affine: the point is not in the prime subgroup");
+  return (sizeof(blst_p2_affine));
+}
+
+static const struct custom_fixed_length blst_p2_affine_fixed_length = {
+    sizeof(blst_p2_affine), sizeof(blst_p2_affine)};
+
 static struct custom_operations blst_p2_ops = {"blst_p2",
                                                custom_finalize_default,
-                                               custom_compare_default,
-                                               custom_hash_default,
-                                               custom_serialize_default,
-                                               custom_deserialize_default,
+                                               caml_blst_p2_compare,
+                                               caml_blst_p2_hash,
+                                               caml_blst_p2_serialize,
+                                               caml_blst_p2_deserialize,
                                                custom_compare_ext_default,
-                                               custom_fixed_length_default};
+                                               &blst_p2_fixed_length};
 
 static struct custom_operations blst_p2_affine_ops = {
-    "blst_p2_affine",           custom_finalize_default,
-    custom_compare_default,     custom_hash_default,
-    custom_serialize_default,   custom_deserialize_default,
-    custom_compare_ext_default, custom_fixed_length_default};
+    "blst_p2_affine",
+    custom_finalize_default,
+    caml_blst_p2_affine_compare,
+    caml_blst_p2_affine_hash,
+    caml_blst_p2_affine_serialize,
+    caml_blst_p2_affine_deserialize,
+    custom_compare_ext_default,
+    &blst_p2_affine_fixed_length};
 
 CAMLprim value allocate_p2_stubs(value unit) {
   CAMLparam1(unit);
@@ -614,6 +873,14 @@ CAMLprim value caml_blst_p2_from_affine_stubs(value buffer, value p) {
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
+CAMLprim value caml_blst_p2_normalize_stubs(value p) {
+  CAMLparam1(p);
+  blst_p2_affine p_affine;
+  blst_p2_to_affine(&p_affine, Blst_p2_val(p));
+  blst_p2_from_affine(Blst_p2_val(p), &p_affine);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
 CAMLprim value caml_blst_p2_double_stubs(value buffer, value p) {
   CAMLparam2(buffer, p);
   blst_p2_double(Blst_p2_val(buffer), Blst_p2_val(p));
@@ -753,137 +1020,968 @@ CAMLprim value caml_blst_final_exponentiation_stubs(value buffer, value p) {
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
-// Hypothesis: jacobian_list and scalars are arrays of size *at least* start +
-// npoints
-CAMLprim value caml_blst_g1_pippenger_stubs(value buffer, value jacobian_list,
-                                            value scalars, value start,
-                                            value npoints) {
-  CAMLparam5(buffer, jacobian_list, scalars, start, npoints);
-  size_t npoints_c = ctypes_size_t_val(npoints);
-  size_t start_c = ctypes_size_t_val(start);
+// Batch conversion to affine coordinates. blst_p1s_to_affine shares one
+// inversion between all the points but requires Z != 0: the points at infinity
+// are replaced by the generator and their output is reset to the all-zero
+// affine point afterwards, which is the encoding of the infinity used by blst.
+// The points are OCaml custom blocks, so they never alias the static
+// generator. For large inputs, the points are split in chunks converted in
+// parallel, i.e. one inversion per chunk. The array of pointers is modified.
+#define CAML_BLS12_381_TO_AFFINE_MIN_CHUNK_SIZE 1024
+
+typedef struct {
+  void *dst;
+  const void **points;
+  size_t n;
+  size_t chunk_size;
+} to_affine_ctx;
+
+// Split n elements in at most one chunk per thread, each chunk having at least
+// min_chunk_size elements. Returns the number of chunks.
+static size_t parallel_nb_chunks(size_t n, size_t min_chunk_size,
+                                 size_t *chunk_size) {
+  size_t nb_chunks = n / min_chunk_size;
+  size_t nb_threads = caml_bls12_381_get_nb_threads();
+  if (nb_chunks > nb_threads)
+    nb_chunks = nb_threads;
+  if (nb_chunks < 1)
+    nb_chunks = 1;
+  *chunk_size = (n + nb_chunks - 1) / nb_chunks;
+  return ((n + *chunk_size - 1) / *chunk_size);
+}
 
-  blst_p1_affine **addr_ps =
-      (blst_p1_affine **)calloc(npoints_c, sizeof(blst_p1_affine *));
-  if (addr_ps == NULL) {
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+static void p1_to_affine_chunk(size_t k, void *arg) {
+  to_affine_ctx *ctx = (to_affine_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  blst_p1_affine *dst = (blst_p1_affine *)ctx->dst + start;
+  const blst_p1 **points = (const blst_p1 **)ctx->points + start;
+  const blst_p1 *generator = blst_p1_generator();
+  for (size_t i = 0; i < len; i++) {
+    if (blst_p1_is_inf(points[i]))
+      points[i] = generator;
   }
-  blst_p1_affine *ps =
-      (blst_p1_affine *)calloc(npoints_c, sizeof(blst_p1_affine));
-  if (ps == NULL) {
-    free(addr_ps);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_p1s_to_affine(dst, points, len);
+  for (size_t i = 0; i < len; i++) {
+    if (points[i] == generator)
+      memset(dst + i, 0, sizeof(blst_p1_affine));
   }
+}
 
-  byte **addr_scalars_bs = (byte **)calloc(npoints_c, sizeof(byte *));
-  if (addr_scalars_bs == NULL) {
-    free(addr_ps);
-    free(ps);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+static void caml_blst_p1s_to_affine(blst_p1_affine *dst,
+                                    const blst_p1 **points, size_t n) {
+  if (n == 0)
+    return;
+  to_affine_ctx ctx = {dst, (const void **)points, n, 0};
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_TO_AFFINE_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p1_to_affine_chunk, &ctx);
+}
+
+static void p2_to_affine_chunk(size_t k, void *arg) {
+  to_affine_ctx *ctx = (to_affine_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  blst_p2_affine *dst = (blst_p2_affine *)ctx->dst + start;
+  const blst_p2 **points = (const blst_p2 **)ctx->points + start;
+  const blst_p2 *generator = blst_p2_generator();
+  for (size_t i = 0; i < len; i++) {
+    if (blst_p2_is_inf(points[i]))
+      points[i] = generator;
   }
-  byte *scalars_bs = (byte *)calloc(npoints_c * 32, sizeof(byte));
-  if (scalars_bs == NULL) {
-    free(addr_ps);
-    free(ps);
-    free(addr_scalars_bs);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_p2s_to_affine(dst, points, len);
+  for (size_t i = 0; i < len; i++) {
+    if (points[i] == generator)
+      memset(dst + i, 0, sizeof(blst_p2_affine));
+  }
+}
+
+static void caml_blst_p2s_to_affine(blst_p2_affine *dst,
+                                    const blst_p2 **points, size_t n) {
+  if (n == 0)
+    return;
+  to_affine_ctx ctx = {dst, (const void **)points, n, 0};
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_TO_AFFINE_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p2_to_affine_chunk, &ctx);
+}
+
+// Bulk addition of affine points with blst_p1s_add, which shares one inversion
+// between the additions of each layer of a binary tree. For large inputs, the
+// points are split in chunks summed in parallel. Returns 1 if the allocation
+// of the partial sums fails.
+typedef struct {
+  void *partial_sums;
+  const void *points;
+  size_t n;
+  size_t chunk_size;
+} add_bulk_ctx;
+
+static void p1_add_chunk(size_t k, void *arg) {
+  add_bulk_ctx *ctx = (add_bulk_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  // A NULL pointer means the points are contiguous
+  const blst_p1_affine *points[2] = {
+      (const blst_p1_affine *)ctx->points + start, NULL};
+  blst_p1s_add((blst_p1 *)ctx->partial_sums + k, points, len);
+}
+
+static int caml_blst_p1s_add(blst_p1 *ret, const blst_p1_affine *points,
+                             size_t n) {
+  size_t chunk_size;
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_TO_AFFINE_MIN_CHUNK_SIZE, &chunk_size);
+  blst_p1 *partial_sums = (blst_p1 *)calloc(nb_chunks, sizeof(blst_p1));
+  if (partial_sums == NULL)
+    return (1);
+  add_bulk_ctx ctx = {partial_sums, points, n, chunk_size};
+  caml_bls12_381_parallel_for(nb_chunks, p1_add_chunk, &ctx);
+  memset(ret, 0, sizeof(blst_p1));
+  for (size_t k = 0; k < nb_chunks; k++)
+    blst_p1_add_or_double(ret, ret, partial_sums + k);
+  free(partial_sums);
+  return (0);
+}
+
+static void p2_add_chunk(size_t k, void *arg) {
+  add_bulk_ctx *ctx = (add_bulk_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  // A NULL pointer means the points are contiguous
+  const blst_p2_affine *points[2] = {
+      (const blst_p2_affine *)ctx->points + start, NULL};
+  blst_p2s_add((blst_p2 *)ctx->partial_sums + k, points, len);
+}
+
+static int caml_blst_p2s_add(blst_p2 *ret, const blst_p2_affine *points,
+                             size_t n) {
+  size_t chunk_size;
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_TO_AFFINE_MIN_CHUNK_SIZE, &chunk_size);
+  blst_p2 *partial_sums = (blst_p2 *)calloc(nb_chunks, sizeof(blst_p2));
+  if (partial_sums == NULL)
+    return (1);
+  add_bulk_ctx ctx = {partial_sums, points, n, chunk_size};
+  caml_bls12_381_parallel_for(nb_chunks, p2_add_chunk, &ctx);
+  memset(ret, 0, sizeof(blst_p2));
+  for (size_t k = 0; k < nb_chunks; k++)
+    blst_p2_add_or_double(ret, ret, partial_sums + k);
+  free(partial_sums);
+  return (0);
+}
+
+// MSM contexts: the buffers of the MSMs of the stubs, i.e. the scalars
+// converted to bytes, the points converted to affine coordinates, the arrays of
+// pointers, the scratch of Pippenger's algorithm, the buffers of the sparse
+// scalars and, for the multithreaded MSMs, the tiles, their results and the
+// scratch of each thread, kept from one MSM to the next instead of being
+// allocated at each call. A buffer grows to the next power of two of the
+// requested size and is never shrunk. The functions taking a context accept
+// NULL, the buffers being then allocated and freed at each call. A context must
+// not be used by two MSMs at the same time, e.g. one context per thread.
+#define MSM_CONTEXT_SCALARS 0
+#define MSM_CONTEXT_POINTS 1
+#define MSM_CONTEXT_POINTERS 2
+#define MSM_CONTEXT_SCRATCH 3
+#define MSM_CONTEXT_SPARSE_POINTS 4
+#define MSM_CONTEXT_SPARSE_SCALARS 5
+#define MSM_CONTEXT_UNITS 6
+#define MSM_CONTEXT_TILES 7
+#define MSM_CONTEXT_TILE_RESULTS 8
+#define MSM_CONTEXT_TILE_SCRATCH 9
+#define MSM_CONTEXT_NB_BUFFERS 10
+
+typedef struct {
+  void *buffers[MSM_CONTEXT_NB_BUFFERS];
+  size_t sizes[MSM_CONTEXT_NB_BUFFERS];
+} msm_context;
+
+// Return a buffer of at least size bytes, not initialised, or NULL on memory
+// allocation failure
+static void *msm_context_alloc(msm_context *ctx, int k, size_t size) {
+  if (ctx == NULL)
+    return (malloc(size > 0 ? size : 1));
+  if (ctx->sizes[k] < size || ctx->buffers[k] == NULL) {
+    size_t capacity = 64;
+    while (capacity < size)
+      capacity <<= 1;
+    free(ctx->buffers[k]);
+    ctx->buffers[k] = malloc(capacity);
+    ctx->sizes[k] = ctx->buffers[k] == NULL ? 0 : capacity;
+  }
+  return (ctx->buffers[k]);
+}
+
+static void msm_context_release(msm_context *ctx, void *buffer) {
+  if (ctx == NULL)
+    free(buffer);
+}
+
+#define Msm_context_val(v) (*((msm_context **)Data_custom_val(v)))
+
+static void finalize_free_msm_context(value v) {
+  msm_context *ctx = Msm_context_val(v);
+  if (ctx == NULL)
+    return;
+  for (int k = 0; k < MSM_CONTEXT_NB_BUFFERS; k++)
+    free(ctx->buffers[k]);
+  free(ctx);
+}
+
+static struct custom_operations msm_context_ops = {
+    "msm_context",              finalize_free_msm_context,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+CAMLprim value allocate_msm_context_stubs(value unit) {
+  CAMLparam1(unit);
+  CAMLlocal1(block);
+  block = caml_alloc_custom(&msm_context_ops, sizeof(msm_context *), 0, 1);
+  Msm_context_val(block) = NULL;
+  msm_context *ctx = (msm_context *)calloc(1, sizeof(msm_context));
+  if (ctx == NULL)
+    caml_raise_out_of_memory();
+  Msm_context_val(block) = ctx;
+  CAMLreturn(block);
+}
+
+// The scalars are elements of Fr, i.e. on 255 bits
+#define CAML_BLS12_381_FR_NBITS 255
+
+// Multithreaded Pippenger, following the tiling of the Rust bindings of blst.
+// The MSM is split in a grid of nx ranges of points times ny windows of bits.
+// Each tile computes the partial MSM of its range of points on its window, and
+// the rows are combined from the top window, doubling between the rows. The
+// result is the same point than the sequential algorithm, up to the jacobian
+// representation. Below this number of points, or with one thread, the
+// sequential algorithm is used.
+#define CAML_BLS12_381_PIPPENGER_PARALLEL_MIN_SIZE 1024
+
+// From this number of points (per tile), the buckets are accumulated in affine
+// coordinates by batches sharing one inversion, see
+// blst_p1s_mult_pippenger_affine_cont. Below, the inversions cost more than the
+// XYZZ additions.
+#define CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE 4096
+
+typedef struct {
+  size_t x0;
+  size_t dx;
+  size_t bit0;
+} msm_tile;
+
+static size_t msm_num_bits(size_t l) {
+  size_t r = 0;
+  while (l) {
+    r++;
+    l >>= 1;
   }
+  return (r);
+}
+
+// Windows of Pippenger's algorithm: msm_window_sizes[k] is the window of the
+// MSMs of npoints points for 2^k <= npoints < 2^(k + 1), 0 for the heuristic
+// of blst. The windows can be calibrated for the machine with
+// caml_blst_set_msm_window_stubs. The multithreaded MSMs start from this
+// window to split the tiles.
+static size_t msm_window_sizes[64];
+
+static size_t msm_window_size(size_t npoints) {
+  size_t k = npoints > 0 ? msm_num_bits(npoints) - 1 : 0;
+  return (msm_window_sizes[k] ? msm_window_sizes[k]
+                              : blst_pippenger_window_size(npoints));
+}
+
+// Hypothesis: 0 <= log_npoints < 64 and window is 0 or between 2 and 20
+CAMLprim value caml_blst_set_msm_window_stubs(value log_npoints, value window) {
+  CAMLparam2(log_npoints, window);
+  msm_window_sizes[Int_val(log_npoints)] = Int_val(window);
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_blst_get_msm_window_stubs(value log_npoints) {
+  CAMLparam1(log_npoints);
+  CAMLreturn(Val_int(msm_window_sizes[Int_val(log_npoints)]));
+}
 
-  blst_scalar scalar;
+// Return the number of tiles, i.e. nx * ny. The tiles of the row y (bits
+// [y * window, (y + 1) * window)) are tiles[y * nx .. (y + 1) * nx - 1].
+static size_t msm_breakdown(size_t npoints, size_t nbits, size_t ncpus,
+                            size_t *nx, size_t *ny, size_t *window) {
+  size_t w = msm_window_size(npoints);
+  size_t wnd;
+  if (nbits > w * ncpus) {
+    *nx = 1;
+    wnd = msm_num_bits(ncpus / 4);
+    if (w + wnd > 18)
+      wnd = w - wnd;
+    else {
+      wnd = (nbits / w + ncpus - 1) / ncpus;
+      if ((nbits / (w + 1) + ncpus - 1) / ncpus < wnd)
+        wnd = w + 1;
+      else
+        wnd = w;
+    }
+  } else {
+    *nx = 2;
+    // The window can be set to 2, see caml_blst_set_msm_window_stubs
+    wnd = w > 2 ? w - 2 : 1;
+    while ((nbits / wnd + 1) * *nx < ncpus) {
+      (*nx)++;
+      wnd = w - msm_num_bits(3 * *nx / 2);
+      if (wnd < 1 || wnd > w) {
+        wnd = 1;
+        break;
+      }
+    }
+    (*nx)--;
+    wnd = w > msm_num_bits(3 * *nx / 2) ? w - msm_num_bits(3 * *nx / 2) : 1;
+  }
+  *ny = nbits / wnd + 1;
+  *window = nbits / *ny + 1;
+  return (*nx * *ny);
+}
 
-  for (int i = 0; i < npoints_c; i++) {
-    blst_p1_to_affine(ps + i, Blst_p1_val(Field(jacobian_list, start_c + i)));
-    blst_scalar_from_fr(&scalar, Blst_fr_val(Field(scalars, start_c + i)));
-    blst_lendian_from_scalar(scalars_bs + i * 32, &scalar);
-    addr_scalars_bs[i] = scalars_bs + i * 32;
-    addr_ps[i] = ps + i;
+static msm_tile *msm_tiles_grid(msm_context *msm, size_t npoints, size_t nx,
+                                size_t ny, size_t window) {
+  msm_tile *tiles = (msm_tile *)msm_context_alloc(msm, MSM_CONTEXT_TILES,
+                                                  nx * ny * sizeof(msm_tile));
+  if (tiles == NULL)
+    return (NULL);
+  size_t dx = npoints / nx;
+  for (size_t y = 0; y < ny; y++) {
+    for (size_t x = 0; x < nx; x++) {
+      msm_tile *tile = tiles + y * nx + x;
+      tile->x0 = x * dx;
+      tile->dx = x + 1 == nx ? npoints - tile->x0 : dx;
+      tile->bit0 = y * window;
+    }
   }
-  void *scratch = calloc(1, blst_p1s_mult_pippenger_scratch_sizeof(npoints_c));
+  return (tiles);
+}
+
+static msm_tile *msm_tiles(msm_context *msm, size_t npoints, size_t nbits,
+                           size_t ncpus, size_t *nx, size_t *ny,
+                           size_t *window) {
+  msm_breakdown(npoints, nbits, ncpus, nx, ny, window);
+  return (msm_tiles_grid(msm, npoints, *nx, *ny, *window));
+}
+
+typedef struct {
+  void *results;
+  const void *points;
+  const byte *scalars;
+  size_t nbits;
+  size_t window;
+  const msm_tile *tiles;
+  // If not NULL, the Booth digits of the rows, see blst_scalar_batch. The
+  // scalars are not used.
+  const unsigned int *digits;
+  size_t digits_stride;
+  int ret;
+  // The scratch of the thread of index i, see
+  // caml_bls12_381_parallel_worker_index, starts at scratch + i *
+  // scratch_size, for i < nb_scratch. The other threads allocate their own.
+  byte *scratch;
+  size_t scratch_size;
+  size_t nb_scratch;
+} msm_ctx;
+
+// Size of the scratch of a tile, for the affine or the XYZZ buckets, rounded
+// to a cache line
+static size_t msm_tile_scratch_size(size_t affine_size, size_t xyzz_size) {
+  size_t size = affine_size > xyzz_size ? affine_size : xyzz_size;
+  return ((size + 63) & ~(size_t)63);
+}
+
+// Return the scratch of the current thread, or NULL on memory allocation
+// failure. Release it with msm_tile_scratch_release.
+static limb_t *msm_tile_scratch(const msm_ctx *ctx, size_t size) {
+  size_t i = caml_bls12_381_parallel_worker_index();
+  if (i < ctx->nb_scratch)
+    return ((limb_t *)(ctx->scratch + i * ctx->scratch_size));
+  return ((limb_t *)malloc(size));
+}
+
+static void msm_tile_scratch_release(const msm_ctx *ctx, limb_t *scratch) {
+  byte *p = (byte *)scratch;
+  if (p < ctx->scratch ||
+      p >= ctx->scratch + ctx->nb_scratch * ctx->scratch_size)
+    free(scratch);
+}
+
+static void p1_msm_tile_task(size_t k, void *arg) {
+  msm_ctx *ctx = (msm_ctx *)arg;
+  const msm_tile *tile = ctx->tiles + k;
+  size_t nbytes = (ctx->nbits + 7) / 8;
+  int affine = tile->dx >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE;
+  limb_t *scratch = msm_tile_scratch(
+      ctx, affine
+               ? blst_p1s_mult_pippenger_affine_scratch_sizeof(ctx->window)
+               : blst_p1s_mult_pippenger_scratch_sizeof(0)
+                     << (ctx->window - 1));
   if (scratch == NULL) {
-    free(addr_ps);
-    free(ps);
-    free(addr_scalars_bs);
-    free(scalars_bs);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
   }
+  blst_p1 *res = (blst_p1 *)ctx->results + k;
+  const blst_p1_affine *points = (const blst_p1_affine *)ctx->points + tile->x0;
+  if (ctx->digits != NULL) {
+    const unsigned int *digits = ctx->digits +
+                                 tile->bit0 / ctx->window * ctx->digits_stride +
+                                 tile->x0;
+    if (affine)
+      blst_p1s_tile_pippenger_affine_digits(res, points, tile->dx, digits,
+                                            ctx->nbits, scratch, tile->bit0,
+                                            ctx->window);
+    else
+      blst_p1s_tile_pippenger_digits(res, points, tile->dx, digits, ctx->nbits,
+                                     scratch, tile->bit0, ctx->window);
+  } else if (affine)
+    blst_p1s_tile_pippenger_affine_cont(
+        res, points, tile->dx, ctx->scalars + tile->x0 * nbytes, ctx->nbits,
+        scratch, tile->bit0, ctx->window);
+  else
+    blst_p1s_tile_pippenger_cont(res, points, tile->dx,
+                                 ctx->scalars + tile->x0 * nbytes, ctx->nbits,
+                                 scratch, tile->bit0, ctx->window);
+  msm_tile_scratch_release(ctx, scratch);
+}
 
-  blst_p1s_mult_pippenger(Blst_p1_val(buffer), (const blst_p1_affine **)addr_ps,
-                          npoints_c, (const byte **)addr_scalars_bs, 256,
-                          scratch);
+// Compute the nx * ny tiles of ctx and combine them in ret, with the buffers of
+// msm. Returns 1 on memory allocation failure.
+static int caml_blst_p1s_mult_tiles(msm_context *msm, blst_p1 *ret,
+                                    msm_ctx *ctx, size_t nx, size_t ny) {
+  size_t nb_scratch = caml_bls12_381_get_nb_threads();
+  size_t scratch_size = msm_tile_scratch_size(
+      blst_p1s_mult_pippenger_affine_scratch_sizeof(ctx->window),
+      blst_p1s_mult_pippenger_scratch_sizeof(0) << (ctx->window - 1));
+  blst_p1 *results = (blst_p1 *)msm_context_alloc(
+      msm, MSM_CONTEXT_TILE_RESULTS, nx * ny * sizeof(blst_p1));
+  byte *scratch = (byte *)msm_context_alloc(msm, MSM_CONTEXT_TILE_SCRATCH,
+                                            nb_scratch * scratch_size);
+  if (results == NULL || scratch == NULL) {
+    msm_context_release(msm, results);
+    msm_context_release(msm, scratch);
+    return (1);
+  }
+  ctx->results = results;
+  ctx->scratch = scratch;
+  ctx->scratch_size = scratch_size;
+  ctx->nb_scratch = nb_scratch;
+  caml_bls12_381_parallel_for(nx * ny, p1_msm_tile_task, ctx);
+  if (ctx->ret == 0) {
+    memset(ret, 0, sizeof(blst_p1));
+    for (size_t y = ny; y-- > 0;) {
+      if (y + 1 < ny)
+        for (size_t i = 0; i < ctx->window; i++)
+          blst_p1_double(ret, ret);
+      for (size_t x = 0; x < nx; x++)
+        blst_p1_add_or_double(ret, ret, results + y * nx + x);
+    }
+  }
+  msm_context_release(msm, results);
+  msm_context_release(msm, scratch);
+  return (ctx->ret);
+}
 
-  free(addr_ps);
-  free(ps);
-  free(addr_scalars_bs);
-  free(scalars_bs);
-  free(scratch);
+// Scalars of MSMs are often small or sparse, e.g. selectors, boolean witnesses
+// or 128 bits challenges. caml_blst_p1s_mult_pippenger_sparse skips the zero
+// scalars, sums the points multiplied by 1 and -1 with the batched affine
+// additions of blst_p1s_add, and runs Pippenger's algorithm on the other
+// points only, on the bit length of their largest scalar.
+
+// r - 1 in little endian
+static const byte msm_scalar_minus_one[32] = {
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xfe, 0x5b, 0xfe,
+    0xff, 0x02, 0xa4, 0xbd, 0x53, 0x05, 0xd8, 0xa1, 0x09, 0x08, 0xd8,
+    0x39, 0x33, 0x48, 0x7d, 0x9d, 0x29, 0x53, 0xa7, 0xed, 0x73};
+
+// Number of bits of a scalar encoded on 256 bits in little endian
+static size_t msm_scalar_nbits(const byte scalar[32]) {
+  size_t i = 32;
+  while (i > 0 && scalar[i - 1] == 0)
+    i--;
+  if (i == 0)
+    return (0);
+  size_t nbits = 8 * (i - 1);
+  for (byte b = scalar[i - 1]; b != 0; b >>= 1)
+    nbits++;
+  return (nbits);
+}
 
-  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+static int msm_scalar_is_unit(const byte scalar[32], size_t nbits) {
+  return (nbits == 1 || memcmp(scalar, msm_scalar_minus_one, 32) == 0);
 }
 
-// Hypothesis: jacobian_list and scalars are arrays of size *at least* start +
-// npoints
-CAMLprim value caml_blst_g2_pippenger_stubs(value buffer, value jacobian_list,
-                                            value scalars, value start,
-                                            value npoints) {
-  CAMLparam5(buffer, jacobian_list, scalars, start, npoints);
-  size_t npoints_c = ctypes_size_t_val(npoints);
-  size_t start_c = ctypes_size_t_val(start);
+// Selection of the MSM algorithm: up to msm_straus_max_size[g][c] points,
+// Straus' algorithm is used instead of Pippenger's, see blst_p1s_mult_straus,
+// g being the group (0 for G1, 1 for G2) and c the class of the bit length of
+// the scalars (at most 64, 128 or 256 bits). The defaults are the crossovers
+// measured on x86-64; they can be calibrated for the machine with
+// caml_blst_set_straus_threshold_stubs.
+#define MSM_NB_SCALAR_CLASSES 3
 
-  blst_p2_affine **addr_ps =
-      (blst_p2_affine **)calloc(npoints_c, sizeof(blst_p2_affine *));
-  if (addr_ps == NULL) {
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+static size_t msm_straus_max_size[2][MSM_NB_SCALAR_CLASSES] = {{28, 36, 44},
+                                                               {32, 40, 64}};
+
+static size_t msm_scalar_class(size_t nbits) {
+  return (nbits <= 64 ? 0 : nbits <= 128 ? 1 : 2);
+}
+
+// Hypothesis: group is 0 or 1 and nbits is 64, 128 or 256
+CAMLprim value caml_blst_set_straus_threshold_stubs(value group, value nbits,
+                                                    value n) {
+  CAMLparam3(group, nbits, n);
+  msm_straus_max_size[Int_val(group)][msm_scalar_class(Int_val(nbits))] =
+      Int_val(n);
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_blst_get_straus_threshold_stubs(value group, value nbits) {
+  CAMLparam2(group, nbits);
+  CAMLreturn(Val_int(
+      msm_straus_max_size[Int_val(group)][msm_scalar_class(Int_val(nbits))]));
+}
+
+// ret = sum scalars[i] * points[i], the scalars being encoded on nbits bits in
+// little endian, contiguously. Returns 1 on memory allocation failure.
+static int caml_blst_p1s_mult_pippenger(msm_context *msm, blst_p1 *ret,
+                                        const blst_p1_affine *points,
+                                        size_t npoints, const byte *scalars,
+                                        size_t nbits) {
+  size_t ncpus = caml_bls12_381_get_nb_threads();
+  if (npoints <= msm_straus_max_size[0][msm_scalar_class(nbits)]) {
+    limb_t *scratch = (limb_t *)msm_context_alloc(
+        msm, MSM_CONTEXT_SCRATCH,
+        blst_p1s_mult_straus_scratch_sizeof(npoints, nbits));
+    if (scratch == NULL)
+      return (1);
+    blst_p1s_mult_straus(ret, points, npoints, scalars, nbits, scratch);
+    msm_context_release(msm, scratch);
+    return (0);
   }
-  blst_p2_affine *ps =
-      (blst_p2_affine *)calloc(npoints_c, sizeof(blst_p2_affine));
-  if (ps == NULL) {
-    free(addr_ps);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  if (ncpus <= 1 && npoints >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE) {
+    // Same windows than msm_breakdown, balanced over the nbits bits. It avoids
+    // a last window of a few bits for the short scalars of the GLV MSMs.
+    size_t window = msm_window_size(npoints);
+    window = nbits / (nbits / window + 1) + 1;
+    limb_t *scratch = (limb_t *)msm_context_alloc(
+        msm, MSM_CONTEXT_SCRATCH,
+        blst_p1s_mult_pippenger_affine_scratch_sizeof(window));
+    if (scratch == NULL)
+      return (1);
+    blst_p1s_mult_pippenger_affine_cont(ret, points, npoints, scalars, nbits,
+                                        scratch, window);
+    msm_context_release(msm, scratch);
+    return (0);
+  }
+  if (ncpus <= 1 || npoints < CAML_BLS12_381_PIPPENGER_PARALLEL_MIN_SIZE) {
+    size_t window = msm_window_size(npoints);
+    limb_t *scratch = (limb_t *)msm_context_alloc(
+        msm, MSM_CONTEXT_SCRATCH,
+        blst_p1s_mult_pippenger_scratch_sizeof(0) << (window - 1));
+    if (scratch == NULL)
+      return (1);
+    blst_p1s_mult_pippenger_cont_window(ret, points, npoints, scalars, nbits,
+                                        scratch, window);
+    msm_context_release(msm, scratch);
+    return (0);
   }
-  *addr_ps = ps;
 
-  byte **addr_scalars_bs = (byte **)calloc(npoints_c, sizeof(byte *));
-  if (addr_scalars_bs == NULL) {
-    free(addr_ps);
-    free(ps);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  size_t nx, ny, window;
+  msm_tile *tiles =
+      msm_tiles(msm, npoints, nbits, ncpus, &nx, &ny, &window);
+  if (tiles == NULL)
+    return (1);
+  msm_ctx ctx = {
+      NULL, points, scalars, nbits, window, tiles, NULL, 0, 0, NULL, 0, 0};
+  int res = caml_blst_p1s_mult_tiles(msm, ret, &ctx, nx, ny);
+  msm_context_release(msm, tiles);
+  return (res);
+}
+
+// ret = sum scalars[i] * points[i], the scalars being encoded on 256 bits in
+// little endian, contiguously. Returns 1 on memory allocation failure.
+static int caml_blst_p1s_mult_pippenger_sparse(msm_context *msm,
+                                               blst_p1 *ret,
+                                               const blst_p1_affine *points,
+                                               size_t npoints,
+                                               const byte *scalars) {
+  size_t nbits = 0, nrest = 0, nunits = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    size_t b = msm_scalar_nbits(scalars + i * 32);
+    if (b == 0)
+      continue;
+    if (msm_scalar_is_unit(scalars + i * 32, b))
+      nunits++;
+    else {
+      nrest++;
+      nbits = b > nbits ? b : nbits;
+    }
   }
-  byte *scalars_bs = (byte *)calloc(npoints_c * 32, sizeof(byte));
-  if (scalars_bs == NULL) {
-    free(addr_ps);
-    free(ps);
-    free(addr_scalars_bs);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  if (nrest == npoints && nbits > 248)
+    return (
+        caml_blst_p1s_mult_pippenger(msm, ret, points, npoints, scalars, 256));
+
+  size_t nbytes = (nbits + 7) / 8;
+  blst_p1_affine *rest = (blst_p1_affine *)msm_context_alloc(
+      msm, MSM_CONTEXT_SPARSE_POINTS, nrest * sizeof(blst_p1_affine));
+  byte *rest_scalars = (byte *)msm_context_alloc(
+      msm, MSM_CONTEXT_SPARSE_SCALARS, nrest * nbytes);
+  // The points multiplied by 1 from the start, by -1 from the end
+  const blst_p1_affine **units = (const blst_p1_affine **)msm_context_alloc(
+      msm, MSM_CONTEXT_UNITS, nunits * sizeof(blst_p1_affine *));
+  int res = 1;
+  if (rest == NULL || rest_scalars == NULL || units == NULL)
+    goto out;
+  size_t k = 0, nones = 0, nminus = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    const byte *scalar = scalars + i * 32;
+    size_t b = msm_scalar_nbits(scalar);
+    if (b == 0)
+      continue;
+    if (b == 1)
+      units[nones++] = points + i;
+    else if (msm_scalar_is_unit(scalar, b))
+      units[nunits - ++nminus] = points + i;
+    else {
+      memcpy(rest + k, points + i, sizeof(blst_p1_affine));
+      memcpy(rest_scalars + k * nbytes, scalar, nbytes);
+      k++;
+    }
   }
-  blst_scalar scalar;
 
-  for (int i = 0; i < npoints_c; i++) {
-    blst_p2_to_affine(ps + i, Blst_p2_val(Field(jacobian_list, start_c + i)));
-    blst_scalar_from_fr(&scalar, Blst_fr_val(Field(scalars, start_c + i)));
-    blst_lendian_from_scalar(scalars_bs + i * 32, &scalar);
-    addr_scalars_bs[i] = scalars_bs + i * 32;
-    addr_ps[i] = ps + i;
+  res = 0;
+  memset(ret, 0, sizeof(blst_p1));
+  if (nrest == 1) {
+    blst_p1_from_affine(ret, rest);
+    blst_p1_mult(ret, ret, rest_scalars, nbits);
+  } else if (nrest > 1)
+    res = caml_blst_p1s_mult_pippenger(msm, ret, rest, nrest, rest_scalars,
+                                        nbits);
+  if (res == 0 && nones > 0) {
+    blst_p1 sum;
+    blst_p1s_add(&sum, units, nones);
+    blst_p1_add_or_double(ret, ret, &sum);
   }
+  if (res == 0 && nminus > 0) {
+    blst_p1 sum;
+    blst_p1s_add(&sum, units + nones, nminus);
+    blst_p1_cneg(&sum, 1);
+    blst_p1_add_or_double(ret, ret, &sum);
+  }
+out:
+  msm_context_release(msm, rest);
+  msm_context_release(msm, rest_scalars);
+  msm_context_release(msm, (void *)units);
+  return (res);
+}
 
-  void *scratch = calloc(1, blst_p2s_mult_pippenger_scratch_sizeof(npoints_c));
+static void p2_msm_tile_task(size_t k, void *arg) {
+  msm_ctx *ctx = (msm_ctx *)arg;
+  const msm_tile *tile = ctx->tiles + k;
+  size_t nbytes = (ctx->nbits + 7) / 8;
+  int affine = tile->dx >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE;
+  limb_t *scratch = msm_tile_scratch(
+      ctx, affine
+               ? blst_p2s_mult_pippenger_affine_scratch_sizeof(ctx->window)
+               : blst_p2s_mult_pippenger_scratch_sizeof(0)
+                     << (ctx->window - 1));
   if (scratch == NULL) {
-    free(addr_ps);
-    free(ps);
-    free(addr_scalars_bs);
-    free(scalars_bs);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  blst_p2 *res = (blst_p2 *)ctx->results + k;
+  const blst_p2_affine *points = (const blst_p2_affine *)ctx->points + tile->x0;
+  if (ctx->digits != NULL) {
+    const unsigned int *digits = ctx->digits +
+                                 tile->bit0 / ctx->window * ctx->digits_stride +
+                                 tile->x0;
+    if (affine)
+      blst_p2s_tile_pippenger_affine_digits(res, points, tile->dx, digits,
+                                            ctx->nbits, scratch, tile->bit0,
+                                            ctx->window);
+    else
+      blst_p2s_tile_pippenger_digits(res, points, tile->dx, digits, ctx->nbits,
+                                     scratch, tile->bit0, ctx->window);
+  } else if (affine)
+    blst_p2s_tile_pippenger_affine_cont(
+        res, points, tile->dx, ctx->scalars + tile->x0 * nbytes, ctx->nbits,
+        scratch, tile->bit0, ctx->window);
+  else
+    blst_p2s_tile_pippenger_cont(res, points, tile->dx,
+                                 ctx->scalars + tile->x0 * nbytes, ctx->nbits,
+                                 scratch, tile->bit0, ctx->window);
+  msm_tile_scratch_release(ctx, scratch);
+}
+
+// Compute the nx * ny tiles of ctx and combine them in ret, with the buffers of
+// msm. Returns 1 on memory allocation failure.
+static int caml_blst_p2s_mult_tiles(msm_context *msm, blst_p2 *ret,
+                                    msm_ctx *ctx, size_t nx, size_t ny) {
+  size_t nb_scratch = caml_bls12_381_get_nb_threads();
+  size_t scratch_size = msm_tile_scratch_size(
+      blst_p2s_mult_pippenger_affine_scratch_sizeof(ctx->window),
+      blst_p2s_mult_pippenger_scratch_sizeof(0) << (ctx->window - 1));
+  blst_p2 *results = (blst_p2 *)msm_context_alloc(
+      msm, MSM_CONTEXT_TILE_RESULTS, nx * ny * sizeof(blst_p2));
+  byte *scratch = (byte *)msm_context_alloc(msm, MSM_CONTEXT_TILE_SCRATCH,
+                                            nb_scratch * scratch_size);
+  if (results == NULL || scratch == NULL) {
+    msm_context_release(msm, results);
+    msm_context_release(msm, scratch);
+    return (1);
   }
+  ctx->results = results;
+  ctx->scratch = scratch;
+  ctx->scratch_size = scratch_size;
+  ctx->nb_scratch = nb_scratch;
+  caml_bls12_381_parallel_for(nx * ny, p2_msm_tile_task, ctx);
+  if (ctx->ret == 0) {
+    memset(ret, 0, sizeof(blst_p2));
+    for (size_t y = ny; y-- > 0;) {
+      if (y + 1 < ny)
+        for (size_t i = 0; i < ctx->window; i++)
+          blst_p2_double(ret, ret);
+      for (size_t x = 0; x < nx; x++)
+        blst_p2_add_or_double(ret, ret, results + y * nx + x);
+    }
+  }
+  msm_context_release(msm, results);
+  msm_context_release(msm, scratch);
+  return (ctx->ret);
+}
 
-  blst_p2s_mult_pippenger(Blst_p2_val(buffer), (const blst_p2_affine **)addr_ps,
-                          npoints_c, (const byte **)addr_scalars_bs, 256,
-                          scratch);
+// ret = sum scalars[i] * points[i], the scalars being encoded on nbits bits in
+// little endian, contiguously. Returns 1 on memory allocation failure.
+static int caml_blst_p2s_mult_pippenger(msm_context *msm, blst_p2 *ret,
+                                        const blst_p2_affine *points,
+                                        size_t npoints, const byte *scalars,
+                                        size_t nbits) {
+  size_t ncpus = caml_bls12_381_get_nb_threads();
+  if (npoints <= msm_straus_max_size[1][msm_scalar_class(nbits)]) {
+    limb_t *scratch = (limb_t *)msm_context_alloc(
+        msm, MSM_CONTEXT_SCRATCH,
+        blst_p2s_mult_straus_scratch_sizeof(npoints, nbits));
+    if (scratch == NULL)
+      return (1);
+    blst_p2s_mult_straus(ret, points, npoints, scalars, nbits, scratch);
+    msm_context_release(msm, scratch);
+    return (0);
+  }
+  if (ncpus <= 1 && npoints >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE) {
+    // Same windows than msm_breakdown, balanced over the nbits bits. It avoids
+    // a last window of a few bits for the short scalars of the GLV MSMs.
+    size_t window = msm_window_size(npoints);
+    window = nbits / (nbits / window + 1) + 1;
+    limb_t *scratch = (limb_t *)msm_context_alloc(
+        msm, MSM_CONTEXT_SCRATCH,
+        blst_p2s_mult_pippenger_affine_scratch_sizeof(window));
+    if (scratch == NULL)
+      return (1);
+    blst_p2s_mult_pippenger_affine_cont(ret, points, npoints, scalars, nbits,
+                                        scratch, window);
+    msm_context_release(msm, scratch);
+    return (0);
+  }
+  if (ncpus <= 1 || npoints < CAML_BLS12_381_PIPPENGER_PARALLEL_MIN_SIZE) {
+    size_t window = msm_window_size(npoints);
+    limb_t *scratch = (limb_t *)msm_context_alloc(
+        msm, MSM_CONTEXT_SCRATCH,
+        blst_p2s_mult_pippenger_scratch_sizeof(0) << (window - 1));
+    if (scratch == NULL)
+      return (1);
+    blst_p2s_mult_pippenger_cont_window(ret, points, npoints, scalars, nbits,
+                                        scratch, window);
+    msm_context_release(msm, scratch);
+    return (0);
+  }
 
-  free(addr_ps);
-  free(ps);
-  free(addr_scalars_bs);
-  free(scalars_bs);
-  free(scratch);
+  size_t nx, ny, window;
+  msm_tile *tiles =
+      msm_tiles(msm, npoints, nbits, ncpus, &nx, &ny, &window);
+  if (tiles == NULL)
+    return (1);
+  msm_ctx ctx = {
+      NULL, points, scalars, nbits, window, tiles, NULL, 0, 0, NULL, 0, 0};
+  int res = caml_blst_p2s_mult_tiles(msm, ret, &ctx, nx, ny);
+  msm_context_release(msm, tiles);
+  return (res);
+}
 
-  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+// ret = sum scalars[i] * points[i], the scalars being encoded on 256 bits in
+// little endian, contiguously. Returns 1 on memory allocation failure.
+static int caml_blst_p2s_mult_pippenger_sparse(msm_context *msm,
+                                               blst_p2 *ret,
+                                               const blst_p2_affine *points,
+                                               size_t npoints,
+                                               const byte *scalars) {
+  size_t nbits = 0, nrest = 0, nunits = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    size_t b = msm_scalar_nbits(scalars + i * 32);
+    if (b == 0)
+      continue;
+    if (msm_scalar_is_unit(scalars + i * 32, b))
+      nunits++;
+    else {
+      nrest++;
+      nbits = b > nbits ? b : nbits;
+    }
+  }
+  if (nrest == npoints && nbits > 248)
+    return (
+        caml_blst_p2s_mult_pippenger(msm, ret, points, npoints, scalars, 256));
+
+  size_t nbytes = (nbits + 7) / 8;
+  blst_p2_affine *rest = (blst_p2_affine *)msm_context_alloc(
+      msm, MSM_CONTEXT_SPARSE_POINTS, nrest * sizeof(blst_p2_affine));
+  byte *rest_scalars = (byte *)msm_context_alloc(
+      msm, MSM_CONTEXT_SPARSE_SCALARS, nrest * nbytes);
+  // The points multiplied by 1 from the start, by -1 from the end
+  const blst_p2_affine **units = (const blst_p2_affine **)msm_context_alloc(
+      msm, MSM_CONTEXT_UNITS, nunits * sizeof(blst_p2_affine *));
+  int res = 1;
+  if (rest == NULL || rest_scalars == NULL || units == NULL)
+    goto out;
+  size_t k = 0, nones = 0, nminus = 0;
+  for (size_t i = 0; i < npoints; i++) {
+    const byte *scalar = scalars + i * 32;
+    size_t b = msm_scalar_nbits(scalar);
+    if (b == 0)
+      continue;
+    if (b == 1)
+      units[nones++] = points + i;
+    else if (msm_scalar_is_unit(scalar, b))
+      units[nunits - ++nminus] = points + i;
+    else {
+      memcpy(rest + k, points + i, sizeof(blst_p2_affine));
+      memcpy(rest_scalars + k * nbytes, scalar, nbytes);
+      k++;
+    }
+  }
+
+  res = 0;
+  memset(ret, 0, sizeof(blst_p2));
+  if (nrest == 1) {
+    blst_p2_from_affine(ret, rest);
+    blst_p2_mult(ret, ret, rest_scalars, nbits);
+  } else if (nrest > 1)
+    res = caml_blst_p2s_mult_pippenger(msm, ret, rest, nrest, rest_scalars,
+                                        nbits);
+  if (res == 0 && nones > 0) {
+    blst_p2 sum;
+    blst_p2s_add(&sum, units, nones);
+    blst_p2_add_or_double(ret, ret, &sum);
+  }
+  if (res == 0 && nminus > 0) {
+    blst_p2 sum;
+    blst_p2s_add(&sum, units + nones, nminus);
+    blst_p2_cneg(&sum, 1);
+    blst_p2_add_or_double(ret, ret, &sum);
+  }
+out:
+  msm_context_release(msm, rest);
+  msm_context_release(msm, rest_scalars);
+  msm_context_release(msm, (void *)units);
+  return (res);
+}
+
+// ret = sum scalars[start + i] * jacobian_list[start + i] for i < npoints, the
+// buffers being taken from msm (possibly NULL). Returns 1 on memory allocation
+// failure.
+static int caml_blst_g1_pippenger(msm_context *msm, blst_p1 *ret,
+                                   value jacobian_list, value scalars,
+                                   size_t start, size_t npoints) {
+  blst_p1_affine *ps = (blst_p1_affine *)msm_context_alloc(
+      msm, MSM_CONTEXT_POINTS, npoints * sizeof(blst_p1_affine));
+  byte *scalars_bs =
+      (byte *)msm_context_alloc(msm, MSM_CONTEXT_SCALARS, npoints * 32);
+  const blst_p1 **jacobian_ps = (const blst_p1 **)msm_context_alloc(
+      msm, MSM_CONTEXT_POINTERS, npoints * sizeof(blst_p1 *));
+  int res = 1;
+  if (ps == NULL || scalars_bs == NULL || jacobian_ps == NULL)
+    goto out;
+
+  for (size_t i = 0; i < npoints; i++)
+    jacobian_ps[i] = Blst_p1_val(Field(jacobian_list, start + i));
+  caml_blst_p1s_to_affine(ps, jacobian_ps, npoints);
+
+  for (size_t i = 0; i < npoints; i++) {
+    blst_lendian_from_fr(scalars_bs + i * 32,
+                         Blst_fr_val(Field(scalars, start + i)));
+  }
+
+  res = caml_blst_p1s_mult_pippenger_sparse(msm, ret, ps, npoints, scalars_bs);
+
+out:
+  msm_context_release(msm, ps);
+  msm_context_release(msm, scalars_bs);
+  msm_context_release(msm, (void *)jacobian_ps);
+  return (res);
+}
+
+// Hypothesis: jacobian_list and scalars are arrays of size *at least* start +
+// npoints
+CAMLprim value caml_blst_g1_pippenger_stubs(value buffer, value jacobian_list,
+                                            value scalars, value start,
+                                            value npoints) {
+  CAMLparam5(buffer, jacobian_list, scalars, start, npoints);
+  int ret = caml_blst_g1_pippenger(NULL, Blst_p1_val(buffer), jacobian_list,
+                                    scalars, ctypes_size_t_val(start),
+                                    ctypes_size_t_val(npoints));
+  CAMLreturn(Val_int(ret));
+}
+
+// ret = sum scalars[start + i] * jacobian_list[start + i] for i < npoints, the
+// buffers being taken from msm (possibly NULL). Returns 1 on memory allocation
+// failure.
+static int caml_blst_g2_pippenger(msm_context *msm, blst_p2 *ret,
+                                   value jacobian_list, value scalars,
+                                   size_t start, size_t npoints) {
+  blst_p2_affine *ps = (blst_p2_affine *)msm_context_alloc(
+      msm, MSM_CONTEXT_POINTS, npoints * sizeof(blst_p2_affine));
+  byte *scalars_bs =
+      (byte *)msm_context_alloc(msm, MSM_CONTEXT_SCALARS, npoints * 32);
+  const blst_p2 **jacobian_ps = (const blst_p2 **)msm_context_alloc(
+      msm, MSM_CONTEXT_POINTERS, npoints * sizeof(blst_p2 *));
+  int res = 1;
+  if (ps == NULL || scalars_bs == NULL || jacobian_ps == NULL)
+    goto out;
+
+  for (size_t i = 0; i < npoints; i++)
+    jacobian_ps[i] = Blst_p2_val(Field(jacobian_list, start + i));
+  caml_blst_p2s_to_affine(ps, jacobian_ps, npoints);
+
+  for (size_t i = 0; i < npoints; i++) {
+    blst_lendian_from_fr(scalars_bs + i * 32,
+                         Blst_fr_val(Field(scalars, start + i)));
+  }
+
+  res = caml_blst_p2s_mult_pippenger_sparse(msm, ret, ps, npoints, scalars_bs);
+
+out:
+  msm_context_release(msm, ps);
+  msm_context_release(msm, scalars_bs);
+  msm_context_release(msm, (void *)jacobian_ps);
+  return (res);
+}
+
+// Hypothesis: jacobian_list and scalars are arrays of size *at least* start +
+// npoints
+CAMLprim value caml_blst_g2_pippenger_stubs(value buffer, value jacobian_list,
+                                            value scalars, value start,
+                                            value npoints) {
+  CAMLparam5(buffer, jacobian_list, scalars, start, npoints);
+  int ret = caml_blst_g2_pippenger(NULL, Blst_p2_val(buffer), jacobian_list,
+                                    scalars, ctypes_size_t_val(start),
+                                    ctypes_size_t_val(npoints));
+  CAMLreturn(Val_int(ret));
 }
 
 // Hypothesis: fr_array_left and fr_array_right are both *at least* of size
@@ -904,11 +2002,52 @@ CAMLprim value caml_blst_fr_inner_product_stubs(value buffer,
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
+// The number of points is written first as the size of the array is not fixed
+static void caml_blst_p1_affine_array_serialize(value v, uintnat *bsize_32,
+                                                uintnat *bsize_64) {
+  size_t size = Custom_data_size(v);
+  size_t n = size / sizeof(blst_p1_affine);
+  caml_serialize_int_8(n);
+  caml_serialize_block_8(Data_custom_val(v), n * sizeof(blst_p1_affine) / 8);
+  *bsize_32 = size;
+  *bsize_64 = size;
+}
+
+static uintnat caml_blst_p1_affine_array_deserialize(void *dst) {
+  blst_p1_affine *ps = (blst_p1_affine *)dst;
+  size_t n = caml_deserialize_uint_8();
+  // The number of points is read from the stream and must not be trusted
+#ifdef Custom_deserialized_size
+  if (n != Custom_deserialized_size(dst) / sizeof(blst_p1_affine) ||
+      Custom_deserialized_size(dst) % sizeof(blst_p1_affine) != 0)
+    caml_deserialize_error(
+        "blst_p1_affine_array: the length does not match the block size");
+#else
+  caml_deserialize_error(
+      "blst_p1_affine_array: unmarshalling requires OCaml 5.0 or later");
+  return (0);
+#endif
+  caml_deserialize_block_8(dst, n * sizeof(blst_p1_affine) / 8);
+  if (!unchecked_deserialization) {
+    for (size_t i = 0; i < n; i++) {
+      if (!(blst_p1_affine_is_reduced(ps + i) &&
+            blst_p1_affine_on_curve(ps + i) && blst_p1_affine_in_g1(ps + i)))
+        caml_deserialize_error(
+            "blst_p1_affine_array: a point is not in the prime subgroup");
+    }
+  }
+  return (n * sizeof(blst_p1_affine));
+}
+
 static struct custom_operations blst_p1_affine_array_ops = {
-    "blst_p1_affine_array",     custom_finalize_default,
-    custom_compare_default,     custom_hash_default,
-    custom_serialize_default,   custom_deserialize_default,
-    custom_compare_ext_default, custom_fixed_length_default};
+    "blst_p1_affine_array",
+    custom_finalize_default,
+    custom_compare_default,
+    custom_hash_default,
+    caml_blst_p1_affine_array_serialize,
+    caml_blst_p1_affine_array_deserialize,
+    custom_compare_ext_default,
+    custom_fixed_length_default};
 
 CAMLprim value allocate_p1_affine_array_stubs(value n) {
   CAMLparam1(n);
@@ -925,63 +2064,159 @@ CAMLprim value caml_blst_p1_affine_array_set_p1_points_stubs(value buffer,
   int n_c = Int_val(n);
   blst_p1_affine *buffer_c = Blst_p1_affine_val(buffer);
 
-  for (int i = 0; i < n_c; i++) {
-    blst_p1 *p = Blst_p1_val(Field(l, i));
-    blst_p1_to_affine(buffer_c + i, p);
-  }
+  const blst_p1 **points =
+      (const blst_p1 **)calloc(n_c > 0 ? n_c : 1, sizeof(blst_p1 *));
+  if (points == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  for (int i = 0; i < n_c; i++)
+    points[i] = Blst_p1_val(Field(l, i));
+  caml_blst_p1s_to_affine(buffer_c, points, n_c);
+  free(points);
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
-// NB: we do not check i is smaller than the array size because it is supposed
-// to be done on the caml side
-CAMLprim value caml_blst_p1_affine_array_get_stubs(value buffer, value list,
-                                                   value i) {
-  CAMLparam3(buffer, list, i);
-  blst_p1 *buffer_c = Blst_p1_val(buffer);
-  blst_p1_affine *list_c = Blst_p1_affine_val(list);
-  int i_c = Int_val(i);
+// Below this number of points, the conversion to affine coordinates costs more
+// than it saves
+#define CAML_BLS12_381_ADD_BULK_MIN_SIZE 16
 
-  blst_p1_from_affine(buffer_c, list_c + i_c);
+CAMLprim value caml_blst_p1_add_bulk_stubs(value buffer, value l, value n) {
+  CAMLparam3(buffer, l, n);
+  size_t n_c = Int_val(n);
+  blst_p1 *buffer_c = Blst_p1_val(buffer);
+  memset(buffer_c, 0, sizeof(blst_p1));
+  if (n_c < CAML_BLS12_381_ADD_BULK_MIN_SIZE) {
+    for (size_t i = 0; i < n_c; i++)
+      blst_p1_add_or_double(buffer_c, buffer_c, Blst_p1_val(Field(l, i)));
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  }
+  const blst_p1 **points =
+      (const blst_p1 **)calloc(n_c, sizeof(blst_p1 *));
+  blst_p1_affine *affine_points =
+      (blst_p1_affine *)calloc(n_c, sizeof(blst_p1_affine));
+  int ret = 1;
+  if (points != NULL && affine_points != NULL) {
+    for (size_t i = 0; i < n_c; i++)
+      points[i] = Blst_p1_val(Field(l, i));
+    caml_blst_p1s_to_affine(affine_points, points, n_c);
+    ret = caml_blst_p1s_add(buffer_c, affine_points, n_c);
+  }
+  free(points);
+  free(affine_points);
+  CAMLreturn(ret ? CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY
+                 : CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+// NB: start and len are supposed to be checked on the caml side
+CAMLprim value caml_blst_p1_affine_array_add_bulk_stubs(value buffer,
+                                                         value affine_list,
+                                                         value start,
+                                                         value len) {
+  CAMLparam4(buffer, affine_list, start, len);
+  size_t len_c = Int_val(len);
+  blst_p1 *buffer_c = Blst_p1_val(buffer);
+  blst_p1_affine *affine_list_c =
+      Blst_p1_affine_val(affine_list) + Int_val(start);
+  if (len_c == 0) {
+    memset(buffer_c, 0, sizeof(blst_p1));
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  }
+  if (caml_blst_p1s_add(buffer_c, affine_list_c, len_c))
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
-CAMLprim value caml_blst_g1_pippenger_contiguous_affine_array_stubs(
-    value buffer, value affine_list, value scalars, value start, value len) {
-  CAMLparam5(buffer, affine_list, scalars, start, len);
-  size_t start_c = ctypes_size_t_val(start);
-  const blst_p1_affine *pts_c = Blst_p1_affine_val(affine_list) + start_c;
-  size_t len_c = ctypes_size_t_val(len);
+// NB: we do not check i is smaller than the array size because it is supposed
+// to be done on the caml side
+CAMLprim value caml_blst_p1_affine_array_get_stubs(value buffer, value list,
+                                                   value i) {
+  CAMLparam3(buffer, list, i);
+  blst_p1 *buffer_c = Blst_p1_val(buffer);
+  blst_p1_affine *list_c = Blst_p1_affine_val(list);
+  int i_c = Int_val(i);
 
-  byte *scalars_bs = (byte *)calloc(len_c * 32, sizeof(byte));
-  if (scalars_bs == NULL) {
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
-  }
+  blst_p1_from_affine(buffer_c, list_c + i_c);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
 
-  for (int i = 0; i < len_c; i++) {
+// ret = sum scalars[start + i] * points[start + i] for i < npoints, the
+// buffers being taken from msm (possibly NULL). Returns 1 on memory allocation
+// failure.
+static int caml_blst_g1_pippenger_affine(msm_context *msm, blst_p1 *ret,
+                                          const blst_p1_affine *points,
+                                          value scalars, size_t start,
+                                          size_t npoints) {
+  byte *scalars_bs =
+      (byte *)msm_context_alloc(msm, MSM_CONTEXT_SCALARS, npoints * 32);
+  if (scalars_bs == NULL)
+    return (1);
+
+  for (size_t i = 0; i < npoints; i++) {
     blst_lendian_from_fr(scalars_bs + i * 32,
-                         Blst_fr_val(Field(scalars, start_c + i)));
+                         Blst_fr_val(Field(scalars, start + i)));
   }
 
-  limb_t *scratch = calloc(1, blst_p1s_mult_pippenger_scratch_sizeof(len_c));
-  if (scratch == NULL) {
-    free(scalars_bs);
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
-  }
+  int res = caml_blst_p1s_mult_pippenger_sparse(msm, ret, points + start,
+                                                npoints, scalars_bs);
 
-  blst_p1s_mult_pippenger_cont(Blst_p1_val(buffer), pts_c, len_c, scalars_bs,
-                               256, scratch);
+  msm_context_release(msm, scalars_bs);
+  return (res);
+}
 
-  free(scalars_bs);
-  free(scratch);
+CAMLprim value caml_blst_g1_pippenger_contiguous_affine_array_stubs(
+    value buffer, value affine_list, value scalars, value start, value len) {
+  CAMLparam5(buffer, affine_list, scalars, start, len);
+  int ret = caml_blst_g1_pippenger_affine(
+      NULL, Blst_p1_val(buffer), Blst_p1_affine_val(affine_list), scalars,
+      ctypes_size_t_val(start), ctypes_size_t_val(len));
+  CAMLreturn(Val_int(ret));
+}
 
-  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+// The number of points is written first as the size of the array is not fixed
+static void caml_blst_p2_affine_array_serialize(value v, uintnat *bsize_32,
+                                                uintnat *bsize_64) {
+  size_t size = Custom_data_size(v);
+  size_t n = size / sizeof(blst_p2_affine);
+  caml_serialize_int_8(n);
+  caml_serialize_block_8(Data_custom_val(v), n * sizeof(blst_p2_affine) / 8);
+  *bsize_32 = size;
+  *bsize_64 = size;
+}
+
+static uintnat caml_blst_p2_affine_array_deserialize(void *dst) {
+  blst_p2_affine *ps = (blst_p2_affine *)dst;
+  size_t n = caml_deserialize_uint_8();
+  // The number of points is read from the stream and must not be trusted
+#ifdef Custom_deserialized_size
+  if (n != Custom_deserialized_size(dst) / sizeof(blst_p2_affine) ||
+      Custom_deserialized_size(dst) % sizeof(blst_p2_affine) != 0)
+    caml_deserialize_error(
+        "blst_p2_affine_array: the length does not match the block size");
+#else
+  caml_deserialize_error(
+      "blst_p2_affine_array: unmarshalling requires OCaml 5.0 or later");
+  return (0);
+#endif
+  caml_deserialize_block_8(dst, n * sizeof(blst_p2_affine) / 8);
+  if (!unchecked_deserialization) {
+    for (size_t i = 0; i < n; i++) {
+      if (!(blst_p2_affine_is_reduced(ps + i) &&
+            blst_p2_affine_on_curve(ps + i) && blst_p2_affine_in_g2(ps + i)))
+        caml_deserialize_error(
+            "blst_p2_affine_array: a point is not in the prime subgroup");
+    }
+  }
+  return (n * sizeof(blst_p2_affine));
 }
 
 static struct custom_operations blst_p2_affine_array_ops = {
-    "blst_p2_affine_array",     custom_finalize_default,
-    custom_compare_default,     custom_hash_default,
-    custom_serialize_default,   custom_deserialize_default,
-    custom_compare_ext_default, custom_fixed_length_default};
+    "blst_p2_affine_array",
+    custom_finalize_default,
+    custom_compare_default,
+    custom_hash_default,
+    caml_blst_p2_affine_array_serialize,
+    caml_blst_p2_affine_array_deserialize,
+    custom_compare_ext_default,
+    custom_fixed_length_default};
 
 CAMLprim value allocate_p2_affine_array_stubs(value n) {
   CAMLparam1(n);
@@ -998,10 +2233,60 @@ CAMLprim value caml_blst_p2_affine_array_set_p2_points_stubs(value buffer,
   int n_c = Int_val(n);
   blst_p2_affine *buffer_c = Blst_p2_affine_val(buffer);
 
-  for (int i = 0; i < n_c; i++) {
-    blst_p2 *p = Blst_p2_val(Field(l, i));
-    blst_p2_to_affine(buffer_c + i, p);
+  const blst_p2 **points =
+      (const blst_p2 **)calloc(n_c > 0 ? n_c : 1, sizeof(blst_p2 *));
+  if (points == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  for (int i = 0; i < n_c; i++)
+    points[i] = Blst_p2_val(Field(l, i));
+  caml_blst_p2s_to_affine(buffer_c, points, n_c);
+  free(points);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_add_bulk_stubs(value buffer, value l, value n) {
+  CAMLparam3(buffer, l, n);
+  size_t n_c = Int_val(n);
+  blst_p2 *buffer_c = Blst_p2_val(buffer);
+  memset(buffer_c, 0, sizeof(blst_p2));
+  if (n_c < CAML_BLS12_381_ADD_BULK_MIN_SIZE) {
+    for (size_t i = 0; i < n_c; i++)
+      blst_p2_add_or_double(buffer_c, buffer_c, Blst_p2_val(Field(l, i)));
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  }
+  const blst_p2 **points =
+      (const blst_p2 **)calloc(n_c, sizeof(blst_p2 *));
+  blst_p2_affine *affine_points =
+      (blst_p2_affine *)calloc(n_c, sizeof(blst_p2_affine));
+  int ret = 1;
+  if (points != NULL && affine_points != NULL) {
+    for (size_t i = 0; i < n_c; i++)
+      points[i] = Blst_p2_val(Field(l, i));
+    caml_blst_p2s_to_affine(affine_points, points, n_c);
+    ret = caml_blst_p2s_add(buffer_c, affine_points, n_c);
   }
+  free(points);
+  free(affine_points);
+  CAMLreturn(ret ? CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY
+                 : CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+// NB: start and len are supposed to be checked on the caml side
+CAMLprim value caml_blst_p2_affine_array_add_bulk_stubs(value buffer,
+                                                         value affine_list,
+                                                         value start,
+                                                         value len) {
+  CAMLparam4(buffer, affine_list, start, len);
+  size_t len_c = Int_val(len);
+  blst_p2 *buffer_c = Blst_p2_val(buffer);
+  blst_p2_affine *affine_list_c =
+      Blst_p2_affine_val(affine_list) + Int_val(start);
+  if (len_c == 0) {
+    memset(buffer_c, 0, sizeof(blst_p2));
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  }
+  if (caml_blst_p2s_add(buffer_c, affine_list_c, len_c))
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
@@ -1018,35 +2303,2668 @@ CAMLprim value caml_blst_p2_affine_array_get_stubs(value buffer, value list,
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
+// ret = sum scalars[start + i] * points[start + i] for i < npoints, the
+// buffers being taken from msm (possibly NULL). Returns 1 on memory allocation
+// failure.
+static int caml_blst_g2_pippenger_affine(msm_context *msm, blst_p2 *ret,
+                                          const blst_p2_affine *points,
+                                          value scalars, size_t start,
+                                          size_t npoints) {
+  byte *scalars_bs =
+      (byte *)msm_context_alloc(msm, MSM_CONTEXT_SCALARS, npoints * 32);
+  if (scalars_bs == NULL)
+    return (1);
+
+  for (size_t i = 0; i < npoints; i++) {
+    blst_lendian_from_fr(scalars_bs + i * 32,
+                         Blst_fr_val(Field(scalars, start + i)));
+  }
+
+  int res = caml_blst_p2s_mult_pippenger_sparse(msm, ret, points + start,
+                                                npoints, scalars_bs);
+
+  msm_context_release(msm, scalars_bs);
+  return (res);
+}
+
 CAMLprim value caml_blst_g2_pippenger_contiguous_affine_array_stubs(
     value buffer, value affine_list, value scalars, value start, value len) {
   CAMLparam5(buffer, affine_list, scalars, start, len);
-  size_t start_c = ctypes_size_t_val(start);
-  const blst_p2_affine *pts_c = Blst_p2_affine_val(affine_list) + start_c;
-  size_t len_c = ctypes_size_t_val(len);
+  int ret = caml_blst_g2_pippenger_affine(
+      NULL, Blst_p2_val(buffer), Blst_p2_affine_val(affine_list), scalars,
+      ctypes_size_t_val(start), ctypes_size_t_val(len));
+  CAMLreturn(Val_int(ret));
+}
 
-  byte *scalars_bs = (byte *)calloc(len_c * 32, sizeof(byte));
-  if (scalars_bs == NULL) {
-    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+// Arenas: contiguous arrays of preallocated slots. The operations work on the
+// slots in place, referenced by their index. Indices are supposed to be checked
+// on the caml side.
+static struct custom_operations blst_fr_arena_ops = {
+    "blst_fr_arena",            custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+#define Fr_arena_val_k(v, k) (Blst_fr_val(v) + Int_val(k))
+
+CAMLprim value allocate_fr_arena_stubs(value n) {
+  CAMLparam1(n);
+  CAMLlocal1(block);
+  int n_c = Int_val(n);
+  block = caml_alloc_custom(&blst_fr_arena_ops, sizeof(blst_fr) * n_c, 0, 1);
+  memset(Blst_fr_val(block), 0, sizeof(blst_fr) * n_c);
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_fr_arena_set_stubs(value arena, value i, value x) {
+  CAMLparam3(arena, i, x);
+  memcpy(Fr_arena_val_k(arena, i), Blst_fr_val(x), sizeof(blst_fr));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_get_stubs(value x, value arena, value i) {
+  CAMLparam3(x, arena, i);
+  memcpy(Blst_fr_val(x), Fr_arena_val_k(arena, i), sizeof(blst_fr));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_copy_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  memcpy(Fr_arena_val_k(arena, r), Fr_arena_val_k(arena, a), sizeof(blst_fr));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_add_stubs(value arena, value r, value a,
+                                            value b) {
+  CAMLparam4(arena, r, a, b);
+  blst_fr_add(Fr_arena_val_k(arena, r), Fr_arena_val_k(arena, a),
+              Fr_arena_val_k(arena, b));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_sub_stubs(value arena, value r, value a,
+                                            value b) {
+  CAMLparam4(arena, r, a, b);
+  blst_fr_sub(Fr_arena_val_k(arena, r), Fr_arena_val_k(arena, a),
+              Fr_arena_val_k(arena, b));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_mul_stubs(value arena, value r, value a,
+                                            value b) {
+  CAMLparam4(arena, r, a, b);
+  blst_fr_mul(Fr_arena_val_k(arena, r), Fr_arena_val_k(arena, a),
+              Fr_arena_val_k(arena, b));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_sqr_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  blst_fr_sqr(Fr_arena_val_k(arena, r), Fr_arena_val_k(arena, a));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_cneg_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  blst_fr_cneg(Fr_arena_val_k(arena, r), Fr_arena_val_k(arena, a), 1);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_eucl_inverse_stubs(value arena, value r,
+                                                     value a) {
+  CAMLparam3(arena, r, a);
+  if (blst_fr_is_zero(Fr_arena_val_k(arena, a)))
+    CAMLreturn(CAML_BLS12_381_OUTPUT_INVALID_ARGUMENT);
+  blst_fr_eucl_inverse(Fr_arena_val_k(arena, r), Fr_arena_val_k(arena, a));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_fr_arena_is_zero_stubs(value arena, value a) {
+  CAMLparam2(arena, a);
+  CAMLreturn(Val_bool(blst_fr_is_zero(Fr_arena_val_k(arena, a))));
+}
+
+CAMLprim value caml_blst_fr_arena_eq_stubs(value arena, value a, value b) {
+  CAMLparam3(arena, a, b);
+  CAMLreturn(Val_bool(
+      blst_fr_is_equal(Fr_arena_val_k(arena, a), Fr_arena_val_k(arena, b))));
+}
+
+static struct custom_operations blst_p1_arena_ops = {
+    "blst_p1_arena",            custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+#define G1_arena_val_k(v, k) (Blst_p1_val(v) + Int_val(k))
+
+CAMLprim value allocate_p1_arena_stubs(value n) {
+  CAMLparam1(n);
+  CAMLlocal1(block);
+  int n_c = Int_val(n);
+  block = caml_alloc_custom(&blst_p1_arena_ops, sizeof(blst_p1) * n_c, 0, 1);
+  memset(Blst_p1_val(block), 0, sizeof(blst_p1) * n_c);
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p1_arena_set_stubs(value arena, value i, value x) {
+  CAMLparam3(arena, i, x);
+  memcpy(G1_arena_val_k(arena, i), Blst_p1_val(x), sizeof(blst_p1));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_arena_get_stubs(value x, value arena, value i) {
+  CAMLparam3(x, arena, i);
+  memcpy(Blst_p1_val(x), G1_arena_val_k(arena, i), sizeof(blst_p1));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_arena_copy_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  memcpy(G1_arena_val_k(arena, r), G1_arena_val_k(arena, a), sizeof(blst_p1));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_arena_add_or_double_stubs(value arena, value r,
+                                                      value a, value b) {
+  CAMLparam4(arena, r, a, b);
+  blst_p1_add_or_double(G1_arena_val_k(arena, r), G1_arena_val_k(arena, a),
+                        G1_arena_val_k(arena, b));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_arena_double_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  blst_p1_double(G1_arena_val_k(arena, r), G1_arena_val_k(arena, a));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_arena_negate_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  blst_p1 *r_c = G1_arena_val_k(arena, r);
+  if (r_c != G1_arena_val_k(arena, a))
+    memcpy(r_c, G1_arena_val_k(arena, a), sizeof(blst_p1));
+  blst_p1_cneg(r_c, 1);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_arena_mult_stubs(value arena, value r, value a,
+                                             value n) {
+  CAMLparam4(arena, r, a, n);
+  blst_scalar s;
+  blst_p1 tmp;
+  blst_scalar_from_fr(&s, Blst_fr_val(n));
+  blst_p1_mult(&tmp, G1_arena_val_k(arena, a), s.b, 256);
+  memcpy(G1_arena_val_k(arena, r), &tmp, sizeof(blst_p1));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_arena_is_inf_stubs(value arena, value a) {
+  CAMLparam2(arena, a);
+  CAMLreturn(Val_bool(blst_p1_is_inf(G1_arena_val_k(arena, a))));
+}
+
+CAMLprim value caml_blst_p1_arena_equal_stubs(value arena, value a, value b) {
+  CAMLparam3(arena, a, b);
+  CAMLreturn(Val_bool(
+      blst_p1_is_equal(G1_arena_val_k(arena, a), G1_arena_val_k(arena, b))));
+}
+
+static struct custom_operations blst_p2_arena_ops = {
+    "blst_p2_arena",            custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+#define G2_arena_val_k(v, k) (Blst_p2_val(v) + Int_val(k))
+
+CAMLprim value allocate_p2_arena_stubs(value n) {
+  CAMLparam1(n);
+  CAMLlocal1(block);
+  int n_c = Int_val(n);
+  block = caml_alloc_custom(&blst_p2_arena_ops, sizeof(blst_p2) * n_c, 0, 1);
+  memset(Blst_p2_val(block), 0, sizeof(blst_p2) * n_c);
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p2_arena_set_stubs(value arena, value i, value x) {
+  CAMLparam3(arena, i, x);
+  memcpy(G2_arena_val_k(arena, i), Blst_p2_val(x), sizeof(blst_p2));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_arena_get_stubs(value x, value arena, value i) {
+  CAMLparam3(x, arena, i);
+  memcpy(Blst_p2_val(x), G2_arena_val_k(arena, i), sizeof(blst_p2));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_arena_copy_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  memcpy(G2_arena_val_k(arena, r), G2_arena_val_k(arena, a), sizeof(blst_p2));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_arena_add_or_double_stubs(value arena, value r,
+                                                      value a, value b) {
+  CAMLparam4(arena, r, a, b);
+  blst_p2_add_or_double(G2_arena_val_k(arena, r), G2_arena_val_k(arena, a),
+                        G2_arena_val_k(arena, b));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_arena_double_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  blst_p2_double(G2_arena_val_k(arena, r), G2_arena_val_k(arena, a));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_arena_negate_stubs(value arena, value r, value a) {
+  CAMLparam3(arena, r, a);
+  blst_p2 *r_c = G2_arena_val_k(arena, r);
+  if (r_c != G2_arena_val_k(arena, a))
+    memcpy(r_c, G2_arena_val_k(arena, a), sizeof(blst_p2));
+  blst_p2_cneg(r_c, 1);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_arena_mult_stubs(value arena, value r, value a,
+                                             value n) {
+  CAMLparam4(arena, r, a, n);
+  blst_scalar s;
+  blst_p2 tmp;
+  blst_scalar_from_fr(&s, Blst_fr_val(n));
+  blst_p2_mult(&tmp, G2_arena_val_k(arena, a), s.b, 256);
+  memcpy(G2_arena_val_k(arena, r), &tmp, sizeof(blst_p2));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_arena_is_inf_stubs(value arena, value a) {
+  CAMLparam2(arena, a);
+  CAMLreturn(Val_bool(blst_p2_is_inf(G2_arena_val_k(arena, a))));
+}
+
+CAMLprim value caml_blst_p2_arena_equal_stubs(value arena, value a, value b) {
+  CAMLparam3(arena, a, b);
+  CAMLreturn(Val_bool(
+      blst_p2_is_equal(G2_arena_val_k(arena, a), G2_arena_val_k(arena, b))));
+}
+
+// Prepared bases: for a window c, the table holds the ceil(255 / c) points
+// 2^(c j) P_i of each base P_i in affine coordinates, computed once and reused
+// by each multi-scalar multiplication. The row of the base i starts at the
+// index i * ceil(255 / c). The scalars are split in digits of c bits, the
+// digit j of the scalar i being the scalar of the point 2^(c j) P_i, and the
+// MSM becomes a single Pippenger over n * ceil(255 / c) points of c bits. It
+// drops the doublings between the windows, and the larger number of points
+// favours the batch affine additions. The window of Pippenger is c + 1 to keep
+// the carry of the Booth encoding in one window. The tables are split in
+// chunks of bases precomputed, and used, in parallel.
+#define CAML_BLS12_381_PREPARED_BASES_MIN_CHUNK_SIZE 256
+
+typedef struct {
+  void *bases;
+  const void *points;
+  void *results;
+  const byte *scalars;
+  size_t start;
+  size_t n;
+  size_t chunk_size;
+  int ret;
+} prepared_bases_ctx;
+
+static size_t prepared_bases_nwindows(size_t window) {
+  return ((CAML_BLS12_381_FR_NBITS + window - 1) / window);
+}
+
+// Hypothesis: 2 <= window <= 16. The digits of c bits are written on
+// (c + 7) / 8 bytes in little endian, the nwindows digits of the scalar i
+// starting at digits + i * nwindows * ((c + 7) / 8).
+static void prepared_bases_digits(byte *digits, const byte *scalars, size_t n,
+                                  size_t window) {
+  size_t nw = prepared_bases_nwindows(window);
+  size_t nbytes = (window + 7) / 8;
+  limb_t mask = ((limb_t)1 << window) - 1;
+  for (size_t i = 0; i < n; i++) {
+    const byte *scalar = scalars + i * 32;
+    for (size_t j = 0; j < nw; j++) {
+      size_t bit = j * window;
+      limb_t d = 0;
+      for (size_t b = bit / 8; b < 32 && b <= (bit + window - 1) / 8; b++)
+        d |= (limb_t)scalar[b] << (8 * (b - bit / 8));
+      d = (d >> (bit % 8)) & mask;
+      for (size_t b = 0; b < nbytes; b++)
+        *digits++ = (byte)(d >> (8 * b));
+    }
+  }
+}
+
+typedef struct {
+  size_t window;
+  size_t npoints;
+  blst_p1_affine table[];
+} blst_p1_prepared_bases;
+
+#define Blst_p1_prepared_bases_val(v)                                          \
+  ((blst_p1_prepared_bases *)Data_custom_val(v))
+
+static struct custom_operations blst_p1_prepared_bases_ops = {
+    "blst_p1_prepared_bases",   custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+CAMLprim value allocate_p1_prepared_bases_stubs(value window, value npoints) {
+  CAMLparam2(window, npoints);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  size_t npoints_c = Int_val(npoints);
+  block = caml_alloc_custom(&blst_p1_prepared_bases_ops,
+                            sizeof(blst_p1_prepared_bases) +
+                                npoints_c *
+                                    prepared_bases_nwindows(window_c) *
+                                    sizeof(blst_p1_affine),
+                            0, 1);
+  Blst_p1_prepared_bases_val(block)->window = window_c;
+  Blst_p1_prepared_bases_val(block)->npoints = npoints_c;
+  CAMLreturn(block);
+}
+
+// The infinity is encoded by zero in the table, see caml_blst_p1s_to_affine
+static void p1_prepared_bases_precompute_chunk(size_t k, void *arg) {
+  prepared_bases_ctx *ctx = (prepared_bases_ctx *)arg;
+  blst_p1_prepared_bases *bases = (blst_p1_prepared_bases *)ctx->bases;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  size_t nw = prepared_bases_nwindows(bases->window);
+  const blst_p1_affine *points = (const blst_p1_affine *)ctx->points + start;
+  blst_p1 *rows = (blst_p1 *)malloc(len * nw * sizeof(blst_p1));
+  const blst_p1 **ptrs = (const blst_p1 **)malloc(len * nw * sizeof(blst_p1 *));
+  if (rows == NULL || ptrs == NULL) {
+    free(rows);
+    free(ptrs);
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
   }
+  for (size_t i = 0; i < len; i++) {
+    blst_p1 *row = rows + i * nw;
+    blst_p1_from_affine(row, points + i);
+    for (size_t j = 1; j < nw; j++) {
+      memcpy(row + j, row + j - 1, sizeof(blst_p1));
+      for (size_t d = 0; d < bases->window; d++)
+        blst_p1_double(row + j, row + j);
+    }
+  }
+  for (size_t i = 0; i < len * nw; i++)
+    ptrs[i] = rows + i;
+  caml_blst_p1s_to_affine(bases->table + start * nw, ptrs, len * nw);
+  free(rows);
+  free(ptrs);
+}
+
+CAMLprim value caml_blst_p1_prepared_bases_precompute_stubs(value bases,
+                                                            value points) {
+  CAMLparam2(bases, points);
+  prepared_bases_ctx ctx = {Blst_p1_prepared_bases_val(bases),
+                            Blst_p1_affine_val(points),
+                            NULL,
+                            NULL,
+                            0,
+                            Blst_p1_prepared_bases_val(bases)->npoints,
+                            0,
+                            0};
+  if (ctx.n == 0)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  size_t nb_chunks = parallel_nb_chunks(
+      ctx.n, CAML_BLS12_381_PREPARED_BASES_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p1_prepared_bases_precompute_chunk,
+                              &ctx);
+  CAMLreturn(Val_int(ctx.ret));
+}
+
+static void p1_prepared_bases_mult_chunk(size_t k, void *arg) {
+  prepared_bases_ctx *ctx = (prepared_bases_ctx *)arg;
+  blst_p1_prepared_bases *bases = (blst_p1_prepared_bases *)ctx->bases;
+  size_t offset = k * ctx->chunk_size;
+  size_t len = ctx->n - offset < ctx->chunk_size ? ctx->n - offset
+                                                  : ctx->chunk_size;
+  size_t window = bases->window;
+  size_t nw = prepared_bases_nwindows(window);
+  size_t npoints = len * nw;
+  const blst_p1_affine *table = bases->table + (ctx->start + offset) * nw;
+  int affine = npoints >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE;
+  byte *digits = (byte *)malloc(npoints * ((window + 7) / 8));
+  limb_t *scratch = (limb_t *)malloc(
+      affine ? blst_p1s_mult_pippenger_affine_scratch_sizeof(window + 1)
+             : blst_p1s_mult_pippenger_scratch_sizeof(0) << window);
+  if (digits == NULL || scratch == NULL) {
+    free(digits);
+    free(scratch);
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  prepared_bases_digits(digits, ctx->scalars + offset * 32, len, window);
+  if (affine)
+    blst_p1s_mult_pippenger_affine_cont((blst_p1 *)ctx->results + k, table,
+                                        npoints, digits, window, scratch,
+                                        window + 1);
+  else
+    blst_p1s_mult_pippenger_cont_window((blst_p1 *)ctx->results + k, table,
+                                        npoints, digits, window, scratch,
+                                        window + 1);
+  free(digits);
+  free(scratch);
+}
 
-  for (int i = 0; i < len_c; i++) {
+// Hypothesis: start + len is smaller than the number of bases and the length
+// of scalars
+CAMLprim value caml_blst_p1_prepared_bases_mult_stubs(value buffer, value bases,
+                                                      value scalars,
+                                                      value start, value len) {
+  CAMLparam5(buffer, bases, scalars, start, len);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  prepared_bases_ctx ctx = {
+      Blst_p1_prepared_bases_val(bases), NULL, NULL, NULL, start_c, len_c, 0,
+      0};
+  size_t nb_chunks = parallel_nb_chunks(
+      len_c, CAML_BLS12_381_PREPARED_BASES_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  byte *scalars_bs = (byte *)malloc(len_c * 32);
+  blst_p1 *results = (blst_p1 *)calloc(nb_chunks, sizeof(blst_p1));
+  if (scalars_bs == NULL || results == NULL) {
+    free(scalars_bs);
+    free(results);
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  }
+  for (size_t i = 0; i < len_c; i++) {
     blst_lendian_from_fr(scalars_bs + i * 32,
                          Blst_fr_val(Field(scalars, start_c + i)));
   }
+  ctx.scalars = scalars_bs;
+  ctx.results = results;
+  caml_bls12_381_parallel_for(nb_chunks, p1_prepared_bases_mult_chunk, &ctx);
+  if (ctx.ret == 0) {
+    blst_p1 *buffer_c = Blst_p1_val(buffer);
+    memcpy(buffer_c, results, sizeof(blst_p1));
+    for (size_t k = 1; k < nb_chunks; k++)
+      blst_p1_add_or_double(buffer_c, buffer_c, results + k);
+  }
+  free(scalars_bs);
+  free(results);
+  CAMLreturn(Val_int(ctx.ret));
+}
 
-  limb_t *scratch = calloc(1, blst_p2s_mult_pippenger_scratch_sizeof(len_c));
-  if (scratch == NULL) {
+typedef struct {
+  size_t window;
+  size_t npoints;
+  blst_p2_affine table[];
+} blst_p2_prepared_bases;
+
+#define Blst_p2_prepared_bases_val(v)                                          \
+  ((blst_p2_prepared_bases *)Data_custom_val(v))
+
+static struct custom_operations blst_p2_prepared_bases_ops = {
+    "blst_p2_prepared_bases",   custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+CAMLprim value allocate_p2_prepared_bases_stubs(value window, value npoints) {
+  CAMLparam2(window, npoints);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  size_t npoints_c = Int_val(npoints);
+  block = caml_alloc_custom(&blst_p2_prepared_bases_ops,
+                            sizeof(blst_p2_prepared_bases) +
+                                npoints_c *
+                                    prepared_bases_nwindows(window_c) *
+                                    sizeof(blst_p2_affine),
+                            0, 1);
+  Blst_p2_prepared_bases_val(block)->window = window_c;
+  Blst_p2_prepared_bases_val(block)->npoints = npoints_c;
+  CAMLreturn(block);
+}
+
+// The infinity is encoded by zero in the table, see caml_blst_p2s_to_affine
+static void p2_prepared_bases_precompute_chunk(size_t k, void *arg) {
+  prepared_bases_ctx *ctx = (prepared_bases_ctx *)arg;
+  blst_p2_prepared_bases *bases = (blst_p2_prepared_bases *)ctx->bases;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  size_t nw = prepared_bases_nwindows(bases->window);
+  const blst_p2_affine *points = (const blst_p2_affine *)ctx->points + start;
+  blst_p2 *rows = (blst_p2 *)malloc(len * nw * sizeof(blst_p2));
+  const blst_p2 **ptrs = (const blst_p2 **)malloc(len * nw * sizeof(blst_p2 *));
+  if (rows == NULL || ptrs == NULL) {
+    free(rows);
+    free(ptrs);
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  for (size_t i = 0; i < len; i++) {
+    blst_p2 *row = rows + i * nw;
+    blst_p2_from_affine(row, points + i);
+    for (size_t j = 1; j < nw; j++) {
+      memcpy(row + j, row + j - 1, sizeof(blst_p2));
+      for (size_t d = 0; d < bases->window; d++)
+        blst_p2_double(row + j, row + j);
+    }
+  }
+  for (size_t i = 0; i < len * nw; i++)
+    ptrs[i] = rows + i;
+  caml_blst_p2s_to_affine(bases->table + start * nw, ptrs, len * nw);
+  free(rows);
+  free(ptrs);
+}
+
+CAMLprim value caml_blst_p2_prepared_bases_precompute_stubs(value bases,
+                                                            value points) {
+  CAMLparam2(bases, points);
+  prepared_bases_ctx ctx = {Blst_p2_prepared_bases_val(bases),
+                            Blst_p2_affine_val(points),
+                            NULL,
+                            NULL,
+                            0,
+                            Blst_p2_prepared_bases_val(bases)->npoints,
+                            0,
+                            0};
+  if (ctx.n == 0)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  size_t nb_chunks = parallel_nb_chunks(
+      ctx.n, CAML_BLS12_381_PREPARED_BASES_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p2_prepared_bases_precompute_chunk,
+                              &ctx);
+  CAMLreturn(Val_int(ctx.ret));
+}
+
+static void p2_prepared_bases_mult_chunk(size_t k, void *arg) {
+  prepared_bases_ctx *ctx = (prepared_bases_ctx *)arg;
+  blst_p2_prepared_bases *bases = (blst_p2_prepared_bases *)ctx->bases;
+  size_t offset = k * ctx->chunk_size;
+  size_t len = ctx->n - offset < ctx->chunk_size ? ctx->n - offset
+                                                  : ctx->chunk_size;
+  size_t window = bases->window;
+  size_t nw = prepared_bases_nwindows(window);
+  size_t npoints = len * nw;
+  const blst_p2_affine *table = bases->table + (ctx->start + offset) * nw;
+  int affine = npoints >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE;
+  byte *digits = (byte *)malloc(npoints * ((window + 7) / 8));
+  limb_t *scratch = (limb_t *)malloc(
+      affine ? blst_p2s_mult_pippenger_affine_scratch_sizeof(window + 1)
+             : blst_p2s_mult_pippenger_scratch_sizeof(0) << window);
+  if (digits == NULL || scratch == NULL) {
+    free(digits);
+    free(scratch);
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  prepared_bases_digits(digits, ctx->scalars + offset * 32, len, window);
+  if (affine)
+    blst_p2s_mult_pippenger_affine_cont((blst_p2 *)ctx->results + k, table,
+                                        npoints, digits, window, scratch,
+                                        window + 1);
+  else
+    blst_p2s_mult_pippenger_cont_window((blst_p2 *)ctx->results + k, table,
+                                        npoints, digits, window, scratch,
+                                        window + 1);
+  free(digits);
+  free(scratch);
+}
+
+// Hypothesis: start + len is smaller than the number of bases and the length
+// of scalars
+CAMLprim value caml_blst_p2_prepared_bases_mult_stubs(value buffer, value bases,
+                                                      value scalars,
+                                                      value start, value len) {
+  CAMLparam5(buffer, bases, scalars, start, len);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  prepared_bases_ctx ctx = {
+      Blst_p2_prepared_bases_val(bases), NULL, NULL, NULL, start_c, len_c, 0,
+      0};
+  size_t nb_chunks = parallel_nb_chunks(
+      len_c, CAML_BLS12_381_PREPARED_BASES_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  byte *scalars_bs = (byte *)malloc(len_c * 32);
+  blst_p2 *results = (blst_p2 *)calloc(nb_chunks, sizeof(blst_p2));
+  if (scalars_bs == NULL || results == NULL) {
     free(scalars_bs);
+    free(results);
     CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
   }
+  for (size_t i = 0; i < len_c; i++) {
+    blst_lendian_from_fr(scalars_bs + i * 32,
+                         Blst_fr_val(Field(scalars, start_c + i)));
+  }
+  ctx.scalars = scalars_bs;
+  ctx.results = results;
+  caml_bls12_381_parallel_for(nb_chunks, p2_prepared_bases_mult_chunk, &ctx);
+  if (ctx.ret == 0) {
+    blst_p2 *buffer_c = Blst_p2_val(buffer);
+    memcpy(buffer_c, results, sizeof(blst_p2));
+    for (size_t k = 1; k < nb_chunks; k++)
+      blst_p2_add_or_double(buffer_c, buffer_c, results + k);
+  }
+  free(scalars_bs);
+  free(results);
+  CAMLreturn(Val_int(ctx.ret));
+}
 
-  blst_p2s_mult_pippenger_cont(Blst_p2_val(buffer), pts_c, len_c, scalars_bs,
-                               256, scratch);
+// Scalar batches: the scalars are converted once to little endian and recoded
+// in the Booth digits of the rows of the tiles of Pippenger's algorithm, for a
+// window chosen from the number of scalars. The digits of the row y (bits
+// [y * window, (y + 1) * window)) of the scalar i are digits[y * nscalars + i].
+// A batch can be used by any number of MSMs, on G1 or G2, which only read the
+// digits. The little endian encoding is kept for the MSMs of one point.
+typedef struct {
+  size_t nscalars;
+  size_t window;
+  size_t nrows;
+} blst_scalar_batch;
+
+#define Blst_scalar_batch_val(v) ((blst_scalar_batch *)Data_custom_val(v))
+
+static byte *scalar_batch_scalars(const blst_scalar_batch *batch) {
+  return ((byte *)(batch + 1));
+}
 
-  free(scalars_bs);
-  free(scratch);
+static unsigned int *scalar_batch_digits(const blst_scalar_batch *batch) {
+  return ((unsigned int *)(scalar_batch_scalars(batch) + 32 * batch->nscalars));
+}
+
+static struct custom_operations blst_scalar_batch_ops = {
+    "blst_scalar_batch",        custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
 
+// The rows follow msm_tiles. The window is at least 2, Booth digits on one bit
+// are not supported by blst.
+CAMLprim value allocate_scalar_batch_stubs(value nscalars) {
+  CAMLparam1(nscalars);
+  CAMLlocal1(block);
+  size_t nscalars_c = Int_val(nscalars);
+  size_t window = msm_window_size(nscalars_c);
+  if (window < 2)
+    window = 2;
+  size_t nrows = CAML_BLS12_381_FR_NBITS / window + 1;
+  window = CAML_BLS12_381_FR_NBITS / nrows + 1;
+  block = caml_alloc_custom(&blst_scalar_batch_ops,
+                            sizeof(blst_scalar_batch) + 32 * nscalars_c +
+                                nrows * nscalars_c * sizeof(unsigned int),
+                            0, 1);
+  Blst_scalar_batch_val(block)->nscalars = nscalars_c;
+  Blst_scalar_batch_val(block)->window = window;
+  Blst_scalar_batch_val(block)->nrows = nrows;
+  CAMLreturn(block);
+}
+
+static void scalar_batch_recode_row(size_t y, void *arg) {
+  const blst_scalar_batch *batch = (const blst_scalar_batch *)arg;
+  blst_pippenger_booth_digits(scalar_batch_digits(batch) + y * batch->nscalars,
+                              scalar_batch_scalars(batch), batch->nscalars,
+                              CAML_BLS12_381_FR_NBITS, y * batch->window,
+                              batch->window);
+}
+
+// Hypothesis: scalars is an array of size *at least* the number of scalars of
+// the batch. The rows are recoded in parallel.
+CAMLprim value caml_blst_scalar_batch_set_stubs(value batch, value scalars) {
+  CAMLparam2(batch, scalars);
+  blst_scalar_batch *batch_c = Blst_scalar_batch_val(batch);
+  byte *scalars_bs = scalar_batch_scalars(batch_c);
+  for (size_t i = 0; i < batch_c->nscalars; i++)
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  caml_bls12_381_parallel_for(batch_c->nrows, scalar_batch_recode_row,
+                              batch_c);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+// Without the scalars, the tiles are only split in rows when there are more
+// rows than threads. Else, the points are split in nx ranges of at least
+// CAML_BLS12_381_PIPPENGER_PARALLEL_MIN_SIZE points.
+static size_t scalar_batch_nx(const blst_scalar_batch *batch, size_t npoints) {
+  size_t ncpus = caml_bls12_381_get_nb_threads();
+  size_t nx = 1;
+  while (nx * batch->nrows < ncpus &&
+         npoints / (nx + 1) >= CAML_BLS12_381_PIPPENGER_PARALLEL_MIN_SIZE)
+    nx++;
+  return (nx);
+}
+
+// ret = sum scalars[start + i] * points[i] for i < npoints, the scalars being
+// the ones of the batch. Returns 1 on memory allocation failure.
+static int caml_blst_p1s_mult_scalar_batch(blst_p1 *ret,
+                                           const blst_p1_affine *points,
+                                           const blst_scalar_batch *batch,
+                                           size_t start, size_t npoints) {
+  if (npoints == 0) {
+    memset(ret, 0, sizeof(blst_p1));
+    return (0);
+  }
+  if (npoints == 1) {
+    blst_p1_from_affine(ret, points);
+    blst_p1_mult(ret, ret, scalar_batch_scalars(batch) + start * 32,
+                 CAML_BLS12_381_FR_NBITS);
+    return (0);
+  }
+  size_t nx = scalar_batch_nx(batch, npoints);
+  msm_tile *tiles =
+      msm_tiles_grid(NULL, npoints, nx, batch->nrows, batch->window);
+  if (tiles == NULL)
+    return (1);
+  msm_ctx ctx = {NULL,
+                 points,
+                 NULL,
+                 CAML_BLS12_381_FR_NBITS,
+                 batch->window,
+                 tiles,
+                 scalar_batch_digits(batch) + start,
+                 batch->nscalars,
+                 0,
+                 NULL,
+                 0,
+                 0};
+  int res = caml_blst_p1s_mult_tiles(NULL, ret, &ctx, nx, batch->nrows);
+  free(tiles);
+  return (res);
+}
+
+// Hypothesis: start + len is smaller than the number of points of affine_list
+// and the number of scalars of the batch
+CAMLprim value caml_blst_g1_pippenger_scalar_batch_stubs(value buffer,
+                                                         value affine_list,
+                                                         value batch,
+                                                         value start,
+                                                         value len) {
+  CAMLparam5(buffer, affine_list, batch, start, len);
+  size_t start_c = Int_val(start);
+  int ret = caml_blst_p1s_mult_scalar_batch(
+      Blst_p1_val(buffer), Blst_p1_affine_val(affine_list) + start_c,
+      Blst_scalar_batch_val(batch), start_c, Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+// ret = sum scalars[start + i] * points[i] for i < npoints, the scalars being
+// the ones of the batch. Returns 1 on memory allocation failure.
+static int caml_blst_p2s_mult_scalar_batch(blst_p2 *ret,
+                                           const blst_p2_affine *points,
+                                           const blst_scalar_batch *batch,
+                                           size_t start, size_t npoints) {
+  if (npoints == 0) {
+    memset(ret, 0, sizeof(blst_p2));
+    return (0);
+  }
+  if (npoints == 1) {
+    blst_p2_from_affine(ret, points);
+    blst_p2_mult(ret, ret, scalar_batch_scalars(batch) + start * 32,
+                 CAML_BLS12_381_FR_NBITS);
+    return (0);
+  }
+  size_t nx = scalar_batch_nx(batch, npoints);
+  msm_tile *tiles =
+      msm_tiles_grid(NULL, npoints, nx, batch->nrows, batch->window);
+  if (tiles == NULL)
+    return (1);
+  msm_ctx ctx = {NULL,
+                 points,
+                 NULL,
+                 CAML_BLS12_381_FR_NBITS,
+                 batch->window,
+                 tiles,
+                 scalar_batch_digits(batch) + start,
+                 batch->nscalars,
+                 0,
+                 NULL,
+                 0,
+                 0};
+  int res = caml_blst_p2s_mult_tiles(NULL, ret, &ctx, nx, batch->nrows);
+  free(tiles);
+  return (res);
+}
+
+// Hypothesis: start + len is smaller than the number of points of affine_list
+// and the number of scalars of the batch
+CAMLprim value caml_blst_g2_pippenger_scalar_batch_stubs(value buffer,
+                                                         value affine_list,
+                                                         value batch,
+                                                         value start,
+                                                         value len) {
+  CAMLparam5(buffer, affine_list, batch, start, len);
+  size_t start_c = Int_val(start);
+  int ret = caml_blst_p2s_mult_scalar_batch(
+      Blst_p2_val(buffer), Blst_p2_affine_val(affine_list) + start_c,
+      Blst_scalar_batch_val(batch), start_c, Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+// Multi-MSM: MSMs of several vectors of scalars over the same points, computed
+// on the tiles of caml_blst_p1s_mult_pippenger, each tile computing its partial
+// MSMs for all the vectors. From CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE
+// points per tile, the vectors are processed by groups sharing the loads of the
+// points and the offsets of the digits, see
+// blst_p1s_tile_pippenger_affine_multi. The groups have at most
+// CAML_BLS12_381_PIPPENGER_MULTI_GROUP_SIZE vectors, and their buckets use at
+// most CAML_BLS12_381_PIPPENGER_MULTI_MAX_SCRATCH bytes per thread (unless one
+// vector needs more). Below, the points of the tile stay in cache and the
+// vectors are computed one after the other.
+#define CAML_BLS12_381_PIPPENGER_MULTI_GROUP_SIZE 8
+#define CAML_BLS12_381_PIPPENGER_MULTI_MAX_SCRATCH ((size_t)32 << 20)
+
+typedef struct {
+  // The tile k of the vector j is results[k * nvectors + j]
+  void *results;
+  const void *points;
+  // The scalars of the vector j start at scalars + j * stride
+  const byte *scalars;
+  size_t stride;
+  size_t nvectors;
+  size_t window;
+  const msm_tile *tiles;
+  int ret;
+} msm_multi_ctx;
+
+static size_t msm_multi_group_size(size_t nvectors, size_t scratch_size) {
+  size_t group = CAML_BLS12_381_PIPPENGER_MULTI_MAX_SCRATCH / scratch_size;
+  if (group > CAML_BLS12_381_PIPPENGER_MULTI_GROUP_SIZE)
+    group = CAML_BLS12_381_PIPPENGER_MULTI_GROUP_SIZE;
+  if (group > nvectors)
+    group = nvectors;
+  return (group > 0 ? group : 1);
+}
+
+static void p1_msm_multi_tile_task(size_t k, void *arg) {
+  msm_multi_ctx *ctx = (msm_multi_ctx *)arg;
+  const msm_tile *tile = ctx->tiles + k;
+  blst_p1 *res = (blst_p1 *)ctx->results + k * ctx->nvectors;
+  const blst_p1_affine *points = (const blst_p1_affine *)ctx->points + tile->x0;
+  const byte *scalars[CAML_BLS12_381_PIPPENGER_MULTI_GROUP_SIZE];
+  int affine = tile->dx >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE;
+  size_t scratch_size =
+      blst_p1s_mult_pippenger_affine_scratch_sizeof(ctx->window);
+  size_t group = msm_multi_group_size(ctx->nvectors, scratch_size);
+  limb_t *scratch = (limb_t *)malloc(
+      affine ? blst_p1s_mult_pippenger_affine_multi_scratch_sizeof(ctx->window,
+                                                                   group)
+             : blst_p1s_mult_pippenger_scratch_sizeof(0) << (ctx->window - 1));
+  if (scratch == NULL) {
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  for (size_t j0 = 0; j0 < ctx->nvectors; j0 += group) {
+    size_t n = ctx->nvectors - j0 < group ? ctx->nvectors - j0 : group;
+    for (size_t j = 0; j < n; j++)
+      scalars[j] = ctx->scalars + (j0 + j) * ctx->stride + tile->x0 * 32;
+    if (affine)
+      blst_p1s_tile_pippenger_affine_multi(
+          res + j0, points, tile->dx, scalars, n, CAML_BLS12_381_FR_NBITS,
+          scratch, tile->bit0, ctx->window);
+    else
+      for (size_t j = 0; j < n; j++)
+        blst_p1s_tile_pippenger_cont(res + j0 + j, points, tile->dx,
+                                     scalars[j], CAML_BLS12_381_FR_NBITS,
+                                     scratch, tile->bit0, ctx->window);
+  }
+  free(scratch);
+}
+
+// ret[j] = sum scalars_j[i] * points[i] for j < nvectors, the scalars being
+// encoded on 256 bits in little endian, the vector j starting at
+// scalars + j * npoints * 32. Returns 1 on memory allocation failure.
+static int caml_blst_p1s_mult_pippenger_multi(blst_p1 ret[],
+                                              const blst_p1_affine *points,
+                                              size_t npoints,
+                                              const byte *scalars,
+                                              size_t nvectors) {
+  if (npoints == 1) {
+    for (size_t j = 0; j < nvectors; j++) {
+      blst_p1_from_affine(ret + j, points);
+      blst_p1_mult(ret + j, ret + j, scalars + j * 32,
+                   CAML_BLS12_381_FR_NBITS);
+    }
+    return (0);
+  }
+  size_t ncpus = caml_bls12_381_get_nb_threads();
+  size_t nx = 1, window = msm_window_size(npoints);
+  size_t ny = CAML_BLS12_381_FR_NBITS / window + 1;
+  msm_tile *tiles;
+  // With one thread, the window of the sequential algorithm
+  if (ncpus <= 1 || npoints < CAML_BLS12_381_PIPPENGER_PARALLEL_MIN_SIZE)
+    tiles = msm_tiles_grid(NULL, npoints, nx, ny, window);
+  else
+    tiles = msm_tiles(NULL, npoints, CAML_BLS12_381_FR_NBITS, ncpus, &nx, &ny,
+                      &window);
+  blst_p1 *results = (blst_p1 *)calloc(nx * ny * nvectors, sizeof(blst_p1));
+  if (tiles == NULL || results == NULL) {
+    free(tiles);
+    free(results);
+    return (1);
+  }
+  msm_multi_ctx ctx = {
+      results, points, scalars, npoints * 32, nvectors, window, tiles, 0};
+  caml_bls12_381_parallel_for(nx * ny, p1_msm_multi_tile_task, &ctx);
+  if (ctx.ret == 0) {
+    for (size_t j = 0; j < nvectors; j++) {
+      memset(ret + j, 0, sizeof(blst_p1));
+      for (size_t y = ny; y-- > 0;) {
+        if (y + 1 < ny)
+          for (size_t i = 0; i < window; i++)
+            blst_p1_double(ret + j, ret + j);
+        for (size_t x = 0; x < nx; x++)
+          blst_p1_add_or_double(ret + j, ret + j,
+                                results + (y * nx + x) * nvectors + j);
+      }
+    }
+  }
+  free(tiles);
+  free(results);
+  return (ctx.ret);
+}
+
+// Hypothesis: start + len is smaller than the number of points of affine_list
+// and the length of each array of scalars. buffers has one point per array of
+// scalars.
+CAMLprim value caml_blst_g1_pippenger_multi_stubs(value buffers,
+                                                  value affine_list,
+                                                  value scalars, value start,
+                                                  value len) {
+  CAMLparam5(buffers, affine_list, scalars, start, len);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  size_t nvectors = Wosize_val(scalars);
+  if (nvectors == 0)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  byte *scalars_bs = (byte *)malloc(nvectors * len_c * 32);
+  blst_p1 *res = (blst_p1 *)malloc(nvectors * sizeof(blst_p1));
+  if (scalars_bs == NULL || res == NULL) {
+    free(scalars_bs);
+    free(res);
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  }
+  for (size_t j = 0; j < nvectors; j++) {
+    value vector = Field(scalars, j);
+    for (size_t i = 0; i < len_c; i++)
+      blst_lendian_from_fr(scalars_bs + (j * len_c + i) * 32,
+                           Blst_fr_val(Field(vector, start_c + i)));
+  }
+  int ret = caml_blst_p1s_mult_pippenger_multi(
+      res, Blst_p1_affine_val(affine_list) + start_c, len_c, scalars_bs,
+      nvectors);
+  if (ret == 0) {
+    for (size_t j = 0; j < nvectors; j++)
+      memcpy(Blst_p1_val(Field(buffers, j)), res + j, sizeof(blst_p1));
+  }
+  free(scalars_bs);
+  free(res);
+  CAMLreturn(Val_int(ret));
+}
+
+static void p2_msm_multi_tile_task(size_t k, void *arg) {
+  msm_multi_ctx *ctx = (msm_multi_ctx *)arg;
+  const msm_tile *tile = ctx->tiles + k;
+  blst_p2 *res = (blst_p2 *)ctx->results + k * ctx->nvectors;
+  const blst_p2_affine *points = (const blst_p2_affine *)ctx->points + tile->x0;
+  const byte *scalars[CAML_BLS12_381_PIPPENGER_MULTI_GROUP_SIZE];
+  int affine = tile->dx >= CAML_BLS12_381_PIPPENGER_AFFINE_MIN_SIZE;
+  size_t scratch_size =
+      blst_p2s_mult_pippenger_affine_scratch_sizeof(ctx->window);
+  size_t group = msm_multi_group_size(ctx->nvectors, scratch_size);
+  limb_t *scratch = (limb_t *)malloc(
+      affine ? blst_p2s_mult_pippenger_affine_multi_scratch_sizeof(ctx->window,
+                                                                   group)
+             : blst_p2s_mult_pippenger_scratch_sizeof(0) << (ctx->window - 1));
+  if (scratch == NULL) {
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  for (size_t j0 = 0; j0 < ctx->nvectors; j0 += group) {
+    size_t n = ctx->nvectors - j0 < group ? ctx->nvectors - j0 : group;
+    for (size_t j = 0; j < n; j++)
+      scalars[j] = ctx->scalars + (j0 + j) * ctx->stride + tile->x0 * 32;
+    if (affine)
+      blst_p2s_tile_pippenger_affine_multi(
+          res + j0, points, tile->dx, scalars, n, CAML_BLS12_381_FR_NBITS,
+          scratch, tile->bit0, ctx->window);
+    else
+      for (size_t j = 0; j < n; j++)
+        blst_p2s_tile_pippenger_cont(res + j0 + j, points, tile->dx,
+                                     scalars[j], CAML_BLS12_381_FR_NBITS,
+                                     scratch, tile->bit0, ctx->window);
+  }
+  free(scratch);
+}
+
+// ret[j] = sum scalars_j[i] * points[i] for j < nvectors, the scalars being
+// encoded on 256 bits in little endian, the vector j starting at
+// scalars + j * npoints * 32. Returns 1 on memory allocation failure.
+static int caml_blst_p2s_mult_pippenger_multi(blst_p2 ret[],
+                                              const blst_p2_affine *points,
+                                              size_t npoints,
+                                              const byte *scalars,
+                                              size_t nvectors) {
+  if (npoints == 1) {
+    for (size_t j = 0; j < nvectors; j++) {
+      blst_p2_from_affine(ret + j, points);
+      blst_p2_mult(ret + j, ret + j, scalars + j * 32,
+                   CAML_BLS12_381_FR_NBITS);
+    }
+    return (0);
+  }
+  size_t ncpus = caml_bls12_381_get_nb_threads();
+  size_t nx = 1, window = msm_window_size(npoints);
+  size_t ny = CAML_BLS12_381_FR_NBITS / window + 1;
+  msm_tile *tiles;
+  // With one thread, the window of the sequential algorithm
+  if (ncpus <= 1 || npoints < CAML_BLS12_381_PIPPENGER_PARALLEL_MIN_SIZE)
+    tiles = msm_tiles_grid(NULL, npoints, nx, ny, window);
+  else
+    tiles = msm_tiles(NULL, npoints, CAML_BLS12_381_FR_NBITS, ncpus, &nx, &ny,
+                      &window);
+  blst_p2 *results = (blst_p2 *)calloc(nx * ny * nvectors, sizeof(blst_p2));
+  if (tiles == NULL || results == NULL) {
+    free(tiles);
+    free(results);
+    return (1);
+  }
+  msm_multi_ctx ctx = {
+      results, points, scalars, npoints * 32, nvectors, window, tiles, 0};
+  caml_bls12_381_parallel_for(nx * ny, p2_msm_multi_tile_task, &ctx);
+  if (ctx.ret == 0) {
+    for (size_t j = 0; j < nvectors; j++) {
+      memset(ret + j, 0, sizeof(blst_p2));
+      for (size_t y = ny; y-- > 0;) {
+        if (y + 1 < ny)
+          for (size_t i = 0; i < window; i++)
+            blst_p2_double(ret + j, ret + j);
+        for (size_t x = 0; x < nx; x++)
+          blst_p2_add_or_double(ret + j, ret + j,
+                                results + (y * nx + x) * nvectors + j);
+      }
+    }
+  }
+  free(tiles);
+  free(results);
+  return (ctx.ret);
+}
+
+// Hypothesis: start + len is smaller than the number of points of affine_list
+// and the length of each array of scalars. buffers has one point per array of
+// scalars.
+CAMLprim value caml_blst_g2_pippenger_multi_stubs(value buffers,
+                                                  value affine_list,
+                                                  value scalars, value start,
+                                                  value len) {
+  CAMLparam5(buffers, affine_list, scalars, start, len);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  size_t nvectors = Wosize_val(scalars);
+  if (nvectors == 0)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+  byte *scalars_bs = (byte *)malloc(nvectors * len_c * 32);
+  blst_p2 *res = (blst_p2 *)malloc(nvectors * sizeof(blst_p2));
+  if (scalars_bs == NULL || res == NULL) {
+    free(scalars_bs);
+    free(res);
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  }
+  for (size_t j = 0; j < nvectors; j++) {
+    value vector = Field(scalars, j);
+    for (size_t i = 0; i < len_c; i++)
+      blst_lendian_from_fr(scalars_bs + (j * len_c + i) * 32,
+                           Blst_fr_val(Field(vector, start_c + i)));
+  }
+  int ret = caml_blst_p2s_mult_pippenger_multi(
+      res, Blst_p2_affine_val(affine_list) + start_c, len_c, scalars_bs,
+      nvectors);
+  if (ret == 0) {
+    for (size_t j = 0; j < nvectors; j++)
+      memcpy(Blst_p2_val(Field(buffers, j)), res + j, sizeof(blst_p2));
+  }
+  free(scalars_bs);
+  free(res);
+  CAMLreturn(Val_int(ret));
+}
+
+// GLV/GLS MSMs: the scalars are split in 2 digits of 128 bits for G1 and 4
+// digits of 64 bits for G2, see blst_scalar_split_glv and
+// blst_scalar_split_gls, and each point is replaced by its images by the
+// endomorphism, one per digit. The images of the point i are stored one after
+// the other, from the index 2 * i (resp. 4 * i), in the order of the digits.
+// The MSM of the images computed by caml_blst_p1s_mult_pippenger has then 2
+// (resp. 4) times more points but 2 (resp. 4) times less windows. The images
+// are either computed at each MSM, in parallel, or once in GLV bases.
+#define CAML_BLS12_381_GLV_IMAGES_MIN_CHUNK_SIZE 1024
+
+typedef struct {
+  void *images;
+  const void *points;
+  size_t n;
+  size_t chunk_size;
+} glv_images_ctx;
+
+// Return the scalars start, ..., start + n - 1 encoded in little endian and
+// split in digits by split, or NULL on memory allocation failure.
+static byte *glv_scalars(value scalars, size_t start, size_t n,
+                         void (*split)(byte[32], const byte[32])) {
+  byte *scalars_bs = (byte *)malloc((n > 0 ? n : 1) * 32);
+  if (scalars_bs == NULL)
+    return (NULL);
+  for (size_t i = 0; i < n; i++) {
+    blst_lendian_from_fr(scalars_bs + i * 32,
+                         Blst_fr_val(Field(scalars, start + i)));
+    split(scalars_bs + i * 32, scalars_bs + i * 32);
+  }
+  return (scalars_bs);
+}
+
+static void p1_glv_images_chunk(size_t k, void *arg) {
+  glv_images_ctx *ctx = (glv_images_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  blst_p1_affine *images = (blst_p1_affine *)ctx->images + 2 * start;
+  const blst_p1_affine *points = (const blst_p1_affine *)ctx->points + start;
+  for (size_t i = 0; i < len; i++)
+    blst_p1_affine_glv_images(images + 2 * i, points + i);
+}
+
+static void caml_blst_p1s_glv_images(blst_p1_affine *images,
+                                     const blst_p1_affine *points, size_t n) {
+  if (n == 0)
+    return;
+  glv_images_ctx ctx = {images, points, n, 0};
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_GLV_IMAGES_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p1_glv_images_chunk, &ctx);
+}
+
+// ret = sum scalars[start + i] * p_i for i < npoints, images being the images
+// of the points p_i. Returns 1 on memory allocation failure.
+static int caml_blst_p1s_mult_pippenger_glv(blst_p1 *ret,
+                                            const blst_p1_affine *images,
+                                            value scalars, size_t start,
+                                            size_t npoints) {
+  byte *scalars_bs =
+      glv_scalars(scalars, start, npoints, blst_scalar_split_glv);
+  if (scalars_bs == NULL)
+    return (1);
+  int res = caml_blst_p1s_mult_pippenger(NULL, ret, images, 2 * npoints,
+                                         scalars_bs, 128);
+  free(scalars_bs);
+  return (res);
+}
+
+// Hypothesis: start + len is smaller than the number of points of affine_list
+// and the length of scalars
+CAMLprim value caml_blst_g1_pippenger_glv_stubs(value buffer, value affine_list,
+                                                value scalars, value start,
+                                                value len) {
+  CAMLparam5(buffer, affine_list, scalars, start, len);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  blst_p1_affine *images =
+      (blst_p1_affine *)malloc(2 * len_c * sizeof(blst_p1_affine));
+  if (images == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  caml_blst_p1s_glv_images(images, Blst_p1_affine_val(affine_list) + start_c,
+                           len_c);
+  int ret = caml_blst_p1s_mult_pippenger_glv(Blst_p1_val(buffer), images,
+                                             scalars, start_c, len_c);
+  free(images);
+  CAMLreturn(Val_int(ret));
+}
+
+static struct custom_operations blst_p1_glv_bases_ops = {
+    "blst_p1_glv_bases",        custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+CAMLprim value allocate_p1_glv_bases_stubs(value npoints) {
+  CAMLparam1(npoints);
+  CAMLlocal1(block);
+  size_t npoints_c = Int_val(npoints);
+  block = caml_alloc_custom(&blst_p1_glv_bases_ops,
+                            2 * npoints_c * sizeof(blst_p1_affine), 0, 1);
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p1_glv_bases_set_stubs(value bases, value points,
+                                                value npoints) {
+  CAMLparam3(bases, points, npoints);
+  caml_blst_p1s_glv_images(Blst_p1_affine_val(bases),
+                           Blst_p1_affine_val(points), Int_val(npoints));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+// Hypothesis: start + len is smaller than the number of bases and the length
+// of scalars
+CAMLprim value caml_blst_p1_glv_bases_mult_stubs(value buffer, value bases,
+                                                 value scalars, value start,
+                                                 value len) {
+  CAMLparam5(buffer, bases, scalars, start, len);
+  size_t start_c = Int_val(start);
+  int ret = caml_blst_p1s_mult_pippenger_glv(
+      Blst_p1_val(buffer), Blst_p1_affine_val(bases) + 2 * start_c, scalars,
+      start_c, Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+static void p2_glv_images_chunk(size_t k, void *arg) {
+  glv_images_ctx *ctx = (glv_images_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  blst_p2_affine *images = (blst_p2_affine *)ctx->images + 4 * start;
+  const blst_p2_affine *points = (const blst_p2_affine *)ctx->points + start;
+  for (size_t i = 0; i < len; i++)
+    blst_p2_affine_gls_images(images + 4 * i, points + i);
+}
+
+static void caml_blst_p2s_glv_images(blst_p2_affine *images,
+                                     const blst_p2_affine *points, size_t n) {
+  if (n == 0)
+    return;
+  glv_images_ctx ctx = {images, points, n, 0};
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_GLV_IMAGES_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p2_glv_images_chunk, &ctx);
+}
+
+// ret = sum scalars[start + i] * p_i for i < npoints, images being the images
+// of the points p_i. Returns 1 on memory allocation failure.
+static int caml_blst_p2s_mult_pippenger_glv(blst_p2 *ret,
+                                            const blst_p2_affine *images,
+                                            value scalars, size_t start,
+                                            size_t npoints) {
+  byte *scalars_bs =
+      glv_scalars(scalars, start, npoints, blst_scalar_split_gls);
+  if (scalars_bs == NULL)
+    return (1);
+  int res = caml_blst_p2s_mult_pippenger(NULL, ret, images, 4 * npoints,
+                                         scalars_bs, 64);
+  free(scalars_bs);
+  return (res);
+}
+
+// Hypothesis: start + len is smaller than the number of points of affine_list
+// and the length of scalars
+CAMLprim value caml_blst_g2_pippenger_glv_stubs(value buffer, value affine_list,
+                                                value scalars, value start,
+                                                value len) {
+  CAMLparam5(buffer, affine_list, scalars, start, len);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  blst_p2_affine *images =
+      (blst_p2_affine *)malloc(4 * len_c * sizeof(blst_p2_affine));
+  if (images == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  caml_blst_p2s_glv_images(images, Blst_p2_affine_val(affine_list) + start_c,
+                           len_c);
+  int ret = caml_blst_p2s_mult_pippenger_glv(Blst_p2_val(buffer), images,
+                                             scalars, start_c, len_c);
+  free(images);
+  CAMLreturn(Val_int(ret));
+}
+
+static struct custom_operations blst_p2_glv_bases_ops = {
+    "blst_p2_glv_bases",        custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+CAMLprim value allocate_p2_glv_bases_stubs(value npoints) {
+  CAMLparam1(npoints);
+  CAMLlocal1(block);
+  size_t npoints_c = Int_val(npoints);
+  block = caml_alloc_custom(&blst_p2_glv_bases_ops,
+                            4 * npoints_c * sizeof(blst_p2_affine), 0, 1);
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p2_glv_bases_set_stubs(value bases, value points,
+                                                value npoints) {
+  CAMLparam3(bases, points, npoints);
+  caml_blst_p2s_glv_images(Blst_p2_affine_val(bases),
+                           Blst_p2_affine_val(points), Int_val(npoints));
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+// Hypothesis: start + len is smaller than the number of bases and the length
+// of scalars
+CAMLprim value caml_blst_p2_glv_bases_mult_stubs(value buffer, value bases,
+                                                 value scalars, value start,
+                                                 value len) {
+  CAMLparam5(buffer, bases, scalars, start, len);
+  size_t start_c = Int_val(start);
+  int ret = caml_blst_p2s_mult_pippenger_glv(
+      Blst_p2_val(buffer), Blst_p2_affine_val(bases) + 4 * start_c, scalars,
+      start_c, Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+// MSMs with the buffers of an MSM context, see msm_context. Hypothesis: start +
+// len is smaller than the number of points and the length of scalars
+CAMLprim value caml_blst_g1_msm_context_pippenger_stubs(
+    value ctx, value buffer, value jacobian_list, value scalars, value start,
+    value len) {
+  CAMLparam5(ctx, buffer, jacobian_list, scalars, start);
+  CAMLxparam1(len);
+  int ret = caml_blst_g1_pippenger(Msm_context_val(ctx), Blst_p1_val(buffer),
+                                    jacobian_list, scalars, Int_val(start),
+                                    Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_blst_g1_msm_context_pippenger_stubs_bytecode(value *argv,
+                                                                 int argn) {
+  return caml_blst_g1_msm_context_pippenger_stubs(argv[0], argv[1], argv[2],
+                                                  argv[3], argv[4], argv[5]);
+}
+
+CAMLprim value caml_blst_g1_msm_context_pippenger_affine_stubs(
+    value ctx, value buffer, value affine_list, value scalars, value start,
+    value len) {
+  CAMLparam5(ctx, buffer, affine_list, scalars, start);
+  CAMLxparam1(len);
+  int ret = caml_blst_g1_pippenger_affine(
+      Msm_context_val(ctx), Blst_p1_val(buffer),
+      Blst_p1_affine_val(affine_list), scalars, Int_val(start), Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_blst_g1_msm_context_pippenger_affine_stubs_bytecode(
+    value *argv, int argn) {
+  return caml_blst_g1_msm_context_pippenger_affine_stubs(
+      argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]);
+}
+
+CAMLprim value caml_blst_g2_msm_context_pippenger_stubs(
+    value ctx, value buffer, value jacobian_list, value scalars, value start,
+    value len) {
+  CAMLparam5(ctx, buffer, jacobian_list, scalars, start);
+  CAMLxparam1(len);
+  int ret = caml_blst_g2_pippenger(Msm_context_val(ctx), Blst_p2_val(buffer),
+                                    jacobian_list, scalars, Int_val(start),
+                                    Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_blst_g2_msm_context_pippenger_stubs_bytecode(value *argv,
+                                                                 int argn) {
+  return caml_blst_g2_msm_context_pippenger_stubs(argv[0], argv[1], argv[2],
+                                                  argv[3], argv[4], argv[5]);
+}
+
+CAMLprim value caml_blst_g2_msm_context_pippenger_affine_stubs(
+    value ctx, value buffer, value affine_list, value scalars, value start,
+    value len) {
+  CAMLparam5(ctx, buffer, affine_list, scalars, start);
+  CAMLxparam1(len);
+  int ret = caml_blst_g2_pippenger_affine(
+      Msm_context_val(ctx), Blst_p2_val(buffer),
+      Blst_p2_affine_val(affine_list), scalars, Int_val(start), Int_val(len));
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_blst_g2_msm_context_pippenger_affine_stubs_bytecode(
+    value *argv, int argn) {
+  return caml_blst_g2_msm_context_pippenger_affine_stubs(
+      argv[0], argv[1], argv[2], argv[3], argv[4], argv[5]);
+}
+
+// Streaming MSMs: the points and the scalars are given by chunks, added to the
+// buckets of all the windows of Pippenger's algorithm as they come, see
+// blst_p1s_mult_pippenger_stream_add. The buckets are integrated by finish,
+// which resets them for the next MSM. The memory is bounded by the buckets and
+// the staging buffers of CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE points, whatever
+// the number of points. The chunks are copied in the staging buffers with the
+// runtime lock, and added to the buckets without it, the windows in parallel,
+// so that another OCaml thread can produce the next chunk meanwhile. The add
+// stubs are synchronous: they return once the chunk is in the buckets, there is
+// no accumulation in the background. A stream must not be used by two threads
+// at the same time.
+#define CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE 4096
+
+typedef struct {
+  size_t window;
+  size_t nwindows;
+  size_t npoints; // number of points staged
+  limb_t *buckets;
+  void *tiles;    // partial sums of the windows, computed by finish
+  void *points;   // staged points, in affine coordinates
+  byte *scalars;  // staged scalars, in little endian
+  const void **pointers;
+} msm_stream;
+
+#define Msm_stream_val(v) (*((msm_stream **)Data_custom_val(v)))
+
+static void msm_stream_free(msm_stream *s) {
+  if (s == NULL)
+    return;
+  free(s->buckets);
+  free(s->tiles);
+  free(s->points);
+  free(s->scalars);
+  free((void *)s->pointers);
+  free(s);
+}
+
+static void finalize_free_msm_stream(value v) {
+  msm_stream_free(Msm_stream_val(v));
+}
+
+static struct custom_operations msm_stream_ops = {
+    "msm_stream",               finalize_free_msm_stream,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+// Return a stream with zero buckets, or NULL on memory allocation failure
+static msm_stream *msm_stream_alloc(size_t window, size_t buckets_size,
+                                    size_t point_size, size_t affine_size) {
+  size_t n = CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE;
+  msm_stream *s = (msm_stream *)calloc(1, sizeof(msm_stream));
+  if (s == NULL)
+    return (NULL);
+  s->window = window;
+  s->nwindows = CAML_BLS12_381_FR_NBITS / window + 1;
+  s->buckets = (limb_t *)calloc(1, buckets_size);
+  s->tiles = malloc(s->nwindows * point_size);
+  s->points = malloc(n * affine_size);
+  s->scalars = (byte *)malloc(n * 32);
+  s->pointers = (const void **)malloc(n * sizeof(void *));
+  if (s->buckets == NULL || s->tiles == NULL || s->points == NULL ||
+      s->scalars == NULL || s->pointers == NULL) {
+    msm_stream_free(s);
+    return (NULL);
+  }
+  return (s);
+}
+
+// Add the staged points to the buckets, add_window(y, s) adding them to the
+// buckets of the window y
+static void msm_stream_add_staged(msm_stream *s,
+                                  void (*add_window)(size_t y, void *arg)) {
+  caml_enter_blocking_section();
+  caml_bls12_381_parallel_for(s->nwindows, add_window, s);
+  caml_leave_blocking_section();
+  s->npoints = 0;
+}
+
+static void msm_stream_stage_scalars(msm_stream *s, value scalars,
+                                     size_t start, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    blst_lendian_from_fr(s->scalars + i * 32,
+                         Blst_fr_val(Field(scalars, start + i)));
+  }
+  s->npoints = n;
+}
+
+static void p1_msm_stream_add_window(size_t y, void *arg) {
+  msm_stream *s = (msm_stream *)arg;
+  blst_p1s_mult_pippenger_stream_add(
+      s->buckets, (const blst_p1_affine *)s->points, s->npoints, s->scalars,
+      CAML_BLS12_381_FR_NBITS, s->window, y);
+}
+
+static void p1_msm_stream_integrate_window(size_t y, void *arg) {
+  msm_stream *s = (msm_stream *)arg;
+  blst_p1s_mult_pippenger_stream_integrate(
+      (blst_p1 *)s->tiles + y, s->buckets, CAML_BLS12_381_FR_NBITS, s->window,
+      y);
+}
+
+// Hypothesis: 2 <= window <= CAML_BLS12_381_FR_NBITS
+CAMLprim value allocate_p1_msm_stream_stubs(value window) {
+  CAMLparam1(window);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  block = caml_alloc_custom(&msm_stream_ops, sizeof(msm_stream *), 0, 1);
+  Msm_stream_val(block) = NULL;
+  msm_stream *s = msm_stream_alloc(
+      window_c,
+      blst_p1s_mult_pippenger_stream_sizeof(CAML_BLS12_381_FR_NBITS, window_c),
+      sizeof(blst_p1), sizeof(blst_p1_affine));
+  if (s == NULL)
+    caml_raise_out_of_memory();
+  Msm_stream_val(block) = s;
+  CAMLreturn(block);
+}
+
+// Hypothesis: jacobian_list and scalars are arrays of size *at least* start +
+// len
+CAMLprim value caml_blst_g1_msm_stream_add_stubs(value stream,
+                                                 value jacobian_list,
+                                                 value scalars, value start,
+                                                 value len) {
+  CAMLparam5(stream, jacobian_list, scalars, start, len);
+  msm_stream *s = Msm_stream_val(stream);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  const blst_p1 **ps = (const blst_p1 **)s->pointers;
+  for (size_t k = 0; k < len_c; k += CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE) {
+    size_t n = len_c - k < CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE
+                   ? len_c - k
+                   : CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE;
+    for (size_t i = 0; i < n; i++)
+      ps[i] = Blst_p1_val(Field(jacobian_list, start_c + k + i));
+    caml_blst_p1s_to_affine((blst_p1_affine *)s->points, ps, n);
+    msm_stream_stage_scalars(s, scalars, start_c + k, n);
+    msm_stream_add_staged(s, p1_msm_stream_add_window);
+  }
+  CAMLreturn(Val_unit);
+}
+
+// Hypothesis: affine_list and scalars are arrays of size *at least* start +
+// len
+CAMLprim value caml_blst_g1_msm_stream_add_affine_stubs(value stream,
+                                                        value affine_list,
+                                                        value scalars,
+                                                        value start,
+                                                        value len) {
+  CAMLparam5(stream, affine_list, scalars, start, len);
+  msm_stream *s = Msm_stream_val(stream);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  for (size_t k = 0; k < len_c; k += CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE) {
+    size_t n = len_c - k < CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE
+                   ? len_c - k
+                   : CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE;
+    // The array can be moved by the GC while the runtime lock is released
+    memcpy(s->points, Blst_p1_affine_val(affine_list) + start_c + k,
+           n * sizeof(blst_p1_affine));
+    msm_stream_stage_scalars(s, scalars, start_c + k, n);
+    msm_stream_add_staged(s, p1_msm_stream_add_window);
+  }
+  CAMLreturn(Val_unit);
+}
+
+// buffer = sum of the points added since the creation or the last call, times
+// their scalars. The buckets are reset.
+CAMLprim value caml_blst_g1_msm_stream_finish_stubs(value buffer,
+                                                    value stream) {
+  CAMLparam2(buffer, stream);
+  msm_stream *s = Msm_stream_val(stream);
+  blst_p1 *tiles = (blst_p1 *)s->tiles;
+  blst_p1 ret;
+  caml_enter_blocking_section();
+  caml_bls12_381_parallel_for(s->nwindows, p1_msm_stream_integrate_window, s);
+  ret = tiles[s->nwindows - 1];
+  for (size_t y = s->nwindows - 1; y-- > 0;) {
+    for (size_t i = 0; i < s->window; i++)
+      blst_p1_double(&ret, &ret);
+    blst_p1_add_or_double(&ret, &ret, tiles + y);
+  }
+  caml_leave_blocking_section();
+  memcpy(Blst_p1_val(buffer), &ret, sizeof(blst_p1));
+  CAMLreturn(Val_unit);
+}
+
+static void p2_msm_stream_add_window(size_t y, void *arg) {
+  msm_stream *s = (msm_stream *)arg;
+  blst_p2s_mult_pippenger_stream_add(
+      s->buckets, (const blst_p2_affine *)s->points, s->npoints, s->scalars,
+      CAML_BLS12_381_FR_NBITS, s->window, y);
+}
+
+static void p2_msm_stream_integrate_window(size_t y, void *arg) {
+  msm_stream *s = (msm_stream *)arg;
+  blst_p2s_mult_pippenger_stream_integrate(
+      (blst_p2 *)s->tiles + y, s->buckets, CAML_BLS12_381_FR_NBITS, s->window,
+      y);
+}
+
+// Hypothesis: 2 <= window <= CAML_BLS12_381_FR_NBITS
+CAMLprim value allocate_p2_msm_stream_stubs(value window) {
+  CAMLparam1(window);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  block = caml_alloc_custom(&msm_stream_ops, sizeof(msm_stream *), 0, 1);
+  Msm_stream_val(block) = NULL;
+  msm_stream *s = msm_stream_alloc(
+      window_c,
+      blst_p2s_mult_pippenger_stream_sizeof(CAML_BLS12_381_FR_NBITS, window_c),
+      sizeof(blst_p2), sizeof(blst_p2_affine));
+  if (s == NULL)
+    caml_raise_out_of_memory();
+  Msm_stream_val(block) = s;
+  CAMLreturn(block);
+}
+
+// Hypothesis: jacobian_list and scalars are arrays of size *at least* start +
+// len
+CAMLprim value caml_blst_g2_msm_stream_add_stubs(value stream,
+                                                 value jacobian_list,
+                                                 value scalars, value start,
+                                                 value len) {
+  CAMLparam5(stream, jacobian_list, scalars, start, len);
+  msm_stream *s = Msm_stream_val(stream);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  const blst_p2 **ps = (const blst_p2 **)s->pointers;
+  for (size_t k = 0; k < len_c; k += CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE) {
+    size_t n = len_c - k < CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE
+                   ? len_c - k
+                   : CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE;
+    for (size_t i = 0; i < n; i++)
+      ps[i] = Blst_p2_val(Field(jacobian_list, start_c + k + i));
+    caml_blst_p2s_to_affine((blst_p2_affine *)s->points, ps, n);
+    msm_stream_stage_scalars(s, scalars, start_c + k, n);
+    msm_stream_add_staged(s, p2_msm_stream_add_window);
+  }
+  CAMLreturn(Val_unit);
+}
+
+// Hypothesis: affine_list and scalars are arrays of size *at least* start +
+// len
+CAMLprim value caml_blst_g2_msm_stream_add_affine_stubs(value stream,
+                                                        value affine_list,
+                                                        value scalars,
+                                                        value start,
+                                                        value len) {
+  CAMLparam5(stream, affine_list, scalars, start, len);
+  msm_stream *s = Msm_stream_val(stream);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  for (size_t k = 0; k < len_c; k += CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE) {
+    size_t n = len_c - k < CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE
+                   ? len_c - k
+                   : CAML_BLS12_381_MSM_STREAM_CHUNK_SIZE;
+    // The array can be moved by the GC while the runtime lock is released
+    memcpy(s->points, Blst_p2_affine_val(affine_list) + start_c + k,
+           n * sizeof(blst_p2_affine));
+    msm_stream_stage_scalars(s, scalars, start_c + k, n);
+    msm_stream_add_staged(s, p2_msm_stream_add_window);
+  }
+  CAMLreturn(Val_unit);
+}
+
+// buffer = sum of the points added since the creation or the last call, times
+// their scalars. The buckets are reset.
+CAMLprim value caml_blst_g2_msm_stream_finish_stubs(value buffer,
+                                                    value stream) {
+  CAMLparam2(buffer, stream);
+  msm_stream *s = Msm_stream_val(stream);
+  blst_p2 *tiles = (blst_p2 *)s->tiles;
+  blst_p2 ret;
+  caml_enter_blocking_section();
+  caml_bls12_381_parallel_for(s->nwindows, p2_msm_stream_integrate_window, s);
+  ret = tiles[s->nwindows - 1];
+  for (size_t y = s->nwindows - 1; y-- > 0;) {
+    for (size_t i = 0; i < s->window; i++)
+      blst_p2_double(&ret, &ret);
+    blst_p2_add_or_double(&ret, &ret, tiles + y);
+  }
+  caml_leave_blocking_section();
+  memcpy(Blst_p2_val(buffer), &ret, sizeof(blst_p2));
+  CAMLreturn(Val_unit);
+}
+
+// Indexed MSMs, e.g. for the updates of a commitment: the points are gathered
+// from the affine array and the MSM is computed with the sparse scalars path,
+// the differences of the updates being often small.
+// Hypothesis: indices and scalars are arrays of size *at least* len, and the
+// indices are smaller than the number of points of affine_list
+CAMLprim value caml_blst_g1_pippenger_indexed_stubs(value buffer,
+                                                    value affine_list,
+                                                    value indices,
+                                                    value scalars, value len) {
+  CAMLparam5(buffer, affine_list, indices, scalars, len);
+  size_t len_c = Int_val(len);
+  const blst_p1_affine *points = Blst_p1_affine_val(affine_list);
+  blst_p1_affine *ps =
+      (blst_p1_affine *)malloc((len_c + 1) * sizeof(blst_p1_affine));
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  int ret = 1;
+  if (ps == NULL || scalars_bs == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++) {
+    ps[i] = points[Int_val(Field(indices, i))];
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  }
+  ret = caml_blst_p1s_mult_pippenger_sparse(NULL, Blst_p1_val(buffer), ps,
+                                            len_c, scalars_bs);
+out:
+  free(ps);
+  free(scalars_bs);
+  CAMLreturn(Val_int(ret));
+}
+
+// Hypothesis: indices and scalars are arrays of size *at least* len, and the
+// indices are smaller than the number of points of affine_list
+CAMLprim value caml_blst_g2_pippenger_indexed_stubs(value buffer,
+                                                    value affine_list,
+                                                    value indices,
+                                                    value scalars, value len) {
+  CAMLparam5(buffer, affine_list, indices, scalars, len);
+  size_t len_c = Int_val(len);
+  const blst_p2_affine *points = Blst_p2_affine_val(affine_list);
+  blst_p2_affine *ps =
+      (blst_p2_affine *)malloc((len_c + 1) * sizeof(blst_p2_affine));
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  int ret = 1;
+  if (ps == NULL || scalars_bs == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++) {
+    ps[i] = points[Int_val(Field(indices, i))];
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  }
+  ret = caml_blst_p2s_mult_pippenger_sparse(NULL, Blst_p2_val(buffer), ps,
+                                            len_c, scalars_bs);
+out:
+  free(ps);
+  free(scalars_bs);
+  CAMLreturn(Val_int(ret));
+}
+
+// Slice [bit0, bit1) of the MSM: the Booth digits of the scalars on these
+// bits, scaled by 2^bit0. The slices of a partition of [0, nbits) add up to
+// the MSM, whatever the tiles used for each slice. The tiles have at most
+// msm_window_size(npoints) bits and at least 3 to keep 2 bits per tile in
+// short slices, Booth digits on one bit not being supported by blst.
+static int caml_blst_p1s_mult_pippenger_slice(blst_p1 *ret,
+                                              const blst_p1_affine *points,
+                                              size_t npoints,
+                                              const byte *scalars,
+                                              size_t nbits, size_t bit0,
+                                              size_t bit1) {
+  size_t window = msm_window_size(npoints);
+  if (window < 3)
+    window = 3;
+  size_t width = bit1 - bit0;
+  size_t ntiles = (width + window - 1) / window;
+  blst_p1 tile;
+  // The top tile has one more bit to absorb the carry of the Booth encoding
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p1s_mult_pippenger_scratch_sizeof(0) << window);
+  if (scratch == NULL)
+    return (1);
+  memset(ret, 0, sizeof(blst_p1));
+  for (size_t i = ntiles; i-- > 0;) {
+    size_t lo = bit0 + i * width / ntiles;
+    size_t hi = bit0 + (i + 1) * width / ntiles;
+    blst_p1s_tile_pippenger_cont(&tile, points, npoints, scalars, nbits,
+                                 scratch, lo, hi - lo + (hi == nbits));
+    for (size_t j = lo; j < hi; j++)
+      blst_p1_double(ret, ret);
+    blst_p1_add_or_double(ret, ret, &tile);
+  }
+  for (size_t j = 0; j < bit0; j++)
+    blst_p1_double(ret, ret);
+  free(scratch);
+  return (0);
+}
+
+// Hypothesis: start + len is at most the number of points of affine_list and
+// of scalars, and 0 <= bit0 < bit1 <= 255
+CAMLprim value caml_blst_g1_pippenger_slice_stubs(value buffer,
+                                                  value affine_list,
+                                                  value scalars, value start,
+                                                  value len, value bit0,
+                                                  value bit1) {
+  CAMLparam5(buffer, affine_list, scalars, start, len);
+  CAMLxparam2(bit0, bit1);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  int ret = 1;
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  if (scalars_bs == NULL)
+    CAMLreturn(Val_int(ret));
+  for (size_t i = 0; i < len_c; i++)
+    blst_lendian_from_fr(scalars_bs + i * 32,
+                         Blst_fr_val(Field(scalars, start_c + i)));
+  ret = caml_blst_p1s_mult_pippenger_slice(
+      Blst_p1_val(buffer), Blst_p1_affine_val(affine_list) + start_c, len_c,
+      scalars_bs, CAML_BLS12_381_FR_NBITS, Int_val(bit0), Int_val(bit1));
+  free(scalars_bs);
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_blst_g1_pippenger_slice_stubs_bytecode(value *argv,
+                                                           int argn) {
+  return caml_blst_g1_pippenger_slice_stubs(argv[0], argv[1], argv[2],
+                                            argv[3], argv[4], argv[5],
+                                            argv[6]);
+}
+
+// Same than caml_blst_p1s_mult_pippenger_slice
+static int caml_blst_p2s_mult_pippenger_slice(blst_p2 *ret,
+                                              const blst_p2_affine *points,
+                                              size_t npoints,
+                                              const byte *scalars,
+                                              size_t nbits, size_t bit0,
+                                              size_t bit1) {
+  size_t window = msm_window_size(npoints);
+  if (window < 3)
+    window = 3;
+  size_t width = bit1 - bit0;
+  size_t ntiles = (width + window - 1) / window;
+  blst_p2 tile;
+  // The top tile has one more bit to absorb the carry of the Booth encoding
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p2s_mult_pippenger_scratch_sizeof(0) << window);
+  if (scratch == NULL)
+    return (1);
+  memset(ret, 0, sizeof(blst_p2));
+  for (size_t i = ntiles; i-- > 0;) {
+    size_t lo = bit0 + i * width / ntiles;
+    size_t hi = bit0 + (i + 1) * width / ntiles;
+    blst_p2s_tile_pippenger_cont(&tile, points, npoints, scalars, nbits,
+                                 scratch, lo, hi - lo + (hi == nbits));
+    for (size_t j = lo; j < hi; j++)
+      blst_p2_double(ret, ret);
+    blst_p2_add_or_double(ret, ret, &tile);
+  }
+  for (size_t j = 0; j < bit0; j++)
+    blst_p2_double(ret, ret);
+  free(scratch);
+  return (0);
+}
+
+// Hypothesis: start + len is at most the number of points of affine_list and
+// of scalars, and 0 <= bit0 < bit1 <= 255
+CAMLprim value caml_blst_g2_pippenger_slice_stubs(value buffer,
+                                                  value affine_list,
+                                                  value scalars, value start,
+                                                  value len, value bit0,
+                                                  value bit1) {
+  CAMLparam5(buffer, affine_list, scalars, start, len);
+  CAMLxparam2(bit0, bit1);
+  size_t start_c = Int_val(start);
+  size_t len_c = Int_val(len);
+  int ret = 1;
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  if (scalars_bs == NULL)
+    CAMLreturn(Val_int(ret));
+  for (size_t i = 0; i < len_c; i++)
+    blst_lendian_from_fr(scalars_bs + i * 32,
+                         Blst_fr_val(Field(scalars, start_c + i)));
+  ret = caml_blst_p2s_mult_pippenger_slice(
+      Blst_p2_val(buffer), Blst_p2_affine_val(affine_list) + start_c, len_c,
+      scalars_bs, CAML_BLS12_381_FR_NBITS, Int_val(bit0), Int_val(bit1));
+  free(scalars_bs);
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_blst_g2_pippenger_slice_stubs_bytecode(value *argv,
+                                                           int argn) {
+  return caml_blst_g2_pippenger_slice_stubs(argv[0], argv[1], argv[2],
+                                            argv[3], argv[4], argv[5],
+                                            argv[6]);
+}
+
+// Fixed-base tables, see blst_p1_fixed_base_table. The batches of
+// multiplications are split in chunks of at least
+// CAML_BLS12_381_FIXED_BASE_MIN_CHUNK_SIZE scalars computed in parallel, and
+// the results are normalised to affine coordinates at the end with
+// caml_blst_p1s_to_affine, i.e. they are returned with Z = 1.
+#define CAML_BLS12_381_FIXED_BASE_MIN_CHUNK_SIZE 64
+
+typedef struct {
+  const void *table;
+  void *results;
+  const byte *scalars;
+  size_t window;
+  size_t n;
+  size_t chunk_size;
+} fixed_base_ctx;
+
+typedef struct {
+  size_t window;
+  blst_p1_affine table[];
+} blst_p1_fixed_base;
+
+#define Blst_p1_fixed_base_val(v) ((blst_p1_fixed_base *)Data_custom_val(v))
+
+static struct custom_operations blst_p1_fixed_base_ops = {
+    "blst_p1_fixed_base",       custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+// Hypothesis: 2 <= window <= 10
+CAMLprim value allocate_p1_fixed_base_stubs(value window) {
+  CAMLparam1(window);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  block = caml_alloc_custom(
+      &blst_p1_fixed_base_ops,
+      sizeof(blst_p1_fixed_base) +
+          blst_p1_fixed_base_table_sizeof(CAML_BLS12_381_FR_NBITS, window_c),
+      0, 1);
+  Blst_p1_fixed_base_val(block)->window = window_c;
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p1_fixed_base_precompute_stubs(value table,
+                                                        value point) {
+  CAMLparam2(table, point);
+  blst_p1_fixed_base *table_c = Blst_p1_fixed_base_val(table);
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p1_fixed_base_scratch_sizeof(table_c->window));
+  if (scratch == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_p1_fixed_base_table(table_c->table, Blst_p1_val(point),
+                           CAML_BLS12_381_FR_NBITS, table_c->window, scratch);
+  free(scratch);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_mult_fixed_base_stubs(value buffer, value table,
+                                                  value scalar) {
+  CAMLparam3(buffer, table, scalar);
+  blst_p1_fixed_base *table_c = Blst_p1_fixed_base_val(table);
+  byte bs[32];
+  blst_lendian_from_fr(bs, Blst_fr_val(scalar));
+  blst_p1_mult_fixed_base(Blst_p1_val(buffer), table_c->table, bs,
+                          CAML_BLS12_381_FR_NBITS, table_c->window);
+  CAMLreturn(Val_unit);
+}
+
+static void p1_mult_fixed_base_chunk(size_t k, void *arg) {
+  fixed_base_ctx *ctx = (fixed_base_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  for (size_t i = start; i < start + len; i++)
+    blst_p1_mult_fixed_base((blst_p1 *)ctx->results + i,
+                            (const blst_p1_affine *)ctx->table,
+                            ctx->scalars + i * 32, CAML_BLS12_381_FR_NBITS,
+                            ctx->window);
+}
+
+// Hypothesis: res and scalars have at least len elements
+CAMLprim value caml_blst_p1_mult_fixed_base_many_stubs(value res, value table,
+                                                       value scalars,
+                                                       value len) {
+  CAMLparam4(res, table, scalars, len);
+  size_t len_c = Int_val(len);
+  blst_p1_fixed_base *table_c = Blst_p1_fixed_base_val(table);
+  fixed_base_ctx ctx = {table_c->table, NULL, NULL, table_c->window, len_c,
+                        0};
+  int ret = 1;
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  blst_p1 *results = (blst_p1 *)malloc((len_c + 1) * sizeof(blst_p1));
+  blst_p1_affine *affines =
+      (blst_p1_affine *)malloc((len_c + 1) * sizeof(blst_p1_affine));
+  const blst_p1 **ptrs =
+      (const blst_p1 **)malloc((len_c + 1) * sizeof(blst_p1 *));
+  if (scalars_bs == NULL || results == NULL || affines == NULL || ptrs == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++)
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  ctx.scalars = scalars_bs;
+  ctx.results = results;
+  size_t nb_chunks = parallel_nb_chunks(
+      len_c, CAML_BLS12_381_FIXED_BASE_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p1_mult_fixed_base_chunk, &ctx);
+  for (size_t i = 0; i < len_c; i++)
+    ptrs[i] = results + i;
+  caml_blst_p1s_to_affine(affines, ptrs, len_c);
+  for (size_t i = 0; i < len_c; i++)
+    blst_p1_from_affine(Blst_p1_val(Field(res, i)), affines + i);
+  ret = 0;
+out:
+  free(scalars_bs);
+  free(results);
+  free(affines);
+  free(ptrs);
+  CAMLreturn(Val_int(ret));
+}
+
+typedef struct {
+  size_t window;
+  blst_p2_affine table[];
+} blst_p2_fixed_base;
+
+#define Blst_p2_fixed_base_val(v) ((blst_p2_fixed_base *)Data_custom_val(v))
+
+static struct custom_operations blst_p2_fixed_base_ops = {
+    "blst_p2_fixed_base",       custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+// Hypothesis: 2 <= window <= 10
+CAMLprim value allocate_p2_fixed_base_stubs(value window) {
+  CAMLparam1(window);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  block = caml_alloc_custom(
+      &blst_p2_fixed_base_ops,
+      sizeof(blst_p2_fixed_base) +
+          blst_p2_fixed_base_table_sizeof(CAML_BLS12_381_FR_NBITS, window_c),
+      0, 1);
+  Blst_p2_fixed_base_val(block)->window = window_c;
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p2_fixed_base_precompute_stubs(value table,
+                                                        value point) {
+  CAMLparam2(table, point);
+  blst_p2_fixed_base *table_c = Blst_p2_fixed_base_val(table);
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p2_fixed_base_scratch_sizeof(table_c->window));
+  if (scratch == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_p2_fixed_base_table(table_c->table, Blst_p2_val(point),
+                           CAML_BLS12_381_FR_NBITS, table_c->window, scratch);
+  free(scratch);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_mult_fixed_base_stubs(value buffer, value table,
+                                                  value scalar) {
+  CAMLparam3(buffer, table, scalar);
+  blst_p2_fixed_base *table_c = Blst_p2_fixed_base_val(table);
+  byte bs[32];
+  blst_lendian_from_fr(bs, Blst_fr_val(scalar));
+  blst_p2_mult_fixed_base(Blst_p2_val(buffer), table_c->table, bs,
+                          CAML_BLS12_381_FR_NBITS, table_c->window);
+  CAMLreturn(Val_unit);
+}
+
+static void p2_mult_fixed_base_chunk(size_t k, void *arg) {
+  fixed_base_ctx *ctx = (fixed_base_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  for (size_t i = start; i < start + len; i++)
+    blst_p2_mult_fixed_base((blst_p2 *)ctx->results + i,
+                            (const blst_p2_affine *)ctx->table,
+                            ctx->scalars + i * 32, CAML_BLS12_381_FR_NBITS,
+                            ctx->window);
+}
+
+// Hypothesis: res and scalars have at least len elements
+CAMLprim value caml_blst_p2_mult_fixed_base_many_stubs(value res, value table,
+                                                       value scalars,
+                                                       value len) {
+  CAMLparam4(res, table, scalars, len);
+  size_t len_c = Int_val(len);
+  blst_p2_fixed_base *table_c = Blst_p2_fixed_base_val(table);
+  fixed_base_ctx ctx = {table_c->table, NULL, NULL, table_c->window, len_c,
+                        0};
+  int ret = 1;
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  blst_p2 *results = (blst_p2 *)malloc((len_c + 1) * sizeof(blst_p2));
+  blst_p2_affine *affines =
+      (blst_p2_affine *)malloc((len_c + 1) * sizeof(blst_p2_affine));
+  const blst_p2 **ptrs =
+      (const blst_p2 **)malloc((len_c + 1) * sizeof(blst_p2 *));
+  if (scalars_bs == NULL || results == NULL || affines == NULL || ptrs == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++)
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  ctx.scalars = scalars_bs;
+  ctx.results = results;
+  size_t nb_chunks = parallel_nb_chunks(
+      len_c, CAML_BLS12_381_FIXED_BASE_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p2_mult_fixed_base_chunk, &ctx);
+  for (size_t i = 0; i < len_c; i++)
+    ptrs[i] = results + i;
+  caml_blst_p2s_to_affine(affines, ptrs, len_c);
+  for (size_t i = 0; i < len_c; i++)
+    blst_p2_from_affine(Blst_p2_val(Field(res, i)), affines + i);
+  ret = 0;
+out:
+  free(scalars_bs);
+  free(results);
+  free(affines);
+  free(ptrs);
+  CAMLreturn(Val_int(ret));
+}
+
+// Pointwise multiplications dst[i] = scalars[i] points[i]. The points are
+// split in chunks of at least CAML_BLS12_381_MUL_MANY_MIN_CHUNK_SIZE points
+// computed in parallel, and the results are normalised to affine coordinates
+// with caml_blst_p1s_to_affine. For public inputs, the variable time mode
+// converts the points to affine coordinates and multiplies their GLV (resp.
+// GLS) images with Straus' algorithm, in batches of
+// CAML_BLS12_381_MUL_MANY_BATCH_SIZE points sharing the inversion of their
+// tables, see blst_p1s_mult_straus_groups. Otherwise, the constant time
+// blst_p1_mult is used.
+#define CAML_BLS12_381_MUL_MANY_MIN_CHUNK_SIZE 16
+#define CAML_BLS12_381_MUL_MANY_BATCH_SIZE 64
+
+typedef struct {
+  void *results;
+  // The points in jacobian coordinates, or in affine coordinates in the
+  // variable time mode
+  const void *points;
+  byte *scalars;
+  size_t n;
+  size_t chunk_size;
+  int vartime;
+  int ret;
+} mul_many_ctx;
+
+static void p1_mult_many_chunk(size_t k, void *arg) {
+  mul_many_ctx *ctx = (mul_many_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  size_t batch_size = CAML_BLS12_381_MUL_MANY_BATCH_SIZE;
+  blst_p1 *results = (blst_p1 *)ctx->results + start;
+  byte *scalars = ctx->scalars + start * 32;
+  if (!ctx->vartime) {
+    const blst_p1 **points = (const blst_p1 **)ctx->points + start;
+    for (size_t i = 0; i < len; i++)
+      blst_p1_mult(results + i, points[i], scalars + i * 32,
+                   CAML_BLS12_381_FR_NBITS);
+    return;
+  }
+  const blst_p1_affine *points = (const blst_p1_affine *)ctx->points + start;
+  blst_p1_affine *images =
+      (blst_p1_affine *)malloc(2 * batch_size * sizeof(blst_p1_affine));
+  limb_t *scratch = (limb_t *)malloc(
+      blst_p1s_mult_straus_scratch_sizeof(2 * batch_size, 128));
+  if (images == NULL || scratch == NULL) {
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    goto out;
+  }
+  for (size_t i = 0; i < len; i += batch_size) {
+    size_t n = len - i < batch_size ? len - i : batch_size;
+    for (size_t j = 0; j < n; j++) {
+      blst_p1_affine_glv_images(images + 2 * j, points + i + j);
+      blst_scalar_split_glv(scalars + (i + j) * 32, scalars + (i + j) * 32);
+    }
+    blst_p1s_mult_straus_groups(results + i, images, n, 2, scalars + i * 32,
+                                128, scratch);
+  }
+out:
+  free(images);
+  free(scratch);
+}
+
+// Returns 1 on memory allocation failure.
+// Hypothesis: points and scalars have at least n elements
+static int caml_blst_p1s_mult_many(blst_p1_affine *dst, value points,
+                                   value scalars, size_t n, int vartime) {
+  mul_many_ctx ctx = {NULL, NULL, NULL, n, 0, vartime, 1};
+  byte *scalars_bs = (byte *)malloc((n + 1) * 32);
+  blst_p1 *results = (blst_p1 *)malloc((n + 1) * sizeof(blst_p1));
+  blst_p1_affine *affines =
+      (blst_p1_affine *)malloc((n + 1) * sizeof(blst_p1_affine));
+  const blst_p1 **ptrs =
+      (const blst_p1 **)malloc((n + 1) * sizeof(blst_p1 *));
+  if (scalars_bs == NULL || results == NULL || affines == NULL || ptrs == NULL)
+    goto out;
+  for (size_t i = 0; i < n; i++) {
+    ptrs[i] = Blst_p1_val(Field(points, i));
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  }
+  if (vartime)
+    caml_blst_p1s_to_affine(affines, ptrs, n);
+  ctx.results = results;
+  ctx.points = vartime ? (const void *)affines : (const void *)ptrs;
+  ctx.scalars = scalars_bs;
+  ctx.ret = 0;
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_MUL_MANY_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p1_mult_many_chunk, &ctx);
+  if (ctx.ret == 0) {
+    for (size_t i = 0; i < n; i++)
+      ptrs[i] = results + i;
+    caml_blst_p1s_to_affine(dst, ptrs, n);
+  }
+out:
+  free(scalars_bs);
+  free(results);
+  free(affines);
+  free(ptrs);
+  return (ctx.ret);
+}
+
+// Hypothesis: res, points and scalars have at least len elements
+CAMLprim value caml_blst_p1_mult_many_stubs(value res, value points,
+                                            value scalars, value len,
+                                            value vartime) {
+  CAMLparam5(res, points, scalars, len, vartime);
+  size_t len_c = Int_val(len);
+  blst_p1_affine *affines =
+      (blst_p1_affine *)malloc((len_c + 1) * sizeof(blst_p1_affine));
+  if (affines == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  int ret = caml_blst_p1s_mult_many(affines, points, scalars, len_c,
+                                    Bool_val(vartime));
+  if (ret == 0) {
+    for (size_t i = 0; i < len_c; i++)
+      blst_p1_from_affine(Blst_p1_val(Field(res, i)), affines + i);
+  }
+  free(affines);
+  CAMLreturn(Val_int(ret));
+}
+
+// Hypothesis: res is an affine array, points and scalars have at least len
+// elements
+CAMLprim value caml_blst_p1_mult_many_affine_array_stubs(value res,
+                                                         value points,
+                                                         value scalars,
+                                                         value len,
+                                                         value vartime) {
+  CAMLparam5(res, points, scalars, len, vartime);
+  int ret = caml_blst_p1s_mult_many(Blst_p1_affine_val(res), points, scalars,
+                                    Int_val(len), Bool_val(vartime));
+  CAMLreturn(Val_int(ret));
+}
+
+static void p2_mult_many_chunk(size_t k, void *arg) {
+  mul_many_ctx *ctx = (mul_many_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  size_t batch_size = CAML_BLS12_381_MUL_MANY_BATCH_SIZE;
+  blst_p2 *results = (blst_p2 *)ctx->results + start;
+  byte *scalars = ctx->scalars + start * 32;
+  if (!ctx->vartime) {
+    const blst_p2 **points = (const blst_p2 **)ctx->points + start;
+    for (size_t i = 0; i < len; i++)
+      blst_p2_mult(results + i, points[i], scalars + i * 32,
+                   CAML_BLS12_381_FR_NBITS);
+    return;
+  }
+  const blst_p2_affine *points = (const blst_p2_affine *)ctx->points + start;
+  blst_p2_affine *images =
+      (blst_p2_affine *)malloc(4 * batch_size * sizeof(blst_p2_affine));
+  limb_t *scratch = (limb_t *)malloc(
+      blst_p2s_mult_straus_scratch_sizeof(4 * batch_size, 64));
+  if (images == NULL || scratch == NULL) {
+    __atomic_store_n(&ctx->ret, 1, __ATOMIC_RELAXED);
+    goto out;
+  }
+  for (size_t i = 0; i < len; i += batch_size) {
+    size_t n = len - i < batch_size ? len - i : batch_size;
+    for (size_t j = 0; j < n; j++) {
+      blst_p2_affine_gls_images(images + 4 * j, points + i + j);
+      blst_scalar_split_gls(scalars + (i + j) * 32, scalars + (i + j) * 32);
+    }
+    blst_p2s_mult_straus_groups(results + i, images, n, 4, scalars + i * 32,
+                                64, scratch);
+  }
+out:
+  free(images);
+  free(scratch);
+}
+
+// Returns 1 on memory allocation failure.
+// Hypothesis: points and scalars have at least n elements
+static int caml_blst_p2s_mult_many(blst_p2_affine *dst, value points,
+                                   value scalars, size_t n, int vartime) {
+  mul_many_ctx ctx = {NULL, NULL, NULL, n, 0, vartime, 1};
+  byte *scalars_bs = (byte *)malloc((n + 1) * 32);
+  blst_p2 *results = (blst_p2 *)malloc((n + 1) * sizeof(blst_p2));
+  blst_p2_affine *affines =
+      (blst_p2_affine *)malloc((n + 1) * sizeof(blst_p2_affine));
+  const blst_p2 **ptrs =
+      (const blst_p2 **)malloc((n + 1) * sizeof(blst_p2 *));
+  if (scalars_bs == NULL || results == NULL || affines == NULL || ptrs == NULL)
+    goto out;
+  for (size_t i = 0; i < n; i++) {
+    ptrs[i] = Blst_p2_val(Field(points, i));
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  }
+  if (vartime)
+    caml_blst_p2s_to_affine(affines, ptrs, n);
+  ctx.results = results;
+  ctx.points = vartime ? (const void *)affines : (const void *)ptrs;
+  ctx.scalars = scalars_bs;
+  ctx.ret = 0;
+  size_t nb_chunks = parallel_nb_chunks(
+      n, CAML_BLS12_381_MUL_MANY_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p2_mult_many_chunk, &ctx);
+  if (ctx.ret == 0) {
+    for (size_t i = 0; i < n; i++)
+      ptrs[i] = results + i;
+    caml_blst_p2s_to_affine(dst, ptrs, n);
+  }
+out:
+  free(scalars_bs);
+  free(results);
+  free(affines);
+  free(ptrs);
+  return (ctx.ret);
+}
+
+// Hypothesis: res, points and scalars have at least len elements
+CAMLprim value caml_blst_p2_mult_many_stubs(value res, value points,
+                                            value scalars, value len,
+                                            value vartime) {
+  CAMLparam5(res, points, scalars, len, vartime);
+  size_t len_c = Int_val(len);
+  blst_p2_affine *affines =
+      (blst_p2_affine *)malloc((len_c + 1) * sizeof(blst_p2_affine));
+  if (affines == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  int ret = caml_blst_p2s_mult_many(affines, points, scalars, len_c,
+                                    Bool_val(vartime));
+  if (ret == 0) {
+    for (size_t i = 0; i < len_c; i++)
+      blst_p2_from_affine(Blst_p2_val(Field(res, i)), affines + i);
+  }
+  free(affines);
+  CAMLreturn(Val_int(ret));
+}
+
+// Hypothesis: res is an affine array, points and scalars have at least len
+// elements
+CAMLprim value caml_blst_p2_mult_many_affine_array_stubs(value res,
+                                                         value points,
+                                                         value scalars,
+                                                         value len,
+                                                         value vartime) {
+  CAMLparam5(res, points, scalars, len, vartime);
+  int ret = caml_blst_p2s_mult_many(Blst_p2_affine_val(res), points, scalars,
+                                    Int_val(len), Bool_val(vartime));
+  CAMLreturn(Val_int(ret));
+}
+
+// Variable time multiplication for public scalars, see blst_p1s_mult_vartime
+CAMLprim value caml_blst_p1_mult_vartime_stubs(value buffer, value p,
+                                               value scalar) {
+  CAMLparam3(buffer, p, scalar);
+  byte bs[32];
+  limb_t *scratch = (limb_t *)malloc(blst_p1s_mult_vartime_scratch_sizeof(1));
+  if (scratch == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_lendian_from_fr(bs, Blst_fr_val(scalar));
+  blst_p1s_mult_vartime(Blst_p1_val(buffer), Blst_p1_val(p), 1, bs, scratch);
+  free(scratch);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+// Variable time multiplication for public scalars, see blst_p2s_mult_vartime
+CAMLprim value caml_blst_p2_mult_vartime_stubs(value buffer, value p,
+                                               value scalar) {
+  CAMLparam3(buffer, p, scalar);
+  byte bs[32];
+  limb_t *scratch = (limb_t *)malloc(blst_p2s_mult_vartime_scratch_sizeof(1));
+  if (scratch == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_lendian_from_fr(bs, Blst_fr_val(scalar));
+  blst_p2s_mult_vartime(Blst_p2_val(buffer), Blst_p2_val(p), 1, bs, scratch);
+  free(scratch);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+// Variable time linear combination for public scalars, see
+// blst_p1s_mult_vartime
+// Hypothesis: points and scalars have at least len elements
+CAMLprim value caml_blst_p1_linear_combination_stubs(value buffer,
+                                                     value points,
+                                                     value scalars,
+                                                     value len) {
+  CAMLparam4(buffer, points, scalars, len);
+  size_t len_c = Int_val(len);
+  int ret = 1;
+  blst_p1 *points_c = (blst_p1 *)malloc((len_c + 1) * sizeof(blst_p1));
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p1s_mult_vartime_scratch_sizeof(len_c));
+  if (points_c == NULL || scalars_bs == NULL || scratch == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++) {
+    memcpy(points_c + i, Blst_p1_val(Field(points, i)), sizeof(blst_p1));
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  }
+  blst_p1s_mult_vartime(Blst_p1_val(buffer), points_c, len_c, scalars_bs,
+                        scratch);
+  ret = 0;
+out:
+  free(points_c);
+  free(scalars_bs);
+  free(scratch);
+  CAMLreturn(Val_int(ret));
+}
+
+// Variable time linear combination for public scalars, see
+// blst_p2s_mult_vartime
+// Hypothesis: points and scalars have at least len elements
+CAMLprim value caml_blst_p2_linear_combination_stubs(value buffer,
+                                                     value points,
+                                                     value scalars,
+                                                     value len) {
+  CAMLparam4(buffer, points, scalars, len);
+  size_t len_c = Int_val(len);
+  int ret = 1;
+  blst_p2 *points_c = (blst_p2 *)malloc((len_c + 1) * sizeof(blst_p2));
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p2s_mult_vartime_scratch_sizeof(len_c));
+  if (points_c == NULL || scalars_bs == NULL || scratch == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++) {
+    memcpy(points_c + i, Blst_p2_val(Field(points, i)), sizeof(blst_p2));
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  }
+  blst_p2s_mult_vartime(Blst_p2_val(buffer), points_c, len_c, scalars_bs,
+                        scratch);
+  ret = 0;
+out:
+  free(points_c);
+  free(scalars_bs);
+  free(scratch);
+  CAMLreturn(Val_int(ret));
+}
+
+// Prepared points, see blst_p1_prepare. The batches of multiplications are
+// computed as the ones of the fixed-base tables, with the same context.
+
+typedef struct {
+  size_t window;
+  blst_p1_affine table[];
+} blst_p1_prepared;
+
+#define Blst_p1_prepared_val(v) ((blst_p1_prepared *)Data_custom_val(v))
+
+static struct custom_operations blst_p1_prepared_ops = {
+    "blst_p1_prepared",         custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+// Hypothesis: 2 <= window <= 8
+CAMLprim value allocate_p1_prepared_stubs(value window) {
+  CAMLparam1(window);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  block = caml_alloc_custom(&blst_p1_prepared_ops,
+                            sizeof(blst_p1_prepared) +
+                                blst_p1_prepared_sizeof(window_c),
+                            0, 1);
+  Blst_p1_prepared_val(block)->window = window_c;
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p1_prepare_stubs(value prepared, value point) {
+  CAMLparam2(prepared, point);
+  blst_p1_prepared *prepared_c = Blst_p1_prepared_val(prepared);
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p1_prepared_scratch_sizeof(prepared_c->window));
+  if (scratch == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_p1_prepare(prepared_c->table, Blst_p1_val(point), prepared_c->window,
+                  scratch);
+  free(scratch);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p1_mult_prepared_stubs(value buffer, value prepared,
+                                                value scalar) {
+  CAMLparam3(buffer, prepared, scalar);
+  blst_p1_prepared *prepared_c = Blst_p1_prepared_val(prepared);
+  byte bs[32];
+  blst_lendian_from_fr(bs, Blst_fr_val(scalar));
+  blst_p1_mult_prepared(Blst_p1_val(buffer), prepared_c->table, bs,
+                        prepared_c->window);
+  CAMLreturn(Val_unit);
+}
+
+static void p1_mult_prepared_chunk(size_t k, void *arg) {
+  fixed_base_ctx *ctx = (fixed_base_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  for (size_t i = start; i < start + len; i++)
+    blst_p1_mult_prepared((blst_p1 *)ctx->results + i,
+                          (const blst_p1_affine *)ctx->table,
+                          ctx->scalars + i * 32, ctx->window);
+}
+
+// Hypothesis: res and scalars have at least len elements
+CAMLprim value caml_blst_p1_mult_prepared_many_stubs(value res,
+                                                     value prepared,
+                                                     value scalars,
+                                                     value len) {
+  CAMLparam4(res, prepared, scalars, len);
+  size_t len_c = Int_val(len);
+  blst_p1_prepared *prepared_c = Blst_p1_prepared_val(prepared);
+  fixed_base_ctx ctx = {prepared_c->table, NULL, NULL, prepared_c->window,
+                        len_c, 0};
+  int ret = 1;
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  blst_p1 *results = (blst_p1 *)malloc((len_c + 1) * sizeof(blst_p1));
+  blst_p1_affine *affines =
+      (blst_p1_affine *)malloc((len_c + 1) * sizeof(blst_p1_affine));
+  const blst_p1 **ptrs =
+      (const blst_p1 **)malloc((len_c + 1) * sizeof(blst_p1 *));
+  if (scalars_bs == NULL || results == NULL || affines == NULL || ptrs == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++)
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  ctx.scalars = scalars_bs;
+  ctx.results = results;
+  size_t nb_chunks = parallel_nb_chunks(
+      len_c, CAML_BLS12_381_FIXED_BASE_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p1_mult_prepared_chunk, &ctx);
+  for (size_t i = 0; i < len_c; i++)
+    ptrs[i] = results + i;
+  caml_blst_p1s_to_affine(affines, ptrs, len_c);
+  for (size_t i = 0; i < len_c; i++)
+    blst_p1_from_affine(Blst_p1_val(Field(res, i)), affines + i);
+  ret = 0;
+out:
+  free(scalars_bs);
+  free(results);
+  free(affines);
+  free(ptrs);
+  CAMLreturn(Val_int(ret));
+}
+
+typedef struct {
+  size_t window;
+  blst_p2_affine table[];
+} blst_p2_prepared;
+
+#define Blst_p2_prepared_val(v) ((blst_p2_prepared *)Data_custom_val(v))
+
+static struct custom_operations blst_p2_prepared_ops = {
+    "blst_p2_prepared",         custom_finalize_default,
+    custom_compare_default,     custom_hash_default,
+    custom_serialize_default,   custom_deserialize_default,
+    custom_compare_ext_default, custom_fixed_length_default};
+
+// Hypothesis: 2 <= window <= 8
+CAMLprim value allocate_p2_prepared_stubs(value window) {
+  CAMLparam1(window);
+  CAMLlocal1(block);
+  size_t window_c = Int_val(window);
+  block = caml_alloc_custom(&blst_p2_prepared_ops,
+                            sizeof(blst_p2_prepared) +
+                                blst_p2_prepared_sizeof(window_c),
+                            0, 1);
+  Blst_p2_prepared_val(block)->window = window_c;
+  CAMLreturn(block);
+}
+
+CAMLprim value caml_blst_p2_prepare_stubs(value prepared, value point) {
+  CAMLparam2(prepared, point);
+  blst_p2_prepared *prepared_c = Blst_p2_prepared_val(prepared);
+  limb_t *scratch =
+      (limb_t *)malloc(blst_p2_prepared_scratch_sizeof(prepared_c->window));
+  if (scratch == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  blst_p2_prepare(prepared_c->table, Blst_p2_val(point), prepared_c->window,
+                  scratch);
+  free(scratch);
+  CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
+}
+
+CAMLprim value caml_blst_p2_mult_prepared_stubs(value buffer, value prepared,
+                                                value scalar) {
+  CAMLparam3(buffer, prepared, scalar);
+  blst_p2_prepared *prepared_c = Blst_p2_prepared_val(prepared);
+  byte bs[32];
+  blst_lendian_from_fr(bs, Blst_fr_val(scalar));
+  blst_p2_mult_prepared(Blst_p2_val(buffer), prepared_c->table, bs,
+                        prepared_c->window);
+  CAMLreturn(Val_unit);
+}
+
+static void p2_mult_prepared_chunk(size_t k, void *arg) {
+  fixed_base_ctx *ctx = (fixed_base_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  for (size_t i = start; i < start + len; i++)
+    blst_p2_mult_prepared((blst_p2 *)ctx->results + i,
+                          (const blst_p2_affine *)ctx->table,
+                          ctx->scalars + i * 32, ctx->window);
+}
+
+// Hypothesis: res and scalars have at least len elements
+CAMLprim value caml_blst_p2_mult_prepared_many_stubs(value res,
+                                                     value prepared,
+                                                     value scalars,
+                                                     value len) {
+  CAMLparam4(res, prepared, scalars, len);
+  size_t len_c = Int_val(len);
+  blst_p2_prepared *prepared_c = Blst_p2_prepared_val(prepared);
+  fixed_base_ctx ctx = {prepared_c->table, NULL, NULL, prepared_c->window,
+                        len_c, 0};
+  int ret = 1;
+  byte *scalars_bs = (byte *)malloc((len_c + 1) * 32);
+  blst_p2 *results = (blst_p2 *)malloc((len_c + 1) * sizeof(blst_p2));
+  blst_p2_affine *affines =
+      (blst_p2_affine *)malloc((len_c + 1) * sizeof(blst_p2_affine));
+  const blst_p2 **ptrs =
+      (const blst_p2 **)malloc((len_c + 1) * sizeof(blst_p2 *));
+  if (scalars_bs == NULL || results == NULL || affines == NULL || ptrs == NULL)
+    goto out;
+  for (size_t i = 0; i < len_c; i++)
+    blst_lendian_from_fr(scalars_bs + i * 32, Blst_fr_val(Field(scalars, i)));
+  ctx.scalars = scalars_bs;
+  ctx.results = results;
+  size_t nb_chunks = parallel_nb_chunks(
+      len_c, CAML_BLS12_381_FIXED_BASE_MIN_CHUNK_SIZE, &ctx.chunk_size);
+  caml_bls12_381_parallel_for(nb_chunks, p2_mult_prepared_chunk, &ctx);
+  for (size_t i = 0; i < len_c; i++)
+    ptrs[i] = results + i;
+  caml_blst_p2s_to_affine(affines, ptrs, len_c);
+  for (size_t i = 0; i < len_c; i++)
+    blst_p2_from_affine(Blst_p2_val(Field(res, i)), affines + i);
+  ret = 0;
+out:
+  free(scalars_bs);
+  free(results);
+  free(affines);
+  free(ptrs);
+  CAMLreturn(Val_int(ret));
+}
+
+// Must be called before unmarshalling any value, see bls12_381.ml
+CAMLprim value caml_bls12_381_register_custom_operations_stubs(value unit) {
+  CAMLparam1(unit);
+  caml_register_custom_operations(&blst_fr_ops);
+  caml_register_custom_operations(&blst_fp12_ops);
+  caml_register_custom_operations(&blst_p1_ops);
+  caml_register_custom_operations(&blst_p1_affine_ops);
+  caml_register_custom_operations(&blst_p1_affine_array_ops);
+  caml_register_custom_operations(&blst_p2_ops);
+  caml_register_custom_operations(&blst_p2_affine_ops);
+  caml_register_custom_operations(&blst_p2_affine_array_ops);
   CAMLreturn(CAML_BLS12_381_OUTPUT_SUCCESS);
 }
 
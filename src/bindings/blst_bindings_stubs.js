@@ -550,9 +550,21 @@ function blst_p1_sizeof() {
 
 //Provides: Blst_p1
 //Requires: blst_p1_sizeof
+//Requires: wasm_call
 function Blst_p1() {
   this.v = new globalThis.Uint8Array(blst_p1_sizeof());
 }
+Blst_p1.prototype.compare = function(t) {
+  if (wasm_call('_blst_p1_is_equal', this.v, t.v)) return 0;
+  var x = new globalThis.Uint8Array(48);
+  var y = new globalThis.Uint8Array(48);
+  wasm_call('_blst_p1_compress', x, this.v);
+  wasm_call('_blst_p1_compress', y, t.v);
+  for (var i = 0; i < 48; i++) {
+    if (x[i] != y[i]) return x[i] < y[i] ? -1 : 1;
+  }
+  return 0;
+};
 
 //Provides: allocate_p1_stubs
 //Requires: Blst_p1
@@ -594,6 +606,16 @@ function caml_blst_p1_from_affine_stubs(buffer, p) {
   return 0;
 }
 
+//Provides: caml_blst_p1_normalize_stubs
+//Requires: wasm_call
+//Requires: Blst_p1_val, Blst_p1_affine
+function caml_blst_p1_normalize_stubs(p) {
+  var p_affine = new Blst_p1_affine();
+  wasm_call('_blst_p1_to_affine', p_affine.v, Blst_p1_val(p));
+  wasm_call('_blst_p1_from_affine', Blst_p1_val(p), p_affine.v);
+  return 0;
+}
+
 //Provides: caml_blst_p1_double_stubs
 //Requires: wasm_call
 //Requires: Blst_p1_val
@@ -789,9 +811,21 @@ function blst_p2_sizeof() {
 
 //Provides: Blst_p2
 //Requires: blst_p2_sizeof
+//Requires: wasm_call
 function Blst_p2() {
   this.v = new globalThis.Uint8Array(blst_p2_sizeof());
 }
+Blst_p2.prototype.compare = function(t) {
+  if (wasm_call('_blst_p2_is_equal', this.v, t.v)) return 0;
+  var x = new globalThis.Uint8Array(96);
+  var y = new globalThis.Uint8Array(96);
+  wasm_call('_blst_p2_compress', x, this.v);
+  wasm_call('_blst_p2_compress', y, t.v);
+  for (var i = 0; i < 96; i++) {
+    if (x[i] != y[i]) return x[i] < y[i] ? -1 : 1;
+  }
+  return 0;
+};
 
 //Provides: blst_p2_affine_sizeof
 //Requires: wasm_call
@@ -833,6 +867,16 @@ function caml_blst_p2_from_affine_stubs(buffer, p) {
   return 0;
 }
 
+//Provides: caml_blst_p2_normalize_stubs
+//Requires: wasm_call
+//Requires: Blst_p2_val, Blst_p2_affine
+function caml_blst_p2_normalize_stubs(p) {
+  var p_affine = new Blst_p2_affine();
+  wasm_call('_blst_p2_to_affine', p_affine.v, Blst_p2_val(p));
+  wasm_call('_blst_p2_from_affine', Blst_p2_val(p), p_affine.v);
+  return 0;
+}
+
 //Provides: caml_blst_p2_double_stubs
 //Requires: wasm_call
 //Requires: Blst_p2_val
@@ -1224,6 +1268,42 @@ function caml_blst_p1_affine_array_set_p1_points_stubs(buffer, l, n) {
   return 0;
 }
 
+//Provides: caml_blst_p1_add_bulk_stubs
+//Requires: Blst_p1_val
+//Requires: wasm_call
+function caml_blst_p1_add_bulk_stubs(buffer, l, n) {
+  var buffer_c = Blst_p1_val(buffer);
+  buffer_c.fill(0);
+  for (var i = 0; i < n; i++) {
+    wasm_call(
+        '_blst_p1_add_or_double',
+        buffer_c,
+        buffer_c,
+        Blst_p1_val(l[i + 1])
+    );
+  }
+  return 0;
+}
+
+//Provides: caml_blst_p1_affine_array_add_bulk_stubs
+//Requires: Blst_p1, Blst_p1_val
+//Requires: wasm_call
+function caml_blst_p1_affine_array_add_bulk_stubs(
+    buffer,
+    affine_list,
+    start,
+    len
+) {
+  var buffer_c = Blst_p1_val(buffer);
+  var tmp = Blst_p1_val(new Blst_p1());
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_p1_from_affine', tmp, affine_list.nth(start + i));
+    wasm_call('_blst_p1_add_or_double', buffer_c, buffer_c, tmp);
+  }
+  return 0;
+}
+
 //Provides: caml_blst_p1_affine_array_get_stubs
 //Requires: wasm_call
 //Requires: Blst_p1_val
@@ -1312,6 +1392,42 @@ function caml_blst_p2_affine_array_set_p2_points_stubs(buffer, l, n) {
   return 0;
 }
 
+//Provides: caml_blst_p2_add_bulk_stubs
+//Requires: Blst_p2_val
+//Requires: wasm_call
+function caml_blst_p2_add_bulk_stubs(buffer, l, n) {
+  var buffer_c = Blst_p2_val(buffer);
+  buffer_c.fill(0);
+  for (var i = 0; i < n; i++) {
+    wasm_call(
+        '_blst_p2_add_or_double',
+        buffer_c,
+        buffer_c,
+        Blst_p2_val(l[i + 1])
+    );
+  }
+  return 0;
+}
+
+//Provides: caml_blst_p2_affine_array_add_bulk_stubs
+//Requires: Blst_p2, Blst_p2_val
+//Requires: wasm_call
+function caml_blst_p2_affine_array_add_bulk_stubs(
+    buffer,
+    affine_list,
+    start,
+    len
+) {
+  var buffer_c = Blst_p2_val(buffer);
+  var tmp = Blst_p2_val(new Blst_p2());
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_p2_from_affine', tmp, affine_list.nth(start + i));
+    wasm_call('_blst_p2_add_or_double', buffer_c, buffer_c, tmp);
+  }
+  return 0;
+}
+
 //Provides: caml_blst_p2_affine_array_get_stubs
 //Requires: wasm_call
 //Requires: Blst_p2_val
@@ -1368,8 +1484,1515 @@ function caml_blst_g2_pippenger_contiguous_affine_array_stubs(
   return 0;
 }
 
-//Provides: caml_built_with_blst_portable_stubs
-function caml_built_with_blst_portable_stubs(unit) {
+// Arenas. The slots are views on a single buffer. The views are created once
+// to let wasm_call detect the same slot is given for several arguments.
+
+//Provides: Blst_arena
+function Blst_arena(n, size) {
+  this.v = new globalThis.Uint8Array(n * size);
+  this.slots = new Array(n);
+  for (var i = 0; i < n; i++) {
+    this.slots[i] = this.v.subarray(i * size, (i + 1) * size);
+  }
+}
+
+//Provides: allocate_fr_arena_stubs
+//Requires: Blst_arena, blst_fr_sizeof
+function allocate_fr_arena_stubs(n) {
+  return new Blst_arena(n, blst_fr_sizeof());
+}
+
+//Provides: caml_blst_fr_arena_set_stubs
+//Requires: Blst_fr_val
+function caml_blst_fr_arena_set_stubs(arena, i, x) {
+  arena.slots[i].set(Blst_fr_val(x));
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_get_stubs
+//Requires: Blst_fr_val
+function caml_blst_fr_arena_get_stubs(x, arena, i) {
+  Blst_fr_val(x).set(arena.slots[i]);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_copy_stubs
+function caml_blst_fr_arena_copy_stubs(arena, r, a) {
+  arena.slots[r].set(arena.slots[a]);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_add_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_add_stubs(arena, r, a, b) {
+  var s = arena.slots;
+  wasm_call('_blst_fr_add', s[r], s[a], s[b]);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_sub_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_sub_stubs(arena, r, a, b) {
+  var s = arena.slots;
+  wasm_call('_blst_fr_sub', s[r], s[a], s[b]);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_mul_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_mul_stubs(arena, r, a, b) {
+  var s = arena.slots;
+  wasm_call('_blst_fr_mul', s[r], s[a], s[b]);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_sqr_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_sqr_stubs(arena, r, a) {
+  wasm_call('_blst_fr_sqr', arena.slots[r], arena.slots[a]);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_cneg_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_cneg_stubs(arena, r, a) {
+  wasm_call('_blst_fr_cneg', arena.slots[r], arena.slots[a], 1);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_eucl_inverse_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_eucl_inverse_stubs(arena, r, a) {
+  if (wasm_call('_blst_fr_is_zero', arena.slots[a])) return 2;
+  wasm_call('_blst_fr_eucl_inverse', arena.slots[r], arena.slots[a]);
+  return 0;
+}
+
+//Provides: caml_blst_fr_arena_is_zero_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_is_zero_stubs(arena, a) {
+  return wasm_call('_blst_fr_is_zero', arena.slots[a]) ? 1 : 0;
+}
+
+//Provides: caml_blst_fr_arena_eq_stubs
+//Requires: wasm_call
+function caml_blst_fr_arena_eq_stubs(arena, a, b) {
+  return wasm_call('_blst_fr_is_equal', arena.slots[a], arena.slots[b]) ? 1 : 0;
+}
+
+//Provides: allocate_p1_arena_stubs
+//Requires: Blst_arena, blst_p1_sizeof
+function allocate_p1_arena_stubs(n) {
+  return new Blst_arena(n, blst_p1_sizeof());
+}
+
+//Provides: caml_blst_p1_arena_set_stubs
+//Requires: Blst_p1_val
+function caml_blst_p1_arena_set_stubs(arena, i, x) {
+  arena.slots[i].set(Blst_p1_val(x));
+  return 0;
+}
+
+//Provides: caml_blst_p1_arena_get_stubs
+//Requires: Blst_p1_val
+function caml_blst_p1_arena_get_stubs(x, arena, i) {
+  Blst_p1_val(x).set(arena.slots[i]);
+  return 0;
+}
+
+//Provides: caml_blst_p1_arena_copy_stubs
+function caml_blst_p1_arena_copy_stubs(arena, r, a) {
+  arena.slots[r].set(arena.slots[a]);
+  return 0;
+}
+
+//Provides: caml_blst_p1_arena_add_or_double_stubs
+//Requires: wasm_call
+function caml_blst_p1_arena_add_or_double_stubs(arena, r, a, b) {
+  var s = arena.slots;
+  wasm_call('_blst_p1_add_or_double', s[r], s[a], s[b]);
+  return 0;
+}
+
+//Provides: caml_blst_p1_arena_double_stubs
+//Requires: wasm_call
+function caml_blst_p1_arena_double_stubs(arena, r, a) {
+  wasm_call('_blst_p1_double', arena.slots[r], arena.slots[a]);
+  return 0;
+}
+
+//Provides: caml_blst_p1_arena_negate_stubs
+//Requires: wasm_call
+function caml_blst_p1_arena_negate_stubs(arena, r, a) {
+  if (r != a) arena.slots[r].set(arena.slots[a]);
+  wasm_call('_blst_p1_cneg', arena.slots[r], 1);
+  return 0;
+}
+
+//Provides: caml_blst_p1_arena_mult_stubs
+//Requires: wasm_call
+//Requires: Blst_fr_val, Blst_scalar, Blst_p1
+function caml_blst_p1_arena_mult_stubs(arena, r, a, n) {
+  var scalar = new Blst_scalar();
+  var tmp = new Blst_p1();
+  wasm_call('_blst_scalar_from_fr', scalar.v, Blst_fr_val(n));
+  wasm_call('_blst_p1_mult', tmp.v, arena.slots[a], scalar.v, 256);
+  arena.slots[r].set(tmp.v);
+  return 0;
+}
+
+//Provides: caml_blst_p1_arena_is_inf_stubs
+//Requires: wasm_call
+function caml_blst_p1_arena_is_inf_stubs(arena, a) {
+  return wasm_call('_blst_p1_is_inf', arena.slots[a]) ? 1 : 0;
+}
+
+//Provides: caml_blst_p1_arena_equal_stubs
+//Requires: wasm_call
+function caml_blst_p1_arena_equal_stubs(arena, a, b) {
+  return wasm_call('_blst_p1_is_equal', arena.slots[a], arena.slots[b]) ?
+    1 :
+    0;
+}
+
+//Provides: allocate_p2_arena_stubs
+//Requires: Blst_arena, blst_p2_sizeof
+function allocate_p2_arena_stubs(n) {
+  return new Blst_arena(n, blst_p2_sizeof());
+}
+
+//Provides: caml_blst_p2_arena_set_stubs
+//Requires: Blst_p2_val
+function caml_blst_p2_arena_set_stubs(arena, i, x) {
+  arena.slots[i].set(Blst_p2_val(x));
+  return 0;
+}
+
+//Provides: caml_blst_p2_arena_get_stubs
+//Requires: Blst_p2_val
+function caml_blst_p2_arena_get_stubs(x, arena, i) {
+  Blst_p2_val(x).set(arena.slots[i]);
+  return 0;
+}
+
+//Provides: caml_blst_p2_arena_copy_stubs
+function caml_blst_p2_arena_copy_stubs(arena, r, a) {
+  arena.slots[r].set(arena.slots[a]);
+  return 0;
+}
+
+//Provides: caml_blst_p2_arena_add_or_double_stubs
+//Requires: wasm_call
+function caml_blst_p2_arena_add_or_double_stubs(arena, r, a, b) {
+  var s = arena.slots;
+  wasm_call('_blst_p2_add_or_double', s[r], s[a], s[b]);
+  return 0;
+}
+
+//Provides: caml_blst_p2_arena_double_stubs
+//Requires: wasm_call
+function caml_blst_p2_arena_double_stubs(arena, r, a) {
+  wasm_call('_blst_p2_double', arena.slots[r], arena.slots[a]);
+  return 0;
+}
+
+//Provides: caml_blst_p2_arena_negate_stubs
+//Requires: wasm_call
+function caml_blst_p2_arena_negate_stubs(arena, r, a) {
+  if (r != a) arena.slots[r].set(arena.slots[a]);
+  wasm_call('_blst_p2_cneg', arena.slots[r], 1);
+  return 0;
+}
+
+//Provides: caml_blst_p2_arena_mult_stubs
+//Requires: wasm_call
+//Requires: Blst_fr_val, Blst_scalar, Blst_p2
+function caml_blst_p2_arena_mult_stubs(arena, r, a, n) {
+  var scalar = new Blst_scalar();
+  var tmp = new Blst_p2();
+  wasm_call('_blst_scalar_from_fr', scalar.v, Blst_fr_val(n));
+  wasm_call('_blst_p2_mult', tmp.v, arena.slots[a], scalar.v, 256);
+  arena.slots[r].set(tmp.v);
+  return 0;
+}
+
+//Provides: caml_blst_p2_arena_is_inf_stubs
+//Requires: wasm_call
+function caml_blst_p2_arena_is_inf_stubs(arena, a) {
+  return wasm_call('_blst_p2_is_inf', arena.slots[a]) ? 1 : 0;
+}
+
+//Provides: caml_blst_p2_arena_equal_stubs
+//Requires: wasm_call
+function caml_blst_p2_arena_equal_stubs(arena, a, b) {
+  return wasm_call('_blst_p2_is_equal', arena.slots[a], arena.slots[b]) ?
+    1 :
+    0;
+}
+
+// Prepared bases. The JavaScript backend does not precompute the tables: the
+// bases are copied and the multiplications use Pippenger's algorithm.
+
+//Provides: allocate_p1_prepared_bases_stubs
+//Requires: Blst_p1_affine_array
+function allocate_p1_prepared_bases_stubs(window, npoints) {
+  return new Blst_p1_affine_array(npoints);
+}
+
+//Provides: caml_blst_p1_prepared_bases_precompute_stubs
+function caml_blst_p1_prepared_bases_precompute_stubs(bases, points) {
+  bases.v.set(points.v.subarray(0, bases.v.length));
+  return 0;
+}
+
+//Provides: caml_blst_p1_prepared_bases_mult_stubs
+//Requires: Blst_fr_val, Blst_p1_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p1_prepared_bases_mult_stubs(
+    buffer,
+    bases,
+    scalars,
+    start,
+    len
+) {
+  var addr_ps = new Array(len);
+  var addr_scalars_bs = new Array(len);
+  var scalar = Blst_scalar_val(new Blst_scalar());
+
+  for (var i = 0; i < len; i++) {
+    var bs = Blst_scalar_val(new Blst_scalar());
+    wasm_call(
+        '_blst_scalar_from_fr',
+        scalar,
+        Blst_fr_val(scalars[start + i + 1])
+    );
+    wasm_call('_blst_lendian_from_scalar', bs, scalar);
+    addr_scalars_bs[i] = bs;
+    addr_ps[i] = bases.nth(start + i);
+  }
+
+  if (len == 1) {
+    wasm_call('_blst_p1_from_affine', Blst_p1_val(buffer), addr_ps[0]);
+    wasm_call(
+        '_blst_p1_mult',
+        Blst_p1_val(buffer),
+        Blst_p1_val(buffer),
+        addr_scalars_bs[0],
+        256
+    );
+    return 0;
+  }
+
+  var scratch_size = wasm_call('_blst_p1s_mult_pippenger_scratch_sizeof', len);
+  var scratch = new globalThis.Uint8Array(scratch_size);
+
+  wasm_call(
+      '_blst_p1s_mult_pippenger',
+      Blst_p1_val(buffer),
+      addr_ps,
+      len,
+      addr_scalars_bs,
+      256,
+      scratch
+  );
+
+  return 0;
+}
+
+//Provides: allocate_p2_prepared_bases_stubs
+//Requires: Blst_p2_affine_array
+function allocate_p2_prepared_bases_stubs(window, npoints) {
+  return new Blst_p2_affine_array(npoints);
+}
+
+//Provides: caml_blst_p2_prepared_bases_precompute_stubs
+function caml_blst_p2_prepared_bases_precompute_stubs(bases, points) {
+  bases.v.set(points.v.subarray(0, bases.v.length));
+  return 0;
+}
+
+//Provides: caml_blst_p2_prepared_bases_mult_stubs
+//Requires: Blst_fr_val, Blst_p2_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p2_prepared_bases_mult_stubs(
+    buffer,
+    bases,
+    scalars,
+    start,
+    len
+) {
+  var addr_ps = new Array(len);
+  var addr_scalars_bs = new Array(len);
+  var scalar = Blst_scalar_val(new Blst_scalar());
+
+  for (var i = 0; i < len; i++) {
+    var bs = Blst_scalar_val(new Blst_scalar());
+    wasm_call(
+        '_blst_scalar_from_fr',
+        scalar,
+        Blst_fr_val(scalars[start + i + 1])
+    );
+    wasm_call('_blst_lendian_from_scalar', bs, scalar);
+    addr_scalars_bs[i] = bs;
+    addr_ps[i] = bases.nth(start + i);
+  }
+
+  if (len == 1) {
+    wasm_call('_blst_p2_from_affine', Blst_p2_val(buffer), addr_ps[0]);
+    wasm_call(
+        '_blst_p2_mult',
+        Blst_p2_val(buffer),
+        Blst_p2_val(buffer),
+        addr_scalars_bs[0],
+        256
+    );
+    return 0;
+  }
+
+  var scratch_size = wasm_call('_blst_p2s_mult_pippenger_scratch_sizeof', len);
+  var scratch = new globalThis.Uint8Array(scratch_size);
+
+  wasm_call(
+      '_blst_p2s_mult_pippenger',
+      Blst_p2_val(buffer),
+      addr_ps,
+      len,
+      addr_scalars_bs,
+      256,
+      scratch
+  );
+
+  return 0;
+}
+
+// Scalar batches. The JavaScript backend only converts the scalars to bytes
+// once, the multiplications use Pippenger's algorithm of blst.
+
+//Provides: allocate_scalar_batch_stubs
+//Requires: Blst_scalar_val, Blst_scalar
+function allocate_scalar_batch_stubs(n) {
+  var scalars = new Array(n);
+  for (var i = 0; i < n; i++) scalars[i] = Blst_scalar_val(new Blst_scalar());
+  return {scalars: scalars};
+}
+
+//Provides: caml_blst_scalar_batch_set_stubs
+//Requires: Blst_fr_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_scalar_batch_set_stubs(batch, scalars) {
+  var scalar = Blst_scalar_val(new Blst_scalar());
+  for (var i = 0; i < batch.scalars.length; i++) {
+    wasm_call('_blst_scalar_from_fr', scalar, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', batch.scalars[i], scalar);
+  }
+  return 0;
+}
+
+//Provides: caml_blst_g1_pippenger_scalar_batch_stubs
+//Requires: Blst_p1_val
+//Requires: wasm_call
+function caml_blst_g1_pippenger_scalar_batch_stubs(
+    buffer,
+    affine_list,
+    batch,
+    start,
+    len
+) {
+  var addr_ps = new Array(len);
+  var addr_scalars_bs = new Array(len);
+  for (var i = 0; i < len; i++) {
+    addr_ps[i] = affine_list.nth(start + i);
+    addr_scalars_bs[i] = batch.scalars[start + i];
+  }
+
+  if (len == 1) {
+    wasm_call('_blst_p1_from_affine', Blst_p1_val(buffer), addr_ps[0]);
+    wasm_call(
+        '_blst_p1_mult',
+        Blst_p1_val(buffer),
+        Blst_p1_val(buffer),
+        addr_scalars_bs[0],
+        256
+    );
+    return 0;
+  }
+
+  var scratch_size = wasm_call('_blst_p1s_mult_pippenger_scratch_sizeof', len);
+  var scratch = new globalThis.Uint8Array(scratch_size);
+
+  wasm_call(
+      '_blst_p1s_mult_pippenger',
+      Blst_p1_val(buffer),
+      addr_ps,
+      len,
+      addr_scalars_bs,
+      256,
+      scratch
+  );
+
+  return 0;
+}
+
+//Provides: caml_blst_g2_pippenger_scalar_batch_stubs
+//Requires: Blst_p2_val
+//Requires: wasm_call
+function caml_blst_g2_pippenger_scalar_batch_stubs(
+    buffer,
+    affine_list,
+    batch,
+    start,
+    len
+) {
+  var addr_ps = new Array(len);
+  var addr_scalars_bs = new Array(len);
+  for (var i = 0; i < len; i++) {
+    addr_ps[i] = affine_list.nth(start + i);
+    addr_scalars_bs[i] = batch.scalars[start + i];
+  }
+
+  if (len == 1) {
+    wasm_call('_blst_p2_from_affine', Blst_p2_val(buffer), addr_ps[0]);
+    wasm_call(
+        '_blst_p2_mult',
+        Blst_p2_val(buffer),
+        Blst_p2_val(buffer),
+        addr_scalars_bs[0],
+        256
+    );
+    return 0;
+  }
+
+  var scratch_size = wasm_call('_blst_p2s_mult_pippenger_scratch_sizeof', len);
+  var scratch = new globalThis.Uint8Array(scratch_size);
+
+  wasm_call(
+      '_blst_p2s_mult_pippenger',
+      Blst_p2_val(buffer),
+      addr_ps,
+      len,
+      addr_scalars_bs,
+      256,
+      scratch
+  );
+
+  return 0;
+}
+
+//Provides: caml_blst_g1_pippenger_multi_stubs
+//Requires: Blst_fr_val, Blst_p1_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_g1_pippenger_multi_stubs(
+    buffers,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  var addr_ps = new Array(len);
+  var addr_scalars_bs = new Array(len);
+  var scalar = Blst_scalar_val(new Blst_scalar());
+  var scratch = new globalThis.Uint8Array(
+      wasm_call('_blst_p1s_mult_pippenger_scratch_sizeof', len)
+  );
+  for (var i = 0; i < len; i++) {
+    addr_ps[i] = affine_list.nth(start + i);
+    addr_scalars_bs[i] = Blst_scalar_val(new Blst_scalar());
+  }
+
+  // OCaml arrays: the elements start at the index 1
+  for (var j = 1; j < scalars.length; j++) {
+    var buffer_c = Blst_p1_val(buffers[j]);
+    for (var i = 0; i < len; i++) {
+      wasm_call(
+          '_blst_scalar_from_fr',
+          scalar,
+          Blst_fr_val(scalars[j][start + i + 1])
+      );
+      wasm_call('_blst_lendian_from_scalar', addr_scalars_bs[i], scalar);
+    }
+    if (len == 1) {
+      wasm_call('_blst_p1_from_affine', buffer_c, addr_ps[0]);
+      wasm_call('_blst_p1_mult', buffer_c, buffer_c, addr_scalars_bs[0], 256);
+    } else {
+      wasm_call(
+          '_blst_p1s_mult_pippenger',
+          buffer_c,
+          addr_ps,
+          len,
+          addr_scalars_bs,
+          256,
+          scratch
+      );
+    }
+  }
+  return 0;
+}
+
+//Provides: caml_blst_g2_pippenger_multi_stubs
+//Requires: Blst_fr_val, Blst_p2_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_g2_pippenger_multi_stubs(
+    buffers,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  var addr_ps = new Array(len);
+  var addr_scalars_bs = new Array(len);
+  var scalar = Blst_scalar_val(new Blst_scalar());
+  var scratch = new globalThis.Uint8Array(
+      wasm_call('_blst_p2s_mult_pippenger_scratch_sizeof', len)
+  );
+  for (var i = 0; i < len; i++) {
+    addr_ps[i] = affine_list.nth(start + i);
+    addr_scalars_bs[i] = Blst_scalar_val(new Blst_scalar());
+  }
+
+  // OCaml arrays: the elements start at the index 1
+  for (var j = 1; j < scalars.length; j++) {
+    var buffer_c = Blst_p2_val(buffers[j]);
+    for (var i = 0; i < len; i++) {
+      wasm_call(
+          '_blst_scalar_from_fr',
+          scalar,
+          Blst_fr_val(scalars[j][start + i + 1])
+      );
+      wasm_call('_blst_lendian_from_scalar', addr_scalars_bs[i], scalar);
+    }
+    if (len == 1) {
+      wasm_call('_blst_p2_from_affine', buffer_c, addr_ps[0]);
+      wasm_call('_blst_p2_mult', buffer_c, buffer_c, addr_scalars_bs[0], 256);
+    } else {
+      wasm_call(
+          '_blst_p2s_mult_pippenger',
+          buffer_c,
+          addr_ps,
+          len,
+          addr_scalars_bs,
+          256,
+          scratch
+      );
+    }
+  }
+  return 0;
+}
+
+// GLV MSMs. The endomorphism is not exported by the wasm build of blst: the
+// bases are copied and the multiplications are the ones of the prepared bases.
+
+//Provides: caml_blst_g1_pippenger_glv_stubs
+//Requires: caml_blst_p1_prepared_bases_mult_stubs
+function caml_blst_g1_pippenger_glv_stubs(
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_p1_prepared_bases_mult_stubs(
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: allocate_p1_glv_bases_stubs
+//Requires: Blst_p1_affine_array
+function allocate_p1_glv_bases_stubs(npoints) {
+  return new Blst_p1_affine_array(npoints);
+}
+
+//Provides: caml_blst_p1_glv_bases_set_stubs
+function caml_blst_p1_glv_bases_set_stubs(bases, points, npoints) {
+  bases.v.set(points.v.subarray(0, bases.v.length));
+  return 0;
+}
+
+//Provides: caml_blst_p1_glv_bases_mult_stubs
+//Requires: caml_blst_p1_prepared_bases_mult_stubs
+function caml_blst_p1_glv_bases_mult_stubs(buffer, bases, scalars, start, len) {
+  return caml_blst_p1_prepared_bases_mult_stubs(
+      buffer,
+      bases,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: caml_blst_g2_pippenger_glv_stubs
+//Requires: caml_blst_p2_prepared_bases_mult_stubs
+function caml_blst_g2_pippenger_glv_stubs(
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_p2_prepared_bases_mult_stubs(
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: allocate_p2_glv_bases_stubs
+//Requires: Blst_p2_affine_array
+function allocate_p2_glv_bases_stubs(npoints) {
+  return new Blst_p2_affine_array(npoints);
+}
+
+//Provides: caml_blst_p2_glv_bases_set_stubs
+function caml_blst_p2_glv_bases_set_stubs(bases, points, npoints) {
+  bases.v.set(points.v.subarray(0, bases.v.length));
+  return 0;
+}
+
+//Provides: caml_blst_p2_glv_bases_mult_stubs
+//Requires: caml_blst_p2_prepared_bases_mult_stubs
+function caml_blst_p2_glv_bases_mult_stubs(buffer, bases, scalars, start, len) {
+  return caml_blst_p2_prepared_bases_mult_stubs(
+      buffer,
+      bases,
+      scalars,
+      start,
+      len
+  );
+}
+
+// MSM contexts. The JavaScript backend does not keep buffers between the
+// multiplications: the context is a placeholder and the multiplications are
+// the ones of the prepared bases.
+
+//Provides: allocate_msm_context_stubs
+function allocate_msm_context_stubs(unit) {
+  return {};
+}
+
+//Provides: caml_blst_g1_msm_context_pippenger_stubs
+//Requires: Blst_p1_affine_array, Blst_p1_val
+//Requires: caml_blst_p1_prepared_bases_mult_stubs
+//Requires: wasm_call
+function caml_blst_g1_msm_context_pippenger_stubs(
+    ctx,
+    buffer,
+    jacobian_list,
+    scalars,
+    start,
+    len
+) {
+  var ps = new Blst_p1_affine_array(len);
+  for (var i = 0; i < len; i++) {
+    wasm_call(
+        '_blst_p1_to_affine',
+        ps.nth(i),
+        Blst_p1_val(jacobian_list[start + i + 1])
+    );
+  }
+  // OCaml array of the scalars start, ..., start + len - 1
+  var ss = [0].concat(scalars.slice(start + 1, start + len + 1));
+  return caml_blst_p1_prepared_bases_mult_stubs(buffer, ps, ss, 0, len);
+}
+
+//Provides: caml_blst_g1_msm_context_pippenger_stubs_bytecode
+//Requires: caml_blst_g1_msm_context_pippenger_stubs
+function caml_blst_g1_msm_context_pippenger_stubs_bytecode(
+    ctx,
+    buffer,
+    jacobian_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_g1_msm_context_pippenger_stubs(
+      ctx,
+      buffer,
+      jacobian_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: caml_blst_g1_msm_context_pippenger_affine_stubs
+//Requires: caml_blst_p1_prepared_bases_mult_stubs
+function caml_blst_g1_msm_context_pippenger_affine_stubs(
+    ctx,
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_p1_prepared_bases_mult_stubs(
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: caml_blst_g1_msm_context_pippenger_affine_stubs_bytecode
+//Requires: caml_blst_g1_msm_context_pippenger_affine_stubs
+function caml_blst_g1_msm_context_pippenger_affine_stubs_bytecode(
+    ctx,
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_g1_msm_context_pippenger_affine_stubs(
+      ctx,
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: caml_blst_g2_msm_context_pippenger_stubs
+//Requires: Blst_p2_affine_array, Blst_p2_val
+//Requires: caml_blst_p2_prepared_bases_mult_stubs
+//Requires: wasm_call
+function caml_blst_g2_msm_context_pippenger_stubs(
+    ctx,
+    buffer,
+    jacobian_list,
+    scalars,
+    start,
+    len
+) {
+  var ps = new Blst_p2_affine_array(len);
+  for (var i = 0; i < len; i++) {
+    wasm_call(
+        '_blst_p2_to_affine',
+        ps.nth(i),
+        Blst_p2_val(jacobian_list[start + i + 1])
+    );
+  }
+  // OCaml array of the scalars start, ..., start + len - 1
+  var ss = [0].concat(scalars.slice(start + 1, start + len + 1));
+  return caml_blst_p2_prepared_bases_mult_stubs(buffer, ps, ss, 0, len);
+}
+
+//Provides: caml_blst_g2_msm_context_pippenger_stubs_bytecode
+//Requires: caml_blst_g2_msm_context_pippenger_stubs
+function caml_blst_g2_msm_context_pippenger_stubs_bytecode(
+    ctx,
+    buffer,
+    jacobian_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_g2_msm_context_pippenger_stubs(
+      ctx,
+      buffer,
+      jacobian_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: caml_blst_g2_msm_context_pippenger_affine_stubs
+//Requires: caml_blst_p2_prepared_bases_mult_stubs
+function caml_blst_g2_msm_context_pippenger_affine_stubs(
+    ctx,
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_p2_prepared_bases_mult_stubs(
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+//Provides: caml_blst_g2_msm_context_pippenger_affine_stubs_bytecode
+//Requires: caml_blst_g2_msm_context_pippenger_affine_stubs
+function caml_blst_g2_msm_context_pippenger_affine_stubs_bytecode(
+    ctx,
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  return caml_blst_g2_msm_context_pippenger_affine_stubs(
+      ctx,
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+}
+
+// Streaming MSMs. The JavaScript backend keeps the running sum of the MSMs of
+// the chunks instead of the buckets of all the windows.
+
+//Provides: allocate_p1_msm_stream_stubs
+//Requires: Blst_p1
+function allocate_p1_msm_stream_stubs(window) {
+  return {sum: new Blst_p1(), tmp: new Blst_p1()};
+}
+
+//Provides: caml_blst_g1_msm_stream_add_stubs
+//Requires: caml_blst_g1_msm_context_pippenger_stubs
+//Requires: Blst_p1_val, wasm_call
+function caml_blst_g1_msm_stream_add_stubs(
+    stream,
+    jacobian_list,
+    scalars,
+    start,
+    len
+) {
+  if (len == 0) return 0;
+  caml_blst_g1_msm_context_pippenger_stubs(
+      {},
+      stream.tmp,
+      jacobian_list,
+      scalars,
+      start,
+      len
+  );
+  wasm_call(
+      '_blst_p1_add_or_double',
+      Blst_p1_val(stream.sum),
+      Blst_p1_val(stream.sum),
+      Blst_p1_val(stream.tmp)
+  );
+  return 0;
+}
+
+//Provides: caml_blst_g1_msm_stream_add_affine_stubs
+//Requires: caml_blst_p1_prepared_bases_mult_stubs
+//Requires: Blst_p1_val, wasm_call
+function caml_blst_g1_msm_stream_add_affine_stubs(
+    stream,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  if (len == 0) return 0;
+  caml_blst_p1_prepared_bases_mult_stubs(
+      stream.tmp,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+  wasm_call(
+      '_blst_p1_add_or_double',
+      Blst_p1_val(stream.sum),
+      Blst_p1_val(stream.sum),
+      Blst_p1_val(stream.tmp)
+  );
+  return 0;
+}
+
+//Provides: caml_blst_g1_msm_stream_finish_stubs
+//Requires: Blst_p1_val
+function caml_blst_g1_msm_stream_finish_stubs(buffer, stream) {
+  Blst_p1_val(buffer).set(Blst_p1_val(stream.sum));
+  Blst_p1_val(stream.sum).fill(0);
+  return 0;
+}
+
+//Provides: allocate_p2_msm_stream_stubs
+//Requires: Blst_p2
+function allocate_p2_msm_stream_stubs(window) {
+  return {sum: new Blst_p2(), tmp: new Blst_p2()};
+}
+
+//Provides: caml_blst_g2_msm_stream_add_stubs
+//Requires: caml_blst_g2_msm_context_pippenger_stubs
+//Requires: Blst_p2_val, wasm_call
+function caml_blst_g2_msm_stream_add_stubs(
+    stream,
+    jacobian_list,
+    scalars,
+    start,
+    len
+) {
+  if (len == 0) return 0;
+  caml_blst_g2_msm_context_pippenger_stubs(
+      {},
+      stream.tmp,
+      jacobian_list,
+      scalars,
+      start,
+      len
+  );
+  wasm_call(
+      '_blst_p2_add_or_double',
+      Blst_p2_val(stream.sum),
+      Blst_p2_val(stream.sum),
+      Blst_p2_val(stream.tmp)
+  );
+  return 0;
+}
+
+//Provides: caml_blst_g2_msm_stream_add_affine_stubs
+//Requires: caml_blst_p2_prepared_bases_mult_stubs
+//Requires: Blst_p2_val, wasm_call
+function caml_blst_g2_msm_stream_add_affine_stubs(
+    stream,
+    affine_list,
+    scalars,
+    start,
+    len
+) {
+  if (len == 0) return 0;
+  caml_blst_p2_prepared_bases_mult_stubs(
+      stream.tmp,
+      affine_list,
+      scalars,
+      start,
+      len
+  );
+  wasm_call(
+      '_blst_p2_add_or_double',
+      Blst_p2_val(stream.sum),
+      Blst_p2_val(stream.sum),
+      Blst_p2_val(stream.tmp)
+  );
+  return 0;
+}
+
+//Provides: caml_blst_g2_msm_stream_finish_stubs
+//Requires: Blst_p2_val
+function caml_blst_g2_msm_stream_finish_stubs(buffer, stream) {
+  Blst_p2_val(buffer).set(Blst_p2_val(stream.sum));
+  Blst_p2_val(stream.sum).fill(0);
+  return 0;
+}
+
+//Provides: caml_blst_g1_pippenger_indexed_stubs
+//Requires: Blst_fr_val, Blst_p1_val, Blst_p1, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_g1_pippenger_indexed_stubs(
+    buffer,
+    affine_list,
+    indices,
+    scalars,
+    len
+) {
+  var buffer_c = Blst_p1_val(buffer);
+  var tmp = Blst_p1_val(new Blst_p1());
+  var scalar = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', scalar, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, scalar);
+    wasm_call('_blst_p1_from_affine', tmp, affine_list.nth(indices[i + 1]));
+    wasm_call('_blst_p1_mult', tmp, tmp, bs, 256);
+    wasm_call('_blst_p1_add_or_double', buffer_c, buffer_c, tmp);
+  }
+  return 0;
+}
+
+//Provides: caml_blst_g2_pippenger_indexed_stubs
+//Requires: Blst_fr_val, Blst_p2_val, Blst_p2, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_g2_pippenger_indexed_stubs(
+    buffer,
+    affine_list,
+    indices,
+    scalars,
+    len
+) {
+  var buffer_c = Blst_p2_val(buffer);
+  var tmp = Blst_p2_val(new Blst_p2());
+  var scalar = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', scalar, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, scalar);
+    wasm_call('_blst_p2_from_affine', tmp, affine_list.nth(indices[i + 1]));
+    wasm_call('_blst_p2_mult', tmp, tmp, bs, 256);
+    wasm_call('_blst_p2_add_or_double', buffer_c, buffer_c, tmp);
+  }
+  return 0;
+}
+
+// The slices of the JavaScript backend are the bits of the scalars in
+// [bit0, bit1), i.e. the binary digits instead of the Booth digits of the C
+// stubs. Only the merged results are the same.
+//Provides: caml_blst_scalar_keep_bits
+function caml_blst_scalar_keep_bits(bs, bit0, bit1) {
+  for (var k = 0; k < bs.length * 8; k++) {
+    if (k < bit0 || k >= bit1) bs[k >> 3] &= ~(1 << (k & 7));
+  }
+}
+
+//Provides: caml_blst_g1_pippenger_slice_stubs
+//Requires: Blst_fr_val, Blst_p1_val, Blst_p1, Blst_scalar_val, Blst_scalar
+//Requires: caml_blst_scalar_keep_bits, wasm_call
+function caml_blst_g1_pippenger_slice_stubs(
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len,
+    bit0,
+    bit1
+) {
+  var buffer_c = Blst_p1_val(buffer);
+  var tmp = Blst_p1_val(new Blst_p1());
+  var scalar = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call(
+        '_blst_scalar_from_fr',
+        scalar,
+        Blst_fr_val(scalars[start + i + 1])
+    );
+    wasm_call('_blst_lendian_from_scalar', bs, scalar);
+    caml_blst_scalar_keep_bits(bs, bit0, bit1);
+    wasm_call('_blst_p1_from_affine', tmp, affine_list.nth(start + i));
+    wasm_call('_blst_p1_mult', tmp, tmp, bs, 256);
+    wasm_call('_blst_p1_add_or_double', buffer_c, buffer_c, tmp);
+  }
+  return 0;
+}
+
+//Provides: caml_blst_g1_pippenger_slice_stubs_bytecode
+//Requires: caml_blst_g1_pippenger_slice_stubs
+function caml_blst_g1_pippenger_slice_stubs_bytecode(
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len,
+    bit0,
+    bit1
+) {
+  return caml_blst_g1_pippenger_slice_stubs(
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len,
+      bit0,
+      bit1
+  );
+}
+
+//Provides: caml_blst_g2_pippenger_slice_stubs
+//Requires: Blst_fr_val, Blst_p2_val, Blst_p2, Blst_scalar_val, Blst_scalar
+//Requires: caml_blst_scalar_keep_bits, wasm_call
+function caml_blst_g2_pippenger_slice_stubs(
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len,
+    bit0,
+    bit1
+) {
+  var buffer_c = Blst_p2_val(buffer);
+  var tmp = Blst_p2_val(new Blst_p2());
+  var scalar = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call(
+        '_blst_scalar_from_fr',
+        scalar,
+        Blst_fr_val(scalars[start + i + 1])
+    );
+    wasm_call('_blst_lendian_from_scalar', bs, scalar);
+    caml_blst_scalar_keep_bits(bs, bit0, bit1);
+    wasm_call('_blst_p2_from_affine', tmp, affine_list.nth(start + i));
+    wasm_call('_blst_p2_mult', tmp, tmp, bs, 256);
+    wasm_call('_blst_p2_add_or_double', buffer_c, buffer_c, tmp);
+  }
+  return 0;
+}
+
+//Provides: caml_blst_g2_pippenger_slice_stubs_bytecode
+//Requires: caml_blst_g2_pippenger_slice_stubs
+function caml_blst_g2_pippenger_slice_stubs_bytecode(
+    buffer,
+    affine_list,
+    scalars,
+    start,
+    len,
+    bit0,
+    bit1
+) {
+  return caml_blst_g2_pippenger_slice_stubs(
+      buffer,
+      affine_list,
+      scalars,
+      start,
+      len,
+      bit0,
+      bit1
+  );
+}
+
+// The fixed-base tables of the JavaScript backend only keep the point
+//Provides: allocate_p1_fixed_base_stubs
+//Requires: Blst_p1
+function allocate_p1_fixed_base_stubs(window) {
+  return new Blst_p1();
+}
+
+//Provides: caml_blst_p1_fixed_base_precompute_stubs
+//Requires: Blst_p1_val, blst_p1_sizeof, caml_blst_memcpy
+function caml_blst_p1_fixed_base_precompute_stubs(table, point) {
+  caml_blst_memcpy(Blst_p1_val(table), Blst_p1_val(point), blst_p1_sizeof());
+  return 0;
+}
+
+//Provides: caml_blst_p1_mult_fixed_base_stubs
+//Requires: Blst_fr_val, Blst_p1_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p1_mult_fixed_base_stubs(buffer, table, scalar) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalar));
+  wasm_call('_blst_lendian_from_scalar', bs, s);
+  wasm_call('_blst_p1_mult', Blst_p1_val(buffer), Blst_p1_val(table), bs, 256);
+  return 0;
+}
+
+//Provides: caml_blst_p1_mult_fixed_base_many_stubs
+//Requires: caml_blst_p1_mult_fixed_base_stubs
+function caml_blst_p1_mult_fixed_base_many_stubs(res, table, scalars, len) {
+  for (var i = 0; i < len; i++) {
+    caml_blst_p1_mult_fixed_base_stubs(res[i + 1], table, scalars[i + 1]);
+  }
+  return 0;
+}
+
+//Provides: allocate_p2_fixed_base_stubs
+//Requires: Blst_p2
+function allocate_p2_fixed_base_stubs(window) {
+  return new Blst_p2();
+}
+
+//Provides: caml_blst_p2_fixed_base_precompute_stubs
+//Requires: Blst_p2_val, blst_p2_sizeof, caml_blst_memcpy
+function caml_blst_p2_fixed_base_precompute_stubs(table, point) {
+  caml_blst_memcpy(Blst_p2_val(table), Blst_p2_val(point), blst_p2_sizeof());
+  return 0;
+}
+
+//Provides: caml_blst_p2_mult_fixed_base_stubs
+//Requires: Blst_fr_val, Blst_p2_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p2_mult_fixed_base_stubs(buffer, table, scalar) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalar));
+  wasm_call('_blst_lendian_from_scalar', bs, s);
+  wasm_call('_blst_p2_mult', Blst_p2_val(buffer), Blst_p2_val(table), bs, 256);
+  return 0;
+}
+
+//Provides: caml_blst_p2_mult_fixed_base_many_stubs
+//Requires: caml_blst_p2_mult_fixed_base_stubs
+function caml_blst_p2_mult_fixed_base_many_stubs(res, table, scalars, len) {
+  for (var i = 0; i < len; i++) {
+    caml_blst_p2_mult_fixed_base_stubs(res[i + 1], table, scalars[i + 1]);
+  }
+  return 0;
+}
+
+// The JavaScript backend has no variable time mode, the multiplications use
+// blst_p1_mult and blst_p2_mult
+//Provides: caml_blst_p1_mult_vartime_stubs
+//Requires: Blst_fr_val, Blst_p1_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p1_mult_vartime_stubs(buffer, p, scalar) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalar));
+  wasm_call('_blst_lendian_from_scalar', bs, s);
+  wasm_call('_blst_p1_mult', Blst_p1_val(buffer), Blst_p1_val(p), bs, 256);
+  return 0;
+}
+
+//Provides: caml_blst_p2_mult_vartime_stubs
+//Requires: Blst_fr_val, Blst_p2_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p2_mult_vartime_stubs(buffer, p, scalar) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalar));
+  wasm_call('_blst_lendian_from_scalar', bs, s);
+  wasm_call('_blst_p2_mult', Blst_p2_val(buffer), Blst_p2_val(p), bs, 256);
+  return 0;
+}
+
+//Provides: caml_blst_p1_mult_many_stubs
+//Requires: Blst_fr_val, Blst_p1_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p1_mult_many_stubs(res, points, scalars, len, vartime) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, s);
+    wasm_call(
+        '_blst_p1_mult',
+        Blst_p1_val(res[i + 1]),
+        Blst_p1_val(points[i + 1]),
+        bs,
+        256
+    );
+  }
+  return 0;
+}
+
+//Provides: caml_blst_p1_mult_many_affine_array_stubs
+//Requires: Blst_fr_val, Blst_p1, Blst_p1_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p1_mult_many_affine_array_stubs(
+    res,
+    points,
+    scalars,
+    len,
+    vartime
+) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  var p = Blst_p1_val(new Blst_p1());
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, s);
+    wasm_call('_blst_p1_mult', p, Blst_p1_val(points[i + 1]), bs, 256);
+    wasm_call('_blst_p1_to_affine', res.nth(i), p);
+  }
+  return 0;
+}
+
+//Provides: caml_blst_p2_mult_many_stubs
+//Requires: Blst_fr_val, Blst_p2_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p2_mult_many_stubs(res, points, scalars, len, vartime) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, s);
+    wasm_call(
+        '_blst_p2_mult',
+        Blst_p2_val(res[i + 1]),
+        Blst_p2_val(points[i + 1]),
+        bs,
+        256
+    );
+  }
+  return 0;
+}
+
+//Provides: caml_blst_p2_mult_many_affine_array_stubs
+//Requires: Blst_fr_val, Blst_p2, Blst_p2_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p2_mult_many_affine_array_stubs(
+    res,
+    points,
+    scalars,
+    len,
+    vartime
+) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  var p = Blst_p2_val(new Blst_p2());
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, s);
+    wasm_call('_blst_p2_mult', p, Blst_p2_val(points[i + 1]), bs, 256);
+    wasm_call('_blst_p2_to_affine', res.nth(i), p);
+  }
+  return 0;
+}
+
+//Provides: caml_blst_p1_linear_combination_stubs
+//Requires: Blst_fr_val, Blst_p1, Blst_p1_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p1_linear_combination_stubs(buffer, points, scalars, len) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  var p = Blst_p1_val(new Blst_p1());
+  var buffer_c = Blst_p1_val(buffer);
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, s);
+    wasm_call('_blst_p1_mult', p, Blst_p1_val(points[i + 1]), bs, 256);
+    wasm_call('_blst_p1_add_or_double', buffer_c, buffer_c, p);
+  }
+  return 0;
+}
+
+//Provides: caml_blst_p2_linear_combination_stubs
+//Requires: Blst_fr_val, Blst_p2, Blst_p2_val, Blst_scalar_val, Blst_scalar
+//Requires: wasm_call
+function caml_blst_p2_linear_combination_stubs(buffer, points, scalars, len) {
+  var s = Blst_scalar_val(new Blst_scalar());
+  var bs = Blst_scalar_val(new Blst_scalar());
+  var p = Blst_p2_val(new Blst_p2());
+  var buffer_c = Blst_p2_val(buffer);
+  buffer_c.fill(0);
+  for (var i = 0; i < len; i++) {
+    wasm_call('_blst_scalar_from_fr', s, Blst_fr_val(scalars[i + 1]));
+    wasm_call('_blst_lendian_from_scalar', bs, s);
+    wasm_call('_blst_p2_mult', p, Blst_p2_val(points[i + 1]), bs, 256);
+    wasm_call('_blst_p2_add_or_double', buffer_c, buffer_c, p);
+  }
+  return 0;
+}
+
+// The prepared points of the JavaScript backend are the fixed-base tables,
+// i.e. they only keep the point
+//Provides: allocate_p1_prepared_stubs
+//Requires: allocate_p1_fixed_base_stubs
+function allocate_p1_prepared_stubs(window) {
+  return allocate_p1_fixed_base_stubs(window);
+}
+
+//Provides: caml_blst_p1_prepare_stubs
+//Requires: caml_blst_p1_fixed_base_precompute_stubs
+function caml_blst_p1_prepare_stubs(prepared, point) {
+  return caml_blst_p1_fixed_base_precompute_stubs(prepared, point);
+}
+
+//Provides: caml_blst_p1_mult_prepared_stubs
+//Requires: caml_blst_p1_mult_fixed_base_stubs
+function caml_blst_p1_mult_prepared_stubs(buffer, prepared, scalar) {
+  return caml_blst_p1_mult_fixed_base_stubs(buffer, prepared, scalar);
+}
+
+//Provides: caml_blst_p1_mult_prepared_many_stubs
+//Requires: caml_blst_p1_mult_fixed_base_many_stubs
+function caml_blst_p1_mult_prepared_many_stubs(res, prepared, scalars, len) {
+  return caml_blst_p1_mult_fixed_base_many_stubs(res, prepared, scalars, len);
+}
+
+//Provides: allocate_p2_prepared_stubs
+//Requires: allocate_p2_fixed_base_stubs
+function allocate_p2_prepared_stubs(window) {
+  return allocate_p2_fixed_base_stubs(window);
+}
+
+//Provides: caml_blst_p2_prepare_stubs
+//Requires: caml_blst_p2_fixed_base_precompute_stubs
+function caml_blst_p2_prepare_stubs(prepared, point) {
+  return caml_blst_p2_fixed_base_precompute_stubs(prepared, point);
+}
+
+//Provides: caml_blst_p2_mult_prepared_stubs
+//Requires: caml_blst_p2_mult_fixed_base_stubs
+function caml_blst_p2_mult_prepared_stubs(buffer, prepared, scalar) {
+  return caml_blst_p2_mult_fixed_base_stubs(buffer, prepared, scalar);
+}
+
+//Provides: caml_blst_p2_mult_prepared_many_stubs
+//Requires: caml_blst_p2_mult_fixed_base_many_stubs
+function caml_blst_p2_mult_prepared_many_stubs(res, prepared, scalars, len) {
+  return caml_blst_p2_mult_fixed_base_many_stubs(res, prepared, scalars, len);
+}
+
+// The JavaScript backend only uses the prepared bases for the MSMs. The
+// thresholds of Straus' algorithm are kept for the getters.
+
+//Provides: caml_blst_straus_thresholds
+var caml_blst_straus_thresholds = [
+  [28, 36, 44],
+  [32, 40, 64]
+];
+
+//Provides: caml_blst_set_straus_threshold_stubs
+//Requires: caml_blst_straus_thresholds
+function caml_blst_set_straus_threshold_stubs(group, nbits, n) {
+  var c = nbits <= 64 ? 0 : nbits <= 128 ? 1 : 2;
+  caml_blst_straus_thresholds[group][c] = n;
+  return 0;
+}
+
+//Provides: caml_blst_get_straus_threshold_stubs
+//Requires: caml_blst_straus_thresholds
+function caml_blst_get_straus_threshold_stubs(group, nbits) {
+  var c = nbits <= 64 ? 0 : nbits <= 128 ? 1 : 2;
+  return caml_blst_straus_thresholds[group][c];
+}
+
+//Provides: caml_built_with_blst_portable_stubs
+function caml_built_with_blst_portable_stubs(unit) {
+  return 0;
+}
+
+// The windows of Pippenger's algorithm are kept for the getters
+//Provides: caml_blst_msm_window_sizes
+var caml_blst_msm_window_sizes = new Array(64).fill(0);
+
+//Provides: caml_blst_set_msm_window_stubs
+//Requires: caml_blst_msm_window_sizes
+function caml_blst_set_msm_window_stubs(log_npoints, window) {
+  caml_blst_msm_window_sizes[log_npoints] = window;
+  return 0;
+}
+
+//Provides: caml_blst_get_msm_window_stubs
+//Requires: caml_blst_msm_window_sizes
+function caml_blst_get_msm_window_stubs(log_npoints) {
+  return caml_blst_msm_window_sizes[log_npoints];
+}
+
+// The JavaScript backend is single threaded
+//Provides: caml_bls12_381_set_nb_threads_stubs
+function caml_bls12_381_set_nb_threads_stubs(n) {
+  return 0;
+}
+
+//Provides: caml_bls12_381_get_nb_threads_stubs
+function caml_bls12_381_get_nb_threads_stubs(unit) {
+  return 1;
+}
+
+// Marshal is not supported for the custom blocks with js_of_ocaml
+//Provides: caml_bls12_381_monotonic_time_stubs
+function caml_bls12_381_monotonic_time_stubs(unit) {
+  if (globalThis.performance && globalThis.performance.now)
+    return globalThis.performance.now() / 1000;
+  return Date.now() / 1000;
+}
+
+//Provides: caml_bls12_381_register_custom_operations_stubs
+function caml_bls12_381_register_custom_operations_stubs(unit) {
+  return 0;
+}
+
+//Provides: caml_bls12_381_set_unchecked_deserialization_stubs
+function caml_bls12_381_set_unchecked_deserialization_stubs(b) {
+  return 0;
+}
+
+//Provides: caml_bls12_381_get_unchecked_deserialization_stubs
+function caml_bls12_381_get_unchecked_deserialization_stubs(unit) {
   return 0;
 }
 
@@ -24,42 +24,100 @@ void blst_fr_set_to_one(vec256 a_fr) {
   vec_copy(a_fr, BLS12_381_rR, sizeof(vec256));
 }
 
+// Variable time. Only to be used on public data, e.g. when checking
+// deserialized values.
+static bool_t vec_is_smaller(const limb_t *a, const limb_t *m, size_t n) {
+  while (n--) {
+    if (a[n] != m[n])
+      return a[n] < m[n];
+  }
+  return 0;
+}
+
+// Check the Montgomery representation is smaller than the modulus
+bool_t blst_fr_is_reduced(const vec256 a_fr) {
+  return vec_is_smaller(a_fr, BLS12_381_r, NLIMBS(256));
+}
+
+bool_t blst_fp_is_reduced(const vec384 a_fp) {
+  return vec_is_smaller(a_fp, BLS12_381_P, NLIMBS(384));
+}
+
+// Booth digits of the window [bit0, bit0 + wbits) of the scalars, as used by
+// the tiles of Pippenger's algorithm. The digits can be given precomputed, see
+// blst_pippenger_booth_digits, else they are read from the scalars.
+typedef struct {
+  size_t nbytes;
+  size_t bit0;
+  size_t wbits;
+  size_t cbits;
+  size_t z;
+  limb_t wmask;
+} pippenger_digits_ctx;
+
+static void pippenger_digits_init(pippenger_digits_ctx *d, size_t nbits,
+                                  size_t bit0, size_t wbits, size_t cbits) {
+  d->nbytes = (nbits + 7) / 8;
+  d->wmask = ((limb_t)1 << (wbits + 1)) - 1;
+  d->z = is_zero(bit0);
+  d->bit0 = bit0 - (d->z ^ 1);
+  d->wbits = wbits + (d->z ^ 1);
+  d->cbits = cbits;
+}
+
+static inline limb_t pippenger_digit(const pippenger_digits_ctx *d,
+                                     const byte scalars[],
+                                     const unsigned int digits[], size_t i) {
+  limb_t wval;
+  if (digits != NULL)
+    return (digits[i]);
+  wval = get_wval_limb(scalars + i * d->nbytes, d->bit0, d->wbits);
+  return (booth_encode((wval << d->z) & d->wmask, d->cbits));
+}
+
+// Window [bit0, bit0 + window) of the tiles: the top window absorbs the carry
+// of the Booth encoding.
+static void pippenger_tile_bits(size_t nbits, size_t bit0, size_t window,
+                                size_t *wbits, size_t *cbits) {
+  if (bit0 + window > nbits)
+    *wbits = nbits - bit0, *cbits = *wbits + 1;
+  else
+    *wbits = *cbits = window;
+}
+
+void blst_pippenger_booth_digits(unsigned int digits[], const byte scalars[],
+                                 size_t npoints, size_t nbits, size_t bit0,
+                                 size_t window) {
+  size_t i, wbits, cbits;
+  pippenger_digits_ctx d;
+
+  pippenger_tile_bits(nbits, bit0, window, &wbits, &cbits);
+  pippenger_digits_init(&d, nbits, bit0, wbits, cbits);
+  for (i = 0; i < npoints; i++)
+    digits[i] = (unsigned int)pippenger_digit(&d, scalars, NULL, i);
+}
+
 // Improve pippenger using contiguous C array for scalars and affine points.
 // FIXME: let's rename it? ATM, we use a suffix _cont
 #define POINTS_MULT_PIPPENGER_CONT_IMPL(prefix, ptype)                         \
   static void ptype##s_tile_pippenger_cont(                                    \
       ptype *ret, const ptype##_affine points[], size_t npoints,               \
-      const byte scalars[], size_t nbits, ptype##xyzz buckets[], size_t bit0,  \
-      size_t wbits, size_t cbits) {                                            \
-    limb_t wmask, wval, wnxt;                                                  \
-    size_t i, z, nbytes;                                                       \
-    nbytes = (nbits + 7) / 8; /* convert |nbits| to bytes */                   \
-    const byte *scalar = scalars;                                              \
-    const ptype##_affine *point = points++;                                    \
-                                                                               \
-    wmask = ((limb_t)1 << (wbits + 1)) - 1;                                    \
-    z = is_zero(bit0);                                                         \
-    bit0 -= z ^ 1;                                                             \
-    wbits += z ^ 1;                                                            \
-    wval = (get_wval_limb(scalar, bit0, wbits) << z) & wmask;                  \
-    wval = booth_encode(wval, cbits);                                          \
-    scalar = scalar + nbytes /* ? scalars+nbytes : scalar+nbytes */;           \
-    wnxt = (get_wval_limb(scalar, bit0, wbits) << z) & wmask;                  \
-    wnxt = booth_encode(wnxt, cbits);                                          \
-    npoints--; /* account for prefetch */                                      \
-                                                                               \
-    ptype##_bucket(buckets, wval, cbits, point);                               \
-    for (i = 1; i < npoints; i++) {                                            \
+      const byte scalars[], const unsigned int digits[], size_t nbits,         \
+      ptype##xyzz buckets[], size_t bit0, size_t wbits, size_t cbits) {        \
+    limb_t wval, wnxt;                                                         \
+    size_t i;                                                                  \
+    pippenger_digits_ctx d;                                                    \
+                                                                               \
+    pippenger_digits_init(&d, nbits, bit0, wbits, cbits);                      \
+    wnxt = pippenger_digit(&d, scalars, digits, 0);                            \
+    for (i = 0; i < npoints; i++) {                                            \
       wval = wnxt;                                                             \
-      scalar = scalar + nbytes /* ? scalars+nbytes : scalar+nbytes */;         \
-      wnxt = (get_wval_limb(scalar, bit0, wbits) << z) & wmask;                \
-      wnxt = booth_encode(wnxt, cbits);                                        \
-      ptype##_prefetch(buckets, wnxt, cbits);                                  \
-      point = points ? points++ : point + 1;                                   \
-      ptype##_bucket(buckets, wval, cbits, point);                             \
-    }                                                                          \
-    point = points ? points++ : point + 1;                                     \
-    ptype##_bucket(buckets, wnxt, cbits, point);                               \
+      if (i + 1 < npoints) {                                                   \
+        wnxt = pippenger_digit(&d, scalars, digits, i + 1);                    \
+        ptype##_prefetch(buckets, wnxt, cbits);                                \
+      }                                                                        \
+      ptype##_bucket(buckets, wval, cbits, points + i);                        \
+    }                                                                          \
     ptype##_integrate_buckets(ret, buckets, cbits - 1);                        \
   }                                                                            \
                                                                                \
@@ -78,14 +136,14 @@ void blst_fr_set_to_one(vec256 a_fr) {
     wbits = nbits % window; /* yes, it may be zero */                          \
     cbits = wbits + 1;                                                         \
     while (bit0 -= wbits) {                                                    \
-      ptype##s_tile_pippenger_cont(tile, points, npoints, scalars, nbits,      \
-                                   buckets, bit0, wbits, cbits);               \
+      ptype##s_tile_pippenger_cont(tile, points, npoints, scalars, NULL,       \
+                                   nbits, buckets, bit0, wbits, cbits);        \
       ptype##_dadd(ret, ret, tile, NULL);                                      \
       for (i = 0; i < window; i++)                                             \
         ptype##_double(ret, ret);                                              \
       cbits = wbits = window;                                                  \
     }                                                                          \
-    ptype##s_tile_pippenger_cont(tile, points, npoints, scalars, nbits,        \
+    ptype##s_tile_pippenger_cont(tile, points, npoints, scalars, NULL, nbits,  \
                                  buckets, 0, wbits, cbits);                    \
     ptype##_dadd(ret, ret, tile, NULL);                                        \
   }                                                                            \
@@ -95,7 +153,846 @@ void blst_fr_set_to_one(vec256 a_fr) {
       const byte scalars[], size_t nbits, ptype##xyzz scratch[]) {             \
     ptype##s_mult_pippenger_cont(ret, points, npoints, scalars, nbits,         \
                                  scratch, 0);                                  \
+  }                                                                            \
+                                                                               \
+  /* Same with the given window, 0 for the heuristic of blst. The scratch */   \
+  /* must have room for 1 << (window - 1) buckets. */                          \
+  void prefix##s_mult_pippenger_cont_window(                                   \
+      ptype *ret, const ptype##_affine points[], size_t npoints,               \
+      const byte scalars[], size_t nbits, ptype##xyzz scratch[],               \
+      size_t window) {                                                         \
+    ptype##s_mult_pippenger_cont(ret, points, npoints, scalars, nbits,         \
+                                 scratch, window);                             \
+  }                                                                            \
+                                                                               \
+  /* Same than blst_p1s_tile_pippenger: the window [bit0, bit0 + window) of */ \
+  /* the MSM. The top window absorbs the carry of the Booth encoding. The */   \
+  /* scratch must have room for 1 << (window - 1) buckets. */                  \
+  void prefix##s_tile_pippenger_cont(                                          \
+      ptype *ret, const ptype##_affine points[], size_t npoints,               \
+      const byte scalars[], size_t nbits, ptype##xyzz scratch[], size_t bit0,  \
+      size_t window) {                                                         \
+    size_t wbits, cbits;                                                       \
+                                                                               \
+    pippenger_tile_bits(nbits, bit0, window, &wbits, &cbits);                  \
+    vec_zero(scratch, sizeof(scratch[0]) << (cbits - 1));                      \
+    ptype##s_tile_pippenger_cont(ret, points, npoints, scalars, NULL, nbits,   \
+                                 scratch, bit0, wbits, cbits);                 \
+  }                                                                            \
+                                                                               \
+  /* Same with the digits computed by blst_pippenger_booth_digits */           \
+  void prefix##s_tile_pippenger_digits(                                        \
+      ptype *ret, const ptype##_affine points[], size_t npoints,               \
+      const unsigned int digits[], size_t nbits, ptype##xyzz scratch[],        \
+      size_t bit0, size_t window) {                                            \
+    size_t wbits, cbits;                                                       \
+                                                                               \
+    pippenger_tile_bits(nbits, bit0, window, &wbits, &cbits);                  \
+    vec_zero(scratch, sizeof(scratch[0]) << (cbits - 1));                      \
+    ptype##s_tile_pippenger_cont(ret, points, npoints, NULL, digits, nbits,    \
+                                 scratch, bit0, wbits, cbits);                 \
   }
 
 POINTS_MULT_PIPPENGER_CONT_IMPL(blst_p1, POINTonE1)
 POINTS_MULT_PIPPENGER_CONT_IMPL(blst_p2, POINTonE2)
+
+// Window used by blst_p1s_mult_pippenger for npoints points. Exposed to split
+// the MSM in tiles.
+size_t blst_pippenger_window_size(size_t npoints) {
+  return pippenger_window_size(npoints);
+}
+
+// Streaming Pippenger: the buckets of all the windows are kept, the ones of the
+// window y (bits [y * window, (y + 1) * window)) starting at the bucket
+// y << (window - 1). The points are added to the buckets as they come, window
+// by window, and the buckets are integrated once at the end. The windows are
+// the ones of blst_p1s_mult_pippenger_cont, the top one absorbing the carry of
+// the Booth encoding.
+#define POINTS_MULT_PIPPENGER_STREAM_IMPL(prefix, ptype)                       \
+  size_t prefix##s_mult_pippenger_stream_sizeof(size_t nbits, size_t window) { \
+    return ((nbits / window + 1) * (sizeof(ptype##xyzz) << (window - 1)));     \
+  }                                                                            \
+                                                                               \
+  /* Add the points to the buckets of the window y */                          \
+  void prefix##s_mult_pippenger_stream_add(                                    \
+      ptype##xyzz buckets[], const ptype##_affine points[], size_t npoints,    \
+      const byte scalars[], size_t nbits, size_t window, size_t y) {           \
+    limb_t wval, wnxt;                                                         \
+    size_t i, wbits, cbits;                                                    \
+    pippenger_digits_ctx d;                                                    \
+                                                                               \
+    if (npoints == 0)                                                          \
+      return;                                                                  \
+    buckets += y << (window - 1);                                              \
+    pippenger_tile_bits(nbits, y * window, window, &wbits, &cbits);            \
+    pippenger_digits_init(&d, nbits, y * window, wbits, cbits);                \
+    wnxt = pippenger_digit(&d, scalars, NULL, 0);                              \
+    for (i = 0; i < npoints; i++) {                                            \
+      wval = wnxt;                                                             \
+      if (i + 1 < npoints) {                                                   \
+        wnxt = pippenger_digit(&d, scalars, NULL, i + 1);                      \
+        ptype##_prefetch(buckets, wnxt, cbits);                                \
+      }                                                                        \
+      ptype##_bucket(buckets, wval, cbits, points + i);                        \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /* Partial sum of the window y, without the doublings. The buckets of the */ \
+  /* window are reset to zero. */                                              \
+  void prefix##s_mult_pippenger_stream_integrate(                              \
+      ptype *ret, ptype##xyzz buckets[], size_t nbits, size_t window,          \
+      size_t y) {                                                              \
+    size_t wbits, cbits;                                                       \
+                                                                               \
+    pippenger_tile_bits(nbits, y * window, window, &wbits, &cbits);            \
+    ptype##_integrate_buckets(ret, buckets + (y << (window - 1)), cbits - 1);  \
+  }
+
+POINTS_MULT_PIPPENGER_STREAM_IMPL(blst_p1, POINTonE1)
+POINTS_MULT_PIPPENGER_STREAM_IMPL(blst_p2, POINTonE2)
+
+// Straus' algorithm (interleaved wNAF) for MSMs of a few points: the scalars
+// are recoded in wNAF with digits in (-2^(w-1), 2^(w-1)), the odd multiples
+// P, 3P, ..., (2^(w-1) - 1)P of the points are precomputed in affine
+// coordinates, and the multiplications share the doublings. It costs about
+// nbits doublings and npoints * (2^(w-2) + nbits / (w + 1)) additions, against
+// nbits / window * (npoints + 2^window) additions for Pippenger's algorithm.
+// The scalars are given as for blst_p1s_mult_pippenger, i.e. (nbits + 7) / 8
+// bytes per scalar in little endian. NOT constant time.
+//
+// blst_p1s_mult_straus_groups computes ngroups independent MSMs of group_size
+// consecutive points each, ret[g] being the MSM of the group g, e.g. the GLV
+// images of different points. The tables of all the groups are normalised to
+// affine coordinates with one shared inversion. The scratch is sized with
+// blst_p1s_mult_straus_scratch_sizeof for ngroups * group_size points.
+#define STRAUS_MAX_WINDOW 7
+
+size_t blst_straus_window_size(size_t nbits) {
+  size_t w, best = 2, cost, best_cost = (size_t)-1;
+  for (w = 2; w <= STRAUS_MAX_WINDOW; w++) {
+    cost = ((size_t)1 << (w - 2)) * (w + 1) + nbits;
+    cost = cost / (w + 1);
+    if (cost < best_cost)
+      best = w, best_cost = cost;
+  }
+  return (best);
+}
+
+static inline int straus_bit(const byte scalar[], size_t nbits, size_t i) {
+  return (i < nbits ? (scalar[i / 8] >> (i % 8)) & 1 : 0);
+}
+
+// digits[i] for i < nbits + window, the wNAF of the scalar
+static void straus_wnaf(signed char digits[], const byte scalar[],
+                        size_t nbits, size_t window) {
+  size_t i = 0, j, n = nbits + window;
+  int carry = 0, wval;
+
+  // Not vec_zero, which only clears whole limbs
+  for (j = 0; j < n; j++)
+    digits[j] = 0;
+  while (i < n) {
+    if (straus_bit(scalar, nbits, i) == carry) {
+      i++;
+      continue;
+    }
+    for (wval = 0, j = window; j--;)
+      wval = (wval << 1) | straus_bit(scalar, nbits, i + j);
+    wval += carry;
+    carry = (wval >> (window - 1)) & 1;
+    digits[i] = (signed char)(wval - (carry << window));
+    i += window;
+  }
+}
+
+#define POINTS_MULT_STRAUS_IMPL(prefix, ptype, field, one)                     \
+  size_t prefix##s_mult_straus_scratch_sizeof(size_t npoints, size_t nbits) {  \
+    size_t window = blst_straus_window_size(nbits);                            \
+    size_t ntable = npoints << (window - 2);                                   \
+    return (ntable * (sizeof(ptype) + sizeof(ptype##_affine)) +                \
+            (npoints + 1) * sizeof(size_t) + npoints * (nbits + window));      \
+  }                                                                            \
+                                                                               \
+  /* The points are given either in affine coordinates or, if points is */     \
+  /* NULL, in jacobian coordinates */                                          \
+  static void ptype##s_straus_groups(ptype ret[],                              \
+                                     const ptype##_affine points[],            \
+                                     const ptype jacobian_points[],            \
+                                     size_t ngroups, size_t group_size,        \
+                                     const byte scalars[], size_t nbits,       \
+                                     limb_t scratch[]) {                       \
+    size_t window = blst_straus_window_size(nbits);                            \
+    size_t nbytes = (nbits + 7) / 8, ndigits = nbits + window;                 \
+    size_t npoints = ngroups * group_size;                                     \
+    size_t m = (size_t)1 << (window - 2), i, j, k, g, n = 0;                   \
+    ptype *jacobian = (ptype *)scratch, dbl[1], *acc;                          \
+    ptype##_affine *table = (ptype##_affine *)(jacobian + (npoints * m));      \
+    size_t *first = (size_t *)(table + (npoints * m));                         \
+    signed char *digits = (signed char *)(first + (ngroups + 1)), d;           \
+    const ptype *ptrs[2] = {jacobian, NULL};                                   \
+    ptype##_affine neg[1];                                                     \
+    bool_t started;                                                            \
+                                                                               \
+    /* The rows of the group g are first[g], ..., first[g + 1] - 1. The */     \
+    /* points at infinity are skipped. */                                      \
+    for (g = 0; g < ngroups; g++) {                                            \
+      first[g] = n;                                                            \
+      for (i = g * group_size; i < (g + 1) * group_size; i++) {                \
+        ptype *row = jacobian + n * m;                                         \
+        if (points == NULL) {                                                  \
+          if (vec_is_zero(jacobian_points[i].Z, sizeof(row[0].Z)))             \
+            continue;                                                          \
+          vec_copy(row, &jacobian_points[i], sizeof(row[0]));                  \
+        } else {                                                               \
+          if (vec_is_zero(&points[i], sizeof(points[i])))                      \
+            continue;                                                          \
+          vec_copy(row[0].X, points[i].X, 2 * sizeof(row[0].X));               \
+          vec_copy(row[0].Z, one, sizeof(row[0].Z));                           \
+        }                                                                      \
+        ptype##_double(dbl, row);                                              \
+        for (k = 1; k < m; k++)                                                \
+          ptype##_dadd(&row[k], &row[k - 1], dbl, NULL);                       \
+        straus_wnaf(digits + n * ndigits, scalars + i * nbytes, nbits,         \
+                    window);                                                   \
+        n++;                                                                   \
+      }                                                                        \
+    }                                                                          \
+    first[ngroups] = n;                                                        \
+    if (n > 0)                                                                 \
+      ptype##s_to_affine(table, ptrs, n * m);                                  \
+                                                                               \
+    for (g = 0; g < ngroups; g++) {                                            \
+      acc = &ret[g];                                                           \
+      vec_zero(acc, sizeof(*acc));                                             \
+      /* No doublings before the first addition */                             \
+      started = 0;                                                             \
+      for (k = ndigits; k--;) {                                                \
+        if (started)                                                           \
+          ptype##_double(acc, acc);                                            \
+        for (j = first[g]; j < first[g + 1]; j++) {                            \
+          d = digits[j * ndigits + k];                                         \
+          if (d > 0)                                                           \
+            ptype##_dadd_affine(acc, acc, &table[j * m + (d - 1) / 2]);        \
+          else if (d < 0) {                                                    \
+            vec_copy(neg, &table[j * m + (-d - 1) / 2], sizeof(neg));          \
+            cneg_##field(neg->Y, neg->Y, 1);                                   \
+            ptype##_dadd_affine(acc, acc, neg);                                \
+          }                                                                    \
+          started |= d != 0;                                                   \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void prefix##s_mult_straus_groups(ptype ret[],                               \
+                                    const ptype##_affine points[],             \
+                                    size_t ngroups, size_t group_size,         \
+                                    const byte scalars[], size_t nbits,        \
+                                    limb_t scratch[]) {                        \
+    ptype##s_straus_groups(ret, points, NULL, ngroups, group_size, scalars,    \
+                           nbits, scratch);                                    \
+  }                                                                            \
+                                                                               \
+  void prefix##s_mult_straus(ptype *ret, const ptype##_affine points[],        \
+                             size_t npoints, const byte scalars[],             \
+                             size_t nbits, limb_t scratch[]) {                 \
+    ptype##s_straus_groups(ret, points, NULL, 1, npoints, scalars, nbits,      \
+                           scratch);                                           \
+  }
+
+POINTS_MULT_STRAUS_IMPL(blst_p1, POINTonE1, fp, BLS12_381_Rx.p)
+POINTS_MULT_STRAUS_IMPL(blst_p2, POINTonE2, fp2, BLS12_381_Rx.p2)
+
+// Fixed-base scalar multiplication with a comb of precomputed multiples: the
+// row j of the table holds the multiples 1, ..., 2^(window - 1) of
+// 2^(j window) point, in affine coordinates, and a multiplication is one
+// addition of a row entry per Booth digit of the scalar, without doublings.
+// The table takes (nbits / window + 1) 2^(window - 1) affine points.
+// Constant time in the scalar: the rows are scanned entirely and the
+// additions are complete.
+#define FIXED_BASE_MAX_NBITS 256
+
+#define FIXED_BASE_IMPL(prefix, ptype, field)                                  \
+  size_t prefix##_fixed_base_table_sizeof(size_t nbits, size_t window) {       \
+    return ((nbits / window + 1) * (sizeof(ptype##_affine) << (window - 1)));  \
+  }                                                                            \
+                                                                               \
+  size_t prefix##_fixed_base_scratch_sizeof(size_t window) {                   \
+    return (sizeof(ptype) << (window - 1));                                    \
+  }                                                                            \
+                                                                               \
+  void prefix##_fixed_base_table(ptype##_affine table[], const ptype *point,   \
+                                 size_t nbits, size_t window,                  \
+                                 limb_t scratch[]) {                           \
+    size_t nwindows = nbits / window + 1, m = (size_t)1 << (window - 1);       \
+    size_t j, k;                                                               \
+    ptype *row = (ptype *)scratch, base[1];                                    \
+    const ptype *ptrs[2] = {row, NULL};                                        \
+                                                                               \
+    if (vec_is_zero(point->Z, sizeof(point->Z))) {                             \
+      vec_zero(table, nwindows * m * sizeof(table[0]));                        \
+      return;                                                                  \
+    }                                                                          \
+    vec_copy(base, point, sizeof(base));                                       \
+    for (j = 0; j < nwindows; j++) {                                           \
+      /* row[k] = (k + 1) 2^(j window) point */                                \
+      vec_copy(row, base, sizeof(base));                                       \
+      for (k = 1; k < m; k++)                                                  \
+        ptype##_dadd(&row[k], &row[k - 1], base, NULL);                        \
+      ptype##_double(base, &row[m - 1]);                                       \
+      ptype##s_to_affine(table + j * m, ptrs, m);                              \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void prefix##_mult_fixed_base(ptype *ret, const ptype##_affine table[],      \
+                                const byte scalar[], size_t nbits,             \
+                                size_t window) {                               \
+    size_t nwindows = nbits / window + 1, m = (size_t)1 << (window - 1);       \
+    size_t j, k;                                                               \
+    limb_t wmask = ((limb_t)1 << (window + 1)) - 1, wval, idx;                 \
+    bool_t sign;                                                               \
+    /* Room for the bits read above nbits by get_wval_limb */                  \
+    byte padded[FIXED_BASE_MAX_NBITS / 8 + 8];                                 \
+    ptype##_affine sel[1];                                                     \
+                                                                               \
+    vec_zero(padded, sizeof(padded));                                          \
+    for (k = 0; k < (nbits + 7) / 8; k++)                                      \
+      padded[k] = scalar[k];                                                   \
+    vec_zero(ret, sizeof(*ret));                                               \
+    for (j = 0; j < nwindows; j++, table += m) {                               \
+      if (j == 0)                                                              \
+        wval = (get_wval_limb(padded, 0, window) << 1) & wmask;                \
+      else                                                                     \
+        wval = get_wval_limb(padded, j * window - 1, window + 1) & wmask;      \
+      wval = booth_encode(wval, window);                                       \
+      sign = (wval >> window) & 1;                                             \
+      idx = wval & (((limb_t)1 << window) - 1);                                \
+      /* Constant time lookup, the zero digit selecting the infinity */        \
+      vec_zero(sel, sizeof(sel));                                              \
+      for (k = 0; k < m; k++)                                                  \
+        vec_select(sel, &table[k], sel, sizeof(sel), is_zero(idx ^ (k + 1)));  \
+      cneg_##field(sel->Y, sel->Y, sign);                                      \
+      ptype##_dadd_affine(ret, ret, sel);                                      \
+    }                                                                          \
+  }
+
+FIXED_BASE_IMPL(blst_p1, POINTonE1, fp)
+FIXED_BASE_IMPL(blst_p2, POINTonE2, fp2)
+
+// Pippenger with the buckets in affine coordinates. The additions to the
+// buckets are delayed and gathered in batches in which each bucket appears at
+// most once. A batch is computed with one inversion shared with Montgomery's
+// trick, i.e. about 5M + 1S per addition instead of the 8M + 2S of the XYZZ
+// additions. A point whose bucket is already in the batch waits in a queue of
+// pending additions, retried after each batch.
+// NOT constant time, like the Pippenger implementation of blst.
+#define PIPPENGER_AFFINE_BATCH_SIZE 512
+
+// Number of points bucketed for each vector of scalars in turn by the MSMs of
+// several vectors over the same points, see
+// blst_p1s_tile_pippenger_affine_multi. The block stays in cache between the
+// vectors.
+#define PIPPENGER_MULTI_BLOCK_SIZE 1024
+
+#define POINTS_MULT_PIPPENGER_AFFINE_IMPL(prefix, ptype, bits, field, one)     \
+  typedef struct {                                                             \
+    const ptype##_affine *point;                                               \
+    size_t bucket;                                                             \
+    bool_t neg;                                                                \
+    bool_t dbl;                                                                \
+  } ptype##_affine_addition;                                                   \
+                                                                               \
+  typedef struct {                                                             \
+    ptype##_affine *buckets;                                                   \
+    limb_t *scheduled;                                                         \
+    vec##bits *acc;                                                            \
+    ptype##_affine_addition *batch;                                            \
+    ptype##_affine_addition *pending;                                          \
+    size_t batch_size;                                                         \
+    size_t nbatch;                                                             \
+    size_t npending;                                                           \
+  } ptype##_affine_buckets;                                                    \
+                                                                               \
+  static size_t ptype##_affine_batch_size(size_t window) {                     \
+    size_t nbuckets = (size_t)1 << (window - 1);                               \
+    return (nbuckets < PIPPENGER_AFFINE_BATCH_SIZE                             \
+                ? nbuckets                                                     \
+                : PIPPENGER_AFFINE_BATCH_SIZE);                                \
+  }                                                                            \
+                                                                               \
+  size_t prefix##s_mult_pippenger_affine_scratch_sizeof(size_t window) {       \
+    size_t nbuckets = (size_t)1 << (window - 1);                               \
+    size_t batch_size = ptype##_affine_batch_size(window);                     \
+    return (nbuckets * sizeof(ptype##_affine) +                                \
+            batch_size * sizeof(vec##bits) +                                   \
+            2 * batch_size * sizeof(ptype##_affine_addition) +                 \
+            (nbuckets + LIMB_T_BITS - 1) / LIMB_T_BITS * sizeof(limb_t));      \
+  }                                                                            \
+                                                                               \
+  static void ptype##_affine_buckets_init(ptype##_affine_buckets *b,           \
+                                          limb_t scratch[], size_t window,     \
+                                          size_t cbits) {                      \
+    size_t nbuckets = (size_t)1 << (window - 1);                               \
+    size_t nused = (size_t)1 << (cbits - 1);                                   \
+    b->batch_size = ptype##_affine_batch_size(window);                         \
+    b->buckets = (ptype##_affine *)scratch;                                    \
+    b->acc = (vec##bits *)(b->buckets + nbuckets);                             \
+    b->batch = (ptype##_affine_addition *)(b->acc + b->batch_size);            \
+    b->pending = b->batch + b->batch_size;                                     \
+    b->scheduled = (limb_t *)(b->pending + b->batch_size);                     \
+    b->nbatch = 0;                                                             \
+    b->npending = 0;                                                           \
+    vec_zero(b->buckets, nused * sizeof(ptype##_affine));                      \
+    vec_zero(b->scheduled,                                                     \
+             (nused + LIMB_T_BITS - 1) / LIMB_T_BITS * sizeof(limb_t));        \
+  }                                                                            \
+                                                                               \
+  /* buckets[i] += batch[i].point for the whole batch */                       \
+  static void ptype##_affine_buckets_flush(ptype##_affine_buckets *b) {        \
+    size_t i, n = b->nbatch;                                                   \
+    vec##bits den, inv, lambda, num, y2;                                       \
+    ptype##_affine *r;                                                         \
+    const ptype##_affine_addition *e;                                          \
+                                                                               \
+    if (n == 0)                                                                \
+      return;                                                                  \
+    for (i = 0; i < n; i++) {                                                  \
+      e = &b->batch[i];                                                        \
+      r = &b->buckets[e->bucket];                                              \
+      if (e->dbl)                                                              \
+        add_##field(den, r->Y, r->Y);                                          \
+      else                                                                     \
+        sub_##field(den, e->point->X, r->X);                                   \
+      if (i == 0)                                                              \
+        vec_copy(b->acc[0], den, sizeof(den));                                 \
+      else                                                                     \
+        mul_##field(b->acc[i], b->acc[i - 1], den);                            \
+    }                                                                          \
+    reciprocal_##field(inv, b->acc[n - 1]);                                    \
+    for (i = n; i--;) {                                                        \
+      e = &b->batch[i];                                                        \
+      r = &b->buckets[e->bucket];                                              \
+      if (e->dbl)                                                              \
+        add_##field(den, r->Y, r->Y);                                          \
+      else                                                                     \
+        sub_##field(den, e->point->X, r->X);                                   \
+      if (i > 0) {                                                             \
+        mul_##field(lambda, inv, b->acc[i - 1]); /* 1/den */                   \
+        mul_##field(inv, inv, den);                                            \
+      } else                                                                   \
+        vec_copy(lambda, inv, sizeof(inv));                                    \
+      if (e->dbl) {                                                            \
+        sqr_##field(num, r->X);                                                \
+        mul_by_3_##field(num, num); /* 3 X1^2 */                               \
+      } else {                                                                 \
+        cneg_##field(y2, e->point->Y, e->neg);                                 \
+        sub_##field(num, y2, r->Y); /* Y2 - Y1 */                              \
+      }                                                                        \
+      mul_##field(lambda, lambda, num);                                        \
+      sqr_##field(num, lambda);                                                \
+      sub_##field(num, num, r->X);                                             \
+      sub_##field(num, num, e->dbl ? r->X : e->point->X); /* X3 */             \
+      sub_##field(den, r->X, num);                                             \
+      mul_##field(den, den, lambda);                                           \
+      sub_##field(r->Y, den, r->Y); /* Y3 = lambda (X1 - X3) - Y1 */           \
+      vec_copy(r->X, num, sizeof(num));                                        \
+      b->scheduled[e->bucket / LIMB_T_BITS] &=                                 \
+          ~((limb_t)1 << (e->bucket % LIMB_T_BITS));                           \
+    }                                                                          \
+    b->nbatch = 0;                                                             \
+  }                                                                            \
+                                                                               \
+  /* Returns 0 if the bucket is already in the batch */                        \
+  static int ptype##_affine_buckets_add(ptype##_affine_buckets *b,             \
+                                        const ptype##_affine_addition *e) {    \
+    ptype##_affine *r = &b->buckets[e->bucket];                                \
+    limb_t bit = (limb_t)1 << (e->bucket % LIMB_T_BITS);                       \
+    limb_t *scheduled = &b->scheduled[e->bucket / LIMB_T_BITS];                \
+    vec##bits y2;                                                              \
+                                                                               \
+    if (*scheduled & bit)                                                      \
+      return 0;                                                                \
+    if (vec_is_zero(r, sizeof(*r))) {                                          \
+      vec_copy(r->X, e->point->X, sizeof(r->X));                               \
+      cneg_##field(r->Y, e->point->Y, e->neg);                                 \
+      return 1;                                                                \
+    }                                                                          \
+    ptype##_affine_addition *f = &b->batch[b->nbatch];                         \
+    *f = *e;                                                                   \
+    f->dbl = 0;                                                                \
+    if (vec_is_equal(r->X, e->point->X, sizeof(r->X))) {                       \
+      cneg_##field(y2, e->point->Y, e->neg);                                   \
+      if (!vec_is_equal(r->Y, y2, sizeof(y2))) {                               \
+        vec_zero(r, sizeof(*r)); /* P - P */                                   \
+        return 1;                                                              \
+      }                                                                        \
+      f->dbl = 1;                                                              \
+    }                                                                          \
+    *scheduled |= bit;                                                         \
+    if (++b->nbatch == b->batch_size)                                          \
+      ptype##_affine_buckets_flush(b);                                         \
+    return 1;                                                                  \
+  }                                                                            \
+                                                                               \
+  /* Retry the pending additions. The ones still in conflict stay pending */   \
+  static void ptype##_affine_buckets_drain(ptype##_affine_buckets *b) {        \
+    size_t i, k = 0;                                                           \
+    for (i = 0; i < b->npending; i++) {                                        \
+      if (!ptype##_affine_buckets_add(b, &b->pending[i]))                      \
+        b->pending[k++] = b->pending[i];                                       \
+    }                                                                          \
+    b->npending = k;                                                           \
+  }                                                                            \
+                                                                               \
+  static void ptype##_affine_bucket(ptype##_affine_buckets *b,                 \
+                                    limb_t booth_idx, size_t cbits,            \
+                                    const ptype##_affine *p) {                 \
+    ptype##_affine_addition e;                                                 \
+    e.neg = (booth_idx >> cbits) & 1;                                          \
+    booth_idx &= ((limb_t)1 << cbits) - 1;                                     \
+    if (booth_idx-- == 0 || vec_is_zero(p, sizeof(*p)))                        \
+      return;                                                                  \
+    e.point = p;                                                               \
+    e.bucket = booth_idx;                                                      \
+    e.dbl = 0;                                                                 \
+    if (ptype##_affine_buckets_add(b, &e))                                     \
+      return;                                                                  \
+    if (b->npending == b->batch_size) {                                        \
+      ptype##_affine_buckets_flush(b);                                         \
+      ptype##_affine_buckets_drain(b);                                         \
+    }                                                                          \
+    b->pending[b->npending++] = e;                                             \
+  }                                                                            \
+                                                                               \
+  /* Complete the pending additions and integrate the buckets in ret */        \
+  static void ptype##_affine_buckets_integrate(ptype *ret,                     \
+                                               ptype##_affine_buckets *b,      \
+                                               size_t cbits) {                 \
+    size_t i;                                                                  \
+    ptype##xyzz sum[1], acc[1];                                                \
+                                                                               \
+    while (b->nbatch || b->npending) {                                         \
+      ptype##_affine_buckets_flush(b);                                         \
+      ptype##_affine_buckets_drain(b);                                         \
+    }                                                                          \
+                                                                               \
+    /* sum of buckets[i - 1] * i */                                            \
+    vec_zero(sum, sizeof(sum));                                                \
+    vec_zero(acc, sizeof(acc));                                                \
+    for (i = (size_t)1 << (cbits - 1); i--;) {                                 \
+      ptype##xyzz_dadd_affine(acc, acc, &b->buckets[i], 0);                    \
+      ptype##xyzz_dadd(sum, sum, acc);                                         \
+    }                                                                          \
+    ptype##xyzz_to_Jacobian(ret, sum);                                         \
+  }                                                                            \
+                                                                               \
+  static void ptype##s_tile_pippenger_affine_cont(                             \
+      ptype *ret, const ptype##_affine points[], size_t npoints,               \
+      const byte scalars[], const unsigned int digits[], size_t nbits,         \
+      limb_t scratch[], size_t bit0, size_t window, size_t wbits,              \
+      size_t cbits) {                                                          \
+    size_t i;                                                                  \
+    pippenger_digits_ctx d;                                                    \
+    ptype##_affine_buckets b;                                                  \
+                                                                               \
+    ptype##_affine_buckets_init(&b, scratch, window, cbits);                   \
+    pippenger_digits_init(&d, nbits, bit0, wbits, cbits);                      \
+    for (i = 0; i < npoints; i++)                                              \
+      ptype##_affine_bucket(&b, pippenger_digit(&d, scalars, digits, i),       \
+                            cbits, points + i);                                \
+    ptype##_affine_buckets_integrate(ret, &b, cbits);                          \
+  }                                                                            \
+                                                                               \
+  void prefix##s_mult_pippenger_affine_cont(                                   \
+      ptype *ret, const ptype##_affine points[], size_t npoints,               \
+      const byte scalars[], size_t nbits, limb_t scratch[], size_t window) {   \
+    size_t i, wbits, cbits, bit0 = nbits;                                      \
+    ptype tile[1];                                                             \
+                                                                               \
+    vec_zero(ret, sizeof(*ret));                                               \
+    /* top excess bits modulo target window size */                            \
+    wbits = nbits % window; /* yes, it may be zero */                          \
+    cbits = wbits + 1;                                                         \
+    while (bit0 -= wbits) {                                                    \
+      ptype##s_tile_pippenger_affine_cont(tile, points, npoints, scalars,      \
+                                          NULL, nbits, scratch, bit0, window,  \
+                                          wbits, cbits);                       \
+      ptype##_dadd(ret, ret, tile, NULL);                                      \
+      for (i = 0; i < window; i++)                                             \
+        ptype##_double(ret, ret);                                              \
+      cbits = wbits = window;                                                  \
+    }                                                                          \
+    ptype##s_tile_pippenger_affine_cont(tile, points, npoints, scalars, NULL,  \
+                                        nbits, scratch, 0, window, wbits,      \
+                                        cbits);                                \
+    ptype##_dadd(ret, ret, tile, NULL);                                        \
+  }                                                                            \
+                                                                               \
+  /* Same than prefix##s_tile_pippenger_cont */                                \
+  void prefix##s_tile_pippenger_affine_cont(                                   \
+      ptype *ret, const ptype##_affine points[], size_t npoints,               \
+      const byte scalars[], size_t nbits, limb_t scratch[], size_t bit0,       \
+      size_t window) {                                                         \
+    size_t wbits, cbits;                                                       \
+                                                                               \
+    pippenger_tile_bits(nbits, bit0, window, &wbits, &cbits);                  \
+    ptype##s_tile_pippenger_affine_cont(ret, points, npoints, scalars, NULL,   \
+                                        nbits, scratch, bit0, window, wbits,   \
+                                        cbits);                                \
+  }                                                                            \
+                                                                               \
+  /* Same than prefix##s_tile_pippenger_digits */                              \
+  void prefix##s_tile_pippenger_affine_digits(                                 \
+      ptype *ret, const ptype##_affine points[], size_t npoints,               \
+      const unsigned int digits[], size_t nbits, limb_t scratch[],             \
+      size_t bit0, size_t window) {                                            \
+    size_t wbits, cbits;                                                       \
+                                                                               \
+    pippenger_tile_bits(nbits, bit0, window, &wbits, &cbits);                  \
+    ptype##s_tile_pippenger_affine_cont(ret, points, npoints, NULL, digits,    \
+                                        nbits, scratch, bit0, window, wbits,   \
+                                        cbits);                                \
+  }                                                                            \
+                                                                               \
+  size_t prefix##s_mult_pippenger_affine_multi_scratch_sizeof(                 \
+      size_t window, size_t nvectors) {                                        \
+    size_t area = prefix##s_mult_pippenger_affine_scratch_sizeof(window);      \
+    return (nvectors * (sizeof(ptype##_affine_buckets) + area));               \
+  }                                                                            \
+                                                                               \
+  /* Tiles of nvectors MSMs over the same points, ret[j] being the tile of the \
+     vector scalars[j]. The points are bucketed by blocks, for each vector in  \
+     turn: the block is loaded once and the digits share the same offsets. */  \
+  void prefix##s_tile_pippenger_affine_multi(                                  \
+      ptype ret[], const ptype##_affine points[], size_t npoints,              \
+      const byte *const scalars[], size_t nvectors, size_t nbits,              \
+      limb_t scratch[], size_t bit0, size_t window) {                          \
+    size_t i, j, i0, i1, wbits, cbits;                                         \
+    size_t stride = prefix##s_mult_pippenger_affine_scratch_sizeof(window) /   \
+                    sizeof(limb_t);                                            \
+    pippenger_digits_ctx d;                                                    \
+    ptype##_affine_buckets *b = (ptype##_affine_buckets *)scratch;             \
+    limb_t *areas = (limb_t *)(b + nvectors);                                  \
+                                                                               \
+    pippenger_tile_bits(nbits, bit0, window, &wbits, &cbits);                  \
+    pippenger_digits_init(&d, nbits, bit0, wbits, cbits);                      \
+    for (j = 0; j < nvectors; j++)                                             \
+      ptype##_affine_buckets_init(&b[j], areas + j * stride, window, cbits);   \
+    for (i0 = 0; i0 < npoints; i0 = i1) {                                      \
+      i1 = npoints - i0 < PIPPENGER_MULTI_BLOCK_SIZE                           \
+               ? npoints                                                       \
+               : i0 + PIPPENGER_MULTI_BLOCK_SIZE;                              \
+      for (j = 0; j < nvectors; j++)                                           \
+        for (i = i0; i < i1; i++)                                              \
+          ptype##_affine_bucket(&b[j],                                         \
+                                pippenger_digit(&d, scalars[j], NULL, i),      \
+                                cbits, points + i);                            \
+    }                                                                          \
+    for (j = 0; j < nvectors; j++)                                             \
+      ptype##_affine_buckets_integrate(&ret[j], &b[j], cbits);                 \
+  }
+
+POINTS_MULT_PIPPENGER_AFFINE_IMPL(blst_p1, POINTonE1, 384, fp, BLS12_381_Rx.p)
+POINTS_MULT_PIPPENGER_AFFINE_IMPL(blst_p2, POINTonE2, 384x, fp2,
+                                  BLS12_381_Rx.p2)
+
+// GLV and GLS decompositions of a scalar k smaller than 2^255, in place. For
+// G1, k = k0 + k1 z^2 with k0 and k1 on 128 bits, z being the parameter of
+// the curve. For G2, k = k0 + k1 |z| + k2 |z|^2 + k3 |z|^3 with the digits on
+// 64 bits. The digits are encoded in little endian one after the other, i.e.
+// as 2 (resp. 4) scalars of 128 (resp. 64) bits.
+void blst_scalar_split_glv(byte out[32], const byte scalar[32]) {
+  vec256 val;
+
+  limbs_from_le_bytes(val, scalar, 32);
+  div_by_zz(val);
+  le_bytes_from_limbs(out, val, 32);
+}
+
+void blst_scalar_split_gls(byte out[32], const byte scalar[32]) {
+  vec256 val;
+
+  limbs_from_le_bytes(val, scalar, 32);
+  div_by_zz(val);
+  div_by_z(val);
+  div_by_z(val + NLIMBS(256) / 2);
+  le_bytes_from_limbs(out, val, 32);
+}
+
+// out[0] = p and out[1] = (beta^2 x, -y), on which the multiplication by k1
+// acts as the multiplication of p by k1 z^2, see blst_scalar_split_glv. The
+// point at infinity, encoded as (0, 0), is its own image.
+void blst_p1_affine_glv_images(POINTonE1_affine out[2],
+                               const POINTonE1_affine *p) {
+  POINTonE1_affine q;
+
+  mul_fp(q.X, p->X, beta);
+  mul_fp(q.X, q.X, beta);
+  cneg_fp(q.Y, p->Y, 1);
+  vec_copy(&out[0], p, sizeof(out[0]));
+  vec_copy(&out[1], &q, sizeof(out[1]));
+}
+
+// out[i] = (-1)^i psi^i(p), on which the multiplication by ki acts as the
+// multiplication of p by ki |z|^i, see blst_scalar_split_gls. The point at
+// infinity, encoded as (0, 0), is its own image.
+void blst_p2_affine_gls_images(POINTonE2_affine out[4],
+                               const POINTonE2_affine *p) {
+  POINTonE2 q[4];
+  size_t i;
+
+  vec_copy(q[0].X, p->X, 2 * sizeof(q[0].X));
+  vec_copy(q[0].Z, BLS12_381_Rx.p2, sizeof(q[0].Z));
+  for (i = 1; i < 4; i++)
+    psi(&q[i], &q[i - 1]);
+  for (i = 0; i < 4; i++) {
+    cneg_fp2(q[i].Y, q[i].Y, i & 1);
+    vec_copy(&out[i], &q[i], sizeof(out[i]));
+  }
+}
+
+// Same with jacobian coordinates, the point at infinity having Z = 0
+static void POINTonE1_glv_images(POINTonE1 out[2], const POINTonE1 *p) {
+  vec_copy(&out[0], p, sizeof(out[0]));
+  mul_fp(out[1].X, p->X, beta);
+  mul_fp(out[1].X, out[1].X, beta);
+  cneg_fp(out[1].Y, p->Y, 1);
+  vec_copy(out[1].Z, p->Z, sizeof(out[1].Z));
+}
+
+static void POINTonE2_gls_images(POINTonE2 out[4], const POINTonE2 *p) {
+  size_t i;
+
+  vec_copy(&out[0], p, sizeof(out[0]));
+  for (i = 1; i < 4; i++)
+    psi(&out[i], &out[i - 1]);
+  for (i = 1; i < 4; i += 2)
+    cneg_fp2(out[i].Y, out[i].Y, 1);
+}
+
+// Variable time linear combination of points with scalars smaller than 2^255,
+// with Straus' algorithm on the GLV (resp. GLS) images of the points and the
+// digits of the scalars: the doublings are shared by all the points and cover
+// 128 (resp. 64) bits only. The tables are built from the jacobian coordinates
+// of the images, with one inversion. The scalars are encoded on 32 bytes each.
+// NOT constant time: for public scalars only.
+size_t blst_p1s_mult_vartime_scratch_sizeof(size_t npoints) {
+  return (npoints * (2 * sizeof(POINTonE1) + 32) +
+          blst_p1s_mult_straus_scratch_sizeof(2 * npoints, 128));
+}
+
+void blst_p1s_mult_vartime(POINTonE1 *ret, const POINTonE1 points[],
+                           size_t npoints, const byte scalars[],
+                           limb_t scratch[]) {
+  POINTonE1 *images = (POINTonE1 *)scratch;
+  byte *digits = (byte *)(images + 2 * npoints);
+  size_t i;
+
+  for (i = 0; i < npoints; i++) {
+    POINTonE1_glv_images(images + 2 * i, &points[i]);
+    blst_scalar_split_glv(digits + 32 * i, scalars + 32 * i);
+  }
+  POINTonE1s_straus_groups(ret, NULL, images, 1, 2 * npoints, digits, 128,
+                           (limb_t *)(digits + 32 * npoints));
+}
+
+size_t blst_p2s_mult_vartime_scratch_sizeof(size_t npoints) {
+  return (npoints * (4 * sizeof(POINTonE2) + 32) +
+          blst_p2s_mult_straus_scratch_sizeof(4 * npoints, 64));
+}
+
+void blst_p2s_mult_vartime(POINTonE2 *ret, const POINTonE2 points[],
+                           size_t npoints, const byte scalars[],
+                           limb_t scratch[]) {
+  POINTonE2 *images = (POINTonE2 *)scratch;
+  byte *digits = (byte *)(images + 4 * npoints);
+  size_t i;
+
+  for (i = 0; i < npoints; i++) {
+    POINTonE2_gls_images(images + 4 * i, &points[i]);
+    blst_scalar_split_gls(digits + 32 * i, scalars + 32 * i);
+  }
+  POINTonE2s_straus_groups(ret, NULL, images, 1, 4 * npoints, digits, 64,
+                           (limb_t *)(digits + 32 * npoints));
+}
+
+// Prepared points: the multiples 1, ..., 2^(window - 1) of the GLV (resp.
+// GLS) images of a point, in affine coordinates, i.e. 2 (resp. 4)
+// 2^(window - 1) affine points, row i of the table for the image i. A
+// multiplication splits the scalar in digits of 128 (resp. 64) bits and adds
+// one row entry per Booth window of each digit, with 128 (resp. 64)
+// doublings, without rebuilding the table as blst_p1_mult does. Constant time
+// in the scalar: the rows are scanned entirely and the additions are
+// complete.
+#define PREPARED_IMPL(prefix, ptype, field, ndigits, split, images)            \
+  size_t prefix##_prepared_sizeof(size_t window) {                             \
+    return ((ndigits * sizeof(ptype##_affine)) << (window - 1));               \
+  }                                                                            \
+                                                                               \
+  size_t prefix##_prepared_scratch_sizeof(size_t window) {                     \
+    return ((ndigits * sizeof(ptype)) << (window - 1));                        \
+  }                                                                            \
+                                                                               \
+  void prefix##_prepare(ptype##_affine table[], const ptype *point,            \
+                        size_t window, limb_t scratch[]) {                     \
+    size_t m = (size_t)1 << (window - 1), i, k;                                \
+    ptype *rows = (ptype *)scratch, q[ndigits];                                \
+    const ptype *ptrs[2] = {rows, NULL};                                       \
+                                                                               \
+    if (vec_is_zero(point->Z, sizeof(point->Z))) {                             \
+      vec_zero(table, ndigits * m * sizeof(table[0]));                         \
+      return;                                                                  \
+    }                                                                          \
+    images(q, point);                                                          \
+    for (i = 0; i < ndigits; i++) {                                            \
+      /* rows[i m + k] = (k + 1) q[i] */                                       \
+      vec_copy(&rows[i * m], &q[i], sizeof(q[i]));                             \
+      for (k = 1; k < m; k++)                                                  \
+        ptype##_dadd(&rows[i * m + k], &rows[i * m + k - 1], &q[i], NULL);     \
+    }                                                                          \
+    ptype##s_to_affine(table, ptrs, ndigits * m);                              \
+  }                                                                            \
+                                                                               \
+  void prefix##_mult_prepared(ptype *ret, const ptype##_affine table[],        \
+                              const byte scalar[32], size_t window) {          \
+    size_t dbits = 256 / ndigits, nwindows = dbits / window + 1;               \
+    size_t m = (size_t)1 << (window - 1), i, j, k;                             \
+    limb_t wmask = ((limb_t)1 << (window + 1)) - 1, wval, idx;                 \
+    bool_t sign;                                                               \
+    byte digits[32];                                                           \
+    /* Each digit with room for the bits read above it by get_wval_limb */     \
+    byte padded[ndigits][256 / ndigits / 8 + 8];                               \
+    ptype##_affine sel[1];                                                     \
+                                                                               \
+    split(digits, scalar);                                                     \
+    vec_zero(padded, sizeof(padded));                                          \
+    for (i = 0; i < ndigits; i++)                                              \
+      for (k = 0; k < dbits / 8; k++)                                          \
+        padded[i][k] = digits[i * dbits / 8 + k];                              \
+    vec_zero(ret, sizeof(*ret));                                               \
+    for (j = nwindows; j--;) {                                                 \
+      for (k = 0; j + 1 < nwindows && k < window; k++)                         \
+        ptype##_double(ret, ret);                                              \
+      for (i = 0; i < ndigits; i++) {                                          \
+        if (j == 0)                                                            \
+          wval = (get_wval_limb(padded[i], 0, window) << 1) & wmask;           \
+        else                                                                   \
+          wval = get_wval_limb(padded[i], j * window - 1, window + 1) & wmask; \
+        wval = booth_encode(wval, window);                                     \
+        sign = (wval >> window) & 1;                                           \
+        idx = wval & (((limb_t)1 << window) - 1);                              \
+        /* Constant time lookup, the zero digit selecting the infinity */      \
+        vec_zero(sel, sizeof(sel));                                            \
+        for (k = 0; k < m; k++)                                                \
+          vec_select(sel, &table[i * m + k], sel, sizeof(sel),                 \
+                     is_zero(idx ^ (k + 1)));                                  \
+        cneg_##field(sel->Y, sel->Y, sign);                                    \
+        ptype##_dadd_affine(ret, ret, sel);                                    \
+      }                                                                        \
+    }                                                                          \
+  }
+
+PREPARED_IMPL(blst_p1, POINTonE1, fp, 2, blst_scalar_split_glv,
+              POINTonE1_glv_images)
+PREPARED_IMPL(blst_p2, POINTonE2, fp2, 4, blst_scalar_split_gls,
+              POINTonE2_gls_images)
@@ -10,6 +10,8 @@ bool blst_fr_is_one(const blst_fr *a);
 bool blst_fr_is_equal(const blst_fr *a, const blst_fr *b);
 void blst_fr_set_to_zero(blst_fr *a);
 void blst_fr_set_to_one(blst_fr *a);
+bool blst_fr_is_reduced(const blst_fr *a);
+bool blst_fp_is_reduced(const blst_fp *a);
 
 void blst_p1s_mult_pippenger_cont(blst_p1 *ret, const blst_p1_affine points[],
                                   size_t npoints, const byte scalars[],
@@ -19,4 +21,214 @@ void blst_p2s_mult_pippenger_cont(blst_p2 *ret, const blst_p2_affine points[],
                                   size_t npoints, const byte scalars[],
                                   size_t nbits, limb_t *scratch);
 
+void blst_p1s_mult_pippenger_cont_window(blst_p1 *ret,
+                                         const blst_p1_affine points[],
+                                         size_t npoints, const byte scalars[],
+                                         size_t nbits, limb_t *scratch,
+                                         size_t window);
+
+void blst_p2s_mult_pippenger_cont_window(blst_p2 *ret,
+                                         const blst_p2_affine points[],
+                                         size_t npoints, const byte scalars[],
+                                         size_t nbits, limb_t *scratch,
+                                         size_t window);
+
+void blst_p1s_tile_pippenger_cont(blst_p1 *ret, const blst_p1_affine points[],
+                                  size_t npoints, const byte scalars[],
+                                  size_t nbits, limb_t *scratch, size_t bit0,
+                                  size_t window);
+
+void blst_p2s_tile_pippenger_cont(blst_p2 *ret, const blst_p2_affine points[],
+                                  size_t npoints, const byte scalars[],
+                                  size_t nbits, limb_t *scratch, size_t bit0,
+                                  size_t window);
+
+size_t blst_pippenger_window_size(size_t npoints);
+
+size_t blst_p1s_mult_pippenger_stream_sizeof(size_t nbits, size_t window);
+
+void blst_p1s_mult_pippenger_stream_add(limb_t *buckets,
+                                        const blst_p1_affine points[],
+                                        size_t npoints, const byte scalars[],
+                                        size_t nbits, size_t window, size_t y);
+
+void blst_p1s_mult_pippenger_stream_integrate(blst_p1 *ret, limb_t *buckets,
+                                              size_t nbits, size_t window,
+                                              size_t y);
+
+size_t blst_p2s_mult_pippenger_stream_sizeof(size_t nbits, size_t window);
+
+void blst_p2s_mult_pippenger_stream_add(limb_t *buckets,
+                                        const blst_p2_affine points[],
+                                        size_t npoints, const byte scalars[],
+                                        size_t nbits, size_t window, size_t y);
+
+void blst_p2s_mult_pippenger_stream_integrate(blst_p2 *ret, limb_t *buckets,
+                                              size_t nbits, size_t window,
+                                              size_t y);
+
+size_t blst_straus_window_size(size_t nbits);
+
+size_t blst_p1s_mult_straus_scratch_sizeof(size_t npoints, size_t nbits);
+
+void blst_p1s_mult_straus(blst_p1 *ret, const blst_p1_affine points[],
+                          size_t npoints, const byte scalars[], size_t nbits,
+                          limb_t *scratch);
+
+void blst_p1s_mult_straus_groups(blst_p1 ret[], const blst_p1_affine points[],
+                                 size_t ngroups, size_t group_size,
+                                 const byte scalars[], size_t nbits,
+                                 limb_t *scratch);
+
+size_t blst_p2s_mult_straus_scratch_sizeof(size_t npoints, size_t nbits);
+
+void blst_p2s_mult_straus(blst_p2 *ret, const blst_p2_affine points[],
+                          size_t npoints, const byte scalars[], size_t nbits,
+                          limb_t *scratch);
+
+void blst_p2s_mult_straus_groups(blst_p2 ret[], const blst_p2_affine points[],
+                                 size_t ngroups, size_t group_size,
+                                 const byte scalars[], size_t nbits,
+                                 limb_t *scratch);
+
+void blst_pippenger_booth_digits(unsigned int digits[], const byte scalars[],
+                                 size_t npoints, size_t nbits, size_t bit0,
+                                 size_t window);
+
+void blst_p1s_tile_pippenger_digits(blst_p1 *ret, const blst_p1_affine points[],
+                                    size_t npoints, const unsigned int digits[],
+                                    size_t nbits, limb_t *scratch, size_t bit0,
+                                    size_t window);
+
+void blst_p2s_tile_pippenger_digits(blst_p2 *ret, const blst_p2_affine points[],
+                                    size_t npoints, const unsigned int digits[],
+                                    size_t nbits, limb_t *scratch, size_t bit0,
+                                    size_t window);
+
+size_t blst_p1s_mult_pippenger_affine_scratch_sizeof(size_t window);
+
+void blst_p1s_mult_pippenger_affine_cont(blst_p1 *ret,
+                                         const blst_p1_affine points[],
+                                         size_t npoints, const byte scalars[],
+                                         size_t nbits, limb_t *scratch,
+                                         size_t window);
+
+void blst_p1s_tile_pippenger_affine_cont(blst_p1 *ret,
+                                         const blst_p1_affine points[],
+                                         size_t npoints, const byte scalars[],
+                                         size_t nbits, limb_t *scratch,
+                                         size_t bit0, size_t window);
+
+void blst_p1s_tile_pippenger_affine_digits(blst_p1 *ret,
+                                           const blst_p1_affine points[],
+                                           size_t npoints,
+                                           const unsigned int digits[],
+                                           size_t nbits, limb_t *scratch,
+                                           size_t bit0, size_t window);
+
+size_t blst_p1s_mult_pippenger_affine_multi_scratch_sizeof(size_t window,
+                                                           size_t nvectors);
+
+void blst_p1s_tile_pippenger_affine_multi(blst_p1 ret[],
+                                          const blst_p1_affine points[],
+                                          size_t npoints,
+                                          const byte *const scalars[],
+                                          size_t nvectors, size_t nbits,
+                                          limb_t *scratch, size_t bit0,
+                                          size_t window);
+
+size_t blst_p2s_mult_pippenger_affine_scratch_sizeof(size_t window);
+
+void blst_p2s_mult_pippenger_affine_cont(blst_p2 *ret,
+                                         const blst_p2_affine points[],
+                                         size_t npoints, const byte scalars[],
+                                         size_t nbits, limb_t *scratch,
+                                         size_t window);
+
+void blst_p2s_tile_pippenger_affine_cont(blst_p2 *ret,
+                                         const blst_p2_affine points[],
+                                         size_t npoints, const byte scalars[],
+                                         size_t nbits, limb_t *scratch,
+                                         size_t bit0, size_t window);
+
+void blst_p2s_tile_pippenger_affine_digits(blst_p2 *ret,
+                                           const blst_p2_affine points[],
+                                           size_t npoints,
+                                           const unsigned int digits[],
+                                           size_t nbits, limb_t *scratch,
+                                           size_t bit0, size_t window);
+
+size_t blst_p2s_mult_pippenger_affine_multi_scratch_sizeof(size_t window,
+                                                           size_t nvectors);
+
+void blst_p2s_tile_pippenger_affine_multi(blst_p2 ret[],
+                                          const blst_p2_affine points[],
+                                          size_t npoints,
+                                          const byte *const scalars[],
+                                          size_t nvectors, size_t nbits,
+                                          limb_t *scratch, size_t bit0,
+                                          size_t window);
+
+size_t blst_p1_fixed_base_table_sizeof(size_t nbits, size_t window);
+
+size_t blst_p1_fixed_base_scratch_sizeof(size_t window);
+
+void blst_p1_fixed_base_table(blst_p1_affine table[], const blst_p1 *point,
+                               size_t nbits, size_t window, limb_t *scratch);
+
+void blst_p1_mult_fixed_base(blst_p1 *ret, const blst_p1_affine table[],
+                              const byte scalar[], size_t nbits,
+                              size_t window);
+
+size_t blst_p2_fixed_base_table_sizeof(size_t nbits, size_t window);
+
+size_t blst_p2_fixed_base_scratch_sizeof(size_t window);
+
+void blst_p2_fixed_base_table(blst_p2_affine table[], const blst_p2 *point,
+                               size_t nbits, size_t window, limb_t *scratch);
+
+void blst_p2_mult_fixed_base(blst_p2 *ret, const blst_p2_affine table[],
+                              const byte scalar[], size_t nbits,
+                              size_t window);
+
+void blst_scalar_split_glv(byte out[32], const byte scalar[32]);
+
+void blst_scalar_split_gls(byte out[32], const byte scalar[32]);
+
+void blst_p1_affine_glv_images(blst_p1_affine out[2], const blst_p1_affine *p);
+
+void blst_p2_affine_gls_images(blst_p2_affine out[4], const blst_p2_affine *p);
+
+size_t blst_p1s_mult_vartime_scratch_sizeof(size_t npoints);
+
+void blst_p1s_mult_vartime(blst_p1 *ret, const blst_p1 points[],
+                           size_t npoints, const byte scalars[],
+                           limb_t *scratch);
+
+size_t blst_p2s_mult_vartime_scratch_sizeof(size_t npoints);
+
+void blst_p2s_mult_vartime(blst_p2 *ret, const blst_p2 points[],
+                           size_t npoints, const byte scalars[],
+                           limb_t *scratch);
+
+size_t blst_p1_prepared_sizeof(size_t window);
+
+size_t blst_p1_prepared_scratch_sizeof(size_t window);
+
+void blst_p1_prepare(blst_p1_affine table[], const blst_p1 *point,
+                      size_t window, limb_t *scratch);
+
+void blst_p1_mult_prepared(blst_p1 *ret, const blst_p1_affine table[],
+                            const byte scalar[32], size_t window);
+
+size_t blst_p2_prepared_sizeof(size_t window);
+
+size_t blst_p2_prepared_scratch_sizeof(size_t window);
+
+void blst_p2_prepare(blst_p2_affine table[], const blst_p2 *point,
+                      size_t window, limb_t *scratch);
+
+void blst_p2_mult_prepared(blst_p2 *ret, const blst_p2_affine table[],
+                            const byte scalar[32], size_t window);
+
 #endif
@@ -0,0 +1,182 @@
+#include "caml_bls12_381_parallel.h"
+#include <caml/alloc.h>
+#include <caml/memory.h>
+#include <caml/mlvalues.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define CAML_BLS12_381_MAX_NB_THREADS 256
+
+static size_t nb_threads = 1;
+
+// Set in the workers and in the calling thread during
+// caml_bls12_381_parallel_for to make nested calls sequential
+static __thread int in_parallel_for = 0;
+
+// 0 in the calling threads, k + 1 in the worker k
+static __thread size_t worker_index = 0;
+
+size_t caml_bls12_381_get_nb_threads(void) { return (nb_threads); }
+
+size_t caml_bls12_381_parallel_worker_index(void) { return (worker_index); }
+
+void caml_bls12_381_set_nb_threads(size_t n) {
+  if (n < 1)
+    n = 1;
+  if (n > CAML_BLS12_381_MAX_NB_THREADS)
+    n = CAML_BLS12_381_MAX_NB_THREADS;
+  nb_threads = n;
+}
+
+// The tasks are run by a pool of workers created at the first call needing
+// them and kept afterwards, as creating and joining the threads at each call
+// costs more than the small parallel calls of the library. The pool grows up
+// to the number of threads minus one, the calling thread taking part in the
+// computation. The workers beyond the current number of threads stay idle.
+// The callers are serialised with pool.lock, i.e. two OCaml threads calling
+// the parallel kernels share the pool instead of oversubscribing the cores.
+typedef struct {
+  pthread_mutex_t lock;
+  // Protects the fields below
+  pthread_mutex_t mutex;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  size_t nb_workers;
+  // Incremented for each job, the workers wait for a new value
+  size_t generation;
+  // The workers of index smaller than nb_active take part in the job.
+  // nb_running of them are running tasks. Once all the tasks are claimed, the
+  // job is closed and the workers waking up late skip it, so that the caller
+  // only waits for the ones still running a task.
+  size_t nb_active;
+  size_t nb_running;
+  int closed;
+  size_t n;
+  size_t next;
+  void (*f)(size_t, void *);
+  void *arg;
+  // Generation when the worker k was created, i.e. before the job it is
+  // created for. The worker may start after the job is posted.
+  size_t created_at[CAML_BLS12_381_MAX_NB_THREADS];
+} parallel_pool;
+
+static parallel_pool pool = {.lock = PTHREAD_MUTEX_INITIALIZER,
+                             .mutex = PTHREAD_MUTEX_INITIALIZER,
+                             .start = PTHREAD_COND_INITIALIZER,
+                             .done = PTHREAD_COND_INITIALIZER};
+
+static pthread_once_t pool_atfork_once = PTHREAD_ONCE_INIT;
+
+static void run_tasks(void) {
+  size_t i;
+  while ((i = __atomic_fetch_add(&pool.next, 1, __ATOMIC_RELAXED)) < pool.n)
+    pool.f(i, pool.arg);
+}
+
+static void *parallel_for_worker(void *p) {
+  size_t k = (size_t)p;
+  size_t generation;
+  in_parallel_for = 1;
+  worker_index = k + 1;
+  pthread_mutex_lock(&pool.mutex);
+  generation = pool.created_at[k];
+  for (;;) {
+    while (pool.generation == generation)
+      pthread_cond_wait(&pool.start, &pool.mutex);
+    generation = pool.generation;
+    if (k >= pool.nb_active || pool.closed)
+      continue;
+    pool.nb_running++;
+    pthread_mutex_unlock(&pool.mutex);
+    run_tasks();
+    pthread_mutex_lock(&pool.mutex);
+    if (--pool.nb_running == 0)
+      pthread_cond_signal(&pool.done);
+  }
+  return (NULL);
+}
+
+// The workers do not exist in a child process after fork
+static void pool_atfork_child(void) {
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_mutex_init(&pool.mutex, NULL);
+  pthread_cond_init(&pool.start, NULL);
+  pthread_cond_init(&pool.done, NULL);
+  pool.nb_workers = 0;
+}
+
+static void pool_register_atfork(void) {
+  pthread_atfork(NULL, NULL, pool_atfork_child);
+}
+
+// Called with pool.lock held. Returns the number of workers available, which
+// is smaller than n if a thread can not be created.
+static size_t pool_ensure_workers(size_t n) {
+  pthread_t thread;
+  pthread_once(&pool_atfork_once, pool_register_atfork);
+  while (pool.nb_workers < n) {
+    pool.created_at[pool.nb_workers] = pool.generation;
+    if (pthread_create(&thread, NULL, parallel_for_worker,
+                       (void *)pool.nb_workers))
+      break;
+    pthread_detach(thread);
+    pool.nb_workers++;
+  }
+  return (pool.nb_workers < n ? pool.nb_workers : n);
+}
+
+void caml_bls12_381_parallel_for(size_t n, void (*f)(size_t i, void *arg),
+                                 void *arg) {
+  size_t nb_workers = nb_threads < n ? nb_threads : n;
+  if (nb_workers <= 1 || in_parallel_for) {
+    for (size_t i = 0; i < n; i++)
+      f(i, arg);
+    return;
+  }
+
+  pthread_mutex_lock(&pool.lock);
+  size_t nb_active = pool_ensure_workers(nb_workers - 1);
+  pthread_mutex_lock(&pool.mutex);
+  pool.n = n;
+  pool.next = 0;
+  pool.f = f;
+  pool.arg = arg;
+  pool.nb_active = nb_active;
+  pool.nb_running = 0;
+  pool.closed = 0;
+  pool.generation++;
+  pthread_cond_broadcast(&pool.start);
+  pthread_mutex_unlock(&pool.mutex);
+
+  in_parallel_for = 1;
+  run_tasks();
+  in_parallel_for = 0;
+
+  pthread_mutex_lock(&pool.mutex);
+  pool.closed = 1;
+  while (pool.nb_running > 0)
+    pthread_cond_wait(&pool.done, &pool.mutex);
+  pthread_mutex_unlock(&pool.mutex);
+  pthread_mutex_unlock(&pool.lock);
+}
+
+CAMLprim value caml_bls12_381_set_nb_threads_stubs(value n) {
+  CAMLparam1(n);
+  caml_bls12_381_set_nb_threads(Int_val(n) < 1 ? 1 : Int_val(n));
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_bls12_381_get_nb_threads_stubs(value unit) {
+  CAMLparam1(unit);
+  CAMLreturn(Val_int(caml_bls12_381_get_nb_threads()));
+}
+
+// Monotonic clock in seconds, used to calibrate the parameters of the
+// kernels. The library does not depend on unix.
+CAMLprim value caml_bls12_381_monotonic_time_stubs(value unit) {
+  CAMLparam1(unit);
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  CAMLreturn(caml_copy_double((double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec));
+}
@@ -0,0 +1,29 @@
+#ifndef CAML_BLS12_381_PARALLEL
+#define CAML_BLS12_381_PARALLEL
+
+#include <stddef.h>
+
+// Number of threads used by the parallel kernels, including the calling
+// thread. Default is 1, i.e. the kernels are sequential.
+size_t caml_bls12_381_get_nb_threads(void);
+
+void caml_bls12_381_set_nb_threads(size_t nb_threads);
+
+// Call f(i, arg) for each i in [0, n) using at most
+// caml_bls12_381_get_nb_threads() threads. The calling thread takes part in
+// the computation and the function returns when all the tasks are done. The
+// other threads are the workers of a pool created on demand and reused by the
+// next calls. If a thread can not be created, the remaining tasks are
+// performed by the other ones. Nested calls from a task are sequential, and
+// concurrent calls from different threads wait for each other.
+// The tasks must not call the OCaml runtime.
+void caml_bls12_381_parallel_for(size_t n, void (*f)(size_t i, void *arg),
+                                 void *arg);
+
+// Index of the thread running a task of caml_bls12_381_parallel_for, smaller
+// than the number of threads of the call: 0 for the calling thread and
+// 1, 2, ... for the workers of the pool. The threads running the tasks of one
+// call have different indexes, e.g. to give each one its own scratch.
+size_t caml_bls12_381_parallel_worker_index(void);
+
+#endif
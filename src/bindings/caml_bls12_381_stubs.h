@@ -20,14 +20,22 @@ static int caml_blst_fr_compare(value x, value y) {
   return (blst_fr_compare(x_c, y_c));
 }
 
+// Defined in blst_bindings_stubs.c
+void caml_blst_fr_serialize(value v, uintnat *bsize_32, uintnat *bsize_64);
+
+uintnat caml_blst_fr_deserialize(void *dst);
+
+static const struct custom_fixed_length blst_fr_fixed_length = {
+    sizeof(blst_fr), sizeof(blst_fr)};
+
 static struct custom_operations blst_fr_ops = {"blst_fr",
                                                custom_finalize_default,
                                                caml_blst_fr_compare,
                                                custom_hash_default,
-                                               custom_serialize_default,
-                                               custom_deserialize_default,
+                                               caml_blst_fr_serialize,
+                                               caml_blst_fr_deserialize,
                                                custom_compare_ext_default,
-                                               custom_fixed_length_default};
+                                               &blst_fr_fixed_length};
 
 #define Blst_scalar_val(v) ((blst_scalar *)Data_custom_val(v))
 
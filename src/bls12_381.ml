@@ -113,6 +113,10 @@ module type CURVE = sig
 
   val add_bulk : t list -> t
 
+  val add_bulk_array : t array -> t
+
+  val add_bulk_affine_array : ?start:int -> ?len:int -> affine_array -> t
+
   (** [double g] returns [2g] *)
   val double : t -> t
 
@@ -122,11 +126,41 @@ module type CURVE = sig
   (** Return [true] if the two elements are algebraically the same *)
   val eq : t -> t -> bool
 
+  (** Alias of {!eq}. Together with {!hash}, it allows to use the module as the
+      argument of [Hashtbl.Make]. *)
+  val equal : t -> t -> bool
+
+  (** [hash p] returns a hash of the compressed affine encoding of [p]. Two
+      points that are algebraically equal have the same hash, whatever their
+      jacobian representation. [Hashtbl.hash] on values of type [t] and
+      [affine] follows the same semantics, except with the JavaScript
+      backend. *)
+  val hash : t -> int
+
+  (** [compare a b] returns [0] if [a] and [b] are algebraically equal (no field
+      inversion is involved in this case), otherwise compares the compressed
+      affine encodings. The polymorphic [compare] follows the same semantics. *)
+  val compare : t -> t -> int
+
+  (** [normalize_inplace p] rewrites the jacobian coordinates of [p] to have [Z
+      = 1], without changing the point algebraically. The following calls to
+      {!hash}, {!compare}, {!to_bytes} and {!to_compressed_bytes} on [p] do not
+      require a field inversion anymore. It is recommended to call it once on
+      long-living points, for instance keys of a hash table. *)
+  val normalize_inplace : t -> unit
+
   (** Multiply an element by a scalar *)
   val mul : t -> Scalar.t -> t
 
   val mul_inplace : t -> Scalar.t -> unit
 
+  (** [mul_vartime g x] returns the same point as {!mul} in variable time,
+      using the endomorphism of the curve (GLV for G1, GLS for G2) and a wNAF
+      recoding of the scalar with precomputed odd multiples. The running time
+      depends on [x]: use it only for public scalars, e.g. the challenges of a
+      verifier, never for secrets. *)
+  val mul_vartime : t -> Scalar.t -> t
+
   (** [fft ~domain ~points] performs a Fourier transform on [points] using
       [domain] The domain should be of the form [w^{i}] where [w] is a principal
       root of unity. If the domain is of size [n], [w] must be a [n]-th
@@ -173,7 +207,15 @@ module type CURVE = sig
       convert the points [pts] in affine coordinates as values of type [t] are
       in jacobian coordinates.
 
-      {b Warning.} Undefined behavior if the point to infinity is in the array *)
+      The zero scalars are skipped, the points multiplied by [1] or [-1] are
+      summed with batched affine additions, and Pippenger's algorithm only runs
+      over the bit length of the largest other scalar, e.g. for selectors,
+      boolean witnesses or 128 bits challenges. Up to {!get_straus_threshold}
+      remaining points, Straus' algorithm (interleaved wNAF) is used instead of
+      Pippenger's.
+
+      The points at infinity are supported and contribute nothing to the
+      sum. *)
   val pippenger : ?start:int -> ?len:int -> t array -> Scalar.t array -> t
 
   (** [pippenger_with_affine_array ?start ?len pts scalars] computes the multi
@@ -197,9 +239,471 @@ module type CURVE = sig
 
       Perform allocations on the C heap to convert scalars to bytes.
 
-      {b Warning.} Undefined behavior if the point to infinity is in the array *)
+      The scalars are handled as in {!pippenger}: the zero, [1] and [-1]
+      scalars and the short ones do not run Pippenger's algorithm on all the
+      bits. The points at infinity are supported and contribute nothing to the
+      sum. *)
   val pippenger_with_affine_array :
     ?start:int -> ?len:int -> affine_array -> Scalar.t array -> t
+
+  (** [set_straus_threshold ~nbits n] sets to [n] the number of points up to
+      which the MSMs of scalars of at most [nbits] bits use Straus' algorithm
+      (interleaved wNAF) instead of Pippenger's, e.g. to calibrate the
+      crossover for the machine. [nbits] is the class of the bit length of the
+      largest scalar, i.e. [64], [128] or [256]. The defaults were measured on
+      x86-64. It applies to {!pippenger}, {!pippenger_with_affine_array} and
+      the MSMs using them. [0] disables Straus' algorithm.
+
+      @raise Invalid_argument if [nbits] is not [64], [128] or [256], or if
+      [n] is negative. *)
+  val set_straus_threshold : nbits:int -> int -> unit
+
+  (** Return the threshold set by {!set_straus_threshold} for the class
+      [nbits]
+
+      @raise Invalid_argument if [nbits] is not [64], [128] or [256] *)
+  val get_straus_threshold : nbits:int -> int
+
+  (** [pippenger_with_scalar_batch ?start ?len pts batch] computes the same
+      multi scalar multiplication than {!pippenger_with_affine_array} with the
+      scalars of [batch], without converting nor recoding them. The same batch
+      can be used for several sets of points, in {!G1} and {!G2}.
+
+      @raise Invalid_argument if [start] or [len] would infer out of bounds
+      array access. *)
+  val pippenger_with_scalar_batch :
+    ?start:int -> ?len:int -> affine_array -> Fr.Scalar_batch.t -> t
+
+  (** [pippenger_multi ?start ?len pts scalars] computes the multi scalar
+      multiplications of the points [pts] by each vector of [scalars], e.g. the
+      commitments of several polynomials with the same SRS. The arguments
+      [start] and [len] apply to each vector, as in
+      {!pippenger_with_affine_array}, the length being bounded by the shortest
+      vector. The MSMs share the loads of the points instead of reading them
+      once per vector.
+
+      @raise Invalid_argument if [start] or [len] would infer out of bounds
+      array access. *)
+  val pippenger_multi :
+    ?start:int -> ?len:int -> affine_array -> Scalar.t array array -> t array
+
+  (** [pippenger_glv ?start ?len pts scalars] computes the same multi scalar
+      multiplication than {!pippenger_with_affine_array} with the
+      endomorphism of the curve, GLV for {!G1} and GLS for {!G2}. Each scalar
+      is split in 2 (resp. 4) scalars of 128 (resp. 64) bits and each point is
+      replaced by its 2 (resp. 4) images by the endomorphism: Pippenger's
+      algorithm runs on 2 (resp. 4) times more points with 2 (resp. 4) times
+      less windows. It saves the additions combining the buckets, i.e. it is
+      faster for small and medium sizes and about the same for hundreds of
+      thousands of points. The images are computed at each call, see
+      {!Glv_bases} to compute them once.
+
+      @raise Invalid_argument if [start] or [len] would infer out of bounds
+      array access. *)
+  val pippenger_glv :
+    ?start:int -> ?len:int -> affine_array -> Scalar.t array -> t
+
+  (** Arenas of preallocated points, in jacobian coordinates. See
+      {!Fr.Arena}.
+
+      All functions raise [Invalid_argument] if an index is out of bounds. *)
+  module Arena : sig
+    (** The type of the elements of the arena *)
+    type elt = t
+
+    type t
+
+    (** [create n] allocates an arena of [n] slots set to zero *)
+    val create : int -> t
+
+    (** Return the number of slots *)
+    val length : t -> int
+
+    (** [set arena i p] copies [p] into the slot [i] *)
+    val set : t -> int -> elt -> unit
+
+    (** [get arena i] returns a fresh copy of the slot [i] *)
+    val get : t -> int -> elt
+
+    (** [get_inplace res arena i] copies the slot [i] into [res] *)
+    val get_inplace : elt -> t -> int -> unit
+
+    (** Allocate an arena containing a copy of the given points *)
+    val of_array : elt array -> t
+
+    (** Return a copy of the slots as an OCaml array *)
+    val to_array : t -> elt array
+
+    (** [copy arena r x] copies the slot [x] into the slot [r] *)
+    val copy : t -> int -> int -> unit
+
+    (** [add arena r x y] writes [x + y] into the slot [r] *)
+    val add : t -> int -> int -> int -> unit
+
+    (** [double arena r x] writes [2 x] into the slot [r] *)
+    val double : t -> int -> int -> unit
+
+    (** [negate arena r x] writes [-x] into the slot [r] *)
+    val negate : t -> int -> int -> unit
+
+    (** [mul arena r x n] writes [n x] into the slot [r] *)
+    val mul : t -> int -> int -> Scalar.t -> unit
+
+    (** [is_zero arena x] returns [true] if the slot [x] is the point at
+        infinity *)
+    val is_zero : t -> int -> bool
+
+    (** [eq arena x y] returns [true] if the slots [x] and [y] are
+        algebraically equal *)
+    val eq : t -> int -> int -> bool
+  end
+
+  (** Bases prepared for repeated multi scalar multiplications, e.g. the SRS
+      of a polynomial commitment scheme. For a window [c], the points
+      [2^(c j) P] of each base [P] are precomputed once in affine coordinates
+      for [j < ceil(255 / c)], and each {!msm} is a single Pippenger over
+      [ceil(255 / c)] times more points but with scalars of [c] bits, without
+      the doublings between the windows. The table takes [ceil(255 / c)]
+      affine points per base, e.g. [20] for [c = 13].
+
+      Measured on one core for {!G1}, with the default window, an {!msm}
+      takes about half the time of {!pippenger_with_affine_array} up to
+      [2^10] bases, and is about 20 to 30% faster from [2^12] to [2^16] bases.
+      The precomputation costs about as much as [15] to [20] {!msm} of the same
+      size, so the bases must be reused for dozens of multiplications to pay
+      off. See [benchmark/bench_prepared_bases.ml]. The precomputation and the
+      multiplications are split between the threads set by
+      {!Bls12_381.set_number_of_threads}. *)
+  module Prepared_bases : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window ps] precomputes the tables of the points [ps]. Default
+        value for [window] is [log2 n] for [n] points, bounded by [8] and
+        [13].
+
+        @raise Invalid_argument if [window] is not between [2] and [14] *)
+    val create : ?window:int -> affine_array -> t
+
+    (** Return the number of bases *)
+    val length : t -> int
+
+    (** Return the window used to build the tables *)
+    val window : t -> int
+
+    (** [msm ?start ?len bases scalars] computes the multi scalar
+        multiplication of the bases by [scalars], with the same semantic as
+        {!pippenger_with_affine_array} for the arguments [start] and [len].
+
+        @raise Invalid_argument if [start] or [len] would infer out of bounds
+        array access. *)
+    val msm : ?start:int -> ?len:int -> t -> Scalar.t array -> elt
+  end
+
+  (** Bases extended with their images by the endomorphism of the curve, see
+      {!pippenger_glv}, computed once for repeated multi scalar
+      multiplications. The bases take 2 (resp. 4) affine points per point for
+      {!G1} (resp. {!G2}). *)
+  module Glv_bases : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ps] computes the images of the points [ps] *)
+    val create : affine_array -> t
+
+    (** Return the number of bases *)
+    val length : t -> int
+
+    (** [msm ?start ?len bases scalars] computes the multi scalar
+        multiplication of the bases by [scalars], with the same semantic as
+        {!pippenger_with_affine_array} for the arguments [start] and [len].
+
+        @raise Invalid_argument if [start] or [len] would infer out of bounds
+        array access. *)
+    val msm : ?start:int -> ?len:int -> t -> Scalar.t array -> elt
+  end
+
+  (** MSM contexts: the buffers used by {!pippenger} and
+      {!pippenger_with_affine_array} to convert the scalars and the points,
+      the scratch of Pippenger's algorithm and, with several threads, the
+      tiles of the multiplication and the scratch of each thread, kept from one
+      multiplication to the next instead of being allocated on the C heap at
+      each call, e.g. for many MSMs of medium size. The buffers grow with the sizes of the MSMs and are
+      freed with the context. A context must not be used by two MSMs at the
+      same time: use one context per domain or thread. *)
+  module Msm_context : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ()] returns a context without buffers *)
+    val create : unit -> t
+
+    (** Same as {!pippenger} with the buffers of the context *)
+    val pippenger :
+      ?start:int -> ?len:int -> t -> elt array -> Scalar.t array -> elt
+
+    (** Same as {!pippenger_with_affine_array} with the buffers of the
+        context *)
+    val pippenger_with_affine_array :
+      ?start:int -> ?len:int -> t -> affine_array -> Scalar.t array -> elt
+  end
+
+  (** Streaming MSMs: the points and the scalars are added by chunks, e.g. as
+      they are produced, to the buckets of all the windows of Pippenger's
+      algorithm, and {!finish} returns the sum. Only the buckets and a bounded
+      staging buffer are kept, i.e. the memory does not depend on the number of
+      points. A stream must not be used by two threads at the same time.
+
+      {!add} is synchronous: it returns once the chunk is accumulated in the
+      buckets, and the stream does not compute in the background. The chunks
+      are accumulated without the OCaml runtime lock, so that the production
+      of the next chunk can overlap the accumulation of the current one only
+      if it is done by another thread (or domain), e.g. a producer thread
+      passing the chunks to the thread calling {!add}. *)
+  module Msm_stream : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window ()] returns an empty stream whose buckets are on
+        [window] bits, i.e. [(255 / window + 1) * 2^(window - 1)] buckets of
+        4 coordinates. Larger windows need less additions per point but more
+        memory. Default is 10.
+
+        @raise Invalid_argument if [window] is not between 2 and 16 *)
+    val create : ?window:int -> unit -> t
+
+    (** [add ?start ?len stream ps ss] adds the points [ps.(start + i)] times
+        the scalars [ss.(start + i)] for [i < len] to the stream, and returns
+        once they are accumulated in the buckets. [start] and [len] are as for
+        {!pippenger}, except that [len] can be [0]. The arrays can be reused
+        after the call.
+
+        @raise Invalid_argument if [start] or [len] would infer out of bounds
+        array access. *)
+    val add : ?start:int -> ?len:int -> t -> elt array -> Scalar.t array -> unit
+
+    (** Same as {!add} with the points of an affine array *)
+    val add_with_affine_array :
+      ?start:int -> ?len:int -> t -> affine_array -> Scalar.t array -> unit
+
+    (** [finish stream] returns the sum of the points added since the creation
+        of the stream or the previous call to [finish], times their scalars.
+        The stream is reset and can be used for another MSM. *)
+    val finish : t -> elt
+  end
+
+  (** Commitments to vectors of scalars over fixed bases, i.e. the sums of the
+      bases times the scalars, updated incrementally when a few scalars of the
+      vector change: the updates are applied as the MSM of the differences of
+      the scalars over the bases of the changed entries, instead of the MSM of
+      the whole vector. *)
+  module Commitment : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create bases ss] computes the commitment to [ss] over the first
+        [Array.length ss] bases of [bases].
+
+        @raise Invalid_argument if there are more scalars than bases *)
+    val create : affine_array -> Scalar.t array -> t
+
+    (** [of_commitment bases c] is the commitment [c] over [bases], e.g. a
+        commitment computed previously. The vector is not needed. *)
+    val of_commitment : affine_array -> elt -> t
+
+    (** Return the current commitment *)
+    val commitment : t -> elt
+
+    (** [update t i old new_] updates the commitment for the scalar of the
+        entry [i] changing from [old] to [new_].
+
+        @raise Invalid_argument if [i] is not the index of a base *)
+    val update : t -> int -> Scalar.t -> Scalar.t -> unit
+
+    (** [update_many t updates] applies the updates [(i, old, new_)] of
+        [updates] with one MSM of size [Array.length updates]. The entries
+        do not have to be distinct, the updates of an entry being applied in
+        order.
+
+        @raise Invalid_argument if one of the indices is not the index of a
+        base. The commitment is then unchanged. *)
+    val update_many : t -> (int * Scalar.t * Scalar.t) array -> unit
+  end
+
+  (** Partial results of a MSM split between processes, possibly on different
+      hosts. Each worker computes with {!pippenger_partial} the part of the
+      MSM of a range of the points, restricted to a slice of the bits of the
+      scalars. The partials are sent to the coordinator as bytes and added
+      with {!merge}.
+
+      The partials are only meaningful in a merge: except with the JavaScript
+      backend, the slices are made of the signed digits used by Pippenger's
+      algorithm, i.e. a slice is not the MSM of the bits of the scalars in the
+      slice. *)
+  module Partial : sig
+    type elt = t
+
+    type t
+
+    (** Size of the encoding of a partial, the size of a compressed point *)
+    val size_in_bytes : int
+
+    val to_bytes : t -> Bytes.t
+
+    (** Return [None] if the bytes are not the encoding of a partial *)
+    val of_bytes_opt : Bytes.t -> t option
+
+    (** Raise {!Not_on_curve} if the bytes are not the encoding of a partial *)
+    val of_bytes_exn : Bytes.t -> t
+  end
+
+  (** [pippenger_partial ?start ?len ?slice bases ss] computes the partial of
+      the MSM [pippenger_with_affine_array ?start ?len bases ss] for the slice
+      [slice = (k, nslices)] of the bits of the scalars, i.e. the [k]-th of
+      [nslices] consecutive ranges of bits. Default is [(0, 1)], i.e. the
+      whole MSM of the range of points.
+
+      {!merge} of the partials of a partition of the points in ranges, with
+      each range split in all its slices, is the MSM of all the points. The
+      number of slices can be different for each range. Splitting the bits
+      lets more workers than ranges of points share the MSM, each one
+      touching only its range of the bases.
+
+      @raise Invalid_argument if the range is not a range of the bases and
+      of the scalars, or if not [0 <= k < nslices <= 64]. *)
+  val pippenger_partial :
+    ?start:int ->
+    ?len:int ->
+    ?slice:int * int ->
+    affine_array ->
+    Scalar.t array ->
+    Partial.t
+
+  (** Return the sum of the partials, {!zero} for the empty list *)
+  val merge : Partial.t list -> t
+
+  (** Tables of precomputed multiples of a fixed point, e.g. the generators
+      for the generation of a SRS. The table of a point [p] holds the
+      [2^(window - 1)] first multiples of [2^(k window) p] for each window [k]
+      of the scalars, in affine coordinates, i.e. [(255 / window + 1)
+      2^(window - 1)] affine points. A multiplication is then one addition per
+      window, without doublings. The multiplications are constant time in the
+      scalar, the tables being scanned entirely. *)
+  module Fixed_base : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window p] precomputes the table of [p]. Default value for
+        [window] is [6].
+
+        @raise Invalid_argument if [window] is not between [2] and [10] *)
+    val create : ?window:int -> elt -> t
+
+    (** The table of {!one} with the default window, built at the first call *)
+    val one : unit -> t
+
+    (** Return the window used to build the table *)
+    val window : t -> int
+
+    (** [mul table s] returns [s p] where [p] is the point of [table] *)
+    val mul : t -> Scalar.t -> elt
+  end
+
+  (** [mul_fixed_base_many table ss] returns the array of the multiples
+      [ss.(i) p] where [p] is the point of [table], e.g. the powers of a
+      secret for a SRS. The multiplications are split between the threads set
+      by {!Bls12_381.set_number_of_threads} and the results are normalised to
+      affine coordinates with one batched inversion per thread. *)
+  val mul_fixed_base_many : Fixed_base.t -> Scalar.t array -> t array
+
+  (** [mul_many ?vartime ps ss] returns the array of the products
+      [ss.(i) ps.(i)], e.g. for the Lagrange basis of a SRS or the folding of
+      the bases of an inner product argument. The multiplications are split
+      between the threads set by {!Bls12_381.set_number_of_threads} and the
+      results are normalised to affine coordinates with one batched inversion
+      per thread. Default value for [vartime] is [false].
+
+      With [vartime = true], the points are multiplied in variable time using
+      the endomorphism of the curve and a wNAF recoding of the scalars, which
+      is faster but leaks the scalars through timing: use it only on public
+      inputs.
+
+      @raise Invalid_argument if [ps] and [ss] have different lengths *)
+  val mul_many : ?vartime:bool -> t array -> Scalar.t array -> t array
+
+  (** Same as {!mul_many} with the results in a contiguous C array in affine
+      coordinates, ready for {!pippenger_with_affine_array} *)
+  val mul_many_affine_array :
+    ?vartime:bool -> t array -> Scalar.t array -> affine_array
+
+  (** [linear_combination ps ss] returns the sum of the [ss.(i) ps.(i)], {!zero}
+      for empty arrays. Meant for the few terms of verification equations,
+      e.g. signatures and KZG checks: up to a few points, Straus' algorithm
+      runs on the GLV (resp. GLS) images of the points and shares one chain of
+      128 (resp. 64) doublings between them. Larger combinations use
+      {!pippenger}. The point at infinity is supported.
+
+      {b Warning.} Variable time, like {!pippenger}: use it only for public
+      scalars.
+
+      @raise Invalid_argument if [ps] and [ss] have different lengths *)
+  val linear_combination : t array -> Scalar.t array -> t
+
+  (** [mul2 p a q b] returns [a p + b q], see {!linear_combination} *)
+  val mul2 : t -> Scalar.t -> t -> Scalar.t -> t
+
+  (** Prepared points: the multiples [1 p, ..., 2^(window - 1) p] of the
+      images of [p] by the endomorphism of the curve, i.e. of the two GLV
+      images for {!G1} and of the four GLS images for {!G2}, in affine
+      coordinates. A multiplication is then a chain of 128 (resp. 64)
+      doublings with one addition per image every [window] bits, and the
+      multiples are not recomputed at each call as {!mul} does. Meant for
+      points multiplied many times by secret scalars, e.g. a public key or the
+      generator of a protocol.
+
+      The table of a prepared point takes [2^window] (resp. [2^(window + 1)])
+      affine points, i.e. 3KB for {!G1} and 12KB for {!G2} with the default
+      window. Larger windows save additions but the whole table is scanned at
+      each window to keep the multiplications constant time in the scalar, so
+      the default one is usually the fastest. {!Fixed_base} uses much larger
+      tables to also remove the doublings. *)
+  module Prepared : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window p] precomputes the table of [p]. Default value for
+        [window] is [5].
+
+        @raise Invalid_argument if [window] is not between [2] and [8] *)
+    val create : ?window:int -> elt -> t
+
+    (** Return the window used to build the table *)
+    val window : t -> int
+
+    (** [mul prepared s] returns [s p] where [p] is the prepared point *)
+    val mul : t -> Scalar.t -> elt
+
+    (** [mul_many prepared ss] returns the array of the multiples [ss.(i) p]
+        where [p] is the prepared point. The multiplications are split between
+        the threads set by {!Bls12_381.set_number_of_threads} and the results
+        are normalised to affine coordinates with one batched inversion per
+        thread. *)
+    val mul_many : t -> Scalar.t array -> elt array
+  end
 end
 
 module Fr = Fr
@@ -213,3 +717,300 @@ external built_with_blst_portable_stubs : unit -> bool
   = "caml_built_with_blst_portable_stubs"
 
 let built_with_blst_portable = built_with_blst_portable_stubs ()
+
+external set_number_of_threads : int -> unit
+  = "caml_bls12_381_set_nb_threads_stubs"
+
+external get_number_of_threads : unit -> int
+  = "caml_bls12_381_get_nb_threads_stubs"
+
+external register_custom_operations : unit -> int
+  = "caml_bls12_381_register_custom_operations_stubs"
+
+external set_unchecked_deserialization : bool -> int
+  = "caml_bls12_381_set_unchecked_deserialization_stubs"
+
+external get_unchecked_deserialization : unit -> bool
+  = "caml_bls12_381_get_unchecked_deserialization_stubs"
+
+let () = ignore @@ register_custom_operations ()
+
+let with_unchecked_unmarshal f =
+  let previous = get_unchecked_deserialization () in
+  ignore @@ set_unchecked_deserialization true ;
+  Fun.protect
+    ~finally:(fun () -> ignore @@ set_unchecked_deserialization previous)
+    f
+
+module Tuning = struct
+  external monotonic_time : unit -> float
+    = "caml_bls12_381_monotonic_time_stubs"
+
+  external set_msm_window : int -> int -> unit
+    = "caml_blst_set_msm_window_stubs"
+
+  external get_msm_window : int -> int = "caml_blst_get_msm_window_stubs"
+
+  external set_poly_parameter : int -> int -> unit
+    = "caml_polynomial_set_parameter_stubs"
+
+  external get_poly_parameter : int -> int
+    = "caml_polynomial_get_parameter_stubs"
+
+  (* Same values than POLY_PARAMETER_* in polynomial.h *)
+  let poly_mul_naive_threshold = 0
+
+  let ntt_parallel_log_size = 1
+
+  let ntt_task_size = 2
+
+  let max_log_npoints = 31
+
+  type parameter = {
+    name : string;
+    get : unit -> int;
+    set : int -> unit;
+    valid : int -> bool;
+    default : int;
+  }
+
+  let straus_parameters group name =
+    let module G = (val group : CURVE) in
+    List.map
+      (fun nbits ->
+        {
+          name = Printf.sprintf "%s_straus_%d" name nbits;
+          get = (fun () -> G.get_straus_threshold ~nbits);
+          set = G.set_straus_threshold ~nbits;
+          valid = (fun n -> n >= 0);
+          default = G.get_straus_threshold ~nbits;
+        })
+      [64; 128; 256]
+
+  let poly_parameter name k valid =
+    {
+      name;
+      get = (fun () -> get_poly_parameter k);
+      set = set_poly_parameter k;
+      valid;
+      default = get_poly_parameter k;
+    }
+
+  let all =
+    [
+      {
+        name = "threads";
+        get = get_number_of_threads;
+        set = set_number_of_threads;
+        valid = (fun n -> n >= 1 && n <= 256);
+        default = get_number_of_threads ();
+      };
+    ]
+    @ List.init (max_log_npoints + 1) (fun k ->
+          {
+            name = Printf.sprintf "msm_window_%d" k;
+            get = (fun () -> get_msm_window k);
+            set = set_msm_window k;
+            valid = (fun w -> w = 0 || (w >= 2 && w <= 20));
+            default = 0;
+          })
+    @ straus_parameters (module G1 : CURVE) "g1"
+    @ straus_parameters (module G2 : CURVE) "g2"
+    @ [
+        poly_parameter "poly_mul_naive_threshold" poly_mul_naive_threshold
+          (fun n -> n >= 1);
+        poly_parameter "ntt_parallel_log_size" ntt_parallel_log_size (fun n ->
+            n >= 0 && n < 64);
+        poly_parameter "ntt_task_size" ntt_task_size (fun n -> n >= 1);
+      ]
+
+  let find name =
+    match List.find_opt (fun p -> p.name = name) all with
+    | Some p -> p
+    | None -> raise (Invalid_argument ("Unknown parameter " ^ name))
+
+  let parameters () = List.map (fun p -> (p.name, p.get ())) all
+
+  let get name = (find name).get ()
+
+  let set name v =
+    let p = find name in
+    if not (p.valid v) then
+      raise
+        (Invalid_argument (Printf.sprintf "Invalid value %d for %s" v name)) ;
+    p.set v
+
+  let reset () = List.iter (fun p -> p.set p.default) all
+
+  let save file =
+    let oc = open_out file in
+    Fun.protect
+      ~finally:(fun () -> close_out oc)
+      (fun () ->
+        Printf.fprintf oc "# Parameters of bls12-381\n" ;
+        List.iter (fun (name, v) -> Printf.fprintf oc "%s %d\n" name v)
+        @@ parameters ())
+
+  let parse_line lineno line =
+    let fail () =
+      failwith (Printf.sprintf "Invalid profile line %d: %s" lineno line)
+    in
+    let line = String.trim line in
+    if line = "" || line.[0] = '#' then None
+    else
+      match List.filter (( <> ) "") (String.split_on_char ' ' line) with
+      | [name; v] -> (
+          match
+            (List.find_opt (fun p -> p.name = name) all, int_of_string_opt v)
+          with
+          | (_, None) -> fail ()
+          | (None, Some _) -> None
+          | (Some p, Some v) -> if p.valid v then Some (p, v) else fail ())
+      | _ -> fail ()
+
+  let load file =
+    let ic = open_in file in
+    let rec read lineno acc =
+      match input_line ic with
+      | line -> (
+          match parse_line lineno line with
+          | Some x -> read (lineno + 1) (x :: acc)
+          | None -> read (lineno + 1) acc)
+      | exception End_of_file -> List.rev acc
+    in
+    let values =
+      Fun.protect ~finally:(fun () -> close_in ic) (fun () -> read 1 [])
+    in
+    List.iter (fun (p, v) -> p.set v) values
+
+  (* Minimal duration of [f ()] over [repeat] runs *)
+  let time ?(repeat = 3) f =
+    let best = ref infinity in
+    for _ = 1 to repeat do
+      let t0 = monotonic_time () in
+      ignore (Sys.opaque_identity (f ())) ;
+      let t = monotonic_time () -. t0 in
+      if t < !best then best := t
+    done ;
+    !best
+
+  (* Return the candidate minimising [f], and its duration *)
+  let fastest ?repeat set candidates f =
+    List.fold_left
+      (fun (best, best_t) c ->
+        set c ;
+        let t = time ?repeat f in
+        if t < best_t then (c, t) else (best, best_t))
+      (List.hd candidates, infinity)
+      candidates
+
+  let range a b = if a > b then [] else List.init (b - a + 1) (fun i -> a + i)
+
+  (* Scalars of at most [nbits] bits *)
+  let random_scalars ~state ~nbits n =
+    Array.init n (fun _ ->
+        let b = Fr.to_bytes (Fr.random ~state ()) in
+        Bytes.fill b (nbits / 8) (Bytes.length b - (nbits / 8)) '\000' ;
+        Fr.of_bytes_exn b)
+
+  let calibrate_threads ~log ~max_threads points scalars =
+    let rec loop best best_t n =
+      if n > max_threads then best
+      else (
+        set_number_of_threads n ;
+        let t =
+          time (fun () -> G1.pippenger_with_affine_array points scalars)
+        in
+        log (Printf.sprintf "threads %d: %.6fs" n t) ;
+        (* Stop when more threads do not help anymore *)
+        if t < best_t then loop n t (2 * n) else best)
+    in
+    set_number_of_threads (loop 1 infinity 1)
+
+  let calibrate_msm_windows ~log ~max_log_npoints points scalars =
+    List.iter
+      (fun k ->
+        let len = 1 lsl k in
+        let f () = G1.pippenger_with_affine_array ~len points scalars in
+        let candidates = range (max 2 (k - 6)) (min 20 (k + 1)) in
+        let (w, t) = fastest (set_msm_window k) candidates f in
+        log (Printf.sprintf "msm_window_%d %d: %.6fs" k w t) ;
+        set_msm_window k w)
+      (range 4 max_log_npoints)
+
+  let calibrate_straus ~log ~state group name =
+    let module G = (val group : CURVE) in
+    let max_n = 128 in
+    let points =
+      G.to_affine_array (Array.init max_n (fun _ -> G.random ~state ()))
+    in
+    List.iter
+      (fun nbits ->
+        let scalars = random_scalars ~state ~nbits max_n in
+        let faster n =
+          let f () = G.pippenger_with_affine_array ~len:n points scalars in
+          G.set_straus_threshold ~nbits n ;
+          let t_straus = time ~repeat:10 f in
+          G.set_straus_threshold ~nbits 0 ;
+          let t_pippenger = time ~repeat:10 f in
+          t_straus < t_pippenger
+        in
+        (* Largest size, by steps of 4, up to which Straus' algorithm wins *)
+        let rec loop n =
+          if n <= max_n && faster n then loop (n + 4) else n - 4
+        in
+        let n = max 0 (loop 4) in
+        log (Printf.sprintf "%s_straus_%d %d" name nbits n) ;
+        G.set_straus_threshold ~nbits n)
+      [64; 128; 256]
+
+  let calibrate_poly ~log ~state ~max_log_size =
+    let n = 1 lsl max_log_size in
+    let coefficients = Array.init n (fun _ -> Fr.random ~state ()) in
+    let points = Array.init n (fun _ -> Fr.random ~state ()) in
+    let f () = Fr.Poly.multi_eval ~coefficients ~points in
+    let tune name k candidates =
+      let (v, t) = fastest ~repeat:1 (set_poly_parameter k) candidates f in
+      log (Printf.sprintf "%s %d: %.6fs" name v t) ;
+      set_poly_parameter k v
+    in
+    tune "poly_mul_naive_threshold" poly_mul_naive_threshold
+      [8; 16; 32; 64; 128] ;
+    if get_number_of_threads () > 1 then (
+      tune "ntt_task_size" ntt_task_size [1024; 2048; 4096; 8192; 16384] ;
+      tune "ntt_parallel_log_size" ntt_parallel_log_size (range 10 16))
+
+  let calibrate ?(max_log_npoints = 16) ?(max_threads = 256)
+      ?(max_log_poly_size = 12) ?(log = fun _ -> ()) () =
+    if max_log_npoints < 4 || max_log_npoints > 31 then
+      raise (Invalid_argument "max_log_npoints must be between 4 and 31") ;
+    if max_threads < 1 || max_threads > 256 then
+      raise (Invalid_argument "max_threads must be between 1 and 256") ;
+    if max_log_poly_size < 1 || max_log_poly_size > 24 then
+      raise (Invalid_argument "max_log_poly_size must be between 1 and 24") ;
+    let state = Random.State.make [|42|] in
+    let n = 1 lsl max_log_npoints in
+    (* Consecutive multiples of a random point, far cheaper to generate than
+       random points *)
+    let p = G1.random ~state () in
+    let points = Array.make n p in
+    for i = 1 to n - 1 do
+      points.(i) <- G1.add points.(i - 1) G1.one
+    done ;
+    let points = G1.to_affine_array points in
+    let scalars = Array.init n (fun _ -> Fr.random ~state ()) in
+    calibrate_threads ~log ~max_threads points scalars ;
+    calibrate_msm_windows ~log ~max_log_npoints points scalars ;
+    calibrate_straus ~log ~state (module G1 : CURVE) "g1" ;
+    calibrate_straus ~log ~state (module G2 : CURVE) "g2" ;
+    calibrate_poly ~log ~state ~max_log_size:max_log_poly_size
+
+  let () =
+    match Sys.getenv_opt "BLS12_381_PROFILE" with
+    | None | Some "" -> ()
+    | Some file -> (
+        try load file
+        with (Sys_error msg | Failure msg) ->
+          Printf.eprintf "bls12-381: can not load the profile %s: %s\n%!" file
+            msg)
+end
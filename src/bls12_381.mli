@@ -119,9 +119,135 @@ module Fr : sig
       exception. *)
   val inner_product_opt : t array -> t array -> t option
 
+  (** [grand_product_exn a b] returns the running products [z] of the
+      fractions [a_i / b_i], i.e. [z.(0) = one] and [z.(i + 1) = z.(i) * a.(i)
+      / b.(i)]. The result has [n + 1] elements, the last one being the
+      product of all the fractions. The denominators are inverted by batch
+      while computing the scan, which is split in blocks between the threads
+      set by {!Bls12_381.set_number_of_threads}. Raise [Invalid_argument] if
+      the arguments are not of the same length and [Division_by_zero] if one
+      of the elements of [b] is zero. *)
+  val grand_product_exn : t array -> t array -> t array
+
   (** [of_int x] is equivalent to [of_z (Z.of_int x)]. If [x] is is negative,
       returns the element [order - |x|]. *)
   val of_int : int -> t
+
+  (** Arenas of preallocated field elements.
+
+      An arena is a contiguous C array of [n] slots, allocated at once and
+      released at once by the GC. The operations read and write the slots in
+      place, referenced by their index, and do not allocate. It is recommended
+      for hot loops performing a long sequence of operations, to avoid
+      allocating a new value for each intermediate result. The output slot can
+      be the same than the input slots.
+
+      All functions raise [Invalid_argument] if an index is out of bounds. *)
+  module Arena : sig
+    (** The type of the elements of the arena *)
+    type elt = t
+
+    type t
+
+    (** [create n] allocates an arena of [n] slots set to zero *)
+    val create : int -> t
+
+    (** Return the number of slots *)
+    val length : t -> int
+
+    (** [set arena i x] copies [x] into the slot [i] *)
+    val set : t -> int -> elt -> unit
+
+    (** [get arena i] returns a fresh copy of the slot [i] *)
+    val get : t -> int -> elt
+
+    (** [get_inplace res arena i] copies the slot [i] into [res] *)
+    val get_inplace : elt -> t -> int -> unit
+
+    (** Allocate an arena containing a copy of the given elements *)
+    val of_array : elt array -> t
+
+    (** Return a copy of the slots as an OCaml array *)
+    val to_array : t -> elt array
+
+    (** [copy arena r x] copies the slot [x] into the slot [r] *)
+    val copy : t -> int -> int -> unit
+
+    (** [add arena r x y] writes [x + y] into the slot [r] *)
+    val add : t -> int -> int -> int -> unit
+
+    (** [sub arena r x y] writes [x - y] into the slot [r] *)
+    val sub : t -> int -> int -> int -> unit
+
+    (** [mul arena r x y] writes [x * y] into the slot [r] *)
+    val mul : t -> int -> int -> int -> unit
+
+    (** [double arena r x] writes [2 * x] into the slot [r] *)
+    val double : t -> int -> int -> unit
+
+    (** [square arena r x] writes [x * x] into the slot [r] *)
+    val square : t -> int -> int -> unit
+
+    (** [negate arena r x] writes [-x] into the slot [r] *)
+    val negate : t -> int -> int -> unit
+
+    (** [inverse_exn arena r x] writes [x^-1] into the slot [r]. Raise
+        [Division_by_zero] if the slot [x] is zero. *)
+    val inverse_exn : t -> int -> int -> unit
+
+    (** [is_zero arena x] returns [true] if the slot [x] is zero *)
+    val is_zero : t -> int -> bool
+
+    (** [eq arena x y] returns [true] if the slots [x] and [y] are equal *)
+    val eq : t -> int -> int -> bool
+  end
+
+  (** Polynomials over [Fr], represented by the array of their coefficients,
+      the constant monomial first. The computations are performed in C on
+      contiguous copies of the arrays and are split between the threads set by
+      {!Bls12_381.set_number_of_threads}. *)
+  module Poly : sig
+    (** [eval p x] returns [p(x)], using Horner's method on chunks of the
+        coefficients evaluated in parallel *)
+    val eval : t array -> t -> t
+
+    (** [eval_many ps x] returns the array of the evaluations of the
+        polynomials [ps] at [x]. The polynomials are evaluated in parallel. *)
+    val eval_many : t array array -> t -> t array
+
+    (** [multi_eval ~coefficients ~points] returns the evaluations of the
+        polynomial at each point of [points]. Uses a subproduct tree and a
+        remainder tree with FFT-based products, i.e. [O(n log^2 n)] operations
+        instead of [O(n^2)] with Horner's method. *)
+    val multi_eval : coefficients:t array -> points:t array -> t array
+
+    (** [interpolate ~points ~values] returns the coefficients of the unique
+        polynomial [p] of degree smaller than [n = Array.length points] such
+        that [p(points.(i)) = values.(i)], in [O(n log^2 n)] operations. Raise
+        [Invalid_argument] if the arrays are not of the same length or if the
+        points are not distinct. *)
+    val interpolate : points:t array -> values:t array -> t array
+  end
+
+  (** Scalars prepared once for any number of multi scalar multiplications, on
+      {!G1} or {!G2}, with the same scalars and different points, e.g. the
+      witness of a Groth16 proof. The scalars are converted to bytes and recoded
+      in the signed digits used by Pippenger's algorithm when the batch is
+      created, instead of at each multiplication. See
+      [pippenger_with_scalar_batch]. *)
+  module Scalar_batch : sig
+    (** The type of the scalars *)
+    type elt = t
+
+    type t
+
+    (** [create scalars] converts and recodes [scalars]. The batch does not
+        depend on [scalars] afterwards. *)
+    val create : elt array -> t
+
+    (** Return the number of scalars *)
+    val length : t -> int
+  end
 end
 
 module type CURVE = sig
@@ -227,10 +353,23 @@ module type CURVE = sig
   val add_inplace : t -> t -> unit
 
   (** [add_bulk xs] returns the sum of the elements of [xs] by performing only
-      one allocation for the output. This method is recommended to save the
-      allocation overhead of using [n] times {!add}. *)
+      one allocation for the output. The points are converted to affine
+      coordinates with one shared inversion and summed with the affine bulk
+      addition of blst, which also amortizes the inversions. This method is
+      recommended over [n] calls to {!add}. *)
   val add_bulk : t list -> t
 
+  (** Same than {!add_bulk} on an array. The chunks of points are converted and
+      summed in parallel when several threads are set with
+      {!Bls12_381.set_number_of_threads}. *)
+  val add_bulk_array : t array -> t
+
+  (** [add_bulk_affine_array ?start ?len ps] returns the sum of the [len]
+      points of [ps] starting at [start] (by default, all the points), using
+      the affine bulk addition directly on the contiguous array. Raise
+      [Invalid_argument] if [start] and [len] do not describe a range of [ps]. *)
+  val add_bulk_affine_array : ?start:int -> ?len:int -> affine_array -> t
+
   (** [double g] returns [2g] *)
   val double : t -> t
 
@@ -240,6 +379,29 @@ module type CURVE = sig
   (** Return [true] if the two elements are algebraically the same *)
   val eq : t -> t -> bool
 
+  (** Alias of {!eq}. Together with {!hash}, it allows to use the module as the
+      argument of [Hashtbl.Make]. *)
+  val equal : t -> t -> bool
+
+  (** [hash p] returns a hash of the compressed affine encoding of [p]. Two
+      points that are algebraically equal have the same hash, whatever their
+      jacobian representation. [Hashtbl.hash] on values of type [t] and
+      [affine] follows the same semantics, except with the JavaScript
+      backend. *)
+  val hash : t -> int
+
+  (** [compare a b] returns [0] if [a] and [b] are algebraically equal (no field
+      inversion is involved in this case), otherwise compares the compressed
+      affine encodings. The polymorphic [compare] follows the same semantics. *)
+  val compare : t -> t -> int
+
+  (** [normalize_inplace p] rewrites the jacobian coordinates of [p] to have [Z
+      = 1], without changing the point algebraically. The following calls to
+      {!hash}, {!compare}, {!to_bytes} and {!to_compressed_bytes} on [p] do not
+      require a field inversion anymore. It is recommended to call it once on
+      long-living points, for instance keys of a hash table. *)
+  val normalize_inplace : t -> unit
+
   (** Multiply an element by a scalar *)
   val mul : t -> Scalar.t -> t
 
@@ -247,6 +409,13 @@ module type CURVE = sig
       allocation happens. *)
   val mul_inplace : t -> Scalar.t -> unit
 
+  (** [mul_vartime g x] returns the same point as {!mul} in variable time,
+      using the endomorphism of the curve (GLV for G1, GLS for G2) and a wNAF
+      recoding of the scalar with precomputed odd multiples. The running time
+      depends on [x]: use it only for public scalars, e.g. the challenges of a
+      verifier, never for secrets. *)
+  val mul_vartime : t -> Scalar.t -> t
+
   (** [fft ~domain ~points] performs a Fourier transform on [points] using
       [domain] The domain should be of the form [w^{i}] where [w] is a principal
       root of unity. If the domain is of size [n], [w] must be a [n]-th
@@ -298,7 +467,15 @@ module type CURVE = sig
       convert the points [pts] in affine coordinates as values of type [t] are
       in jacobian coordinates.
 
-      {b Warning.} Undefined behavior if the point to infinity is in the array *)
+      The zero scalars are skipped, the points multiplied by [1] or [-1] are
+      summed with batched affine additions, and Pippenger's algorithm only runs
+      over the bit length of the largest other scalar, e.g. for selectors,
+      boolean witnesses or 128 bits challenges. Up to {!get_straus_threshold}
+      remaining points, Straus' algorithm (interleaved wNAF) is used instead of
+      Pippenger's.
+
+      The points at infinity are supported and contribute nothing to the
+      sum. *)
   val pippenger : ?start:int -> ?len:int -> t array -> Scalar.t array -> t
 
   (** [pippenger_with_affine_array ?start ?len pts scalars] computes the multi
@@ -322,9 +499,471 @@ module type CURVE = sig
 
       Perform allocations on the C heap to convert scalars to bytes.
 
-      {b Warning.} Undefined behavior if the point to infinity is in the array *)
+      The scalars are handled as in {!pippenger}: the zero, [1] and [-1]
+      scalars and the short ones do not run Pippenger's algorithm on all the
+      bits. The points at infinity are supported and contribute nothing to the
+      sum. *)
   val pippenger_with_affine_array :
     ?start:int -> ?len:int -> affine_array -> Scalar.t array -> t
+
+  (** [set_straus_threshold ~nbits n] sets to [n] the number of points up to
+      which the MSMs of scalars of at most [nbits] bits use Straus' algorithm
+      (interleaved wNAF) instead of Pippenger's, e.g. to calibrate the
+      crossover for the machine. [nbits] is the class of the bit length of the
+      largest scalar, i.e. [64], [128] or [256]. The defaults were measured on
+      x86-64. It applies to {!pippenger}, {!pippenger_with_affine_array} and
+      the MSMs using them. [0] disables Straus' algorithm.
+
+      @raise Invalid_argument if [nbits] is not [64], [128] or [256], or if
+      [n] is negative. *)
+  val set_straus_threshold : nbits:int -> int -> unit
+
+  (** Return the threshold set by {!set_straus_threshold} for the class
+      [nbits]
+
+      @raise Invalid_argument if [nbits] is not [64], [128] or [256] *)
+  val get_straus_threshold : nbits:int -> int
+
+  (** [pippenger_with_scalar_batch ?start ?len pts batch] computes the same
+      multi scalar multiplication than {!pippenger_with_affine_array} with the
+      scalars of [batch], without converting nor recoding them. The same batch
+      can be used for several sets of points, in {!G1} and {!G2}.
+
+      @raise Invalid_argument if [start] or [len] would infer out of bounds
+      array access. *)
+  val pippenger_with_scalar_batch :
+    ?start:int -> ?len:int -> affine_array -> Fr.Scalar_batch.t -> t
+
+  (** [pippenger_multi ?start ?len pts scalars] computes the multi scalar
+      multiplications of the points [pts] by each vector of [scalars], e.g. the
+      commitments of several polynomials with the same SRS. The arguments
+      [start] and [len] apply to each vector, as in
+      {!pippenger_with_affine_array}, the length being bounded by the shortest
+      vector. The MSMs share the loads of the points instead of reading them
+      once per vector.
+
+      @raise Invalid_argument if [start] or [len] would infer out of bounds
+      array access. *)
+  val pippenger_multi :
+    ?start:int -> ?len:int -> affine_array -> Scalar.t array array -> t array
+
+  (** [pippenger_glv ?start ?len pts scalars] computes the same multi scalar
+      multiplication than {!pippenger_with_affine_array} with the
+      endomorphism of the curve, GLV for {!G1} and GLS for {!G2}. Each scalar
+      is split in 2 (resp. 4) scalars of 128 (resp. 64) bits and each point is
+      replaced by its 2 (resp. 4) images by the endomorphism: Pippenger's
+      algorithm runs on 2 (resp. 4) times more points with 2 (resp. 4) times
+      less windows. It saves the additions combining the buckets, i.e. it is
+      faster for small and medium sizes and about the same for hundreds of
+      thousands of points. The images are computed at each call, see
+      {!Glv_bases} to compute them once.
+
+      @raise Invalid_argument if [start] or [len] would infer out of bounds
+      array access. *)
+  val pippenger_glv :
+    ?start:int -> ?len:int -> affine_array -> Scalar.t array -> t
+
+  (** Arenas of preallocated points, in jacobian coordinates. See
+      {!Fr.Arena}.
+
+      All functions raise [Invalid_argument] if an index is out of bounds. *)
+  module Arena : sig
+    (** The type of the elements of the arena *)
+    type elt = t
+
+    type t
+
+    (** [create n] allocates an arena of [n] slots set to zero *)
+    val create : int -> t
+
+    (** Return the number of slots *)
+    val length : t -> int
+
+    (** [set arena i p] copies [p] into the slot [i] *)
+    val set : t -> int -> elt -> unit
+
+    (** [get arena i] returns a fresh copy of the slot [i] *)
+    val get : t -> int -> elt
+
+    (** [get_inplace res arena i] copies the slot [i] into [res] *)
+    val get_inplace : elt -> t -> int -> unit
+
+    (** Allocate an arena containing a copy of the given points *)
+    val of_array : elt array -> t
+
+    (** Return a copy of the slots as an OCaml array *)
+    val to_array : t -> elt array
+
+    (** [copy arena r x] copies the slot [x] into the slot [r] *)
+    val copy : t -> int -> int -> unit
+
+    (** [add arena r x y] writes [x + y] into the slot [r] *)
+    val add : t -> int -> int -> int -> unit
+
+    (** [double arena r x] writes [2 x] into the slot [r] *)
+    val double : t -> int -> int -> unit
+
+    (** [negate arena r x] writes [-x] into the slot [r] *)
+    val negate : t -> int -> int -> unit
+
+    (** [mul arena r x n] writes [n x] into the slot [r] *)
+    val mul : t -> int -> int -> Scalar.t -> unit
+
+    (** [is_zero arena x] returns [true] if the slot [x] is the point at
+        infinity *)
+    val is_zero : t -> int -> bool
+
+    (** [eq arena x y] returns [true] if the slots [x] and [y] are
+        algebraically equal *)
+    val eq : t -> int -> int -> bool
+  end
+
+  (** Bases prepared for repeated multi scalar multiplications, e.g. the SRS
+      of a polynomial commitment scheme. For a window [c], the points
+      [2^(c j) P] of each base [P] are precomputed once in affine coordinates
+      for [j < ceil(255 / c)], and each {!msm} is a single Pippenger over
+      [ceil(255 / c)] times more points but with scalars of [c] bits, without
+      the doublings between the windows. The table takes [ceil(255 / c)]
+      affine points per base, e.g. [20] for [c = 13].
+
+      Measured on one core for {!G1}, with the default window, an {!msm}
+      takes about half the time of {!pippenger_with_affine_array} up to
+      [2^10] bases, and is about 20 to 30% faster from [2^12] to [2^16] bases.
+      The precomputation costs about as much as [15] to [20] {!msm} of the same
+      size, so the bases must be reused for dozens of multiplications to pay
+      off. See [benchmark/bench_prepared_bases.ml]. The precomputation and the
+      multiplications are split between the threads set by
+      {!Bls12_381.set_number_of_threads}. *)
+  module Prepared_bases : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window ps] precomputes the tables of the points [ps]. Default
+        value for [window] is [log2 n] for [n] points, bounded by [8] and
+        [13].
+
+        @raise Invalid_argument if [window] is not between [2] and [14] *)
+    val create : ?window:int -> affine_array -> t
+
+    (** Return the number of bases *)
+    val length : t -> int
+
+    (** Return the window used to build the tables *)
+    val window : t -> int
+
+    (** [msm ?start ?len bases scalars] computes the multi scalar
+        multiplication of the bases by [scalars], with the same semantic as
+        {!pippenger_with_affine_array} for the arguments [start] and [len].
+
+        @raise Invalid_argument if [start] or [len] would infer out of bounds
+        array access. *)
+    val msm : ?start:int -> ?len:int -> t -> Scalar.t array -> elt
+  end
+
+  (** Bases extended with their images by the endomorphism of the curve, see
+      {!pippenger_glv}, computed once for repeated multi scalar
+      multiplications. The bases take 2 (resp. 4) affine points per point for
+      {!G1} (resp. {!G2}). *)
+  module Glv_bases : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ps] computes the images of the points [ps] *)
+    val create : affine_array -> t
+
+    (** Return the number of bases *)
+    val length : t -> int
+
+    (** [msm ?start ?len bases scalars] computes the multi scalar
+        multiplication of the bases by [scalars], with the same semantic as
+        {!pippenger_with_affine_array} for the arguments [start] and [len].
+
+        @raise Invalid_argument if [start] or [len] would infer out of bounds
+        array access. *)
+    val msm : ?start:int -> ?len:int -> t -> Scalar.t array -> elt
+  end
+
+  (** MSM contexts: the buffers used by {!pippenger} and
+      {!pippenger_with_affine_array} to convert the scalars and the points,
+      the scratch of Pippenger's algorithm and, with several threads, the
+      tiles of the multiplication and the scratch of each thread, kept from one
+      multiplication to the next instead of being allocated on the C heap at
+      each call, e.g. for many MSMs of medium size. The buffers grow with the sizes of the MSMs and are
+      freed with the context. A context must not be used by two MSMs at the
+      same time: use one context per domain or thread. *)
+  module Msm_context : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ()] returns a context without buffers *)
+    val create : unit -> t
+
+    (** Same as {!pippenger} with the buffers of the context *)
+    val pippenger :
+      ?start:int -> ?len:int -> t -> elt array -> Scalar.t array -> elt
+
+    (** Same as {!pippenger_with_affine_array} with the buffers of the
+        context *)
+    val pippenger_with_affine_array :
+      ?start:int -> ?len:int -> t -> affine_array -> Scalar.t array -> elt
+  end
+
+  (** Streaming MSMs: the points and the scalars are added by chunks, e.g. as
+      they are produced, to the buckets of all the windows of Pippenger's
+      algorithm, and {!finish} returns the sum. Only the buckets and a bounded
+      staging buffer are kept, i.e. the memory does not depend on the number of
+      points. A stream must not be used by two threads at the same time.
+
+      {!add} is synchronous: it returns once the chunk is accumulated in the
+      buckets, and the stream does not compute in the background. The chunks
+      are accumulated without the OCaml runtime lock, so that the production
+      of the next chunk can overlap the accumulation of the current one only
+      if it is done by another thread (or domain), e.g. a producer thread
+      passing the chunks to the thread calling {!add}. *)
+  module Msm_stream : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window ()] returns an empty stream whose buckets are on
+        [window] bits, i.e. [(255 / window + 1) * 2^(window - 1)] buckets of
+        4 coordinates. Larger windows need less additions per point but more
+        memory. Default is 10.
+
+        @raise Invalid_argument if [window] is not between 2 and 16 *)
+    val create : ?window:int -> unit -> t
+
+    (** [add ?start ?len stream ps ss] adds the points [ps.(start + i)] times
+        the scalars [ss.(start + i)] for [i < len] to the stream, and returns
+        once they are accumulated in the buckets. [start] and [len] are as for
+        {!pippenger}, except that [len] can be [0]. The arrays can be reused
+        after the call.
+
+        @raise Invalid_argument if [start] or [len] would infer out of bounds
+        array access. *)
+    val add : ?start:int -> ?len:int -> t -> elt array -> Scalar.t array -> unit
+
+    (** Same as {!add} with the points of an affine array *)
+    val add_with_affine_array :
+      ?start:int -> ?len:int -> t -> affine_array -> Scalar.t array -> unit
+
+    (** [finish stream] returns the sum of the points added since the creation
+        of the stream or the previous call to [finish], times their scalars.
+        The stream is reset and can be used for another MSM. *)
+    val finish : t -> elt
+  end
+
+  (** Commitments to vectors of scalars over fixed bases, i.e. the sums of the
+      bases times the scalars, updated incrementally when a few scalars of the
+      vector change: the updates are applied as the MSM of the differences of
+      the scalars over the bases of the changed entries, instead of the MSM of
+      the whole vector. *)
+  module Commitment : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create bases ss] computes the commitment to [ss] over the first
+        [Array.length ss] bases of [bases].
+
+        @raise Invalid_argument if there are more scalars than bases *)
+    val create : affine_array -> Scalar.t array -> t
+
+    (** [of_commitment bases c] is the commitment [c] over [bases], e.g. a
+        commitment computed previously. The vector is not needed. *)
+    val of_commitment : affine_array -> elt -> t
+
+    (** Return the current commitment *)
+    val commitment : t -> elt
+
+    (** [update t i old new_] updates the commitment for the scalar of the
+        entry [i] changing from [old] to [new_].
+
+        @raise Invalid_argument if [i] is not the index of a base *)
+    val update : t -> int -> Scalar.t -> Scalar.t -> unit
+
+    (** [update_many t updates] applies the updates [(i, old, new_)] of
+        [updates] with one MSM of size [Array.length updates]. The entries
+        do not have to be distinct, the updates of an entry being applied in
+        order.
+
+        @raise Invalid_argument if one of the indices is not the index of a
+        base. The commitment is then unchanged. *)
+    val update_many : t -> (int * Scalar.t * Scalar.t) array -> unit
+  end
+
+  (** Partial results of a MSM split between processes, possibly on different
+      hosts. Each worker computes with {!pippenger_partial} the part of the
+      MSM of a range of the points, restricted to a slice of the bits of the
+      scalars. The partials are sent to the coordinator as bytes and added
+      with {!merge}.
+
+      The partials are only meaningful in a merge: except with the JavaScript
+      backend, the slices are made of the signed digits used by Pippenger's
+      algorithm, i.e. a slice is not the MSM of the bits of the scalars in the
+      slice. *)
+  module Partial : sig
+    type elt = t
+
+    type t
+
+    (** Size of the encoding of a partial, the size of a compressed point *)
+    val size_in_bytes : int
+
+    val to_bytes : t -> Bytes.t
+
+    (** Return [None] if the bytes are not the encoding of a partial *)
+    val of_bytes_opt : Bytes.t -> t option
+
+    (** Raise {!Not_on_curve} if the bytes are not the encoding of a partial *)
+    val of_bytes_exn : Bytes.t -> t
+  end
+
+  (** [pippenger_partial ?start ?len ?slice bases ss] computes the partial of
+      the MSM [pippenger_with_affine_array ?start ?len bases ss] for the slice
+      [slice = (k, nslices)] of the bits of the scalars, i.e. the [k]-th of
+      [nslices] consecutive ranges of bits. Default is [(0, 1)], i.e. the
+      whole MSM of the range of points.
+
+      {!merge} of the partials of a partition of the points in ranges, with
+      each range split in all its slices, is the MSM of all the points. The
+      number of slices can be different for each range. Splitting the bits
+      lets more workers than ranges of points share the MSM, each one
+      touching only its range of the bases.
+
+      @raise Invalid_argument if the range is not a range of the bases and
+      of the scalars, or if not [0 <= k < nslices <= 64]. *)
+  val pippenger_partial :
+    ?start:int ->
+    ?len:int ->
+    ?slice:int * int ->
+    affine_array ->
+    Scalar.t array ->
+    Partial.t
+
+  (** Return the sum of the partials, {!zero} for the empty list *)
+  val merge : Partial.t list -> t
+
+  (** Tables of precomputed multiples of a fixed point, e.g. the generators
+      for the generation of a SRS. The table of a point [p] holds the
+      [2^(window - 1)] first multiples of [2^(k window) p] for each window [k]
+      of the scalars, in affine coordinates, i.e. [(255 / window + 1)
+      2^(window - 1)] affine points. A multiplication is then one addition per
+      window, without doublings. The multiplications are constant time in the
+      scalar, the tables being scanned entirely. *)
+  module Fixed_base : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window p] precomputes the table of [p]. Default value for
+        [window] is [6].
+
+        @raise Invalid_argument if [window] is not between [2] and [10] *)
+    val create : ?window:int -> elt -> t
+
+    (** The table of {!one} with the default window, built at the first call *)
+    val one : unit -> t
+
+    (** Return the window used to build the table *)
+    val window : t -> int
+
+    (** [mul table s] returns [s p] where [p] is the point of [table] *)
+    val mul : t -> Scalar.t -> elt
+  end
+
+  (** [mul_fixed_base_many table ss] returns the array of the multiples
+      [ss.(i) p] where [p] is the point of [table], e.g. the powers of a
+      secret for a SRS. The multiplications are split between the threads set
+      by {!Bls12_381.set_number_of_threads} and the results are normalised to
+      affine coordinates with one batched inversion per thread. *)
+  val mul_fixed_base_many : Fixed_base.t -> Scalar.t array -> t array
+
+  (** [mul_many ?vartime ps ss] returns the array of the products
+      [ss.(i) ps.(i)], e.g. for the Lagrange basis of a SRS or the folding of
+      the bases of an inner product argument. The multiplications are split
+      between the threads set by {!Bls12_381.set_number_of_threads} and the
+      results are normalised to affine coordinates with one batched inversion
+      per thread. Default value for [vartime] is [false].
+
+      With [vartime = true], the points are multiplied in variable time using
+      the endomorphism of the curve and a wNAF recoding of the scalars, which
+      is faster but leaks the scalars through timing: use it only on public
+      inputs.
+
+      @raise Invalid_argument if [ps] and [ss] have different lengths *)
+  val mul_many : ?vartime:bool -> t array -> Scalar.t array -> t array
+
+  (** Same as {!mul_many} with the results in a contiguous C array in affine
+      coordinates, ready for {!pippenger_with_affine_array} *)
+  val mul_many_affine_array :
+    ?vartime:bool -> t array -> Scalar.t array -> affine_array
+
+  (** [linear_combination ps ss] returns the sum of the [ss.(i) ps.(i)], {!zero}
+      for empty arrays. Meant for the few terms of verification equations,
+      e.g. signatures and KZG checks: up to a few points, Straus' algorithm
+      runs on the GLV (resp. GLS) images of the points and shares one chain of
+      128 (resp. 64) doublings between them. Larger combinations use
+      {!pippenger}. The point at infinity is supported.
+
+      {b Warning.} Variable time, like {!pippenger}: use it only for public
+      scalars.
+
+      @raise Invalid_argument if [ps] and [ss] have different lengths *)
+  val linear_combination : t array -> Scalar.t array -> t
+
+  (** [mul2 p a q b] returns [a p + b q], see {!linear_combination} *)
+  val mul2 : t -> Scalar.t -> t -> Scalar.t -> t
+
+  (** Prepared points: the multiples [1 p, ..., 2^(window - 1) p] of the
+      images of [p] by the endomorphism of the curve, i.e. of the two GLV
+      images for {!G1} and of the four GLS images for {!G2}, in affine
+      coordinates. A multiplication is then a chain of 128 (resp. 64)
+      doublings with one addition per image every [window] bits, and the
+      multiples are not recomputed at each call as {!mul} does. Meant for
+      points multiplied many times by secret scalars, e.g. a public key or the
+      generator of a protocol.
+
+      The table of a prepared point takes [2^window] (resp. [2^(window + 1)])
+      affine points, i.e. 3KB for {!G1} and 12KB for {!G2} with the default
+      window. Larger windows save additions but the whole table is scanned at
+      each window to keep the multiplications constant time in the scalar, so
+      the default one is usually the fastest. {!Fixed_base} uses much larger
+      tables to also remove the doublings. *)
+  module Prepared : sig
+    (** The type of the points *)
+    type elt = t
+
+    type t
+
+    (** [create ?window p] precomputes the table of [p]. Default value for
+        [window] is [5].
+
+        @raise Invalid_argument if [window] is not between [2] and [8] *)
+    val create : ?window:int -> elt -> t
+
+    (** Return the window used to build the table *)
+    val window : t -> int
+
+    (** [mul prepared s] returns [s p] where [p] is the prepared point *)
+    val mul : t -> Scalar.t -> elt
+
+    (** [mul_many prepared ss] returns the array of the multiples [ss.(i) p]
+        where [p] is the prepared point. The multiplications are split between
+        the threads set by {!Bls12_381.set_number_of_threads} and the results
+        are normalised to affine coordinates with one batched inversion per
+        thread. *)
+    val mul_many : t -> Scalar.t array -> elt array
+  end
 end
 
 (** Represents the field extension constructed as described {{:
@@ -615,3 +1254,128 @@ end
     building the library, otherwise [false]. Can be used to detect if the
     backend blst has been optimised with ADX on ADX-supported platforms. *)
 val built_with_blst_portable : bool
+
+(** [set_number_of_threads n] sets to [n] the number of threads used by the
+    parallel routines, like {!Fr.Poly.multi_eval}. The calling thread is
+    counted, i.e. [1] (the default) means the routines are sequential. The
+    value is bounded to [[1; 256]]. The threads are not registered to the
+    OCaml runtime and the runtime lock is kept during the computation. They
+    are created at the first parallel call needing them and reused by the
+    next ones. Decreasing [n] leaves the extra threads idle.
+
+    The JavaScript backend is always sequential. *)
+val set_number_of_threads : int -> unit
+
+(** Return the number of threads used by the parallel routines *)
+val get_number_of_threads : unit -> int
+
+(** Values of type {!Fr.t}, {!Fq12.t}, {!GT.t} and the points of {!G1} and
+    {!G2} (including the affine arrays) can be serialized with the module
+    [Marshal] of the standard library. The raw Montgomery representation is
+    used, i.e. 32 bytes for {!Fr.t}, 144 (resp. 288) bytes for {!G1.t} (resp.
+    {!G2.t}) and 576 bytes for {!Fq12.t}, making the serialization as fast as a
+    copy.
+
+    By default, the values are validated when unmarshalled: the coordinates
+    must be in the field and the points must be on the curve and in the prime
+    subgroup. [Failure] is raised otherwise. Values of type {!GT.t} are only
+    checked to be in {!Fq12}.
+
+    The affine arrays can only be unmarshalled with OCaml 5.0 or later: the
+    number of points read from the stream is checked against the size of the
+    block, which OCaml 4 does not provide. With OCaml 4, unmarshalling an
+    affine array raises [Failure].
+
+    Not supported by the JavaScript backend, i.e. only with the native and
+    bytecode backends. *)
+
+(** [with_unchecked_unmarshal f] evaluates [f ()] with the validation of the
+    unmarshalled values disabled. It is meant to exchange large arrays of
+    values between trusted processes, for instance workers of the same program
+    splitting a MSM or a FFT. {b Never} use it on values coming from an
+    untrusted source. The sizes of the affine arrays are checked in any
+    case.
+
+    The validation is only disabled in the calling thread, i.e. the current
+    domain or system thread: the values unmarshalled meanwhile by the other
+    threads are still validated. Nested calls restore the setting of the
+    enclosing call. *)
+val with_unchecked_unmarshal : (unit -> 'a) -> 'a
+
+(** Parameters of the kernels which can be calibrated for the machine: the
+    number of threads, the windows of Pippenger's algorithm, the thresholds of
+    Straus' algorithm and the sizes used by the polynomial products. The
+    defaults are heuristics tuned on a few machines.
+
+    A profile can be saved in a file with {!save} after {!calibrate}, for
+    instance with the executable [utils/calibrate.exe]. If the environment
+    variable [BLS12_381_PROFILE] is set when the library is loaded, the profile
+    it points to is loaded. An error is then reported on [stderr] and does not
+    stop the program.
+
+    The parameters are named:
+    - [threads], see {!set_number_of_threads};
+    - [msm_window_k] for [0 <= k <= 31], the window of Pippenger's algorithm
+      for [n] points, [2^k <= n < 2^(k + 1)], on {!G1} and {!G2}. [0] (the
+      default) means the window is chosen by blst. Otherwise between [2] and
+      [20];
+    - [g1_straus_b] and [g2_straus_b] for [b] in [64], [128] and [256], see
+      [set_straus_threshold];
+    - [poly_mul_naive_threshold], the number of coefficients up to which the
+      products of polynomials are naive instead of using a NTT;
+    - [ntt_parallel_log_size], the log of the minimal size of the NTTs split
+      between the threads;
+    - [ntt_task_size], the number of butterflies per task of the parallel
+      NTTs.
+
+    The JavaScript backend only keeps the values. *)
+module Tuning : sig
+  (** Return the names and the current values of the parameters *)
+  val parameters : unit -> (string * int) list
+
+  (** Return the current value of a parameter. Raise [Invalid_argument] if the
+      name is unknown. *)
+  val get : string -> int
+
+  (** [set name v] sets the parameter [name] to [v]. Raise [Invalid_argument]
+      if the name is unknown or if [v] is out of the range of the parameter. *)
+  val set : string -> int -> unit
+
+  (** Restore the values of the parameters when the library was loaded *)
+  val reset : unit -> unit
+
+  (** [save file] writes the current values in [file], one [name value] line
+      per parameter *)
+  val save : string -> unit
+
+  (** [load file] sets the parameters to the values of [file], written by
+      {!save}. Blank lines and lines starting with [#] are ignored, as well as
+      the unknown parameters. Raise [Failure] if a line is malformed or a value
+      is out of range, in which case no parameter is modified, and
+      [Sys_error] if the file can not be read. *)
+  val load : string -> unit
+
+  (** [calibrate ()] measures the kernels on this machine and sets the
+      parameters to the fastest values found. In this order:
+      - the number of threads, doubled up to [max_threads] (default [256])
+        while the MSMs of [2^max_log_npoints] points get faster;
+      - the windows of the MSMs of [2^4] to [2^max_log_npoints] points
+        (default [2^16]), shared by {!G1} and {!G2};
+      - the thresholds of Straus' algorithm;
+      - the parameters of the polynomial products, measured on multipoint
+        evaluations of size [2^max_log_poly_size] (default [2^12]). The
+        parameters of the parallel NTTs are only calibrated with several
+        threads.
+
+      It takes from a few seconds to a few minutes. [log] is called with a
+      description of each measurement. Raise [Invalid_argument] if
+      [max_log_npoints] is not between [4] and [31], [max_threads] between [1]
+      and [256] or [max_log_poly_size] between [1] and [24]. *)
+  val calibrate :
+    ?max_log_npoints:int ->
+    ?max_threads:int ->
+    ?max_log_poly_size:int ->
+    ?log:(string -> unit) ->
+    unit ->
+    unit
+end
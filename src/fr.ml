@@ -81,6 +81,65 @@ module Stubs = struct
 
   external inner_product : fr -> fr array -> fr array -> int -> int
     = "caml_blst_fr_inner_product_stubs"
+
+  type arena
+
+  external allocate_arena : int -> arena = "allocate_fr_arena_stubs"
+
+  external arena_set : arena -> int -> fr -> int = "caml_blst_fr_arena_set_stubs"
+
+  external arena_get : fr -> arena -> int -> int = "caml_blst_fr_arena_get_stubs"
+
+  external arena_copy : arena -> int -> int -> int
+    = "caml_blst_fr_arena_copy_stubs"
+
+  external arena_add : arena -> int -> int -> int -> int
+    = "caml_blst_fr_arena_add_stubs"
+
+  external arena_sub : arena -> int -> int -> int -> int
+    = "caml_blst_fr_arena_sub_stubs"
+
+  external arena_mul : arena -> int -> int -> int -> int
+    = "caml_blst_fr_arena_mul_stubs"
+
+  external arena_sqr : arena -> int -> int -> int
+    = "caml_blst_fr_arena_sqr_stubs"
+
+  external arena_cneg : arena -> int -> int -> int
+    = "caml_blst_fr_arena_cneg_stubs"
+
+  external arena_eucl_inverse : arena -> int -> int -> int
+    = "caml_blst_fr_arena_eucl_inverse_stubs"
+
+  external arena_is_zero : arena -> int -> bool
+    = "caml_blst_fr_arena_is_zero_stubs"
+
+  external arena_eq : arena -> int -> int -> bool
+    = "caml_blst_fr_arena_eq_stubs"
+
+  external poly_eval : fr -> fr array -> int -> fr -> int
+    = "caml_polynomial_eval_stubs"
+
+  external poly_eval_many : fr array -> fr array array -> int -> fr -> int
+    = "caml_polynomial_eval_many_stubs"
+
+  external poly_multi_eval :
+    fr array -> fr array -> int -> fr array -> int -> int
+    = "caml_polynomial_multi_eval_stubs"
+
+  external poly_interpolate : fr array -> fr array -> fr array -> int -> int
+    = "caml_polynomial_interpolate_stubs"
+
+  external grand_product : fr array -> fr array -> fr array -> int -> int
+    = "caml_fr_grand_product_stubs"
+
+  type scalar_batch
+
+  external allocate_scalar_batch : int -> scalar_batch
+    = "allocate_scalar_batch_stubs"
+
+  external scalar_batch_set : scalar_batch -> fr array -> int
+    = "caml_blst_scalar_batch_set_stubs"
 end
 
 (* module = Blst_bindings.r (Blst_stubs) *)
@@ -379,7 +438,157 @@ module Fr = struct
         raise (Invalid_argument "Both parameters must be of the same length")
     | Some x -> x
 
+  let grand_product_exn a b =
+    let n = Array.length a in
+    if Array.length b <> n then
+      raise (Invalid_argument "Both parameters must be of the same length") ;
+    let res = Array.init (n + 1) (fun _ -> Stubs.mallocate_fr ()) in
+    match Stubs.grand_product res a b n with
+    | 0 -> res
+    | 2 -> raise Division_by_zero
+    | _ -> raise Out_of_memory
+
   let of_int x = of_z (Z.of_int x)
+
+  module Arena = struct
+    type elt = t
+
+    type t = Stubs.arena * int
+
+    let create n =
+      if n < 0 then
+        raise @@ Invalid_argument (Format.sprintf "Arena.create: size %i" n) ;
+      (Stubs.allocate_arena n, n)
+
+    let length (_, n) = n
+
+    let check_index n i =
+      if i < 0 || i >= n then
+        raise @@ Invalid_argument (Format.sprintf "Arena: index %i" i)
+
+    let set (a, n) i x =
+      check_index n i ;
+      ignore @@ Stubs.arena_set a i x
+
+    let get_inplace res (a, n) i =
+      check_index n i ;
+      ignore @@ Stubs.arena_get res a i
+
+    let get arena i =
+      let res = Stubs.mallocate_fr () in
+      get_inplace res arena i ;
+      res
+
+    let of_array xs =
+      let arena = create (Array.length xs) in
+      Array.iteri (fun i x -> set arena i x) xs ;
+      arena
+
+    let to_array ((_, n) as arena) = Array.init n (fun i -> get arena i)
+
+    let copy (a, n) r x =
+      check_index n r ;
+      check_index n x ;
+      ignore @@ Stubs.arena_copy a r x
+
+    let apply_binary f (a, n) r x y =
+      check_index n r ;
+      check_index n x ;
+      check_index n y ;
+      ignore @@ f a r x y
+
+    let apply_unary f (a, n) r x =
+      check_index n r ;
+      check_index n x ;
+      ignore @@ f a r x
+
+    let add arena r x y = apply_binary Stubs.arena_add arena r x y
+
+    let sub arena r x y = apply_binary Stubs.arena_sub arena r x y
+
+    let mul arena r x y = apply_binary Stubs.arena_mul arena r x y
+
+    let double arena r x = apply_binary Stubs.arena_add arena r x x
+
+    let square arena r x = apply_unary Stubs.arena_sqr arena r x
+
+    let negate arena r x = apply_unary Stubs.arena_cneg arena r x
+
+    let inverse_exn (a, n) r x =
+      check_index n r ;
+      check_index n x ;
+      if Stubs.arena_eucl_inverse a r x <> 0 then raise Division_by_zero
+
+    let is_zero (a, n) x =
+      check_index n x ;
+      Stubs.arena_is_zero a x
+
+    let eq (a, n) x y =
+      check_index n x ;
+      check_index n y ;
+      Stubs.arena_eq a x y
+  end
+
+  module Poly = struct
+    let fresh_array n = Array.init n (fun _ -> Stubs.mallocate_fr ())
+
+    (* The stubs only fail on memory allocation, except [poly_interpolate]
+       which also returns [2] if the points are not distinct *)
+    let check_result = function 0 -> () | _ -> raise Out_of_memory
+
+    let eval coefficients x =
+      let res = Stubs.mallocate_fr () in
+      check_result
+      @@ Stubs.poly_eval res coefficients (Array.length coefficients) x ;
+      res
+
+    let eval_many polys x =
+      let n = Array.length polys in
+      let res = fresh_array n in
+      check_result @@ Stubs.poly_eval_many res polys n x ;
+      res
+
+    let multi_eval ~coefficients ~points =
+      let m = Array.length points in
+      let res = fresh_array m in
+      check_result
+      @@ Stubs.poly_multi_eval
+           res
+           coefficients
+           (Array.length coefficients)
+           points
+           m ;
+      res
+
+    let interpolate ~points ~values =
+      let n = Array.length points in
+      if Array.length values <> n then
+        raise
+        @@ Invalid_argument
+             "Poly.interpolate: points and values must have the same length" ;
+      let res = fresh_array n in
+      match Stubs.poly_interpolate res points values n with
+      | 2 ->
+          raise
+          @@ Invalid_argument "Poly.interpolate: the points must be distinct"
+      | r ->
+          check_result r ;
+          res
+  end
+
+  module Scalar_batch = struct
+    type elt = t
+
+    type t = Stubs.scalar_batch * int
+
+    let create scalars =
+      let n = Array.length scalars in
+      let batch = Stubs.allocate_scalar_batch n in
+      ignore @@ Stubs.scalar_batch_set batch scalars ;
+      (batch, n)
+
+    let length (_, n) = n
+  end
 end
 
 include Fr
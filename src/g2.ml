@@ -40,6 +40,13 @@ module Stubs = struct
     affine_array -> jacobian array -> int -> int
     = "caml_blst_p2_affine_array_set_p2_points_stubs"
 
+  external add_bulk : jacobian -> jacobian array -> int -> int
+    = "caml_blst_p2_add_bulk_stubs"
+
+  external affine_array_add_bulk :
+    jacobian -> affine_array -> int -> int -> int
+    = "caml_blst_p2_affine_array_add_bulk_stubs"
+
   external from_affine : jacobian -> affine -> int
     = "caml_blst_p2_from_affine_stubs"
 
@@ -86,6 +93,8 @@ module Stubs = struct
 
   external memcpy : jacobian -> jacobian -> int = "caml_blst_p2_memcpy_stubs"
 
+  external normalize : jacobian -> int = "caml_blst_p2_normalize_stubs"
+
   external set_affine_coordinates : affine -> Fq2.t -> Fq2.t -> int
     = "caml_blst_p2_set_coordinates_stubs"
 
@@ -111,8 +120,161 @@ module Stubs = struct
     Unsigned.Size_t.t ->
     int = "caml_blst_g2_pippenger_contiguous_affine_array_stubs"
 
+  external pippenger_with_scalar_batch :
+    jacobian -> affine_array -> Fr.Stubs.scalar_batch -> int -> int -> int
+    = "caml_blst_g2_pippenger_scalar_batch_stubs"
+
+  external pippenger_multi :
+    jacobian array -> affine_array -> Fr.t array array -> int -> int -> int
+    = "caml_blst_g2_pippenger_multi_stubs"
+
+  external pippenger_glv :
+    jacobian -> affine_array -> Fr.t array -> int -> int -> int
+    = "caml_blst_g2_pippenger_glv_stubs"
+
   external mul_map_inplace : jacobian array -> Fr.Stubs.fr -> int -> int
     = "caml_mul_map_g2_inplace_stubs"
+
+  type arena
+
+  external allocate_arena : int -> arena = "allocate_p2_arena_stubs"
+
+  external arena_set : arena -> int -> jacobian -> int
+    = "caml_blst_p2_arena_set_stubs"
+
+  external arena_get : jacobian -> arena -> int -> int
+    = "caml_blst_p2_arena_get_stubs"
+
+  external arena_copy : arena -> int -> int -> int
+    = "caml_blst_p2_arena_copy_stubs"
+
+  external arena_dadd : arena -> int -> int -> int -> int
+    = "caml_blst_p2_arena_add_or_double_stubs"
+
+  external arena_double : arena -> int -> int -> int
+    = "caml_blst_p2_arena_double_stubs"
+
+  external arena_negate : arena -> int -> int -> int
+    = "caml_blst_p2_arena_negate_stubs"
+
+  external arena_mult : arena -> int -> int -> Fr.t -> int
+    = "caml_blst_p2_arena_mult_stubs"
+
+  external arena_is_zero : arena -> int -> bool
+    = "caml_blst_p2_arena_is_inf_stubs"
+
+  external arena_eq : arena -> int -> int -> bool
+    = "caml_blst_p2_arena_equal_stubs"
+
+  type prepared_bases
+
+  external allocate_prepared_bases : int -> int -> prepared_bases
+    = "allocate_p2_prepared_bases_stubs"
+
+  external prepared_bases_precompute : prepared_bases -> affine_array -> int
+    = "caml_blst_p2_prepared_bases_precompute_stubs"
+
+  external prepared_bases_mult :
+    jacobian -> prepared_bases -> Fr.t array -> int -> int -> int
+    = "caml_blst_p2_prepared_bases_mult_stubs"
+
+  type glv_bases
+
+  external allocate_glv_bases : int -> glv_bases = "allocate_p2_glv_bases_stubs"
+
+  external glv_bases_set : glv_bases -> affine_array -> int -> int
+    = "caml_blst_p2_glv_bases_set_stubs"
+
+  external glv_bases_mult :
+    jacobian -> glv_bases -> Fr.t array -> int -> int -> int
+    = "caml_blst_p2_glv_bases_mult_stubs"
+
+  type msm_context
+
+  external allocate_msm_context : unit -> msm_context
+    = "allocate_msm_context_stubs"
+
+  external msm_context_pippenger :
+    msm_context -> jacobian -> jacobian array -> Fr.t array -> int -> int -> int
+    = "caml_blst_g2_msm_context_pippenger_stubs_bytecode" "caml_blst_g2_msm_context_pippenger_stubs"
+
+  external msm_context_pippenger_with_affine_array :
+    msm_context -> jacobian -> affine_array -> Fr.t array -> int -> int -> int
+    = "caml_blst_g2_msm_context_pippenger_affine_stubs_bytecode" "caml_blst_g2_msm_context_pippenger_affine_stubs"
+
+  type msm_stream
+
+  external allocate_msm_stream : int -> msm_stream
+    = "allocate_p2_msm_stream_stubs"
+
+  external msm_stream_add :
+    msm_stream -> jacobian array -> Fr.t array -> int -> int -> unit
+    = "caml_blst_g2_msm_stream_add_stubs"
+
+  external msm_stream_add_with_affine_array :
+    msm_stream -> affine_array -> Fr.t array -> int -> int -> unit
+    = "caml_blst_g2_msm_stream_add_affine_stubs"
+
+  external msm_stream_finish : jacobian -> msm_stream -> unit
+    = "caml_blst_g2_msm_stream_finish_stubs"
+
+  external set_straus_threshold : int -> int -> int -> unit
+    = "caml_blst_set_straus_threshold_stubs"
+
+  external get_straus_threshold : int -> int -> int
+    = "caml_blst_get_straus_threshold_stubs"
+
+  external pippenger_indexed :
+    jacobian -> affine_array -> int array -> Fr.t array -> int -> int
+    = "caml_blst_g2_pippenger_indexed_stubs"
+
+  external pippenger_slice :
+    jacobian -> affine_array -> Fr.t array -> int -> int -> int -> int -> int
+    = "caml_blst_g2_pippenger_slice_stubs_bytecode" "caml_blst_g2_pippenger_slice_stubs"
+
+  type fixed_base
+
+  external allocate_fixed_base : int -> fixed_base
+    = "allocate_p2_fixed_base_stubs"
+
+  external fixed_base_precompute : fixed_base -> jacobian -> int
+    = "caml_blst_p2_fixed_base_precompute_stubs"
+
+  external mult_fixed_base : jacobian -> fixed_base -> Fr.t -> unit
+    = "caml_blst_p2_mult_fixed_base_stubs"
+
+  external mult_fixed_base_many :
+    jacobian array -> fixed_base -> Fr.t array -> int -> int
+    = "caml_blst_p2_mult_fixed_base_many_stubs"
+
+  external mult_many :
+    jacobian array -> jacobian array -> Fr.t array -> int -> bool -> int
+    = "caml_blst_p2_mult_many_stubs"
+
+  external mult_many_affine_array :
+    affine_array -> jacobian array -> Fr.t array -> int -> bool -> int
+    = "caml_blst_p2_mult_many_affine_array_stubs"
+
+  external mult_vartime : jacobian -> jacobian -> Fr.t -> int
+    = "caml_blst_p2_mult_vartime_stubs"
+
+  external linear_combination :
+    jacobian -> jacobian array -> Fr.t array -> int -> int
+    = "caml_blst_p2_linear_combination_stubs"
+
+  type prepared
+
+  external allocate_prepared : int -> prepared = "allocate_p2_prepared_stubs"
+
+  external prepare : prepared -> jacobian -> int
+    = "caml_blst_p2_prepare_stubs"
+
+  external mult_prepared : jacobian -> prepared -> Fr.t -> unit
+    = "caml_blst_p2_mult_prepared_stubs"
+
+  external mult_prepared_many :
+    jacobian array -> prepared -> Fr.t array -> int -> int
+    = "caml_blst_p2_mult_prepared_many_stubs"
 end
 
 module G2 = struct
@@ -237,9 +399,21 @@ module G2 = struct
     ignore @@ Stubs.dadd global_buffer x y ;
     memcpy x global_buffer
 
-  let add_bulk xs =
+  let add_bulk_array xs =
+    let buffer = Stubs.allocate_g2 () in
+    let res = Stubs.add_bulk buffer xs (Array.length xs) in
+    assert (res = 0) ;
+    buffer
+
+  let add_bulk xs = add_bulk_array (Array.of_list xs)
+
+  let add_bulk_affine_array ?(start = 0) ?len (ps, n) =
+    let len = Option.value ~default:(n - start) len in
+    if start < 0 || len < 0 || start + len > n then
+      raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
     let buffer = Stubs.allocate_g2 () in
-    List.iter (fun x -> ignore @@ Stubs.dadd buffer buffer x) xs ;
+    let res = Stubs.affine_array_add_bulk buffer ps start len in
+    assert (res = 0) ;
     buffer
 
   let double x =
@@ -261,6 +435,12 @@ module G2 = struct
     let bytes = Fr.to_bytes n in
     mul_bits g bytes
 
+  let mul_vartime g n =
+    let buffer = Stubs.allocate_g2 () in
+    let res = Stubs.mult_vartime buffer g n in
+    if res = 1 then raise Out_of_memory ;
+    buffer
+
   let mul_inplace g n =
     let bytes = Fr.to_bytes n in
     ignore
@@ -312,6 +492,16 @@ module G2 = struct
 
   let eq g1 g2 = Stubs.equal g1 g2
 
+  let equal = eq
+
+  let normalize_inplace p = ignore @@ Stubs.normalize p
+
+  let hash p = Hashtbl.hash (to_compressed_bytes p)
+
+  let compare x y =
+    if eq x y then 0
+    else Bytes.compare (to_compressed_bytes x) (to_compressed_bytes y)
+
   let is_zero x = eq x zero
 
   let order_minus_one = Scalar.(negate one)
@@ -428,6 +618,461 @@ module G2 = struct
       in
       assert (res = 0)) ;
     buffer
+
+  let check_straus_nbits nbits =
+    if nbits <> 64 && nbits <> 128 && nbits <> 256 then
+      raise @@ Invalid_argument (Format.sprintf "nbits %i" nbits)
+
+  let set_straus_threshold ~nbits n =
+    check_straus_nbits nbits ;
+    if n < 0 then raise @@ Invalid_argument (Format.sprintf "threshold %i" n) ;
+    Stubs.set_straus_threshold 1 nbits n
+
+  let get_straus_threshold ~nbits =
+    check_straus_nbits nbits ;
+    Stubs.get_straus_threshold 1 nbits
+
+  let pippenger_with_scalar_batch ?(start = 0) ?len (ps, n) (batch, m) =
+    let l = min n m in
+    let len = Option.value ~default:(l - start) len in
+    if start < 0 || len < 1 || start + len > l then
+      raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+    let buffer = Stubs.allocate_g2 () in
+    let res = Stubs.pippenger_with_scalar_batch buffer ps batch start len in
+    if res = 1 then raise Out_of_memory ;
+    buffer
+
+  let pippenger_multi ?(start = 0) ?len (ps, n) sss =
+    let l = Array.fold_left (fun l ss -> min l (Array.length ss)) n sss in
+    let len = Option.value ~default:(l - start) len in
+    if start < 0 || len < 1 || start + len > l then
+      raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+    let buffers = Array.map (fun _ -> Stubs.allocate_g2 ()) sss in
+    let res = Stubs.pippenger_multi buffers ps sss start len in
+    if res = 1 then raise Out_of_memory ;
+    buffers
+
+  let pippenger_glv ?(start = 0) ?len (ps, n) ss =
+    let l = min n (Array.length ss) in
+    let len = Option.value ~default:(l - start) len in
+    if start < 0 || len < 1 || start + len > l then
+      raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+    let buffer = Stubs.allocate_g2 () in
+    let res = Stubs.pippenger_glv buffer ps ss start len in
+    if res = 1 then raise Out_of_memory ;
+    buffer
+
+  module Arena = struct
+    type elt = t
+
+    type t = Stubs.arena * int
+
+    let create n =
+      if n < 0 then
+        raise @@ Invalid_argument (Format.sprintf "Arena.create: size %i" n) ;
+      (Stubs.allocate_arena n, n)
+
+    let length (_, n) = n
+
+    let check_index n i =
+      if i < 0 || i >= n then
+        raise @@ Invalid_argument (Format.sprintf "Arena: index %i" i)
+
+    let set (a, n) i x =
+      check_index n i ;
+      ignore @@ Stubs.arena_set a i x
+
+    let get_inplace res (a, n) i =
+      check_index n i ;
+      ignore @@ Stubs.arena_get res a i
+
+    let get arena i =
+      let res = Stubs.allocate_g2 () in
+      get_inplace res arena i ;
+      res
+
+    let of_array xs =
+      let arena = create (Array.length xs) in
+      Array.iteri (fun i x -> set arena i x) xs ;
+      arena
+
+    let to_array ((_, n) as arena) = Array.init n (fun i -> get arena i)
+
+    let copy (a, n) r x =
+      check_index n r ;
+      check_index n x ;
+      ignore @@ Stubs.arena_copy a r x
+
+    let add (a, n) r x y =
+      check_index n r ;
+      check_index n x ;
+      check_index n y ;
+      ignore @@ Stubs.arena_dadd a r x y
+
+    let double (a, n) r x =
+      check_index n r ;
+      check_index n x ;
+      ignore @@ Stubs.arena_double a r x
+
+    let negate (a, n) r x =
+      check_index n r ;
+      check_index n x ;
+      ignore @@ Stubs.arena_negate a r x
+
+    let mul (a, n) r x s =
+      check_index n r ;
+      check_index n x ;
+      ignore @@ Stubs.arena_mult a r x s
+
+    let is_zero (a, n) x =
+      check_index n x ;
+      Stubs.arena_is_zero a x
+
+    let eq (a, n) x y =
+      check_index n x ;
+      check_index n y ;
+      Stubs.arena_eq a x y
+  end
+
+  module Prepared_bases = struct
+    type elt = t
+
+    type t = Stubs.prepared_bases * int * int
+
+    let create ?window (ps, n) =
+      let window =
+        match window with
+        | Some window -> window
+        | None -> min 13 (max 8 (Z.log2 (Z.of_int (max n 1))))
+      in
+      if window < 2 || window > 14 then
+        raise
+        @@ Invalid_argument
+             (Format.sprintf "Prepared_bases.create: window %i" window) ;
+      let bases = Stubs.allocate_prepared_bases window n in
+      let res = Stubs.prepared_bases_precompute bases ps in
+      if res = 1 then raise Out_of_memory ;
+      (bases, n, window)
+
+    let length (_, n, _) = n
+
+    let window (_, _, window) = window
+
+    let msm ?(start = 0) ?len (bases, n, _) ss =
+      let l = min n (Array.length ss) in
+      let len = Option.value ~default:(l - start) len in
+      if start < 0 || len < 1 || start + len > l then
+        raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+      let buffer = Stubs.allocate_g2 () in
+      let res = Stubs.prepared_bases_mult buffer bases ss start len in
+      if res = 1 then raise Out_of_memory ;
+      buffer
+  end
+
+  module Glv_bases = struct
+    type elt = t
+
+    type t = Stubs.glv_bases * int
+
+    let create (ps, n) =
+      let bases = Stubs.allocate_glv_bases n in
+      ignore @@ Stubs.glv_bases_set bases ps n ;
+      (bases, n)
+
+    let length (_, n) = n
+
+    let msm ?(start = 0) ?len (bases, n) ss =
+      let l = min n (Array.length ss) in
+      let len = Option.value ~default:(l - start) len in
+      if start < 0 || len < 1 || start + len > l then
+        raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+      let buffer = Stubs.allocate_g2 () in
+      let res = Stubs.glv_bases_mult buffer bases ss start len in
+      if res = 1 then raise Out_of_memory ;
+      buffer
+  end
+
+  module Msm_context = struct
+    type elt = t
+
+    type t = Stubs.msm_context
+
+    let create () = Stubs.allocate_msm_context ()
+
+    let pippenger ?(start = 0) ?len ctx ps ss =
+      let l = min (Array.length ps) (Array.length ss) in
+      let len = Option.value ~default:(l - start) len in
+      if start < 0 || len < 1 || start + len > l then
+        raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+      if len = 1 then mul ps.(start) ss.(start)
+      else
+        let buffer = Stubs.allocate_g2 () in
+        let res = Stubs.msm_context_pippenger ctx buffer ps ss start len in
+        if res = 1 then raise Out_of_memory ;
+        buffer
+
+    let pippenger_with_affine_array ?(start = 0) ?len ctx (ps, n) ss =
+      let l = min n (Array.length ss) in
+      let len = Option.value ~default:(l - start) len in
+      if start < 0 || len < 1 || start + len > l then
+        raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+      let buffer = Stubs.allocate_g2 () in
+      (if len = 1 then (
+       ignore @@ Stubs.continuous_array_get buffer ps start ;
+       mul_inplace buffer ss.(start))
+      else
+        let res =
+          Stubs.msm_context_pippenger_with_affine_array
+            ctx
+            buffer
+            ps
+            ss
+            start
+            len
+        in
+        if res = 1 then raise Out_of_memory) ;
+      buffer
+  end
+
+  module Msm_stream = struct
+    type elt = t
+
+    type t = Stubs.msm_stream
+
+    let create ?(window = 10) () =
+      if window < 2 || window > 16 then
+        raise @@ Invalid_argument (Format.sprintf "window %i" window) ;
+      Stubs.allocate_msm_stream window
+
+    let add ?(start = 0) ?len stream ps ss =
+      let l = min (Array.length ps) (Array.length ss) in
+      let len = Option.value ~default:(l - start) len in
+      if start < 0 || len < 0 || start + len > l then
+        raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+      Stubs.msm_stream_add stream ps ss start len
+
+    let add_with_affine_array ?(start = 0) ?len stream (ps, n) ss =
+      let l = min n (Array.length ss) in
+      let len = Option.value ~default:(l - start) len in
+      if start < 0 || len < 0 || start + len > l then
+        raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+      Stubs.msm_stream_add_with_affine_array stream ps ss start len
+
+    let finish stream =
+      let buffer = Stubs.allocate_g2 () in
+      Stubs.msm_stream_finish buffer stream ;
+      buffer
+  end
+
+  module Commitment = struct
+    type elt = t
+
+    type t = {bases : affine_array; mutable commitment : elt}
+
+    let of_commitment bases commitment = {bases; commitment}
+
+    let create ((_, n) as bases) ss =
+      let l = Array.length ss in
+      if l > n then
+        raise @@ Invalid_argument (Format.sprintf "%i scalars, %i bases" l n) ;
+      let commitment =
+        if l = 0 then zero else pippenger_with_affine_array ~len:l bases ss
+      in
+      {bases; commitment}
+
+    let commitment t = t.commitment
+
+    let check_index (_, n) i =
+      if i < 0 || i >= n then
+        raise @@ Invalid_argument (Format.sprintf "index %i" i)
+
+    let update t i old new_ =
+      check_index t.bases i ;
+      let (ps, _) = t.bases in
+      let buffer = Stubs.allocate_g2 () in
+      ignore @@ Stubs.continuous_array_get buffer ps i ;
+      mul_inplace buffer (Scalar.sub new_ old) ;
+      t.commitment <- add t.commitment buffer
+
+    let update_many t updates =
+      Array.iter (fun (i, _, _) -> check_index t.bases i) updates ;
+      match updates with
+      | [||] -> ()
+      | [|(i, old, new_)|] -> update t i old new_
+      | _ ->
+          let (ps, _) = t.bases in
+          let indices = Array.map (fun (i, _, _) -> i) updates in
+          let deltas =
+            Array.map (fun (_, old, new_) -> Scalar.sub new_ old) updates
+          in
+          let len = Array.length updates in
+          let buffer = Stubs.allocate_g2 () in
+          let res = Stubs.pippenger_indexed buffer ps indices deltas len in
+          if res = 1 then raise Out_of_memory ;
+          t.commitment <- add t.commitment buffer
+  end
+
+  module Partial = struct
+    type elt = t
+
+    type t = elt
+
+    let size_in_bytes = size_in_bytes / 2
+
+    let to_bytes = to_compressed_bytes
+
+    let of_bytes_opt bs =
+      if Bytes.length bs <> size_in_bytes then None
+      else of_compressed_bytes_opt bs
+
+    let of_bytes_exn bs =
+      match of_bytes_opt bs with None -> raise (Not_on_curve bs) | Some p -> p
+  end
+
+  (* The scalars are elements of Fr, i.e. on 255 bits *)
+  let scalar_nbits = 255
+
+  let pippenger_partial ?(start = 0) ?len ?(slice = (0, 1)) ((ps, n) as bases)
+      ss =
+    let (k, nslices) = slice in
+    if nslices < 1 || nslices > 64 || k < 0 || k >= nslices then
+      raise @@ Invalid_argument (Format.sprintf "slice %i of %i" k nslices) ;
+    let l = min n (Array.length ss) in
+    let len = Option.value ~default:(l - start) len in
+    if start < 0 || len < 1 || start + len > l then
+      raise @@ Invalid_argument (Format.sprintf "start %i len %i" start len) ;
+    if nslices = 1 then pippenger_with_affine_array ~start ~len bases ss
+    else
+      let buffer = Stubs.allocate_g2 () in
+      let bit0 = k * scalar_nbits / nslices in
+      let bit1 = (k + 1) * scalar_nbits / nslices in
+      let res = Stubs.pippenger_slice buffer ps ss start len bit0 bit1 in
+      if res = 1 then raise Out_of_memory ;
+      buffer
+
+  let merge partials = List.fold_left add zero partials
+
+  module Fixed_base = struct
+    type elt = t
+
+    type t = Stubs.fixed_base * int
+
+    let create ?(window = 6) p =
+      if window < 2 || window > 10 then
+        raise
+        @@ Invalid_argument
+             (Format.sprintf "Fixed_base.create: window %i" window) ;
+      let table = Stubs.allocate_fixed_base window in
+      let res = Stubs.fixed_base_precompute table p in
+      if res = 1 then raise Out_of_memory ;
+      (table, window)
+
+    let one_table = ref None
+
+    let one () =
+      match !one_table with
+      | Some table -> table
+      | None ->
+          let table = create one in
+          one_table := Some table ;
+          table
+
+    let window (_, window) = window
+
+    let mul (table, _) s =
+      let buffer = Stubs.allocate_g2 () in
+      Stubs.mult_fixed_base buffer table s ;
+      buffer
+  end
+
+  let mul_fixed_base_many (table, _) ss =
+    let n = Array.length ss in
+    let res = Array.init n (fun _ -> Stubs.allocate_g2 ()) in
+    if n > 0 then (
+      let r = Stubs.mult_fixed_base_many res table ss n in
+      if r = 1 then raise Out_of_memory) ;
+    res
+
+  let check_mul_many ps ss =
+    if Array.length ps <> Array.length ss then
+      raise
+      @@ Invalid_argument
+           (Format.sprintf
+              "mul_many: %i points and %i scalars"
+              (Array.length ps)
+              (Array.length ss))
+
+  let mul_many ?(vartime = false) ps ss =
+    check_mul_many ps ss ;
+    let n = Array.length ps in
+    let res = Array.init n (fun _ -> Stubs.allocate_g2 ()) in
+    if n > 0 then (
+      let r = Stubs.mult_many res ps ss n vartime in
+      if r = 1 then raise Out_of_memory) ;
+    res
+
+  let mul_many_affine_array ?(vartime = false) ps ss =
+    check_mul_many ps ss ;
+    let n = Array.length ps in
+    let buffer = Stubs.allocate_g2_affine_contiguous_array n in
+    if n > 0 then (
+      let r = Stubs.mult_many_affine_array buffer ps ss n vartime in
+      if r = 1 then raise Out_of_memory) ;
+    (buffer, n)
+
+  (* Up to this number of points, the GLS linear combination is faster than
+     pippenger *)
+  let linear_combination_max_size = 4
+
+  let linear_combination ps ss =
+    let n = Array.length ps in
+    if n <> Array.length ss then
+      raise
+      @@ Invalid_argument
+           (Format.sprintf
+              "linear_combination: %i points and %i scalars"
+              n
+              (Array.length ss)) ;
+    if n = 0 then zero
+    else if n <= linear_combination_max_size then (
+      let buffer = Stubs.allocate_g2 () in
+      let r = Stubs.linear_combination buffer ps ss n in
+      if r = 1 then raise Out_of_memory ;
+      buffer)
+    else pippenger ps ss
+
+  let mul2 p a q b = linear_combination [|p; q|] [|a; b|]
+
+  module Prepared = struct
+    type elt = t
+
+    type t = Stubs.prepared * int
+
+    let create ?(window = 5) p =
+      if window < 2 || window > 8 then
+        raise
+        @@ Invalid_argument
+             (Format.sprintf "Prepared.create: window %i" window) ;
+      let prepared = Stubs.allocate_prepared window in
+      let res = Stubs.prepare prepared p in
+      if res = 1 then raise Out_of_memory ;
+      (prepared, window)
+
+    let window (_, window) = window
+
+    let mul (prepared, _) s =
+      let buffer = Stubs.allocate_g2 () in
+      Stubs.mult_prepared buffer prepared s ;
+      buffer
+
+    let mul_many (prepared, _) ss =
+      let n = Array.length ss in
+      let res = Array.init n (fun _ -> Stubs.allocate_g2 ()) in
+      if n > 0 then (
+        let r = Stubs.mult_prepared_many res prepared ss n in
+        if r = 1 then raise Out_of_memory) ;
+      res
+  end
 end
 
 include G2
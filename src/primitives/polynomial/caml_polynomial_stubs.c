@@ -0,0 +1,142 @@
+#include "blst.h"
+#include "caml_bls12_381_stubs.h"
+#include "polynomial.h"
+#include <caml/memory.h>
+#include <caml/mlvalues.h>
+
+// The kernels work on contiguous arrays. The OCaml arrays of Fr elements are
+// copied in a C buffer. The caller must free the buffer.
+static blst_fr *fr_buffer_of_array(value array, size_t n) {
+  blst_fr *buffer = (blst_fr *)malloc((n > 0 ? n : 1) * sizeof(blst_fr));
+  if (buffer == NULL)
+    return (NULL);
+  for (size_t i = 0; i < n; i++)
+    memcpy(buffer + i, Fr_val_k(array, i), sizeof(blst_fr));
+  return (buffer);
+}
+
+static void fr_array_of_buffer(value array, blst_fr *buffer, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    memcpy(Fr_val_k(array, i), buffer + i, sizeof(blst_fr));
+}
+
+CAMLprim value caml_polynomial_eval_stubs(value res, value coefficients,
+                                          value n, value x) {
+  CAMLparam4(res, coefficients, n, x);
+  size_t n_c = Int_val(n);
+  blst_fr *coefficients_c = fr_buffer_of_array(coefficients, n_c);
+  if (coefficients_c == NULL)
+    CAMLreturn(CAML_BLS12_381_OUTPUT_OUT_OF_MEMORY);
+  int ret =
+      poly_eval_fr(Blst_fr_val(res), coefficients_c, n_c, Blst_fr_val(x));
+  free(coefficients_c);
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_polynomial_eval_many_stubs(value res, value polys,
+                                               value nb_polys, value x) {
+  CAMLparam4(res, polys, nb_polys, x);
+  size_t nb_polys_c = Int_val(nb_polys);
+  size_t total = 0;
+  for (size_t i = 0; i < nb_polys_c; i++)
+    total += Wosize_val(Field(polys, i));
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  size_t offset = 0;
+  blst_fr *buffer = (blst_fr *)malloc((total > 0 ? total : 1) * sizeof(blst_fr));
+  const blst_fr **polys_c =
+      (const blst_fr **)malloc((nb_polys_c + 1) * sizeof(blst_fr *));
+  size_t *lengths = (size_t *)malloc((nb_polys_c + 1) * sizeof(size_t));
+  blst_fr *res_c = (blst_fr *)malloc((nb_polys_c + 1) * sizeof(blst_fr));
+  if (buffer == NULL || polys_c == NULL || lengths == NULL || res_c == NULL)
+    goto out;
+  for (size_t i = 0; i < nb_polys_c; i++) {
+    value poly = Field(polys, i);
+    lengths[i] = Wosize_val(poly);
+    polys_c[i] = buffer + offset;
+    for (size_t j = 0; j < lengths[i]; j++)
+      memcpy(buffer + offset + j, Fr_val_k(poly, j), sizeof(blst_fr));
+    offset += lengths[i];
+  }
+  ret = poly_eval_many_fr(res_c, polys_c, lengths, nb_polys_c, Blst_fr_val(x));
+  if (ret == POLYNOMIAL_SUCCESS)
+    fr_array_of_buffer(res, res_c, nb_polys_c);
+out:
+  free(buffer);
+  free(polys_c);
+  free(lengths);
+  free(res_c);
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_polynomial_multi_eval_stubs(value res, value coefficients,
+                                                value n, value points,
+                                                value m) {
+  CAMLparam5(res, coefficients, n, points, m);
+  size_t n_c = Int_val(n);
+  size_t m_c = Int_val(m);
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  blst_fr *coefficients_c = fr_buffer_of_array(coefficients, n_c);
+  blst_fr *points_c = fr_buffer_of_array(points, m_c);
+  blst_fr *res_c = (blst_fr *)malloc((m_c > 0 ? m_c : 1) * sizeof(blst_fr));
+  if (coefficients_c == NULL || points_c == NULL || res_c == NULL)
+    goto out;
+  ret = poly_multi_eval_fr(res_c, coefficients_c, n_c, points_c, m_c);
+  if (ret == POLYNOMIAL_SUCCESS)
+    fr_array_of_buffer(res, res_c, m_c);
+out:
+  free(coefficients_c);
+  free(points_c);
+  free(res_c);
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_polynomial_interpolate_stubs(value res, value points,
+                                                 value values, value n) {
+  CAMLparam4(res, points, values, n);
+  size_t n_c = Int_val(n);
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  blst_fr *points_c = fr_buffer_of_array(points, n_c);
+  blst_fr *values_c = fr_buffer_of_array(values, n_c);
+  blst_fr *res_c = (blst_fr *)malloc((n_c > 0 ? n_c : 1) * sizeof(blst_fr));
+  if (points_c == NULL || values_c == NULL || res_c == NULL)
+    goto out;
+  ret = poly_interpolate_fr(res_c, points_c, values_c, n_c);
+  if (ret == POLYNOMIAL_SUCCESS)
+    fr_array_of_buffer(res, res_c, n_c);
+out:
+  free(points_c);
+  free(values_c);
+  free(res_c);
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_fr_grand_product_stubs(value res, value a, value b,
+                                           value n) {
+  CAMLparam4(res, a, b, n);
+  size_t n_c = Int_val(n);
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  blst_fr *a_c = fr_buffer_of_array(a, n_c);
+  blst_fr *b_c = fr_buffer_of_array(b, n_c);
+  blst_fr *res_c = (blst_fr *)malloc((n_c + 1) * sizeof(blst_fr));
+  if (a_c == NULL || b_c == NULL || res_c == NULL)
+    goto out;
+  ret = fr_grand_product(res_c, a_c, b_c, n_c);
+  if (ret == POLYNOMIAL_SUCCESS)
+    fr_array_of_buffer(res, res_c, n_c + 1);
+out:
+  free(a_c);
+  free(b_c);
+  free(res_c);
+  CAMLreturn(Val_int(ret));
+}
+
+CAMLprim value caml_polynomial_set_parameter_stubs(value k, value v) {
+  CAMLparam2(k, v);
+  poly_set_parameter(Int_val(k), Int_val(v));
+  CAMLreturn(Val_unit);
+}
+
+CAMLprim value caml_polynomial_get_parameter_stubs(value k) {
+  CAMLparam1(k);
+  CAMLreturn(Val_int(poly_get_parameter(Int_val(k))));
+}
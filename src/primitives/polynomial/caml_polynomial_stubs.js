@@ -0,0 +1,157 @@
+// The JavaScript backend is single threaded and uses the naive algorithms:
+// Horner's method for the evaluations and the Lagrange formula for the
+// interpolation.
+
+//Provides: polynomial_horner_fr
+//Requires: wasm_call
+//Requires: Blst_fr, Blst_fr_val, blst_fr_sizeof, caml_blst_memcpy
+function polynomial_horner_fr(res, coefficients, n, x) {
+  // coefficients is a JS array of Uint8Array, x an Uint8Array
+  var acc = Blst_fr_val(new Blst_fr());
+  for (var i = n - 1; i >= 0; i--) {
+    wasm_call('_blst_fr_mul', acc, acc, x);
+    wasm_call('_blst_fr_add', acc, acc, coefficients[i]);
+  }
+  caml_blst_memcpy(res, acc, blst_fr_sizeof());
+}
+
+//Provides: polynomial_fr_buffers_of_array
+//Requires: Blst_fr_val
+function polynomial_fr_buffers_of_array(array, n) {
+  var res = new Array(n);
+  for (var i = 0; i < n; i++) {
+    res[i] = Blst_fr_val(array[i + 1]);
+  }
+  return res;
+}
+
+//Provides: caml_polynomial_eval_stubs
+//Requires: polynomial_horner_fr, polynomial_fr_buffers_of_array, Blst_fr_val
+function caml_polynomial_eval_stubs(res, coefficients, n, x) {
+  polynomial_horner_fr(
+      Blst_fr_val(res),
+      polynomial_fr_buffers_of_array(coefficients, n),
+      n,
+      Blst_fr_val(x)
+  );
+  return 0;
+}
+
+//Provides: caml_polynomial_eval_many_stubs
+//Requires: polynomial_horner_fr, polynomial_fr_buffers_of_array, Blst_fr_val
+function caml_polynomial_eval_many_stubs(res, polys, nb_polys, x) {
+  for (var i = 0; i < nb_polys; i++) {
+    var poly = polys[i + 1];
+    var n = poly.length - 1;
+    polynomial_horner_fr(
+        Blst_fr_val(res[i + 1]),
+        polynomial_fr_buffers_of_array(poly, n),
+        n,
+        Blst_fr_val(x)
+    );
+  }
+  return 0;
+}
+
+//Provides: caml_polynomial_multi_eval_stubs
+//Requires: polynomial_horner_fr, polynomial_fr_buffers_of_array, Blst_fr_val
+function caml_polynomial_multi_eval_stubs(res, coefficients, n, points, m) {
+  var coefficients_c = polynomial_fr_buffers_of_array(coefficients, n);
+  for (var i = 0; i < m; i++) {
+    polynomial_horner_fr(
+        Blst_fr_val(res[i + 1]),
+        coefficients_c,
+        n,
+        Blst_fr_val(points[i + 1])
+    );
+  }
+  return 0;
+}
+
+//Provides: caml_polynomial_interpolate_stubs
+//Requires: wasm_call
+//Requires: polynomial_horner_fr, polynomial_fr_buffers_of_array
+//Requires: Blst_fr, Blst_fr_val, blst_fr_sizeof, caml_blst_memcpy
+function caml_polynomial_interpolate_stubs(res, points, values, n) {
+  if (n == 0) return 0;
+  var points_c = polynomial_fr_buffers_of_array(points, n);
+  var tmp = Blst_fr_val(new Blst_fr());
+  var i, k;
+  // m = prod (X - points[i])
+  var m = new Array(n + 1);
+  for (k = 0; k <= n; k++) m[k] = Blst_fr_val(new Blst_fr());
+  var one_le = new globalThis.Uint8Array(blst_fr_sizeof());
+  one_le[0] = 1;
+  wasm_call('_blst_fr_from_lendian', m[0], one_le);
+  for (i = 0; i < n; i++) {
+    for (k = i + 1; k >= 0; k--) {
+      wasm_call('_blst_fr_mul', tmp, m[k], points_c[i]);
+      if (k > 0) wasm_call('_blst_fr_sub', m[k], m[k - 1], tmp);
+      else wasm_call('_blst_fr_cneg', m[k], tmp, 1);
+    }
+  }
+  var acc = new Array(n);
+  var q = new Array(n);
+  for (k = 0; k < n; k++) {
+    acc[k] = Blst_fr_val(new Blst_fr());
+    q[k] = Blst_fr_val(new Blst_fr());
+  }
+  var weight = Blst_fr_val(new Blst_fr());
+  for (i = 0; i < n; i++) {
+    // q = m / (X - points[i])
+    caml_blst_memcpy(q[n - 1], m[n], blst_fr_sizeof());
+    for (k = n - 1; k > 0; k--) {
+      wasm_call('_blst_fr_mul', tmp, q[k], points_c[i]);
+      wasm_call('_blst_fr_add', q[k - 1], m[k], tmp);
+    }
+    polynomial_horner_fr(weight, q, n, points_c[i]);
+    if (wasm_call('_blst_fr_is_zero', weight)) return 2;
+    wasm_call('_blst_fr_eucl_inverse', weight, weight);
+    wasm_call('_blst_fr_mul', weight, weight, Blst_fr_val(values[i + 1]));
+    for (k = 0; k < n; k++) {
+      wasm_call('_blst_fr_mul', tmp, q[k], weight);
+      wasm_call('_blst_fr_add', acc[k], acc[k], tmp);
+    }
+  }
+  for (k = 0; k < n; k++) {
+    caml_blst_memcpy(Blst_fr_val(res[k + 1]), acc[k], blst_fr_sizeof());
+  }
+  return 0;
+}
+
+//Provides: caml_fr_grand_product_stubs
+//Requires: wasm_call
+//Requires: Blst_fr, Blst_fr_val, blst_fr_sizeof, caml_blst_memcpy
+function caml_fr_grand_product_stubs(res, a, b, n) {
+  var acc = Blst_fr_val(new Blst_fr());
+  var tmp = Blst_fr_val(new Blst_fr());
+  var one_le = new globalThis.Uint8Array(blst_fr_sizeof());
+  one_le[0] = 1;
+  wasm_call('_blst_fr_from_lendian', acc, one_le);
+  caml_blst_memcpy(Blst_fr_val(res[1]), acc, blst_fr_sizeof());
+  for (var i = 0; i < n; i++) {
+    if (wasm_call('_blst_fr_is_zero', Blst_fr_val(b[i + 1]))) return 2;
+    wasm_call('_blst_fr_eucl_inverse', tmp, Blst_fr_val(b[i + 1]));
+    wasm_call('_blst_fr_mul', tmp, tmp, Blst_fr_val(a[i + 1]));
+    wasm_call('_blst_fr_mul', acc, acc, tmp);
+    caml_blst_memcpy(Blst_fr_val(res[i + 2]), acc, blst_fr_sizeof());
+  }
+  return 0;
+}
+
+// The parameters are kept for the getters, the JavaScript kernels are naive
+//Provides: caml_polynomial_parameters
+var caml_polynomial_parameters = [32, 14, 4096];
+
+//Provides: caml_polynomial_set_parameter_stubs
+//Requires: caml_polynomial_parameters
+function caml_polynomial_set_parameter_stubs(k, v) {
+  caml_polynomial_parameters[k] = v;
+  return 0;
+}
+
+//Provides: caml_polynomial_get_parameter_stubs
+//Requires: caml_polynomial_parameters
+function caml_polynomial_get_parameter_stubs(k) {
+  return caml_polynomial_parameters[k];
+}
@@ -0,0 +1,797 @@
+#include "polynomial.h"
+#include "caml_bls12_381_parallel.h"
+
+// Below these sizes, the quasi-linear algorithms are slower than the naive
+// ones.
+#define POLY_MUL_NAIVE_THRESHOLD 32
+#define POLY_MULTI_EVAL_NAIVE_THRESHOLD 64
+// Minimal number of coefficients per chunk when evaluating in parallel
+#define POLY_EVAL_MIN_CHUNK_SIZE 1024
+// Minimal number of elements per block of the parallel grand product
+#define GRAND_PRODUCT_MIN_BLOCK_SIZE 1024
+// Minimal size of a NTT to split the butterflies between the threads, and
+// number of butterflies per task.
+#define POLY_NTT_PARALLEL_LOG_SIZE 14
+#define POLY_NTT_TASK_SIZE 4096
+
+// Current values of the tunable parameters, see poly_set_parameter
+static size_t poly_parameters[POLY_NB_PARAMETERS] = {
+    POLY_MUL_NAIVE_THRESHOLD, POLY_NTT_PARALLEL_LOG_SIZE, POLY_NTT_TASK_SIZE};
+
+void poly_set_parameter(int k, size_t v) { poly_parameters[k] = v; }
+
+size_t poly_get_parameter(int k) { return (poly_parameters[k]); }
+
+// 7^((r - 1) / 2^32), primitive 2^32-th root of unity of Fr, in canonical
+// form, least significant limb first.
+#define FR_TWO_ADICITY 32
+static const uint64_t FR_ROOT_OF_UNITY[4] = {
+    0x3829971f439f0d2bULL, 0xb63683508c2280b9ULL, 0xd09b681922c813b4ULL,
+    0x16a2a19edfe81f20ULL};
+
+static void fr_of_u64(blst_fr *res, uint64_t v) {
+  uint64_t limbs[4] = {v, 0, 0, 0};
+  blst_fr_from_uint64(res, limbs);
+}
+
+static void fr_pow_u64(blst_fr *res, const blst_fr *x, uint64_t e) {
+  blst_fr acc, base;
+  fr_of_u64(&acc, 1);
+  memcpy(&base, x, sizeof(blst_fr));
+  while (e > 0) {
+    if (e & 1)
+      blst_fr_mul(&acc, &acc, &base);
+    blst_fr_sqr(&base, &base);
+    e >>= 1;
+  }
+  memcpy(res, &acc, sizeof(blst_fr));
+}
+
+static int fr_is_zero(const blst_fr *x) {
+  blst_fr zero;
+  memset(&zero, 0, sizeof(blst_fr));
+  return (memcmp(x, &zero, sizeof(blst_fr)) == 0);
+}
+
+static void horner(blst_fr *res, const blst_fr *coefficients, size_t n,
+                   const blst_fr *x) {
+  blst_fr acc;
+  memset(&acc, 0, sizeof(blst_fr));
+  for (size_t i = n; i-- > 0;) {
+    blst_fr_mul(&acc, &acc, x);
+    blst_fr_add(&acc, &acc, coefficients + i);
+  }
+  memcpy(res, &acc, sizeof(blst_fr));
+}
+
+// Montgomery's trick. res and a can be the same array. Returns
+// POLYNOMIAL_INVALID_ARGUMENT if one of the elements is zero.
+static int fr_batch_inverse(blst_fr *res, const blst_fr *a, size_t n) {
+  if (n == 0)
+    return (POLYNOMIAL_SUCCESS);
+  blst_fr *prefix = malloc(n * sizeof(blst_fr));
+  if (prefix == NULL)
+    return (POLYNOMIAL_OUT_OF_MEMORY);
+  memcpy(prefix, a, sizeof(blst_fr));
+  for (size_t i = 1; i < n; i++)
+    blst_fr_mul(prefix + i, prefix + i - 1, a + i);
+  if (fr_is_zero(prefix + n - 1)) {
+    free(prefix);
+    return (POLYNOMIAL_INVALID_ARGUMENT);
+  }
+  blst_fr inv, tmp;
+  blst_fr_eucl_inverse(&inv, prefix + n - 1);
+  for (size_t i = n - 1; i > 0; i--) {
+    memcpy(&tmp, a + i, sizeof(blst_fr));
+    blst_fr_mul(res + i, &inv, prefix + i - 1);
+    blst_fr_mul(&inv, &inv, &tmp);
+  }
+  memcpy(res, &inv, sizeof(blst_fr));
+  free(prefix);
+  return (POLYNOMIAL_SUCCESS);
+}
+
+// Evaluation
+
+typedef struct {
+  const blst_fr *coefficients;
+  size_t n;
+  size_t chunk_size;
+  const blst_fr *x;
+  blst_fr *chunks;
+} eval_ctx;
+
+static void eval_chunk(size_t k, void *arg) {
+  eval_ctx *ctx = (eval_ctx *)arg;
+  size_t start = k * ctx->chunk_size;
+  size_t len = ctx->n - start < ctx->chunk_size ? ctx->n - start
+                                                 : ctx->chunk_size;
+  horner(ctx->chunks + k, ctx->coefficients + start, len, ctx->x);
+}
+
+int poly_eval_fr(blst_fr *res, const blst_fr *coefficients, size_t n,
+                 const blst_fr *x) {
+  size_t nb_threads = caml_bls12_381_get_nb_threads();
+  if (nb_threads <= 1 || n < 2 * POLY_EVAL_MIN_CHUNK_SIZE) {
+    horner(res, coefficients, n, x);
+    return (POLYNOMIAL_SUCCESS);
+  }
+  size_t nb_chunks = n / POLY_EVAL_MIN_CHUNK_SIZE;
+  if (nb_chunks > nb_threads)
+    nb_chunks = nb_threads;
+  size_t chunk_size = (n + nb_chunks - 1) / nb_chunks;
+  nb_chunks = (n + chunk_size - 1) / chunk_size;
+  blst_fr *chunks = malloc(nb_chunks * sizeof(blst_fr));
+  if (chunks == NULL)
+    return (POLYNOMIAL_OUT_OF_MEMORY);
+  eval_ctx ctx = {coefficients, n, chunk_size, x, chunks};
+  caml_bls12_381_parallel_for(nb_chunks, eval_chunk, &ctx);
+  // P(x) = sum_k P_k(x) x^(k * chunk_size)
+  blst_fr x_chunk;
+  fr_pow_u64(&x_chunk, x, chunk_size);
+  horner(res, chunks, nb_chunks, &x_chunk);
+  free(chunks);
+  return (POLYNOMIAL_SUCCESS);
+}
+
+typedef struct {
+  blst_fr *res;
+  const blst_fr *const *polys;
+  const size_t *lengths;
+  const blst_fr *x;
+} eval_many_ctx;
+
+static void eval_many_task(size_t i, void *arg) {
+  eval_many_ctx *ctx = (eval_many_ctx *)arg;
+  horner(ctx->res + i, ctx->polys[i], ctx->lengths[i], ctx->x);
+}
+
+int poly_eval_many_fr(blst_fr *res, const blst_fr *const *polys,
+                      const size_t *lengths, size_t nb_polys,
+                      const blst_fr *x) {
+  if (nb_polys == 1)
+    return (poly_eval_fr(res, polys[0], lengths[0], x));
+  eval_many_ctx ctx = {res, polys, lengths, x};
+  caml_bls12_381_parallel_for(nb_polys, eval_many_task, &ctx);
+  return (POLYNOMIAL_SUCCESS);
+}
+
+// NTT
+
+static size_t bitreverse_size(size_t n, size_t l) {
+  size_t r = 0;
+  while (l-- > 0) {
+    r = (r << 1) | (n & 1);
+    n = n >> 1;
+  }
+  return r;
+}
+
+typedef struct {
+  blst_fr *a;
+  const blst_fr *twiddles;
+  size_t half;
+  size_t step;
+  size_t nb_butterflies;
+  size_t task_size;
+} ntt_layer_ctx;
+
+static void ntt_layer_task(size_t k, void *arg) {
+  ntt_layer_ctx *ctx = (ntt_layer_ctx *)arg;
+  blst_fr t;
+  size_t end = (k + 1) * ctx->task_size;
+  if (end > ctx->nb_butterflies)
+    end = ctx->nb_butterflies;
+  for (size_t b = k * ctx->task_size; b < end; b++) {
+    size_t j = b % ctx->half;
+    size_t i = (b / ctx->half) * 2 * ctx->half + j;
+    blst_fr_mul(&t, ctx->a + i + ctx->half, ctx->twiddles + j * ctx->step);
+    blst_fr_sub(ctx->a + i + ctx->half, ctx->a + i, &t);
+    blst_fr_add(ctx->a + i, ctx->a + i, &t);
+  }
+}
+
+// In place NTT of size 2^logn. If inverse is set, computes the inverse
+// transform, including the division by 2^logn.
+static int ntt_fr_inplace(blst_fr *a, size_t logn, int inverse) {
+  size_t n = (size_t)1 << logn;
+  blst_fr tmp, w;
+  for (size_t i = 0; i < n; i++) {
+    size_t j = bitreverse_size(i, logn);
+    if (i < j) {
+      memcpy(&tmp, a + i, sizeof(blst_fr));
+      memcpy(a + i, a + j, sizeof(blst_fr));
+      memcpy(a + j, &tmp, sizeof(blst_fr));
+    }
+  }
+  if (n == 1)
+    return (POLYNOMIAL_SUCCESS);
+
+  blst_fr *twiddles = malloc((n / 2) * sizeof(blst_fr));
+  if (twiddles == NULL)
+    return (POLYNOMIAL_OUT_OF_MEMORY);
+  blst_fr_from_uint64(&w, FR_ROOT_OF_UNITY);
+  for (size_t i = logn; i < FR_TWO_ADICITY; i++)
+    blst_fr_sqr(&w, &w);
+  if (inverse)
+    blst_fr_eucl_inverse(&w, &w);
+  fr_of_u64(twiddles, 1);
+  for (size_t j = 1; j < n / 2; j++)
+    blst_fr_mul(twiddles + j, twiddles + j - 1, &w);
+
+  size_t task_size = poly_parameters[POLY_PARAMETER_NTT_TASK_SIZE];
+  size_t nb_tasks = (n / 2 + task_size - 1) / task_size;
+  for (size_t half = 1; half < n; half <<= 1) {
+    ntt_layer_ctx ctx = {a, twiddles, half, n / (2 * half), n / 2, task_size};
+    if (logn >= poly_parameters[POLY_PARAMETER_NTT_PARALLEL_LOG_SIZE])
+      caml_bls12_381_parallel_for(nb_tasks, ntt_layer_task, &ctx);
+    else
+      for (size_t k = 0; k < nb_tasks; k++)
+        ntt_layer_task(k, &ctx);
+  }
+  free(twiddles);
+
+  if (inverse) {
+    fr_of_u64(&tmp, n);
+    blst_fr_eucl_inverse(&tmp, &tmp);
+    for (size_t i = 0; i < n; i++)
+      blst_fr_mul(a + i, a + i, &tmp);
+  }
+  return (POLYNOMIAL_SUCCESS);
+}
+
+// Product
+
+int poly_mul_fr(blst_fr *res, const blst_fr *a, size_t la, const blst_fr *b,
+                size_t lb) {
+  if (la == 0 || lb == 0)
+    return (POLYNOMIAL_SUCCESS);
+  size_t lres = la + lb - 1;
+  size_t naive = poly_parameters[POLY_PARAMETER_MUL_NAIVE_THRESHOLD];
+  if (la <= naive || lb <= naive) {
+    blst_fr t;
+    memset(res, 0, lres * sizeof(blst_fr));
+    for (size_t i = 0; i < la; i++) {
+      for (size_t j = 0; j < lb; j++) {
+        blst_fr_mul(&t, a + i, b + j);
+        blst_fr_add(res + i + j, res + i + j, &t);
+      }
+    }
+    return (POLYNOMIAL_SUCCESS);
+  }
+
+  size_t logn = 0;
+  while (((size_t)1 << logn) < lres)
+    logn++;
+  if (logn > FR_TWO_ADICITY)
+    return (POLYNOMIAL_INVALID_ARGUMENT);
+  size_t n = (size_t)1 << logn;
+  blst_fr *fa = calloc(n, sizeof(blst_fr));
+  blst_fr *fb = calloc(n, sizeof(blst_fr));
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  if (fa == NULL || fb == NULL)
+    goto out;
+  memcpy(fa, a, la * sizeof(blst_fr));
+  memcpy(fb, b, lb * sizeof(blst_fr));
+  if ((ret = ntt_fr_inplace(fa, logn, 0)) != POLYNOMIAL_SUCCESS)
+    goto out;
+  if ((ret = ntt_fr_inplace(fb, logn, 0)) != POLYNOMIAL_SUCCESS)
+    goto out;
+  for (size_t i = 0; i < n; i++)
+    blst_fr_mul(fa + i, fa + i, fb + i);
+  if ((ret = ntt_fr_inplace(fa, logn, 1)) != POLYNOMIAL_SUCCESS)
+    goto out;
+  memcpy(res, fa, lres * sizeof(blst_fr));
+out:
+  free(fa);
+  free(fb);
+  return (ret);
+}
+
+// Allocate a buffer for a * b truncated to its k first coefficients
+static blst_fr *poly_mul_trunc_alloc(const blst_fr *a, size_t la,
+                                     const blst_fr *b, size_t lb, size_t k,
+                                     int *ret) {
+  if (la > k)
+    la = k;
+  if (lb > k)
+    lb = k;
+  blst_fr *res = calloc(la + lb - 1 > k ? la + lb - 1 : k, sizeof(blst_fr));
+  if (res == NULL) {
+    *ret = POLYNOMIAL_OUT_OF_MEMORY;
+    return (NULL);
+  }
+  if ((*ret = poly_mul_fr(res, a, la, b, lb)) != POLYNOMIAL_SUCCESS) {
+    free(res);
+    return (NULL);
+  }
+  return (res);
+}
+
+// inv[0..k) such that a * inv = 1 mod X^k, using Newton iteration. a[0] must
+// not be zero.
+static int poly_inverse_series(blst_fr *inv, const blst_fr *a, size_t la,
+                               size_t k) {
+  int ret = POLYNOMIAL_SUCCESS;
+  blst_fr two;
+  fr_of_u64(&two, 2);
+  blst_fr_eucl_inverse(inv, a);
+  for (size_t cur = 1; cur < k;) {
+    size_t next = 2 * cur < k ? 2 * cur : k;
+    // inv' = inv * (2 - a * inv) mod X^next
+    blst_fr *e = poly_mul_trunc_alloc(a, la, inv, cur, next, &ret);
+    if (e == NULL)
+      return (ret);
+    for (size_t i = 0; i < next; i++)
+      blst_fr_cneg(e + i, e + i, 1);
+    blst_fr_add(e, e, &two);
+    blst_fr *r = poly_mul_trunc_alloc(inv, cur, e, next, next, &ret);
+    free(e);
+    if (r == NULL)
+      return (ret);
+    memcpy(inv, r, next * sizeof(blst_fr));
+    free(r);
+    cur = next;
+  }
+  return (ret);
+}
+
+// rem[0..lb - 1) = a mod b where b is monic, using the reversed polynomials.
+static int poly_rem_monic(blst_fr *rem, const blst_fr *a, size_t la,
+                          const blst_fr *b, size_t lb) {
+  if (la < lb) {
+    memcpy(rem, a, la * sizeof(blst_fr));
+    memset(rem + la, 0, (lb - 1 - la) * sizeof(blst_fr));
+    return (POLYNOMIAL_SUCCESS);
+  }
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  size_t k = la - lb + 1;
+  blst_fr *rev_b = malloc(lb * sizeof(blst_fr));
+  blst_fr *rev_a = malloc(k * sizeof(blst_fr));
+  blst_fr *inv = malloc(k * sizeof(blst_fr));
+  blst_fr *rev_q = NULL;
+  blst_fr *q = NULL;
+  blst_fr *qb = NULL;
+  if (rev_b == NULL || rev_a == NULL || inv == NULL)
+    goto out;
+  for (size_t i = 0; i < lb; i++)
+    memcpy(rev_b + i, b + lb - 1 - i, sizeof(blst_fr));
+  for (size_t i = 0; i < k; i++)
+    memcpy(rev_a + i, a + la - 1 - i, sizeof(blst_fr));
+  if ((ret = poly_inverse_series(inv, rev_b, lb, k)) != POLYNOMIAL_SUCCESS)
+    goto out;
+  // The reversed quotient is rev(a) / rev(b) mod X^k
+  rev_q = poly_mul_trunc_alloc(rev_a, k, inv, k, k, &ret);
+  if (rev_q == NULL)
+    goto out;
+  q = rev_a;
+  for (size_t i = 0; i < k; i++)
+    memcpy(q + i, rev_q + k - 1 - i, sizeof(blst_fr));
+  free(rev_q);
+  ret = POLYNOMIAL_OUT_OF_MEMORY;
+  if ((qb = malloc(la * sizeof(blst_fr))) == NULL)
+    goto out;
+  if ((ret = poly_mul_fr(qb, q, k, b, lb)) != POLYNOMIAL_SUCCESS)
+    goto out;
+  for (size_t i = 0; i < lb - 1; i++)
+    blst_fr_sub(rem + i, a + i, qb + i);
+out:
+  free(rev_b);
+  free(rev_a);
+  free(inv);
+  free(qb);
+  return (ret);
+}
+
+// Subproduct tree
+
+typedef struct {
+  blst_fr *c;
+  size_t len;
+} poly_node;
+
+typedef struct {
+  int nb_levels;
+  size_t *sizes;
+  // levels[0][i] = X - points[i], levels[j + 1][i] = levels[j][2i] *
+  // levels[j][2i + 1]. A lonely last node is carried to the next level.
+  poly_node **levels;
+} subproduct_tree;
+
+static void subproduct_tree_free(subproduct_tree *tree) {
+  if (tree->levels != NULL) {
+    for (int j = 0; j < tree->nb_levels; j++) {
+      if (tree->levels[j] == NULL)
+        continue;
+      for (size_t i = 0; i < tree->sizes[j]; i++)
+        free(tree->levels[j][i].c);
+      free(tree->levels[j]);
+    }
+  }
+  free(tree->levels);
+  free(tree->sizes);
+}
+
+typedef struct {
+  poly_node *children;
+  size_t nb_children;
+  poly_node *parents;
+  int ret;
+} tree_level_ctx;
+
+static void tree_level_task(size_t i, void *arg) {
+  tree_level_ctx *ctx = (tree_level_ctx *)arg;
+  poly_node *left = ctx->children + 2 * i;
+  poly_node *parent = ctx->parents + i;
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  if (2 * i + 1 == ctx->nb_children) {
+    parent->len = left->len;
+    if ((parent->c = malloc(left->len * sizeof(blst_fr))) != NULL) {
+      memcpy(parent->c, left->c, left->len * sizeof(blst_fr));
+      ret = POLYNOMIAL_SUCCESS;
+    }
+  } else {
+    poly_node *right = left + 1;
+    parent->len = left->len + right->len - 1;
+    if ((parent->c = malloc(parent->len * sizeof(blst_fr))) != NULL)
+      ret = poly_mul_fr(parent->c, left->c, left->len, right->c, right->len);
+  }
+  if (ret != POLYNOMIAL_SUCCESS)
+    __atomic_store_n(&ctx->ret, ret, __ATOMIC_RELAXED);
+}
+
+static int subproduct_tree_build(subproduct_tree *tree, const blst_fr *points,
+                                 size_t m) {
+  int nb_levels = 1;
+  for (size_t s = m; s > 1; s = (s + 1) / 2)
+    nb_levels++;
+  tree->nb_levels = nb_levels;
+  tree->sizes = malloc(nb_levels * sizeof(size_t));
+  tree->levels = calloc(nb_levels, sizeof(poly_node *));
+  if (tree->sizes == NULL || tree->levels == NULL)
+    return (POLYNOMIAL_OUT_OF_MEMORY);
+  tree->sizes[0] = m;
+  for (int j = 1; j < nb_levels; j++)
+    tree->sizes[j] = (tree->sizes[j - 1] + 1) / 2;
+  for (int j = 0; j < nb_levels; j++) {
+    tree->levels[j] = calloc(tree->sizes[j], sizeof(poly_node));
+    if (tree->levels[j] == NULL)
+      return (POLYNOMIAL_OUT_OF_MEMORY);
+  }
+
+  for (size_t i = 0; i < m; i++) {
+    poly_node *leaf = tree->levels[0] + i;
+    leaf->len = 2;
+    if ((leaf->c = malloc(2 * sizeof(blst_fr))) == NULL)
+      return (POLYNOMIAL_OUT_OF_MEMORY);
+    blst_fr_cneg(leaf->c, points + i, 1);
+    fr_of_u64(leaf->c + 1, 1);
+  }
+  for (int j = 0; j + 1 < nb_levels; j++) {
+    tree_level_ctx ctx = {tree->levels[j], tree->sizes[j], tree->levels[j + 1],
+                          POLYNOMIAL_SUCCESS};
+    caml_bls12_381_parallel_for(tree->sizes[j + 1], tree_level_task, &ctx);
+    if (ctx.ret != POLYNOMIAL_SUCCESS)
+      return (ctx.ret);
+  }
+  return (POLYNOMIAL_SUCCESS);
+}
+
+// Remainder tree
+
+typedef struct {
+  poly_node *nodes;
+  poly_node *parent_rems;
+  poly_node *rems;
+  int ret;
+} rem_level_ctx;
+
+static void rem_level_task(size_t i, void *arg) {
+  rem_level_ctx *ctx = (rem_level_ctx *)arg;
+  poly_node *node = ctx->nodes + i;
+  poly_node *parent = ctx->parent_rems + i / 2;
+  poly_node *rem = ctx->rems + i;
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  rem->len = node->len - 1;
+  if ((rem->c = malloc(rem->len * sizeof(blst_fr))) != NULL)
+    ret = poly_rem_monic(rem->c, parent->c, parent->len, node->c, node->len);
+  if (ret != POLYNOMIAL_SUCCESS)
+    __atomic_store_n(&ctx->ret, ret, __ATOMIC_RELAXED);
+}
+
+typedef struct {
+  blst_fr *res;
+  const blst_fr *points;
+  poly_node *rems;
+} leaves_ctx;
+
+static void leaves_task(size_t i, void *arg) {
+  leaves_ctx *ctx = (leaves_ctx *)arg;
+  poly_node *rem = ctx->rems + i / 2;
+  horner(ctx->res + i, rem->c, rem->len, ctx->points + i);
+}
+
+static void poly_nodes_free(poly_node *nodes, size_t n) {
+  if (nodes == NULL)
+    return;
+  for (size_t i = 0; i < n; i++)
+    free(nodes[i].c);
+  free(nodes);
+}
+
+static int multi_eval_with_tree(blst_fr *res, const blst_fr *coefficients,
+                                size_t n, const blst_fr *points,
+                                subproduct_tree *tree) {
+  int top = tree->nb_levels - 1;
+  poly_node *root = tree->levels[top];
+  poly_node *rems = calloc(1, sizeof(poly_node));
+  if (rems == NULL)
+    return (POLYNOMIAL_OUT_OF_MEMORY);
+  rems->len = root->len - 1;
+  if ((rems->c = malloc(rems->len * sizeof(blst_fr))) == NULL) {
+    free(rems);
+    return (POLYNOMIAL_OUT_OF_MEMORY);
+  }
+  int ret = poly_rem_monic(rems->c, coefficients, n, root->c, root->len);
+  // The remainders modulo the leaves are the evaluations. They are computed
+  // directly from the remainders at level 1 by Horner's method.
+  for (int j = top - 1; j > 0 && ret == POLYNOMIAL_SUCCESS; j--) {
+    poly_node *next = calloc(tree->sizes[j], sizeof(poly_node));
+    if (next == NULL) {
+      ret = POLYNOMIAL_OUT_OF_MEMORY;
+      break;
+    }
+    rem_level_ctx ctx = {tree->levels[j], rems, next, POLYNOMIAL_SUCCESS};
+    caml_bls12_381_parallel_for(tree->sizes[j], rem_level_task, &ctx);
+    poly_nodes_free(rems, tree->sizes[j + 1]);
+    rems = next;
+    ret = ctx.ret;
+  }
+  if (ret == POLYNOMIAL_SUCCESS) {
+    leaves_ctx ctx = {res, points, rems};
+    caml_bls12_381_parallel_for(tree->sizes[0], leaves_task, &ctx);
+  }
+  poly_nodes_free(rems, top > 0 ? tree->sizes[1] : 1);
+  return (ret);
+}
+
+typedef struct {
+  blst_fr *res;
+  const blst_fr *coefficients;
+  size_t n;
+  const blst_fr *points;
+} naive_multi_eval_ctx;
+
+static void naive_multi_eval_task(size_t i, void *arg) {
+  naive_multi_eval_ctx *ctx = (naive_multi_eval_ctx *)arg;
+  horner(ctx->res + i, ctx->coefficients, ctx->n, ctx->points + i);
+}
+
+int poly_multi_eval_fr(blst_fr *res, const blst_fr *coefficients, size_t n,
+                       const blst_fr *points, size_t m) {
+  if (m == 0)
+    return (POLYNOMIAL_SUCCESS);
+  if (m <= POLY_MULTI_EVAL_NAIVE_THRESHOLD ||
+      n <= POLY_MULTI_EVAL_NAIVE_THRESHOLD) {
+    naive_multi_eval_ctx ctx = {res, coefficients, n, points};
+    caml_bls12_381_parallel_for(m, naive_multi_eval_task, &ctx);
+    return (POLYNOMIAL_SUCCESS);
+  }
+  subproduct_tree tree = {0, NULL, NULL};
+  int ret = subproduct_tree_build(&tree, points, m);
+  if (ret == POLYNOMIAL_SUCCESS)
+    ret = multi_eval_with_tree(res, coefficients, n, points, &tree);
+  subproduct_tree_free(&tree);
+  return (ret);
+}
+
+// Interpolation
+
+typedef struct {
+  poly_node *nodes;
+  size_t nb_nodes;
+  poly_node *children;
+  poly_node *parents;
+  int ret;
+} interpolate_level_ctx;
+
+static void interpolate_level_task(size_t i, void *arg) {
+  interpolate_level_ctx *ctx = (interpolate_level_ctx *)arg;
+  poly_node *left = ctx->children + 2 * i;
+  poly_node *parent = ctx->parents + i;
+  int ret = POLYNOMIAL_OUT_OF_MEMORY;
+  if (2 * i + 1 == ctx->nb_nodes) {
+    parent->len = left->len;
+    if ((parent->c = malloc(left->len * sizeof(blst_fr))) != NULL) {
+      memcpy(parent->c, left->c, left->len * sizeof(blst_fr));
+      ret = POLYNOMIAL_SUCCESS;
+    }
+  } else {
+    // P = P_left * M_right + P_right * M_left, where the M's are the nodes of
+    // the subproduct tree. deg(P_left) < deg(M_left) and similarly for the
+    // right child, so both products have deg(M_left) + deg(M_right)
+    // coefficients.
+    poly_node *right = left + 1;
+    poly_node *m_left = ctx->nodes + 2 * i;
+    poly_node *m_right = m_left + 1;
+    parent->len = m_left->len + m_right->len - 2;
+    blst_fr *tmp = malloc(parent->len * sizeof(blst_fr));
+    parent->c = malloc(parent->len * sizeof(blst_fr));
+    if (tmp != NULL && parent->c != NULL) {
+      ret = poly_mul_fr(parent->c, left->c, left->len, m_right->c,
+                        m_right->len);
+      if (ret == POLYNOMIAL_SUCCESS)
+        ret = poly_mul_fr(tmp, right->c, right->len, m_left->c, m_left->len);
+      if (ret == POLYNOMIAL_SUCCESS)
+        for (size_t k = 0; k < parent->len; k++)
+          blst_fr_add(parent->c + k, parent->c + k, tmp + k);
+    }
+    free(tmp);
+  }
+  if (ret != POLYNOMIAL_SUCCESS)
+    __atomic_store_n(&ctx->ret, ret, __ATOMIC_RELAXED);
+}
+
+int poly_interpolate_fr(blst_fr *res, const blst_fr *points,
+                        const blst_fr *values, size_t n) {
+  if (n == 0)
+    return (POLYNOMIAL_SUCCESS);
+  subproduct_tree tree = {0, NULL, NULL};
+  blst_fr *weights = NULL;
+  poly_node *current = NULL;
+  size_t current_size = 0;
+  int ret = subproduct_tree_build(&tree, points, n);
+  if (ret != POLYNOMIAL_SUCCESS)
+    goto out;
+
+  // The weights are values[i] / M'(points[i]) where M = prod (X - points[i]).
+  // M'(points[i]) is zero iff points[i] is not a simple root of M.
+  ret = POLYNOMIAL_OUT_OF_MEMORY;
+  poly_node *root = tree.levels[tree.nb_levels - 1];
+  size_t len_derivative = root->len - 1;
+  blst_fr *derivative = malloc(len_derivative * sizeof(blst_fr));
+  weights = malloc(n * sizeof(blst_fr));
+  if (derivative == NULL || weights == NULL) {
+    free(derivative);
+    goto out;
+  }
+  for (size_t i = 0; i < len_derivative; i++) {
+    blst_fr k;
+    fr_of_u64(&k, i + 1);
+    blst_fr_mul(derivative + i, root->c + i + 1, &k);
+  }
+  if (n <= POLY_MULTI_EVAL_NAIVE_THRESHOLD) {
+    naive_multi_eval_ctx ctx = {weights, derivative, len_derivative, points};
+    caml_bls12_381_parallel_for(n, naive_multi_eval_task, &ctx);
+    ret = POLYNOMIAL_SUCCESS;
+  } else
+    ret = multi_eval_with_tree(weights, derivative, len_derivative, points,
+                               &tree);
+  free(derivative);
+  if (ret != POLYNOMIAL_SUCCESS)
+    goto out;
+  if ((ret = fr_batch_inverse(weights, weights, n)) != POLYNOMIAL_SUCCESS)
+    goto out;
+
+  ret = POLYNOMIAL_OUT_OF_MEMORY;
+  current_size = n;
+  if ((current = calloc(n, sizeof(poly_node))) == NULL)
+    goto out;
+  for (size_t i = 0; i < n; i++) {
+    current[i].len = 1;
+    if ((current[i].c = malloc(sizeof(blst_fr))) == NULL)
+      goto out;
+    blst_fr_mul(current[i].c, weights + i, values + i);
+  }
+  ret = POLYNOMIAL_SUCCESS;
+  for (int j = 0; j + 1 < tree.nb_levels; j++) {
+    poly_node *next = calloc(tree.sizes[j + 1], sizeof(poly_node));
+    if (next == NULL) {
+      ret = POLYNOMIAL_OUT_OF_MEMORY;
+      goto out;
+    }
+    interpolate_level_ctx ctx = {tree.levels[j], tree.sizes[j], current, next,
+                                 POLYNOMIAL_SUCCESS};
+    caml_bls12_381_parallel_for(tree.sizes[j + 1], interpolate_level_task,
+                                &ctx);
+    poly_nodes_free(current, current_size);
+    current = next;
+    current_size = tree.sizes[j + 1];
+    if ((ret = ctx.ret) != POLYNOMIAL_SUCCESS)
+      goto out;
+  }
+  memcpy(res, current->c, n * sizeof(blst_fr));
+out:
+  poly_nodes_free(current, current_size);
+  free(weights);
+  subproduct_tree_free(&tree);
+  return (ret);
+}
+
+// Grand product
+
+typedef struct {
+  blst_fr *res;
+  const blst_fr *a;
+  const blst_fr *b;
+  size_t n;
+  size_t block_size;
+  blst_fr *offsets;
+  int ret;
+} grand_product_ctx;
+
+// Write the local scan of the block k in res + 1, i.e. the prefix products of
+// a[j] / b[j] from the start of the block. The denominators of the block are
+// inverted together with Montgomery's trick, the prefix products of b being
+// stored in the output until they are consumed by the backward pass.
+static void grand_product_block_scan(size_t k, void *arg) {
+  grand_product_ctx *ctx = (grand_product_ctx *)arg;
+  size_t start = k * ctx->block_size;
+  size_t len = ctx->n - start < ctx->block_size ? ctx->n - start
+                                                 : ctx->block_size;
+  const blst_fr *a = ctx->a + start;
+  const blst_fr *b = ctx->b + start;
+  blst_fr *out = ctx->res + 1 + start;
+  blst_fr inv, b_inv;
+
+  memcpy(out, b, sizeof(blst_fr));
+  for (size_t i = 1; i < len; i++)
+    blst_fr_mul(out + i, out + i - 1, b + i);
+  if (fr_is_zero(out + len - 1)) {
+    __atomic_store_n(&ctx->ret, POLYNOMIAL_INVALID_ARGUMENT, __ATOMIC_RELAXED);
+    return;
+  }
+  blst_fr_eucl_inverse(&inv, out + len - 1);
+  for (size_t i = len - 1; i > 0; i--) {
+    blst_fr_mul(&b_inv, &inv, out + i - 1);
+    blst_fr_mul(&inv, &inv, b + i);
+    blst_fr_mul(out + i, a + i, &b_inv);
+  }
+  blst_fr_mul(out, a, &inv);
+  for (size_t i = 1; i < len; i++)
+    blst_fr_mul(out + i, out + i - 1, out + i);
+}
+
+// Multiply the block k + 1 by the product of the previous blocks. The first
+// block is already correct.
+static void grand_product_block_fix(size_t k, void *arg) {
+  grand_product_ctx *ctx = (grand_product_ctx *)arg;
+  k++;
+  size_t start = k * ctx->block_size;
+  size_t len = ctx->n - start < ctx->block_size ? ctx->n - start
+                                                 : ctx->block_size;
+  blst_fr *out = ctx->res + 1 + start;
+  for (size_t i = 0; i < len; i++)
+    blst_fr_mul(out + i, out + i, ctx->offsets + k);
+}
+
+int fr_grand_product(blst_fr *res, const blst_fr *a, const blst_fr *b,
+                     size_t n) {
+  fr_of_u64(res, 1);
+  if (n == 0)
+    return (POLYNOMIAL_SUCCESS);
+  size_t nb_threads = caml_bls12_381_get_nb_threads();
+  size_t nb_blocks = n / GRAND_PRODUCT_MIN_BLOCK_SIZE;
+  if (nb_blocks > nb_threads)
+    nb_blocks = nb_threads;
+  if (nb_blocks < 1)
+    nb_blocks = 1;
+  size_t block_size = (n + nb_blocks - 1) / nb_blocks;
+  nb_blocks = (n + block_size - 1) / block_size;
+  blst_fr *offsets = malloc(nb_blocks * sizeof(blst_fr));
+  if (offsets == NULL)
+    return (POLYNOMIAL_OUT_OF_MEMORY);
+  grand_product_ctx ctx = {res,     a, b, n, block_size, offsets,
+                           POLYNOMIAL_SUCCESS};
+  caml_bls12_381_parallel_for(nb_blocks, grand_product_block_scan, &ctx);
+  if (ctx.ret == POLYNOMIAL_SUCCESS && nb_blocks > 1) {
+    // Exclusive scan of the products of the blocks. The product of the block
+    // k - 1 is its last element, i.e. res[k * block_size].
+    fr_of_u64(offsets, 1);
+    for (size_t k = 1; k < nb_blocks; k++)
+      blst_fr_mul(offsets + k, offsets + k - 1, res + k * block_size);
+    caml_bls12_381_parallel_for(nb_blocks - 1, grand_product_block_fix, &ctx);
+  }
+  free(offsets);
+  return (ctx.ret);
+}
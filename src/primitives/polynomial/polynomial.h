@@ -0,0 +1,68 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+
+#include "blst.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Status codes returned by the kernels. Same values than the ones used by the
+// caml stubs.
+#define POLYNOMIAL_SUCCESS 0
+#define POLYNOMIAL_OUT_OF_MEMORY 1
+#define POLYNOMIAL_INVALID_ARGUMENT 2
+
+// Tunable parameters of the kernels: the size up to which the products are
+// naive, the minimal log size of the NTTs split between the threads, and the
+// number of butterflies per task of the NTTs. They can be calibrated for the
+// machine, see Bls12_381.Tuning.
+#define POLY_PARAMETER_MUL_NAIVE_THRESHOLD 0
+#define POLY_PARAMETER_NTT_PARALLEL_LOG_SIZE 1
+#define POLY_PARAMETER_NTT_TASK_SIZE 2
+#define POLY_NB_PARAMETERS 3
+
+// Hypothesis: k < POLY_NB_PARAMETERS, and v > 0 for the task size
+void poly_set_parameter(int k, size_t v);
+
+size_t poly_get_parameter(int k);
+
+// Polynomials are represented by the contiguous array of their coefficients,
+// the constant monomial first.
+
+// Evaluate the polynomial at x using Horner's method. The coefficients are
+// split in chunks evaluated in parallel when multiple threads are available.
+int poly_eval_fr(blst_fr *res, const blst_fr *coefficients, size_t n,
+                 const blst_fr *x);
+
+// res[i] = polys[i](x), the polynomial polys[i] having lengths[i]
+// coefficients. The polynomials are evaluated in parallel.
+int poly_eval_many_fr(blst_fr *res, const blst_fr *const *polys,
+                      const size_t *lengths, size_t nb_polys,
+                      const blst_fr *x);
+
+// res = a * b. res must have at least la + lb - 1 elements and can not be one
+// of the inputs. Uses a NTT of size the next power of two of la + lb - 1 when
+// both polynomials are large enough.
+int poly_mul_fr(blst_fr *res, const blst_fr *a, size_t la, const blst_fr *b,
+                size_t lb);
+
+// res[i] = P(points[i]) for i < m, where P is given by its n coefficients.
+// Uses a subproduct tree and a remainder tree, i.e. O(M(m) log(m)) operations
+// where M(m) is the cost of a product of polynomials of degree m.
+int poly_multi_eval_fr(blst_fr *res, const blst_fr *coefficients, size_t n,
+                       const blst_fr *points, size_t m);
+
+// Compute the n coefficients of the unique polynomial P of degree smaller than
+// n such that P(points[i]) = values[i]. Returns POLYNOMIAL_INVALID_ARGUMENT if
+// the points are not distinct.
+int poly_interpolate_fr(blst_fr *res, const blst_fr *points,
+                        const blst_fr *values, size_t n);
+
+// Grand product: res[i] = prod_{j < i} a[j] / b[j] for i <= n, i.e. res[0] = 1
+// and res[n] is the product of all the fractions. res must have n + 1
+// elements. The inversion of the denominators is fused in the scan. The arrays
+// are split in blocks processed in parallel, with one inversion per block.
+// Returns POLYNOMIAL_INVALID_ARGUMENT if one of the denominators is zero.
+int fr_grand_product(blst_fr *res, const blst_fr *a, const blst_fr *b,
+                     size_t n);
+
+#endif
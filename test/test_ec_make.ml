@@ -30,6 +30,40 @@ module MakeBulkOperations (G : Bls12_381.CURVE) = struct
     let xs = List.init n (fun _ -> G.random ()) in
     assert (G.(eq (List.fold_left G.add G.zero xs) (G.add_bulk xs)))
 
+  let test_bulk_add_with_zero_and_equal_points () =
+    let n = 2100 in
+    let xs =
+      Array.init n (fun i ->
+          if i mod 13 = 0 then G.zero
+          else if i mod 17 = 0 then G.one
+          else G.random ())
+    in
+    let expected = Array.fold_left G.add G.zero xs in
+    assert (G.eq expected (G.add_bulk_array xs)) ;
+    assert (G.eq expected (G.add_bulk (Array.to_list xs))) ;
+    assert (G.eq expected (G.add_bulk_affine_array (G.to_affine_array xs)))
+
+  let test_bulk_add_affine_array_range () =
+    let n = 1 + Random.int 100 in
+    let start = Random.int n in
+    let len = Random.int (n - start + 1) in
+    let xs = Array.init n (fun _ -> G.random ()) in
+    let expected = G.add_bulk_array (Array.sub xs start len) in
+    let ps = G.to_affine_array xs in
+    assert (G.eq expected (G.add_bulk_affine_array ~start ~len ps)) ;
+    try
+      ignore @@ G.add_bulk_affine_array ~start:n ~len:1 ps ;
+      assert false
+    with Invalid_argument _ -> ()
+
+  let test_to_affine_array_with_zero_points () =
+    let n = 2100 in
+    let xs =
+      Array.init n (fun i -> if i mod 13 = 0 then G.zero else G.random ())
+    in
+    let xs' = G.of_affine_array (G.to_affine_array xs) in
+    Array.iteri (fun i x -> assert (G.eq x xs'.(i))) xs
+
   let test_pippenger () =
     let n = 1 + Random.int 5 in
     let start = Random.int n in
@@ -45,6 +79,47 @@ module MakeBulkOperations (G : Bls12_381.CURVE) = struct
     let right = G.pippenger ~start ~len ps ss in
     assert (G.(eq left right))
 
+  (* Large enough for the points to be converted to affine coordinates by
+     chunks when several threads are used *)
+  let test_pippenger_with_zero_points () =
+    let n = 2100 in
+    let ps =
+      Array.init n (fun i -> if i mod 13 = 0 then G.zero else G.random ())
+    in
+    let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+    let left = ref G.zero in
+    Array.iteri (fun i p -> left := G.add !left (G.mul p ss.(i))) ps ;
+    assert (G.(eq !left (pippenger ps ss)))
+
+  (* The tiled parallel algorithm is used above 1024 points when more than one
+     thread is available. The result must be the one of the sequential
+     algorithm. *)
+  let test_pippenger_threads_same_result () =
+    let n = 1024 + Random.int 3000 in
+    let ps = Array.init n (fun _ -> G.random ()) in
+    let ps_contiguous = G.to_affine_array ps in
+    let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+    let start = Random.int 10 in
+    let expected = with_threads 1 (fun () -> G.pippenger ~start ps ss) () in
+    List.iter
+      (fun nb_threads ->
+        let res =
+          with_threads nb_threads (fun () -> G.pippenger ~start ps ss) ()
+        in
+        let res_contiguous =
+          with_threads
+            nb_threads
+            (fun () -> G.pippenger_with_affine_array ~start ps_contiguous ss)
+            ()
+        in
+        if not (G.eq expected res && G.eq expected res_contiguous) then
+          Alcotest.failf
+            "n = %d, start = %d, nb_threads = %d"
+            n
+            start
+            nb_threads)
+      [2; 3; 4; 8]
+
   let test_pippenger_different_size () =
     let n_ps = 1 + Random.int 10 in
     let n_ss = 1 + Random.int 10 in
@@ -218,16 +293,843 @@ module MakeBulkOperations (G : Bls12_381.CURVE) = struct
     let right = G.pippenger_with_affine_array ~start ~len ps_contiguous ss in
     assert (G.(eq left right))
 
+  (* Above 4096 points, the buckets are accumulated in affine coordinates. The
+     points are taken from a small pool, with their opposites and zero, to get
+     conflicts in the batches, doublings and cancellations in the buckets. *)
+  let test_pippenger_affine_buckets () =
+    let n = 4096 + Random.int 1000 in
+    let pool = Array.init 8 (fun _ -> G.random ()) in
+    let pool = Array.append pool (Array.map G.negate pool) in
+    let pool = Array.append pool [|G.zero|] in
+    let indices = Array.init n (fun _ -> Random.int (Array.length pool)) in
+    let ps = Array.map (fun i -> pool.(i)) indices in
+    let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+    let sums = Array.make (Array.length pool) G.Scalar.zero in
+    Array.iteri (fun k i -> sums.(i) <- G.Scalar.add sums.(i) ss.(k)) indices ;
+    let expected =
+      Array.mapi (fun i p -> G.mul p sums.(i)) pool
+      |> Array.fold_left G.add G.zero
+    in
+    let ps_contiguous = G.to_affine_array ps in
+    assert (G.eq expected (G.pippenger ps ss)) ;
+    assert (G.eq expected (G.pippenger_with_affine_array ps_contiguous ss))
+
+  (* Fixtures shared by the tests of the variants of the MSMs. [random_points n]
+     returns [n] points, some of them at infinity, [random_range n] a non empty
+     range of [n] elements and [naive_msm ~start ~len ps ss] the sum of the
+     points times the scalars over the range. *)
+  let random_points n =
+    Array.init n (fun i -> if i mod 7 = 3 then G.zero else G.random ())
+
+  let random_range n =
+    let start = Random.int n in
+    (start, 1 + Random.int (n - start))
+
+  let naive_msm ~start ~len ps ss =
+    let r = ref G.zero in
+    for i = start to start + len - 1 do
+      r := G.add !r (G.mul ps.(i) ss.(i))
+    done ;
+    !r
+
+  (* [n] affine points and scalars, for the comparisons with
+     pippenger_with_affine_array on many points *)
+  let random_affine_msm n =
+    ( G.to_affine_array (Array.init n (fun _ -> G.random ())),
+      Array.init n (fun _ -> G.Scalar.random ()) )
+
+  (* [check_invalid_ranges n f] checks that [f ~start ~len] raises
+     [Invalid_argument] for the ranges out of [n] elements *)
+  let check_invalid_ranges n f =
+    List.iter
+      (fun (start, len) ->
+        try
+          f ~start ~len ;
+          assert false
+        with Invalid_argument _ -> ())
+      [(-1, 1); (0, 0); (n - 2, 3); (n, 1)]
+
+  let test_prepared_bases () =
+    let n = 1 + Random.int 300 in
+    let window = 2 + Random.int 7 in
+    let ps = random_points n in
+    let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+    let bases = G.Prepared_bases.create ~window (G.to_affine_array ps) in
+    assert (G.Prepared_bases.length bases = n) ;
+    assert (G.Prepared_bases.window bases = window) ;
+    let start, len = random_range n in
+    let right = G.Prepared_bases.msm ~start ~len bases ss in
+    if not (G.eq (naive_msm ~start ~len ps ss) right) then
+      Alcotest.failf
+        "n = %d, window = %d, start = %d, len = %d"
+        n
+        window
+        start
+        len
+
+  let test_prepared_bases_large () =
+    let ps, ss = random_affine_msm (1000 + Random.int 1000) in
+    let bases = G.Prepared_bases.create ps in
+    let expected = G.pippenger_with_affine_array ps ss in
+    assert (G.eq expected (G.Prepared_bases.msm bases ss))
+
+  let test_prepared_bases_invalid_arguments () =
+    let ps, ss = random_affine_msm 4 in
+    List.iter
+      (fun window ->
+        try
+          ignore @@ G.Prepared_bases.create ~window ps ;
+          assert false
+        with Invalid_argument _ -> ())
+      [-1; 0; 1; 15] ;
+    let bases = G.Prepared_bases.create ~window:2 ps in
+    check_invalid_ranges 4 (fun ~start ~len ->
+        ignore @@ G.Prepared_bases.msm ~start ~len bases ss)
+
+  let test_scalar_batch () =
+    let n = 1 + Random.int 300 in
+    let ps = random_points n in
+    let ss =
+      Array.init n (fun i ->
+          if i mod 5 = 2 then G.Scalar.zero else G.Scalar.random ())
+    in
+    let batch = Bls12_381.Fr.Scalar_batch.create ss in
+    assert (Bls12_381.Fr.Scalar_batch.length batch = n) ;
+    let ps_contiguous = G.to_affine_array ps in
+    let start, len = random_range n in
+    let left = naive_msm ~start ~len ps ss in
+    let right = G.pippenger_with_scalar_batch ~start ~len ps_contiguous batch in
+    if not (G.eq left right) then
+      Alcotest.failf "n = %d, start = %d, len = %d" n start len ;
+    (* The batch can be reused *)
+    let right = G.pippenger_with_scalar_batch ~start ~len ps_contiguous batch in
+    assert (G.eq left right)
+
+  let test_scalar_batch_large () =
+    let ps, ss = random_affine_msm (1000 + Random.int 5000) in
+    let batch = Bls12_381.Fr.Scalar_batch.create ss in
+    let expected = G.pippenger_with_affine_array ps ss in
+    assert (G.eq expected (G.pippenger_with_scalar_batch ps batch))
+
+  let test_scalar_batch_invalid_arguments () =
+    let ps, ss = random_affine_msm 4 in
+    let batch = Bls12_381.Fr.Scalar_batch.create ss in
+    check_invalid_ranges 4 (fun ~start ~len ->
+        ignore @@ G.pippenger_with_scalar_batch ~start ~len ps batch)
+
+  let test_pippenger_multi () =
+    let n = 1 + Random.int 300 in
+    let k = Random.int 5 in
+    let ps = random_points n in
+    let sss =
+      Array.init k (fun _ -> Array.init n (fun _ -> G.Scalar.random ()))
+    in
+    let ps_contiguous = G.to_affine_array ps in
+    let start, len = random_range n in
+    let res = G.pippenger_multi ~start ~len ps_contiguous sss in
+    assert (Array.length res = k) ;
+    Array.iteri
+      (fun j ss ->
+        if not (G.eq (naive_msm ~start ~len ps ss) res.(j)) then
+          Alcotest.failf "n = %d, start = %d, len = %d, j = %d" n start len j)
+      sss
+
+  let test_pippenger_multi_large () =
+    let n = 1000 + Random.int 5000 in
+    let k = 1 + Random.int 10 in
+    let ps = G.to_affine_array (random_points n) in
+    let sss =
+      Array.init k (fun _ -> Array.init n (fun _ -> G.Scalar.random ()))
+    in
+    let res = G.pippenger_multi ps sss in
+    Array.iteri
+      (fun j ss -> assert (G.eq (G.pippenger_with_affine_array ps ss) res.(j)))
+      sss
+
+  let test_pippenger_multi_invalid_arguments () =
+    let ps, ss = random_affine_msm 4 in
+    (* The ranges are checked against the shortest array of scalars *)
+    let sss = [| ss; Array.sub ss 0 3 |] in
+    check_invalid_ranges 3 (fun ~start ~len ->
+        ignore @@ G.pippenger_multi ~start ~len ps sss)
+
+  let test_pippenger_glv () =
+    let n = 1 + Random.int 300 in
+    let ps = random_points n in
+    let ss =
+      Array.init n (fun i ->
+          if i mod 5 = 2 then G.Scalar.zero
+          else if i mod 5 = 4 then G.Scalar.(negate one)
+          else G.Scalar.random ())
+    in
+    let ps_contiguous = G.to_affine_array ps in
+    let bases = G.Glv_bases.create ps_contiguous in
+    assert (G.Glv_bases.length bases = n) ;
+    let start, len = random_range n in
+    let left = naive_msm ~start ~len ps ss in
+    let right = G.pippenger_glv ~start ~len ps_contiguous ss in
+    if not (G.eq left right) then
+      Alcotest.failf "n = %d, start = %d, len = %d" n start len ;
+    let right = G.Glv_bases.msm ~start ~len bases ss in
+    if not (G.eq left right) then
+      Alcotest.failf "bases: n = %d, start = %d, len = %d" n start len
+
+  let test_pippenger_glv_large () =
+    let ps, ss = random_affine_msm (1000 + Random.int 5000) in
+    let expected = G.pippenger_with_affine_array ps ss in
+    assert (G.eq expected (G.pippenger_glv ps ss)) ;
+    assert (G.eq expected (G.Glv_bases.msm (G.Glv_bases.create ps) ss))
+
+  let test_pippenger_glv_invalid_arguments () =
+    let ps, ss = random_affine_msm 4 in
+    let bases = G.Glv_bases.create ps in
+    check_invalid_ranges 4 (fun ~start ~len ->
+        ignore @@ G.pippenger_glv ~start ~len ps ss) ;
+    check_invalid_ranges 4 (fun ~start ~len ->
+        ignore @@ G.Glv_bases.msm ~start ~len bases ss)
+
+  let test_pippenger_sparse_scalars () =
+    let n = 1 + Random.int 300 in
+    let small () = G.Scalar.of_z (Z.of_int (Random.int 1_000_000)) in
+    let ss =
+      Array.init n (fun _ ->
+          match Random.int 5 with
+          | 0 -> G.Scalar.zero
+          | 1 -> G.Scalar.one
+          | 2 -> G.Scalar.(negate one)
+          | 3 -> small ()
+          | _ -> G.Scalar.random ())
+    in
+    let ss =
+      match Random.int 3 with
+      | 0 -> ss
+      | 1 -> Array.map (fun s -> if G.Scalar.is_zero s then s else small ()) ss
+      | _ ->
+          Array.init n (fun _ ->
+              if Random.bool () then G.Scalar.one else G.Scalar.zero)
+    in
+    let ps = Array.init n (fun _ -> G.random ()) in
+    let expected = ref G.zero in
+    Array.iteri (fun i p -> expected := G.add !expected (G.mul p ss.(i))) ps ;
+    assert (G.eq !expected (G.pippenger ps ss)) ;
+    let ps_contiguous = G.to_affine_array ps in
+    assert (G.eq !expected (G.pippenger_with_affine_array ps_contiguous ss))
+
+  let test_msm_context () =
+    let ctx = G.Msm_context.create () in
+    (* The same context is used for MSMs of different sizes, the buffers being
+       grown and reused between the calls. *)
+    List.iter
+      (fun n ->
+        let ps = Array.init n (fun _ -> G.random ()) in
+        let ss =
+          Array.init n (fun i ->
+              if i mod 3 = 1 then G.Scalar.one else G.Scalar.random ())
+        in
+        let ps_contiguous = G.to_affine_array ps in
+        let start = Random.int n in
+        let len = 1 + Random.int (n - start) in
+        let expected =
+          G.pippenger_with_affine_array ~start ~len ps_contiguous ss
+        in
+        let left = G.Msm_context.pippenger ~start ~len ctx ps ss in
+        let right =
+          G.Msm_context.pippenger_with_affine_array
+            ~start
+            ~len
+            ctx
+            ps_contiguous
+            ss
+        in
+        if not (G.eq expected left && G.eq expected right) then
+          Alcotest.failf "n = %d, start = %d, len = %d" n start len)
+      [ 1 + Random.int 10;
+        1000 + Random.int 1000;
+        1 + Random.int 100;
+        100 + Random.int 3000 ]
+
+  let test_msm_context_invalid_arguments () =
+    let ctx = G.Msm_context.create () in
+    let ps = Array.init 4 (fun _ -> G.random ()) in
+    let ps_contiguous = G.to_affine_array ps in
+    let ss = Array.init 4 (fun _ -> G.Scalar.random ()) in
+    check_invalid_ranges 4 (fun ~start ~len ->
+        ignore @@ G.Msm_context.pippenger ~start ~len ctx ps ss) ;
+    check_invalid_ranges 4 (fun ~start ~len ->
+        ignore
+        @@ G.Msm_context.pippenger_with_affine_array
+             ~start
+             ~len
+             ctx
+             ps_contiguous
+             ss)
+
+  let test_msm_stream () =
+    let window = 2 + Random.int 11 in
+    let stream = G.Msm_stream.create ~window () in
+    (* The stream is reset by finish and used for several MSMs *)
+    for _ = 1 to 2 do
+      let n = 1 + Random.int 5000 in
+      let ps = Array.init n (fun _ -> G.random ()) in
+      let ss =
+        Array.init n (fun i ->
+            if i mod 5 = 1 then G.Scalar.zero else G.Scalar.random ())
+      in
+      let ps_contiguous = G.to_affine_array ps in
+      let expected = G.pippenger_with_affine_array ps_contiguous ss in
+      let start = ref 0 in
+      while !start < n do
+        let len = min (n - !start) (Random.int 1000) in
+        if Random.bool () then G.Msm_stream.add ~start:!start ~len stream ps ss
+        else
+          G.Msm_stream.add_with_affine_array
+            ~start:!start
+            ~len
+            stream
+            ps_contiguous
+            ss ;
+        start := !start + len
+      done ;
+      let res = G.Msm_stream.finish stream in
+      if not (G.eq expected res) then
+        Alcotest.failf "n = %d, window = %d" n window
+    done ;
+    assert (G.is_zero (G.Msm_stream.finish stream))
+
+  let test_msm_stream_invalid_arguments () =
+    List.iter
+      (fun window ->
+        try
+          ignore @@ G.Msm_stream.create ~window () ;
+          assert false
+        with Invalid_argument _ -> ())
+      [-1; 0; 1; 17] ;
+    let stream = G.Msm_stream.create () in
+    let ps = Array.init 4 (fun _ -> G.random ()) in
+    let ps_contiguous = G.to_affine_array ps in
+    let ss = Array.init 4 (fun _ -> G.Scalar.random ()) in
+    List.iter
+      (fun (start, len) ->
+        (try
+           G.Msm_stream.add ~start ~len stream ps ss ;
+           assert false
+         with Invalid_argument _ -> ()) ;
+        try
+          G.Msm_stream.add_with_affine_array
+            ~start
+            ~len
+            stream
+            ps_contiguous
+            ss ;
+          assert false
+        with Invalid_argument _ -> ())
+      [(-1, 1); (0, -1); (2, 3); (5, 0)]
+
+  let test_commitment () =
+    let n = 2 + Random.int 1000 in
+    let bases = G.to_affine_array (Array.init n (fun _ -> G.random ())) in
+    let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+    let c = G.Commitment.create bases ss in
+    let expected = G.pippenger_with_affine_array bases ss in
+    assert (G.eq (G.Commitment.commitment c) expected) ;
+    (* Some entries are updated several times *)
+    let updates =
+      Array.init (1 + Random.int 50) (fun _ ->
+          let i = Random.int n in
+          let old = ss.(i) in
+          let new_ =
+            match Random.int 3 with
+            | 0 -> G.Scalar.(add old one)
+            | 1 -> G.Scalar.zero
+            | _ -> G.Scalar.random ()
+          in
+          ss.(i) <- new_ ;
+          (i, old, new_))
+    in
+    if Random.bool () then G.Commitment.update_many c updates
+    else
+      Array.iter
+        (fun (i, old, new_) -> G.Commitment.update c i old new_)
+        updates ;
+    let expected = G.pippenger_with_affine_array bases ss in
+    assert (G.eq (G.Commitment.commitment c) expected) ;
+    let c = G.Commitment.of_commitment bases expected in
+    let i = Random.int n in
+    G.Commitment.update_many c [|(i, ss.(i), G.Scalar.zero)|] ;
+    ss.(i) <- G.Scalar.zero ;
+    assert (
+      G.eq
+        (G.Commitment.commitment c)
+        (G.pippenger_with_affine_array bases ss))
+
+  let test_commitment_invalid_arguments () =
+    let bases = G.to_affine_array (Array.init 4 (fun _ -> G.random ())) in
+    (try
+       ignore @@ G.Commitment.create bases (Array.make 5 G.Scalar.one) ;
+       assert false
+     with Invalid_argument _ -> ()) ;
+    let c = G.Commitment.create bases (Array.make 4 G.Scalar.one) in
+    let commitment = G.Commitment.commitment c in
+    List.iter
+      (fun i ->
+        (try
+           G.Commitment.update c i G.Scalar.one G.Scalar.zero ;
+           assert false
+         with Invalid_argument _ -> ()) ;
+        try
+          G.Commitment.update_many
+            c
+            [| (0, G.Scalar.one, G.Scalar.zero);
+               (i, G.Scalar.one, G.Scalar.zero) |] ;
+          assert false
+        with Invalid_argument _ -> ())
+      [-1; 4] ;
+    assert (G.eq commitment (G.Commitment.commitment c))
+
+  let test_pippenger_straus () =
+    let n = 2 + Random.int 80 in
+    let nbits = [|16; 64; 100; 128; 200; 256|].(Random.int 6) in
+    let scalar () =
+      G.Scalar.of_z (Z.extract (G.Scalar.to_z (G.Scalar.random ())) 0 nbits)
+    in
+    let ps = Array.init n (fun _ -> G.random ()) in
+    let ss = Array.init n (fun _ -> scalar ()) in
+    let expected = ref G.zero in
+    Array.iteri (fun i p -> expected := G.add !expected (G.mul p ss.(i))) ps ;
+    let ps_contiguous = G.to_affine_array ps in
+    let check () =
+      assert (G.eq !expected (G.pippenger ps ss)) ;
+      assert (G.eq !expected (G.pippenger_with_affine_array ps_contiguous ss))
+    in
+    let c = if nbits <= 64 then 64 else if nbits <= 128 then 128 else 256 in
+    let threshold = G.get_straus_threshold ~nbits:c in
+    (* Straus' algorithm for all the sizes, then Pippenger's *)
+    G.set_straus_threshold ~nbits:c 1000 ;
+    check () ;
+    G.set_straus_threshold ~nbits:c 0 ;
+    check () ;
+    G.set_straus_threshold ~nbits:c threshold ;
+    assert (G.get_straus_threshold ~nbits:c = threshold) ;
+    check ()
+
+  (* The scratch of the context is reused between the MSMs, and must not leak
+     from one to the other *)
+  let test_msm_context_straus () =
+    let ctx = G.Msm_context.create () in
+    List.iter
+      (fun n ->
+        let ps = Array.init n (fun _ -> G.random ()) in
+        let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+        let expected = ref G.zero in
+        Array.iteri
+          (fun i p -> expected := G.add !expected (G.mul p ss.(i)))
+          ps ;
+        assert (G.eq !expected (G.Msm_context.pippenger ctx ps ss)) ;
+        let ps_contiguous = G.to_affine_array ps in
+        assert (
+          G.eq
+            !expected
+            (G.Msm_context.pippenger_with_affine_array ctx ps_contiguous ss)))
+      [20; 3; 11; 1; 17; 2; 20; 7]
+
+  (* The tiles and the scratch of each thread are kept in the context, for the
+     number of threads of the call *)
+  let test_msm_context_varying_threads () =
+    let ctx = G.Msm_context.create () in
+    let n = 1100 + Random.int 1000 in
+    let ps = G.to_affine_array (Array.init n (fun _ -> G.random ())) in
+    let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+    List.iter
+      (fun nb_threads ->
+        let len = n - Random.int 100 in
+        let expected = G.pippenger_with_affine_array ~len ps ss in
+        let res =
+          with_threads
+            nb_threads
+            (fun () -> G.Msm_context.pippenger_with_affine_array ~len ctx ps ss)
+            ()
+        in
+        if not (G.eq expected res) then
+          Alcotest.failf "nb_threads = %d, len = %d" nb_threads len)
+      [4; 2; 8; 1; 3; 8]
+
+  let test_straus_threshold_invalid_arguments () =
+    List.iter
+      (fun nbits ->
+        (try
+           G.set_straus_threshold ~nbits 10 ;
+           assert false
+         with Invalid_argument _ -> ()) ;
+        try
+          ignore @@ G.get_straus_threshold ~nbits ;
+          assert false
+        with Invalid_argument _ -> ())
+      [0; 32; 255; 512] ;
+    try
+      G.set_straus_threshold ~nbits:256 (-1) ;
+      assert false
+    with Invalid_argument _ -> ()
+
+  let test_pippenger_partial () =
+    let n = 1 + Random.int 300 in
+    let bases = G.to_affine_array (Array.init n (fun _ -> G.random ())) in
+    let ss =
+      Array.init n (fun i ->
+          match i mod 5 with
+          | 0 -> G.Scalar.(negate one)
+          | 1 -> G.Scalar.zero
+          | _ -> G.Scalar.random ())
+    in
+    let expected = G.pippenger_with_affine_array bases ss in
+    (* Random ranges, each split in a random number of slices *)
+    let rec partials start acc =
+      if start = n then acc
+      else
+        let len = 1 + Random.int (n - start) in
+        let nslices =
+          match Random.int 3 with 0 -> 1 | 1 -> 64 | _ -> 1 + Random.int 64
+        in
+        let acc =
+          List.init nslices (fun k ->
+              G.pippenger_partial ~start ~len ~slice:(k, nslices) bases ss)
+          @ acc
+        in
+        partials (start + len) acc
+    in
+    let ps = partials 0 [] in
+    assert (G.eq (G.merge ps) expected) ;
+    (* Through the encoding *)
+    let ps =
+      List.map
+        (fun p ->
+          let bs = G.Partial.to_bytes p in
+          assert (Bytes.length bs = G.Partial.size_in_bytes) ;
+          G.Partial.of_bytes_exn bs)
+        ps
+    in
+    assert (G.eq (G.merge ps) expected) ;
+    assert (G.eq (G.merge []) G.zero)
+
+  let test_pippenger_partial_invalid_arguments () =
+    let n = 10 in
+    let bases = G.to_affine_array (Array.init n (fun _ -> G.random ())) in
+    let ss = Array.init n (fun _ -> G.Scalar.random ()) in
+    List.iter
+      (fun (start, len, slice) ->
+        try
+          ignore @@ G.pippenger_partial ~start ~len ~slice bases ss ;
+          assert false
+        with Invalid_argument _ -> ())
+      [ (0, 10, (0, 0));
+        (0, 10, (1, 1));
+        (0, 10, (-1, 2));
+        (0, 10, (0, 65));
+        (-1, 5, (0, 2));
+        (0, 0, (0, 2));
+        (5, 6, (0, 2));
+        (5, 6, (0, 1)) ] ;
+    assert (G.Partial.of_bytes_opt (Bytes.make 3 '\000') = None)
+
+  let test_fixed_base () =
+    let p = if Random.int 10 = 0 then G.zero else G.random () in
+    let window = 2 + Random.int 9 in
+    let table = G.Fixed_base.create ~window p in
+    assert (G.Fixed_base.window table = window) ;
+    let ss =
+      Array.init (Random.int 300) (fun i ->
+          match i with
+          | 0 -> G.Scalar.zero
+          | 1 -> G.Scalar.one
+          | 2 -> G.Scalar.(negate one)
+          | _ -> G.Scalar.random ())
+    in
+    let res = G.mul_fixed_base_many table ss in
+    assert (Array.length res = Array.length ss) ;
+    Array.iteri
+      (fun i s ->
+        let expected = G.mul p s in
+        assert (G.eq res.(i) expected) ;
+        assert (G.eq (G.Fixed_base.mul table s) expected))
+      ss ;
+    let s = G.Scalar.random () in
+    assert (G.eq (G.Fixed_base.mul (G.Fixed_base.one ()) s) (G.mul G.one s))
+
+  let test_fixed_base_invalid_arguments () =
+    List.iter
+      (fun window ->
+        try
+          ignore @@ G.Fixed_base.create ~window G.one ;
+          assert false
+        with Invalid_argument _ -> ())
+      [-1; 0; 1; 11]
+
+  let test_mul_many () =
+    let n = Random.int 300 in
+    let ps =
+      Array.init n (fun i ->
+          if i mod 17 = 3 then G.zero
+          else if i mod 17 = 5 then G.one
+          else G.random ())
+    in
+    let ss =
+      Array.init n (fun i ->
+          match i mod 13 with
+          | 0 -> G.Scalar.zero
+          | 1 -> G.Scalar.one
+          | 2 -> G.Scalar.(negate one)
+          | _ -> G.Scalar.random ())
+    in
+    let expected = Array.map2 G.mul ps ss in
+    List.iter
+      (fun vartime ->
+        let res = G.mul_many ~vartime ps ss in
+        assert (Array.length res = n) ;
+        Array.iteri (fun i p -> assert (G.eq p expected.(i))) res ;
+        let res = G.mul_many_affine_array ~vartime ps ss in
+        assert (G.size_of_affine_array res = n) ;
+        Array.iteri
+          (fun i p -> assert (G.eq p expected.(i)))
+          (G.of_affine_array res))
+      [false; true]
+
+  let test_mul_many_invalid_arguments () =
+    let ps = Array.init 3 (fun _ -> G.random ()) in
+    let ss = Array.init 2 (fun _ -> G.Scalar.random ()) in
+    (try
+       ignore @@ G.mul_many ps ss ;
+       assert false
+     with Invalid_argument _ -> ()) ;
+    try
+      ignore @@ G.mul_many_affine_array ~vartime:true ps ss ;
+      assert false
+    with Invalid_argument _ -> ()
+
+  let test_linear_combination () =
+    let n = Random.int 12 in
+    let ps =
+      Array.init n (fun _ -> if Random.int 5 = 0 then G.zero else G.random ())
+    in
+    let ss =
+      Array.init n (fun _ ->
+          if Random.int 5 = 0 then G.Scalar.zero else G.Scalar.random ())
+    in
+    let expected = Array.fold_left G.add G.zero (Array.map2 G.mul ps ss) in
+    assert (G.eq (G.linear_combination ps ss) expected) ;
+    let p = G.random () and q = G.random () in
+    let a = G.Scalar.random () and b = G.Scalar.random () in
+    let expected = G.add (G.mul p a) (G.mul q b) in
+    assert (G.eq (G.mul2 p a q b) expected) ;
+    assert (G.eq (G.mul2 p a p b) (G.mul p (G.Scalar.add a b))) ;
+    assert (G.eq (G.mul2 p a (G.negate p) a) G.zero)
+
+  let test_linear_combination_invalid_arguments () =
+    try
+      ignore @@ G.linear_combination [|G.one|] [||] ;
+      assert false
+    with Invalid_argument _ -> ()
+
+  let test_prepared () =
+    let p = if Random.int 10 = 0 then G.zero else G.random () in
+    let window = 2 + Random.int 7 in
+    let prepared = G.Prepared.create ~window p in
+    assert (G.Prepared.window prepared = window) ;
+    let ss =
+      Array.init (Random.int 100) (fun i ->
+          match i with
+          | 0 -> G.Scalar.zero
+          | 1 -> G.Scalar.one
+          | 2 -> G.Scalar.(negate one)
+          | _ -> G.Scalar.random ())
+    in
+    let res = G.Prepared.mul_many prepared ss in
+    assert (Array.length res = Array.length ss) ;
+    Array.iteri
+      (fun i s ->
+        let expected = G.mul p s in
+        assert (G.eq res.(i) expected) ;
+        assert (G.eq (G.Prepared.mul prepared s) expected))
+      ss
+
+  let test_prepared_invalid_arguments () =
+    List.iter
+      (fun window ->
+        try
+          ignore @@ G.Prepared.create ~window G.one ;
+          assert false
+        with Invalid_argument _ -> ())
+      [-1; 0; 1; 9]
+
   let get_tests () =
     let open Alcotest in
     ( "Bulk operations",
       [ test_case "bulk add" `Quick (repeat 10 test_bulk_add);
         test_case "to_affine_array" `Quick (repeat 10 test_to_affine_array);
+        test_case
+          "to_affine_array with zero points"
+          `Quick
+          test_to_affine_array_with_zero_points;
+        test_case
+          "to_affine_array with zero points and threads"
+          `Quick
+          (with_threads 4 test_to_affine_array_with_zero_points);
+        test_case
+          "bulk add with zero and equal points"
+          `Quick
+          test_bulk_add_with_zero_and_equal_points;
+        test_case
+          "bulk add with zero and equal points and threads"
+          `Quick
+          (with_threads 4 test_bulk_add_with_zero_and_equal_points);
+        test_case
+          "bulk add affine array range"
+          `Quick
+          (repeat 10 test_bulk_add_affine_array_range);
         test_case
           "size_of_affine_array"
           `Quick
           (repeat 10 test_size_of_affine_array);
         test_case "pippenger" `Quick (repeat 10 test_pippenger);
+        test_case
+          "pippenger with zero points"
+          `Quick
+          test_pippenger_with_zero_points;
+        test_case
+          "pippenger with zero points and threads"
+          `Quick
+          (with_threads 4 test_pippenger_with_zero_points);
+        test_case
+          "pippenger with threads"
+          `Quick
+          (repeat 2 test_pippenger_threads_same_result);
+        test_case
+          "pippenger with affine buckets"
+          `Quick
+          test_pippenger_affine_buckets;
+        test_case
+          "pippenger with affine buckets and threads"
+          `Quick
+          (with_threads 2 test_pippenger_affine_buckets);
+        test_case "prepared bases" `Quick (repeat 10 test_prepared_bases);
+        test_case
+          "prepared bases with many points"
+          `Quick
+          test_prepared_bases_large;
+        test_case
+          "prepared bases with many points and threads"
+          `Quick
+          (with_threads 4 test_prepared_bases_large);
+        test_case
+          "prepared bases invalid arguments"
+          `Quick
+          test_prepared_bases_invalid_arguments;
+        test_case "scalar batch" `Quick (repeat 10 test_scalar_batch);
+        test_case
+          "scalar batch with many points"
+          `Quick
+          test_scalar_batch_large;
+        test_case
+          "scalar batch with many points and threads"
+          `Quick
+          (with_threads 4 test_scalar_batch_large);
+        test_case
+          "scalar batch invalid arguments"
+          `Quick
+          test_scalar_batch_invalid_arguments;
+        test_case "pippenger multi" `Quick (repeat 10 test_pippenger_multi);
+        test_case
+          "pippenger multi with many points"
+          `Quick
+          test_pippenger_multi_large;
+        test_case
+          "pippenger multi with many points and threads"
+          `Quick
+          (with_threads 4 test_pippenger_multi_large);
+        test_case
+          "pippenger multi invalid arguments"
+          `Quick
+          test_pippenger_multi_invalid_arguments;
+        test_case "pippenger glv" `Quick (repeat 10 test_pippenger_glv);
+        test_case
+          "pippenger glv with many points"
+          `Quick
+          test_pippenger_glv_large;
+        test_case
+          "pippenger glv with many points and threads"
+          `Quick
+          (with_threads 4 test_pippenger_glv_large);
+        test_case
+          "pippenger glv invalid arguments"
+          `Quick
+          test_pippenger_glv_invalid_arguments;
+        test_case
+          "pippenger with sparse scalars"
+          `Quick
+          (repeat 10 test_pippenger_sparse_scalars);
+        test_case "msm context" `Quick (repeat 3 test_msm_context);
+        test_case
+          "msm context with threads"
+          `Quick
+          (with_threads 4 test_msm_context);
+        test_case
+          "msm context with a varying number of threads"
+          `Quick
+          test_msm_context_varying_threads;
+        test_case
+          "msm context invalid arguments"
+          `Quick
+          test_msm_context_invalid_arguments;
+        test_case "msm stream" `Quick (repeat 3 test_msm_stream);
+        test_case
+          "msm stream with threads"
+          `Quick
+          (with_threads 4 test_msm_stream);
+        test_case
+          "msm stream invalid arguments"
+          `Quick
+          test_msm_stream_invalid_arguments;
+        test_case "commitment" `Quick (repeat 10 test_commitment);
+        test_case
+          "commitment invalid arguments"
+          `Quick
+          test_commitment_invalid_arguments;
+        test_case "pippenger straus" `Quick (repeat 10 test_pippenger_straus);
+        test_case "msm context straus" `Quick test_msm_context_straus;
+        test_case
+          "straus threshold invalid arguments"
+          `Quick
+          test_straus_threshold_invalid_arguments;
+        test_case "pippenger partial" `Quick (repeat 10 test_pippenger_partial);
+        test_case
+          "pippenger partial invalid arguments"
+          `Quick
+          test_pippenger_partial_invalid_arguments;
+        test_case "fixed base" `Quick (repeat 10 test_fixed_base);
+        test_case
+          "fixed base invalid arguments"
+          `Quick
+          test_fixed_base_invalid_arguments;
+        test_case "mul many" `Quick (repeat 10 test_mul_many);
+        test_case
+          "mul many with threads"
+          `Quick
+          (with_threads 4 test_mul_many);
+        test_case
+          "mul many invalid arguments"
+          `Quick
+          test_mul_many_invalid_arguments;
+        test_case
+          "linear combination"
+          `Quick
+          (repeat 100 test_linear_combination);
+        test_case
+          "linear combination invalid arguments"
+          `Quick
+          test_linear_combination_invalid_arguments;
+        test_case "prepared" `Quick (repeat 10 test_prepared);
+        test_case
+          "prepared invalid arguments"
+          `Quick
+          test_prepared_invalid_arguments;
         test_case
           "pippenger continuous chunk size"
           `Quick
@@ -293,14 +1195,214 @@ module MakeEquality (G : Bls12_381.CURVE) = struct
     let random = G.random () in
     assert (G.eq random random)
 
+  (** Returns the same point than [p] with a different jacobian
+      representation *)
+  let other_representation p = G.add (G.double p) (G.negate p)
+
+  (** Verify [hash] and [compare] do not depend on the jacobian
+      representation *)
+  let hash_and_compare_different_representations () =
+    let p = G.random () in
+    let q = other_representation p in
+    assert (G.eq p q) ;
+    assert (G.hash p = G.hash q) ;
+    assert (G.compare p q = 0) ;
+    assert (compare p q = 0) ;
+    match Sys.backend_type with
+    | Native | Bytecode -> assert (Hashtbl.hash p = Hashtbl.hash q)
+    | Other _ -> ()
+
+  (** Verify [compare] is consistent with [eq] and antisymmetric *)
+  let compare_random () =
+    let p = G.random () in
+    let q = G.random () in
+    let c = G.compare p q in
+    assert (G.eq p q = (c = 0)) ;
+    assert (G.compare q p = -c) ;
+    assert (compare p q = c) ;
+    assert (G.compare G.zero G.zero = 0) ;
+    assert (G.compare p G.zero <> 0)
+
+  (** Verify [normalize_inplace] does not change the point, its hash or its
+      compressed encoding *)
+  let normalize_inplace () =
+    let p = other_representation (G.random ()) in
+    let q = G.copy p in
+    G.normalize_inplace q ;
+    assert (G.eq p q) ;
+    assert (G.hash p = G.hash q) ;
+    assert (Bytes.equal (G.to_compressed_bytes p) (G.to_compressed_bytes q)) ;
+    let z = G.copy G.zero in
+    G.normalize_inplace z ;
+    assert (G.is_zero z)
+
+  (** Verify points can be used as keys of a hash table *)
+  let hashtbl_dedup () =
+    let module H = Hashtbl.Make (G) in
+    let h = H.create 17 in
+    let ps = Array.init 10 (fun _ -> G.random ()) in
+    Array.iter (fun p -> H.replace h p ()) ps ;
+    Array.iter (fun p -> H.replace h (other_representation p) ()) ps ;
+    assert (H.length h = 10) ;
+    Array.iter (fun p -> assert (H.mem h (other_representation p))) ps
+
   (** Returns the tests to be used with Alcotest *)
   let get_tests () =
     let open Alcotest in
     ( "equality",
       [ test_case "zero" `Quick (repeat 1 zero);
         test_case "one" `Quick (repeat 1 one);
-        test_case "random_same_objects" `Quick (repeat 100 random_same_objects)
-      ] )
+        test_case "random_same_objects" `Quick (repeat 100 random_same_objects);
+        test_case
+          "hash and compare with different representations"
+          `Quick
+          (repeat 10 hash_and_compare_different_representations);
+        test_case "compare random" `Quick (repeat 10 compare_random);
+        test_case "normalize inplace" `Quick (repeat 10 normalize_inplace);
+        test_case "hashtbl dedup" `Quick (repeat 1 hashtbl_dedup) ] )
+end
+
+module MakeMarshal (G : Bls12_381.CURVE) = struct
+  let roundtrip x = Marshal.from_string (Marshal.to_string x []) 0
+
+  let random () =
+    let p = G.random () in
+    assert (G.eq p (roundtrip p)) ;
+    assert (G.is_zero (roundtrip G.zero)) ;
+    assert (G.eq G.one (roundtrip G.one))
+
+  let array () =
+    let ps = Array.init 10 (fun _ -> G.random ()) in
+    let ps' : G.t array = roundtrip ps in
+    Array.iteri (fun i p -> assert (G.eq p ps'.(i))) ps
+
+  let affine () =
+    let p = G.random () in
+    let p' : G.affine = roundtrip (G.affine_of_jacobian p) in
+    assert (G.eq p (G.jacobian_of_affine p'))
+
+  (* OCaml 4 does not provide the size of the block to check the length of the
+     array, see forged_affine_array_length_is_rejected *)
+  let affine_array () =
+    let ps = Array.init 10 (fun _ -> G.random ()) in
+    if Sys.ocaml_version >= "5" then (
+      let ps' : G.affine_array = roundtrip (G.to_affine_array ps) in
+      assert (G.size_of_affine_array ps' = 10) ;
+      let ps' = G.of_affine_array ps' in
+      Array.iteri (fun i p -> assert (G.eq p ps'.(i))) ps)
+    else
+      try
+        ignore (roundtrip (G.to_affine_array ps) : G.affine_array) ;
+        assert false
+      with Failure _ -> ()
+
+  let unchecked () =
+    let ps = Array.init 10 (fun _ -> G.random ()) in
+    let s = Marshal.to_string ps [] in
+    let ps' : G.t array =
+      Bls12_381.with_unchecked_unmarshal (fun () -> Marshal.from_string s 0)
+    in
+    Array.iteri (fun i p -> assert (G.eq p ps'.(i))) ps
+
+  let invalid_point_is_rejected () =
+    let s = Marshal.to_string (G.random ()) [] in
+    let s = Utils.corrupt_marshalled_custom_block ~prefix:"blst_p" ~size:8 s in
+    (try
+       ignore (Marshal.from_string s 0 : G.t) ;
+       assert false
+     with Failure _ -> ()) ;
+    ignore
+    @@ Bls12_381.with_unchecked_unmarshal (fun () ->
+           (Marshal.from_string s 0 : G.t))
+
+  (* The length of an affine array is read from the stream, then checked
+     against the size of the block. OCaml 4 does not provide the size to the
+     deserialization function, and the affine arrays are always rejected. *)
+  let forged_affine_array_length_is_rejected () =
+    let s = Marshal.to_string (G.to_affine_array [|G.random (); G.one|]) [] in
+    let identifier = "_affine_array\000" in
+    let rec find i =
+      if String.sub s i (String.length identifier) = identifier then
+        i + String.length identifier
+      else find (i + 1)
+    in
+    (* The 4 and 8 bytes of the sizes, then the length on 8 bytes in big
+       endian *)
+    let length = find 0 + 12 in
+    List.iter
+      (fun (i, c) ->
+        let b = Bytes.of_string s in
+        Bytes.set b (length + i) (Char.chr c) ;
+        try
+          ignore (Marshal.from_bytes b 0 : G.affine_array) ;
+          assert false
+        with Failure _ -> ())
+      (* Smaller and larger lengths, up to 2^62 points *)
+      [(7, 0); (7, 1); (7, 3); (7, 255); (6, 1); (4, 1); (0, 0x40)]
+
+  let get_tests () =
+    let open Alcotest in
+    ( "Marshal",
+      [ test_case "random" `Quick (unless_js (repeat 10 random));
+        test_case "array" `Quick (unless_js (repeat 10 array));
+        test_case "affine" `Quick (unless_js (repeat 10 affine));
+        test_case "affine array" `Quick (unless_js (repeat 10 affine_array));
+        test_case "unchecked" `Quick (unless_js (repeat 10 unchecked));
+        test_case
+          "invalid point is rejected"
+          `Quick
+          (unless_js (repeat 10 invalid_point_is_rejected));
+        test_case
+          "forged affine array length is rejected"
+          `Quick
+          (unless_js forged_affine_array_length_is_rejected) ] )
+end
+
+module MakeArena (G : Bls12_381.CURVE) = struct
+  let operations () =
+    let p = G.random () in
+    let q = G.random () in
+    let n = G.Scalar.random () in
+    let a = G.Arena.of_array [|p; q; G.zero|] in
+    let check i expected = assert (G.eq (G.Arena.get a i) expected) in
+    assert (G.Arena.is_zero a 2) ;
+    G.Arena.add a 2 0 1 ;
+    check 2 (G.add p q) ;
+    G.Arena.double a 2 0 ;
+    check 2 (G.double p) ;
+    G.Arena.negate a 2 0 ;
+    check 2 (G.negate p) ;
+    G.Arena.mul a 2 0 n ;
+    check 2 (G.mul p n) ;
+    G.Arena.copy a 2 1 ;
+    assert (G.Arena.eq a 2 1) ;
+    (* the output slot can be one of the inputs *)
+    G.Arena.mul a 0 0 n ;
+    check 0 (G.mul p n) ;
+    G.Arena.add a 1 1 1 ;
+    check 1 (G.double q) ;
+    G.Arena.negate a 1 1 ;
+    check 1 (G.negate (G.double q))
+
+  let get_set () =
+    let ps = Array.init 10 (fun _ -> G.random ()) in
+    let a = G.Arena.of_array ps in
+    assert (G.Arena.length a = 10) ;
+    let res = G.Arena.to_array a in
+    Array.iteri (fun i p -> assert (G.eq p res.(i))) ps ;
+    let buffer = G.random () in
+    G.Arena.get_inplace buffer a 5 ;
+    assert (G.eq buffer ps.(5)) ;
+    try
+      G.Arena.set a 10 G.one ;
+      assert false
+    with Invalid_argument _ -> ()
+
+  let get_tests () =
+    let open Alcotest in
+    ( "Arena",
+      [ test_case "operations" `Quick (repeat 10 operations);
+        test_case "get and set" `Quick (repeat 10 get_set) ] )
 end
 
 module MakeValueGeneration (G : Bls12_381.CURVE) = struct
@@ -488,6 +1590,22 @@ module MakeECProperties (G : Bls12_381.CURVE) = struct
     let xs = List.init n (fun _ -> G.random ()) in
     assert (G.(eq (List.fold_left G.add G.zero xs) (G.add_bulk xs)))
 
+  (** Verify mul_vartime g s = mul g s, including the edge cases *)
+  let mul_vartime_is_mul () =
+    let gs = [G.zero; G.one; G.random ()] in
+    let ss =
+      [ G.Scalar.zero;
+        G.Scalar.one;
+        G.Scalar.(negate one);
+        G.Scalar.of_z (Z.of_int (Random.int 1_000));
+        G.Scalar.of_z (Z.shift_left Z.one (Random.int 255));
+        G.Scalar.random () ]
+    in
+    List.iter
+      (fun g ->
+        List.iter (fun s -> assert (G.(eq (mul_vartime g s) (mul g s)))) ss)
+      gs
+
   (** Returns the tests to be used with Alcotest *)
   let get_tests () =
     let open Alcotest in
@@ -559,6 +1677,7 @@ module MakeECProperties (G : Bls12_381.CURVE) = struct
           `Quick
           (repeat 100 multiplication_properties_on_base_field_element);
         test_case "double" `Quick (repeat 100 double);
+        test_case "mul_vartime" `Quick (repeat 100 mul_vartime_is_mul);
         test_case
           "additive_associativity_with_scalar"
           `Quick
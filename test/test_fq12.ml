@@ -104,6 +104,17 @@ let test_is_zero_with_gt_zero () =
       (Bls12_381.Fq12.is_zero
          Bls12_381.Fq12.(of_bytes_exn Bls12_381.GT.(to_bytes zero))))
 
+let test_marshal () =
+  let x = Bls12_381.Fq12.random () in
+  let x' = Marshal.from_string (Marshal.to_string x []) 0 in
+  assert (Bls12_381.Fq12.eq x x') ;
+  let s = Marshal.to_string x [] in
+  let s = Utils.corrupt_marshalled_custom_block ~prefix:"blst_fp12" ~size:48 s in
+  try
+    ignore (Marshal.from_string s 0 : Bls12_381.Fq12.t) ;
+    assert false
+  with Failure _ -> ()
+
 let () =
   let open Alcotest in
   run
@@ -156,5 +167,9 @@ let () =
             "is_zero with gt generator"
             `Quick
             test_is_zero_with_gt_generator;
-          test_case "is_zero with gt zero" `Quick test_is_zero_with_gt_zero ] )
-    ]
+          test_case "is_zero with gt zero" `Quick test_is_zero_with_gt_zero ] );
+      ( "Marshal",
+        [ test_case
+            "marshal"
+            `Quick
+            (Utils.unless_js (Utils.repeat 10 test_marshal)) ] ) ]
@@ -1015,6 +1015,53 @@ module InnerProduct = struct
           (Utils.repeat 100 test_random_elements) ] )
 end
 
+module GrandProduct = struct
+  module Fr = Bls12_381.Fr
+
+  let test_random_elements () =
+    List.iter
+      (fun n ->
+        let a = Array.init n (fun _ -> Fr.random ()) in
+        let b = Array.init n (fun _ -> Fr.non_null_random ()) in
+        let z = Fr.grand_product_exn a b in
+        assert (Array.length z = n + 1) ;
+        assert (Fr.is_one z.(0)) ;
+        Array.iteri
+          (fun i a_i -> assert (Fr.eq z.(i + 1) Fr.(z.(i) * a_i / b.(i))))
+          a)
+      [0; 1; 2; 1000; 5000]
+
+  let test_zero_denominator () =
+    let a = Array.init 3000 (fun _ -> Fr.random ()) in
+    let b = Array.init 3000 (fun _ -> Fr.non_null_random ()) in
+    b.(2042) <- Fr.zero ;
+    try
+      ignore @@ Fr.grand_product_exn a b ;
+      assert false
+    with Division_by_zero -> ()
+
+  let test_different_lengths () =
+    try
+      ignore @@ Fr.grand_product_exn [|Fr.one|] [||] ;
+      assert false
+    with Invalid_argument _ -> ()
+
+  let get_tests () =
+    let open Alcotest in
+    ( "Grand product",
+      [ test_case "with random elements" `Quick test_random_elements;
+        test_case
+          "with random elements and threads"
+          `Quick
+          (Utils.with_threads 4 test_random_elements);
+        test_case "zero denominator" `Quick test_zero_denominator;
+        test_case
+          "zero denominator with threads"
+          `Quick
+          (Utils.with_threads 4 test_zero_denominator);
+        test_case "different lengths" `Quick test_different_lengths ] )
+end
+
 module AdditionalConstructors = struct
   let test_positive_values_as_documented () =
     let n = Random.int 1_000_000 in
@@ -1061,6 +1108,206 @@ module AdditionalConstructors = struct
     )
 end
 
+module Arena = struct
+  module Fr = Bls12_381.Fr
+
+  let test_operations () =
+    let x = Fr.random () in
+    let y = Fr.random () in
+    let a = Fr.Arena.of_array [|x; y; Fr.zero|] in
+    let check i expected = assert (Fr.eq (Fr.Arena.get a i) expected) in
+    Fr.Arena.add a 2 0 1 ;
+    check 2 (Fr.add x y) ;
+    Fr.Arena.sub a 2 0 1 ;
+    check 2 (Fr.sub x y) ;
+    Fr.Arena.mul a 2 0 1 ;
+    check 2 (Fr.mul x y) ;
+    Fr.Arena.double a 2 0 ;
+    check 2 (Fr.double x) ;
+    Fr.Arena.square a 2 0 ;
+    check 2 (Fr.square x) ;
+    Fr.Arena.negate a 2 0 ;
+    check 2 (Fr.negate x) ;
+    Fr.Arena.inverse_exn a 2 0 ;
+    check 2 (Fr.inverse_exn x) ;
+    Fr.Arena.copy a 2 1 ;
+    assert (Fr.Arena.eq a 2 1) ;
+    (* the output slot can be one of the inputs *)
+    Fr.Arena.mul a 0 0 1 ;
+    check 0 (Fr.mul x y) ;
+    check 1 y
+
+  let test_get_set () =
+    let xs = Array.init 10 (fun _ -> Fr.random ()) in
+    let a = Fr.Arena.create 10 in
+    assert (Fr.Arena.length a = 10) ;
+    assert (Fr.Arena.is_zero a 3) ;
+    Array.iteri (fun i x -> Fr.Arena.set a i x) xs ;
+    let res = Fr.Arena.to_array a in
+    Array.iteri (fun i x -> assert (Fr.eq x res.(i))) xs ;
+    let buffer = Fr.random () in
+    Fr.Arena.get_inplace buffer a 5 ;
+    assert (Fr.eq buffer xs.(5))
+
+  let test_inverse_of_zero () =
+    let a = Fr.Arena.create 2 in
+    try
+      Fr.Arena.inverse_exn a 0 1 ;
+      assert false
+    with Division_by_zero -> ()
+
+  let test_out_of_bounds () =
+    let a = Fr.Arena.create 2 in
+    List.iter
+      (fun f -> try f () ; assert false with Invalid_argument _ -> ())
+      [ (fun () -> Fr.Arena.add a 0 1 2);
+        (fun () -> Fr.Arena.set a (-1) Fr.one);
+        (fun () -> ignore @@ Fr.Arena.get a 2) ]
+
+  let get_tests () =
+    let open Alcotest in
+    ( "Arena",
+      [ test_case "operations" `Quick (Utils.repeat 100 test_operations);
+        test_case "get and set" `Quick (Utils.repeat 10 test_get_set);
+        test_case "inverse of zero" `Quick test_inverse_of_zero;
+        test_case "out of bounds" `Quick test_out_of_bounds ] )
+end
+
+module Poly = struct
+  module Fr = Bls12_381.Fr
+
+  let naive_eval p x =
+    Array.fold_right (fun c acc -> Fr.(c + (acc * x))) p Fr.zero
+
+  let random_array n = Array.init n (fun _ -> Fr.random ())
+
+  let test_eval () =
+    List.iter
+      (fun n ->
+        let p = random_array n in
+        let x = Fr.random () in
+        assert (Fr.eq (Fr.Poly.eval p x) (naive_eval p x)))
+      [0; 1; 2; 10; 5000]
+
+  let test_eval_many () =
+    let ps = Array.init 10 (fun i -> random_array (i * 7)) in
+    let x = Fr.random () in
+    let res = Fr.Poly.eval_many ps x in
+    Array.iteri (fun i p -> assert (Fr.eq res.(i) (naive_eval p x))) ps
+
+  let test_multi_eval () =
+    List.iter
+      (fun (n, m) ->
+        let coefficients = random_array n in
+        let points = random_array m in
+        let res = Fr.Poly.multi_eval ~coefficients ~points in
+        assert (Array.length res = m) ;
+        Array.iteri
+          (fun i x -> assert (Fr.eq res.(i) (naive_eval coefficients x)))
+          points)
+      [(0, 3); (10, 0); (10, 20); (300, 150); (100, 257)]
+
+  (* The division by the root of the subproduct tree multiplies polynomials of
+     about 9000 coefficients, i.e. NTTs of size 2^15, split between the threads
+     from 2^14 by default *)
+  let test_multi_eval_parallel_ntt () =
+    let coefficients = random_array 9000 in
+    let points = random_array 64 in
+    let res = Fr.Poly.multi_eval ~coefficients ~points in
+    Array.iteri
+      (fun i x -> assert (Fr.eq res.(i) (naive_eval coefficients x)))
+      points
+
+  let test_interpolate () =
+    List.iter
+      (fun n ->
+        let points = random_array n in
+        let values = random_array n in
+        let p = Fr.Poly.interpolate ~points ~values in
+        assert (Array.length p = n) ;
+        Array.iteri
+          (fun i x -> assert (Fr.eq values.(i) (naive_eval p x)))
+          points)
+      [0; 1; 2; 65; 200]
+
+  let test_interpolate_roundtrip () =
+    let coefficients = random_array 130 in
+    let points = random_array 130 in
+    let values = Fr.Poly.multi_eval ~coefficients ~points in
+    let res = Fr.Poly.interpolate ~points ~values in
+    Array.iteri (fun i c -> assert (Fr.eq c res.(i))) coefficients
+
+  let test_interpolate_non_distinct_points () =
+    let points = random_array 100 in
+    points.(42) <- points.(7) ;
+    let values = random_array 100 in
+    try
+      ignore @@ Fr.Poly.interpolate ~points ~values ;
+      assert false
+    with Invalid_argument _ -> ()
+
+  let get_tests () =
+    let open Alcotest in
+    ( "Poly",
+      [ test_case "eval" `Quick (Utils.repeat 10 test_eval);
+        test_case "eval with threads" `Quick (Utils.with_threads 4 test_eval);
+        test_case "eval many" `Quick (Utils.repeat 10 test_eval_many);
+        test_case "multi eval" `Quick test_multi_eval;
+        test_case
+          "multi eval with threads"
+          `Quick
+          (Utils.with_threads 4 test_multi_eval);
+        test_case
+          "multi eval parallel NTT"
+          `Quick
+          (Utils.with_threads 4 test_multi_eval_parallel_ntt);
+        test_case "interpolate" `Quick test_interpolate;
+        test_case
+          "interpolate with threads"
+          `Quick
+          (Utils.with_threads 4 test_interpolate);
+        test_case "interpolate roundtrip" `Quick test_interpolate_roundtrip;
+        test_case
+          "interpolate non distinct points"
+          `Quick
+          test_interpolate_non_distinct_points ] )
+end
+
+module MarshalSupport = struct
+  let roundtrip x = Marshal.from_string (Marshal.to_string x []) 0
+
+  let test_random () =
+    let x = Bls12_381.Fr.random () in
+    assert (Bls12_381.Fr.eq x (roundtrip x)) ;
+    assert (Bls12_381.Fr.is_zero (roundtrip Bls12_381.Fr.zero)) ;
+    assert (Bls12_381.Fr.is_one (roundtrip Bls12_381.Fr.one))
+
+  let test_array () =
+    let xs = Array.init 100 (fun _ -> Bls12_381.Fr.random ()) in
+    let xs' : Bls12_381.Fr.t array =
+      Bls12_381.with_unchecked_unmarshal (fun () -> roundtrip xs)
+    in
+    Array.iteri (fun i x -> assert (Bls12_381.Fr.eq x xs'.(i))) xs
+
+  let test_not_in_field_is_rejected () =
+    let s = Marshal.to_string (Bls12_381.Fr.random ()) [] in
+    let s = Utils.corrupt_marshalled_custom_block ~prefix:"blst_fr" ~size:32 s in
+    try
+      ignore (Marshal.from_string s 0 : Bls12_381.Fr.t) ;
+      assert false
+    with Failure _ -> ()
+
+  let get_tests () =
+    let open Alcotest in
+    ( "Marshal",
+      [ test_case "random" `Quick (Utils.unless_js (Utils.repeat 10 test_random));
+        test_case "array" `Quick (Utils.unless_js (Utils.repeat 10 test_array));
+        test_case
+          "not in field is rejected"
+          `Quick
+          (Utils.unless_js test_not_in_field_is_rejected) ] )
+end
+
 let () =
   let open Alcotest in
   run
@@ -1073,5 +1320,9 @@ let () =
     :: BytesRepresentation.get_tests ()
     :: OCamlComparisonOperators.get_tests ()
     :: InnerProduct.get_tests ()
+    :: GrandProduct.get_tests ()
+    :: MarshalSupport.get_tests ()
+    :: Arena.get_tests ()
+    :: Poly.get_tests ()
     :: StringRepresentation.get_tests ()
     :: FFT.get_tests () :: Tests.get_tests ())
@@ -33,6 +33,8 @@ module Equality = Test_ec_make.MakeEquality (G1)
 module ECProperties = Test_ec_make.MakeECProperties (G1)
 module BulkOperations = Test_ec_make.MakeBulkOperations (G1)
 module InplaceOperations = Test_ec_make.MakeInplaceOperations (G1)
+module MarshalSupport = Test_ec_make.MakeMarshal (G1)
+module Arena = Test_ec_make.MakeArena (G1)
 
 module Memory = struct
   let test_copy () =
@@ -459,5 +461,7 @@ let () =
       UncompressedRepresentation.get_tests ();
       CompressedRepresentation.get_tests ();
       InplaceOperations.get_tests ();
+      MarshalSupport.get_tests ();
+      Arena.get_tests ();
       ArithmeticRegressionTests.get_tests ();
       Constructors.get_tests () ]
@@ -31,6 +31,8 @@ module Equality = Test_ec_make.MakeEquality (G2)
 module ECProperties = Test_ec_make.MakeECProperties (G2)
 module BulkOperations = Test_ec_make.MakeBulkOperations (G2)
 module InplaceOperations = Test_ec_make.MakeInplaceOperations (G2)
+module MarshalSupport = Test_ec_make.MakeMarshal (G2)
+module Arena = Test_ec_make.MakeArena (G2)
 
 module Memory = struct
   let test_copy () =
@@ -330,4 +332,6 @@ let () =
       CompressedRepresentation.get_tests ();
       ArithmeticRegressionTests.get_tests ();
       InplaceOperations.get_tests ();
+      MarshalSupport.get_tests ();
+      Arena.get_tests ();
       Constructors.get_tests () ]
@@ -0,0 +1,117 @@
+let test_set_get_reset () =
+  let open Bls12_381.Tuning in
+  let initial = parameters () in
+  List.iter (fun (name, v) -> assert (get name = v)) initial ;
+  set "msm_window_10" 7 ;
+  assert (get "msm_window_10" = 7) ;
+  set "g2_straus_128" 12 ;
+  assert (get "g2_straus_128" = 12) ;
+  assert (Bls12_381.G2.get_straus_threshold ~nbits:128 = 12) ;
+  set "poly_mul_naive_threshold" 8 ;
+  assert (get "poly_mul_naive_threshold" = 8) ;
+  reset () ;
+  assert (parameters () = initial)
+
+let test_invalid_arguments () =
+  let open Bls12_381.Tuning in
+  let initial = parameters () in
+  let invalid f = try f () ; assert false with Invalid_argument _ -> () in
+  invalid (fun () -> ignore (get "unknown")) ;
+  invalid (fun () -> set "unknown" 1) ;
+  invalid (fun () -> set "msm_window_32" 4) ;
+  invalid (fun () -> set "msm_window_3" 1) ;
+  invalid (fun () -> set "msm_window_3" 21) ;
+  invalid (fun () -> set "threads" 0) ;
+  invalid (fun () -> set "g1_straus_64" (-1)) ;
+  invalid (fun () -> set "ntt_task_size" 0) ;
+  invalid (fun () -> calibrate ~max_log_npoints:3 ()) ;
+  invalid (fun () -> calibrate ~max_threads:0 ()) ;
+  assert (parameters () = initial)
+
+let test_save_load () =
+  let open Bls12_381.Tuning in
+  let file = Filename.temp_file "bls12_381" ".profile" in
+  set "msm_window_12" 9 ;
+  set "g1_straus_256" 20 ;
+  set "ntt_task_size" 2048 ;
+  let expected = parameters () in
+  save file ;
+  reset () ;
+  load file ;
+  assert (parameters () = expected) ;
+  reset () ;
+  Sys.remove file
+
+let test_load_comments_and_unknown () =
+  let open Bls12_381.Tuning in
+  let file = Filename.temp_file "bls12_381" ".profile" in
+  let write lines =
+    let oc = open_out file in
+    List.iter (fun l -> output_string oc (l ^ "\n")) lines ;
+    close_out oc
+  in
+  write ["# comment"; ""; "msm_window_8  5"; "unknown_parameter 3"] ;
+  load file ;
+  assert (get "msm_window_8" = 5) ;
+  reset () ;
+  let initial = parameters () in
+  (* Nothing is set if one of the lines is invalid *)
+  List.iter
+    (fun lines ->
+      write lines ;
+      try
+        load file ;
+        assert false
+      with Failure _ -> assert (parameters () = initial))
+    [ ["msm_window_8 5"; "msm_window_9"];
+      ["msm_window_8 5"; "msm_window_9 x"];
+      ["msm_window_8 5"; "msm_window_9 1"] ] ;
+  Sys.remove file
+
+(* The results do not depend on the parameters *)
+let test_msm_windows () =
+  let open Bls12_381 in
+  let n = 100 in
+  let points = Array.init n (fun _ -> G1.random ()) in
+  let scalars = Array.init n (fun _ -> Fr.random ()) in
+  let expected =
+    Array.fold_left G1.add G1.zero (Array.map2 G1.mul points scalars)
+  in
+  Tuning.set "g1_straus_256" 0 ;
+  List.iter
+    (fun w ->
+      Tuning.set "msm_window_6" w ;
+      assert (G1.eq (G1.pippenger points scalars) expected))
+    [0; 2; 3; 5; 8; 12] ;
+  Tuning.reset ()
+
+let test_poly_parameters () =
+  let open Bls12_381 in
+  let n = 300 in
+  let coefficients = Array.init n (fun _ -> Fr.random ()) in
+  let points = Array.init n (fun _ -> Fr.random ()) in
+  let expected = Array.map (Fr.Poly.eval coefficients) points in
+  List.iter
+    (fun (naive, task_size) ->
+      Tuning.set "poly_mul_naive_threshold" naive ;
+      Tuning.set "ntt_task_size" task_size ;
+      Tuning.set "ntt_parallel_log_size" 0 ;
+      let res = Fr.Poly.multi_eval ~coefficients ~points in
+      assert (Array.for_all2 Fr.eq res expected))
+    [(1, 1); (8, 3); (32, 4096); (128, 64)] ;
+  Tuning.reset ()
+
+let () =
+  let open Alcotest in
+  run
+    "Tuning"
+    [ ( "Parameters",
+        [ test_case "set get reset" `Quick test_set_get_reset;
+          test_case "invalid arguments" `Quick test_invalid_arguments;
+          test_case "save load" `Quick test_save_load;
+          test_case
+            "load comments and unknown"
+            `Quick
+            test_load_comments_and_unknown;
+          test_case "msm windows" `Quick test_msm_windows;
+          test_case "poly parameters" `Quick test_poly_parameters ] ) ]
@@ -46,3 +46,37 @@ let rec repeat n f () =
   if n > 0 then (
     f () ;
     repeat (n - 1) f ())
+
+(** [corrupt_marshalled_custom_block ~prefix ~size s] returns a copy of the
+    marshalled value [s] where the first [size] bytes of the data of the first
+    custom block whose identifier starts with [prefix] are overwritten with
+    [0xff]. The identifier is a null-terminated string preceding the data.
+    [size] must not exceed the size of the data. Pass the size of a whole
+    field element, e.g. [32] for {!Bls12_381.Fr} or [48] for a coordinate in
+    Fq, to get a value which is not reduced, or a few bytes, e.g. [8] for the
+    points, to move a point out of the curve. Only for the blocks of fixed
+    size: the identifier of the affine arrays is followed by their sizes, not
+    by their data. *)
+let corrupt_marshalled_custom_block ~prefix ~size s =
+  let n = String.length prefix in
+  let rec find i =
+    if i + n > String.length s then raise Not_found
+    else if String.sub s i n = prefix then i
+    else find (i + 1)
+  in
+  let start = String.index_from s (find 0) '\000' + 1 in
+  let b = Bytes.of_string s in
+  Bytes.fill b start size '\255' ;
+  Bytes.to_string b
+
+(** [unless_js f] evaluates [f ()] except with the JavaScript backend, i.e.
+    with the native and bytecode backends *)
+let unless_js f () =
+  match Sys.backend_type with Native | Bytecode -> f () | Other _ -> ()
+
+(** [with_threads n f ()] runs [f ()] with [n] threads for the parallel
+    routines, restoring the previous setting afterwards *)
+let with_threads n f () =
+  let previous = Bls12_381.get_number_of_threads () in
+  Bls12_381.set_number_of_threads n ;
+  Fun.protect ~finally:(fun () -> Bls12_381.set_number_of_threads previous) f
@@ -0,0 +1,14 @@
+(* Calibrate the parameters of the kernels for this machine and save them in a
+   profile, to be loaded with BLS12_381_PROFILE=<file>.
+   Usage: calibrate.exe [file] [max_log_npoints] *)
+
+let () =
+  let file =
+    if Array.length Sys.argv > 1 then Sys.argv.(1) else "bls12_381.profile"
+  in
+  let max_log_npoints =
+    if Array.length Sys.argv > 2 then int_of_string Sys.argv.(2) else 16
+  in
+  Bls12_381.Tuning.calibrate ~max_log_npoints ~log:print_endline () ;
+  Bls12_381.Tuning.save file ;
+  Printf.printf "Profile saved in %s\n" file
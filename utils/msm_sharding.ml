@@ -0,0 +1,94 @@
+(* Example of a MSM on G1 split between worker processes with
+   G1.pippenger_partial and G1.merge. The points are split in ranges and the
+   bits of the scalars in slices, each worker computing some of the (range,
+   slice) partials. The partials are sent back to the parent on a pipe, the
+   encoding of a partial being a compressed point. Workers on other hosts would
+   only need their range of the bases and of the scalars.
+   Usage: msm_sharding.exe [log_npoints] [nb_workers] [nslices] *)
+
+module G1 = Bls12_381.G1
+
+let arg i default =
+  if Array.length Sys.argv > i then int_of_string Sys.argv.(i) else default
+
+(* The partials of the jobs [(range, slice)] of the worker [w], i.e. the jobs
+   [j] such that [j mod nb_workers = w] *)
+let worker ~nb_workers ~nranges ~nslices bases scalars w oc =
+  let n = Array.length scalars in
+  for j = 0 to (nranges * nslices) - 1 do
+    if j mod nb_workers = w then (
+      let range = j / nslices in
+      let start = range * n / nranges in
+      let len = ((range + 1) * n / nranges) - start in
+      let slice = (j mod nslices, nslices) in
+      let partial = G1.pippenger_partial ~start ~len ~slice bases scalars in
+      output_bytes oc (G1.Partial.to_bytes partial))
+  done ;
+  close_out oc
+
+let () =
+  let log_npoints = arg 1 16 in
+  let nb_workers = arg 2 4 in
+  let nslices = arg 3 2 in
+  let n = 1 lsl log_npoints in
+  (* At least one job per worker *)
+  let nranges = (nb_workers + nslices - 1) / nslices in
+  let state = Random.State.make [|42|] in
+  let p = G1.random ~state () in
+  let points = Array.make n p in
+  for i = 1 to n - 1 do
+    points.(i) <- G1.add points.(i - 1) G1.one
+  done ;
+  let bases = G1.to_affine_array points in
+  let scalars = Array.init n (fun _ -> Bls12_381.Fr.random ~state ()) in
+  let t0 = Unix.gettimeofday () in
+  let expected = G1.pippenger_with_affine_array bases scalars in
+  let t1 = Unix.gettimeofday () in
+  flush_all () ;
+  let pipes =
+    List.init nb_workers (fun w ->
+        let (fd_in, fd_out) = Unix.pipe () in
+        match Unix.fork () with
+        | 0 ->
+            Unix.close fd_in ;
+            worker
+              ~nb_workers
+              ~nranges
+              ~nslices
+              bases
+              scalars
+              w
+              (Unix.out_channel_of_descr fd_out) ;
+            exit 0
+        | pid ->
+            Unix.close fd_out ;
+            (pid, Unix.in_channel_of_descr fd_in))
+  in
+  let partials =
+    List.map
+      (fun (pid, ic) ->
+        let rec read acc =
+          let bs = Bytes.create G1.Partial.size_in_bytes in
+          match really_input ic bs 0 (Bytes.length bs) with
+          | () -> read (G1.Partial.of_bytes_exn bs :: acc)
+          | exception End_of_file -> acc
+        in
+        let partials = read [] in
+        close_in ic ;
+        ignore (Unix.waitpid [] pid) ;
+        partials)
+      pipes
+  in
+  let res = G1.merge (List.concat partials) in
+  let t2 = Unix.gettimeofday () in
+  Printf.printf
+    "%d points, %d workers, %d ranges of %d slices\n"
+    n
+    nb_workers
+    nranges
+    nslices ;
+  Printf.printf "one process: %.3fs\n" (t1 -. t0) ;
+  Printf.printf "%d workers: %.3fs\n" nb_workers (t2 -. t1) ;
+  if not (G1.eq res expected) then (
+    prerr_endline "The merged partials are not the MSM" ;
+    exit 1)